@@ -1,5 +1,8 @@
 #include "cmdline.hpp"
 #include <mcp/common/pwd.hpp>
+#include <mcp/core/snapshot_archive.hpp>
+
+#include <thread>
 
 bool mcp::handle_node_options(boost::program_options::variables_map & vm)
 {
@@ -84,6 +87,48 @@ bool mcp::handle_node_options(boost::program_options::variables_map & vm)
 			std::cerr << "Requires one <file> option\n";
 		}
 	}
+	else if (vm.count("snapshot_export") || vm.count("snapshot_import"))
+	{
+		if (vm.count("file"))
+		{
+			boost::filesystem::path archive_path(vm["file"].as<std::string>());
+			unsigned threads(vm.count("threads") ? vm["threads"].as<unsigned>() : std::thread::hardware_concurrency());
+			mcp::summary_hash summary(0);
+			if (vm.count("summary"))
+			{
+				std::string summary_text = vm["summary"].as<std::string>();
+				if (!mcp::isH256(summary_text))
+				{
+					std::cerr << "Invalid summary\n";
+					return result;
+				}
+				summary = mcp::summary_hash(summary_text);
+			}
+
+			mcp::db::database::init_table_cache(mcp::db::database_config().cache_size);
+			bool error(false);
+			mcp::block_store store(error, data_path / "chaindb");
+			if (error)
+			{
+				std::cerr << "Chain database open error, stop the node before snapshot_export or snapshot_import\n";
+				return result;
+			}
+
+			mcp::snapshot_archive archive(archive_path);
+			if (vm.count("snapshot_export"))
+				error = archive.write(store, threads);
+			else
+				error = archive.read(store, threads, summary);
+			if (error)
+				std::cerr << "Snapshot " << (vm.count("snapshot_export") ? "export" : "import") << " failed, see log\n";
+			else
+				std::cout << archive.get_info() << '\n';
+		}
+		else
+		{
+			std::cerr << "Requires one <file> option\n";
+		}
+	}
 	else if (vm.count("account_list"))
 	{
 		vm_instance instance(data_path);
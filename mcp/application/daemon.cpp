@@ -1,6 +1,7 @@
 #include <fstream>
 #include <iostream>
 #include <thread>
+#include <future>
 #include <boost/algorithm/string.hpp>
 #include <mcp/core/param.hpp>
 #include <mcp/core/contract.hpp>
@@ -54,7 +55,11 @@ mcp_daemon::thread_config::thread_config() :
 	io_threads(std::max<unsigned>(2, std::thread::hardware_concurrency() / 2)),
 	bg_threads(std::max<unsigned>(1, std::thread::hardware_concurrency() / 2)),
 	sync_threads(std::max<unsigned>(1, std::thread::hardware_concurrency() / 2)),
-	work_threads(std::max<unsigned>(1, std::thread::hardware_concurrency()))
+	work_threads(std::max<unsigned>(1, std::thread::hardware_concurrency())),
+	exec_threads(0),
+	txpool_txs(200000),
+	txpool_mb(256),
+	fast_sync(false)
 {
 }
 
@@ -64,6 +69,10 @@ void mcp_daemon::thread_config::serialize_json(mcp::json & json_a) const
 	json_a["bg_threads"] = bg_threads;
 	json_a["sync_threads"] = sync_threads;
 	json_a["work_threads"] = work_threads;
+	json_a["exec_threads"] = exec_threads;
+	json_a["txpool_txs"] = txpool_txs;
+	json_a["txpool_mb"] = txpool_mb;
+	json_a["fast_sync"] = fast_sync;
 }
 
 bool mcp_daemon::thread_config::deserialize_json(mcp::json const & json_a)
@@ -107,6 +116,27 @@ bool mcp_daemon::thread_config::deserialize_json(mcp::json const & json_a)
 			error = true;
 		}
 
+		///optional, serial execution if not set
+		if (json_a.count("exec_threads") && json_a["exec_threads"].is_number_unsigned())
+		{
+			exec_threads = json_a["exec_threads"].get<unsigned>();
+		}
+
+		///optional, default limits if not set
+		if (json_a.count("txpool_txs") && json_a["txpool_txs"].is_number_unsigned())
+		{
+			txpool_txs = json_a["txpool_txs"].get<unsigned>();
+		}
+		if (json_a.count("txpool_mb") && json_a["txpool_mb"].is_number_unsigned())
+		{
+			txpool_mb = json_a["txpool_mb"].get<unsigned>();
+		}
+		///optional, full sync if not set
+		if (json_a.count("fast_sync") && json_a["fast_sync"].is_boolean())
+		{
+			fast_sync = json_a["fast_sync"].get<bool>();
+		}
+
 		error |= bg_threads == 0;
 		error |= io_threads == 0;
 		error |= sync_threads == 0;
@@ -374,7 +404,11 @@ void mcp_daemon::add_options(boost::program_options::options_description & descr
     description_a.add_options()
         ("io_threads", boost::program_options::value<uint16_t>(), "Number of io threads")
         ("bg_threads", boost::program_options::value<uint16_t>(), "Number of background threads")
-        ("sync_threads", boost::program_options::value<uint16_t>(), "Number of syncing threads");
+        ("sync_threads", boost::program_options::value<uint16_t>(), "Number of syncing threads")
+        ("exec_threads", boost::program_options::value<uint16_t>(), "Number of parallel transaction execution threads, 0 is serial")
+        ("txpool_txs", boost::program_options::value<uint32_t>(), "Max transactions in transaction queue (default: 200000)")
+        ("txpool_mb", boost::program_options::value<uint32_t>(), "Max megabytes of transactions in transaction queue (default: 256)")
+        ("fast_sync", "Bootstrap an empty database from a witness-attested state snapshot of a peer");
 
     //rpc
     description_a.add_options()
@@ -415,7 +449,11 @@ void mcp_daemon::add_options(boost::program_options::options_description & descr
 	//database
 	description_a.add_options()
 		("cache", boost::program_options::value<uint64_t>(), "database block cache")
-		("write_buffer", boost::program_options::value<uint64_t>(), "database write buffer");
+		("write_buffer", boost::program_options::value<uint64_t>(), "database write buffer")
+		("trie_cache", boost::program_options::value<uint64_t>(), "contract trie nodes cache, MB")
+		("block_cache", boost::program_options::value<uint64_t>(), "cache of blocks, transactions, receipts and states, MB")
+		("prune_mcis", boost::program_options::value<uint64_t>(), "keep historical account states and traces of last mcis, 0 keeps all")
+		("no_traces", "Do not record transaction traces");
 }
 
 bool mcp_daemon::parse_command_to_config(mcp_daemon::daemon_config & config_a, boost::program_options::variables_map const & vm_a)
@@ -435,6 +473,22 @@ bool mcp_daemon::parse_command_to_config(mcp_daemon::daemon_config & config_a, b
     {
         config_a.node.sync_threads = vm_a["sync_threads"].as<uint16_t>();
     }
+    if (vm_a.count("exec_threads"))
+    {
+        config_a.node.exec_threads = vm_a["exec_threads"].as<uint16_t>();
+    }
+    if (vm_a.count("txpool_txs"))
+    {
+        config_a.node.txpool_txs = vm_a["txpool_txs"].as<uint32_t>();
+    }
+    if (vm_a.count("txpool_mb"))
+    {
+        config_a.node.txpool_mb = vm_a["txpool_mb"].as<uint32_t>();
+    }
+    if (vm_a.count("fast_sync"))
+    {
+        config_a.node.fast_sync = true;
+    }
     if (vm_a.count("work_threads"))
     {
         config_a.node.work_threads = vm_a["work_threads"].as<uint16_t>();
@@ -567,6 +621,22 @@ bool mcp_daemon::parse_command_to_config(mcp_daemon::daemon_config & config_a, b
 	{
 		config_a.db.write_buffer_size = vm_a["write_buffer"].as<uint32_t>();
 	}
+	if (vm_a.count("trie_cache"))
+	{
+		config_a.db.trie_cache_size = vm_a["trie_cache"].as<uint64_t>();
+	}
+	if (vm_a.count("block_cache"))
+	{
+		config_a.db.block_cache_size = vm_a["block_cache"].as<uint64_t>();
+	}
+	if (vm_a.count("prune_mcis"))
+	{
+		config_a.db.prune_mcis = vm_a["prune_mcis"].as<uint64_t>();
+	}
+	if (vm_a.count("no_traces"))
+	{
+		config_a.db.record_traces = false;
+	}
 
     return error;
 }
@@ -754,6 +824,15 @@ void mcp_daemon::daemon::run(boost::filesystem::path const &data_path, boost::pr
 		mcp::param::init(cache);
 		///chain
 		std::shared_ptr<mcp::chain> chain(std::make_shared<mcp::chain>(chain_store, cache));
+		chain->set_exec_threads(config.node.exec_threads);
+
+		///history pruner
+		std::shared_ptr<mcp::history_pruner> pruner = nullptr;
+		if (mcp::db::database_config::prune_mcis > 0)
+		{
+			pruner = std::make_shared<mcp::history_pruner>(chain_store, mcp::db::database_config::prune_mcis);
+			chain->onMciStable([pruner](uint64_t const& mci) { pruner->on_stable(mci); });
+		}
 
 		///contract caller
 		mcp::DENCaller = NewDENContractCaller(std::bind(&mcp::chain::call, chain, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
@@ -761,6 +840,7 @@ void mcp_daemon::daemon::run(boost::filesystem::path const &data_path, boost::pr
 
 		/// transaction queue
 		std::shared_ptr<mcp::TransactionQueue> TQ(std::make_shared<mcp::TransactionQueue>(io_service, chain_store, cache, chain, sync_async));
+		TQ->set_limits(config.node.txpool_txs, (size_t)config.node.txpool_mb * 1024 * 1024);
 		chain->set_TQ(TQ);
 		/// approve queue
 		std::shared_ptr<mcp::ApproveQueue> AQ(std::make_shared<mcp::ApproveQueue>(chain_store, cache, chain, sync_async));
@@ -779,24 +859,86 @@ void mcp_daemon::daemon::run(boost::filesystem::path const &data_path, boost::pr
 		std::shared_ptr<mcp::node_sync> sync(std::make_shared<mcp::node_sync>(capability, chain_store, chain, cache, TQ, AQ, sync_async, bg_io_service));
 		capability->set_sync(sync);
 
+		///fast sync of empty database, chain is initialized by block processor from imported store
+		bool fast_sync(false);
+		if (config.node.fast_sync)
+		{
+			mcp::db::db_transaction transaction(chain_store.create_transaction());
+			mcp::block_hash genesis;
+			fast_sync = chain_store.genesis_hash_get(transaction, genesis);
+			if (!fast_sync)
+				LOG(m_log.info) << "Fast sync skipped, database is not empty";
+		}
+
+		///host
+		std::shared_ptr<mcp::p2p::host> host;
+		std::unique_ptr<mcp::thread_runner> runner;
+		std::unique_ptr<mcp::thread_runner> sync_runner;
+		std::unique_ptr<mcp::thread_runner> bg_runner;
+		auto start_host = [&]() {
+			host = std::make_shared<mcp::p2p::host>(error, config.p2p, io_service, seed, data_path);
+			if (error)
+			{
+				std::cerr << "host initializing error\n";
+				return;
+			}
+			host->register_capability(capability);
+			host->start();
+		};
+		///runners are started early by fast sync only
+		auto stop_runners = [&]() {
+			if (!runner)
+				return;
+			host->stop();
+			sync->stop();
+			io_service.stop();
+			sync_io_service.stop();
+			bg_io_service.stop();
+			runner->join();
+			sync_runner->join();
+			bg_runner->join();
+		};
+		if (fast_sync)
+		{
+			std::promise<bool> imported;
+			std::future<bool> imported_future(imported.get_future());
+			sync->fast_sync([&imported](bool const & error_a) { imported.set_value(error_a); });
+
+			start_host();
+			if (error)
+				return;
+			runner = std::make_unique<mcp::thread_runner>(io_service, config.node.io_threads, "io_service");
+			sync_runner = std::make_unique<mcp::thread_runner>(sync_io_service, config.node.sync_threads, "sync_io_service");
+			bg_runner = std::make_unique<mcp::thread_runner>(bg_io_service, config.node.bg_threads, "bg_io_service");
+
+			if (imported_future.get())
+			{
+				std::cerr << "Fast sync failed, remove chaindb before starting again\n";
+				stop_runners();
+				return;
+			}
+		}
+
 		/// block processor
 		std::shared_ptr<mcp::block_processor> processor(std::make_shared<mcp::block_processor>(error, chain_store, cache, chain, sync, capability, validation, sync_async, TQ, AQ, bg_io_service, alarm));
 		if (error)
+		{
+			stop_runners();
 			return;
+		}
 		capability->set_processor(processor);
 		sync->set_processor(processor);
+		if (fast_sync)
+			sync->fast_sync_handoff();
 
 		///wallet
 		std::shared_ptr<mcp::wallet> wallet(std::make_shared<mcp::wallet>(chain_store, cache, key_manager, TQ));
-		///host
-		std::shared_ptr<mcp::p2p::host> host(std::make_shared<mcp::p2p::host>(error, config.p2p, io_service, seed, data_path));
-		if (error)
+		if (!host)
 		{
-			std::cerr << "host initializing error\n";
-			return;
+			start_host();
+			if (error)
+				return;
 		}
-		host->register_capability(capability);
-		host->start();
 
 		///witness node start
 		std::shared_ptr<mcp::witness> witness = nullptr;
@@ -810,6 +952,7 @@ void mcp_daemon::daemon::run(boost::filesystem::path const &data_path, boost::pr
 			if (error_msg.error)
 			{
 				std::cerr << error_msg.message << std::endl;
+				stop_runners();
 				return;
 			}
 			witness->start();
@@ -850,11 +993,14 @@ void mcp_daemon::daemon::run(boost::filesystem::path const &data_path, boost::pr
 		//}
 
 		ongoing_report(chain_store, host, sync_async, background, cache,
-			sync, processor, capability,chain, alarm, TQ, AQ, witness, m_log);
+			sync, processor, capability,chain, alarm, TQ, AQ, witness, pruner, m_log);
 
-		std::unique_ptr<mcp::thread_runner> runner = std::make_unique<mcp::thread_runner>(io_service, config.node.io_threads, "io_service");
-		std::unique_ptr<mcp::thread_runner> sync_runner = std::make_unique<mcp::thread_runner>(sync_io_service, config.node.sync_threads, "sync_io_service");
-		std::unique_ptr<mcp::thread_runner> bg_runner = std::make_unique<mcp::thread_runner>(bg_io_service, config.node.bg_threads, "bg_io_service");
+		if (!runner)
+		{
+			runner = std::make_unique<mcp::thread_runner>(io_service, config.node.io_threads, "io_service");
+			sync_runner = std::make_unique<mcp::thread_runner>(sync_io_service, config.node.sync_threads, "sync_io_service");
+			bg_runner = std::make_unique<mcp::thread_runner>(bg_io_service, config.node.bg_threads, "bg_io_service");
+		}
 
 		runner->join();
 		sync_runner->join();
@@ -875,6 +1021,7 @@ void mcp_daemon::ongoing_report(
 	std::shared_ptr<mcp::TransactionQueue> tq,
 	std::shared_ptr<mcp::ApproveQueue> aq,
 	std::shared_ptr<mcp::witness> witness,
+	std::shared_ptr<mcp::history_pruner> pruner,
 	mcp::log& log
 )
 {
@@ -893,6 +1040,10 @@ void mcp_daemon::ongoing_report(
 			peer_metrics_info << ", write queue buffer size:" << p->write_queue_buffer_size;
 			peer_metrics_info << ", send size:" << p->send_size;
 			peer_metrics_info << ", send count:" << p->send_count;
+			peer_metrics_info << ", wire size:" << p->send_wire_size;
+			peer_metrics_info << ", compress frames:" << p->compress_frames;
+			peer_metrics_info << ", uncompressed frames:" << p->uncompressed_frames;
+			peer_metrics_info << ", compress us:" << p->compress_us;
 			LOG(log.info) << peer_metrics_info.str();
 		}
 	}
@@ -900,13 +1051,21 @@ void mcp_daemon::ongoing_report(
 	//io service
 	LOG(log.info) << "task sync_async: " << sync_async->get_size() << " ,background: " << background->get_size();
 
-	LOG(log.info) << "block cache: " << cache->report_cache_size();
+	LOG(log.info) << "block cache: " << std::endl << cache->report();
+
+	LOG(log.info) << "db commit: " << mcp::timeout_db_transaction::stats.report();
+
+	LOG(log.info) << "trie node cache: " << store.trie_node_cache().report();
+
+	LOG(log.info) << "chain: " << chain->get_exec_info();
 
 	LOG(log.info) << "container: "
 		<< processor->get_processor_info();
 
 	LOG(log.info) << "sync info:" << sync->get_sync_info();
 
+	LOG(log.info) << sync->get_fast_sync_info();
+
 	LOG(log.info) << "unhandle: " << processor->unhandle->getInfo();
 
 	LOG(log.info) << "RequestingMageger info: " << mcp::RequestingMageger.get_info();
@@ -955,7 +1114,9 @@ void mcp_daemon::ongoing_report(
 		<< ", hello_info_request:" << mcp::CapMetricsSend.hello_info_request
 		<< ", send_hello_info:" << mcp::CapMetricsSend.send_hello_info
 		<< ", hello_info:" << mcp::CapMetricsSend.hello_info
-		<< ", hello_info_ack:" << mcp::CapMetricsSend.hello_info_ack;
+		<< ", hello_info_ack:" << mcp::CapMetricsSend.hello_info_ack
+		<< ", snapshot_request:" << mcp::CapMetricsSend.snapshot_request
+		<< ", send_snapshot:" << mcp::CapMetricsSend.send_snapshot;
 	LOG(log.info) << "capability receive: "
 		<< ", joint_request:" << mcp::CapMetricsRecieved.joint_request
 		<< ", send_joint:" << mcp::CapMetricsRecieved.send_joint
@@ -978,11 +1139,16 @@ void mcp_daemon::ongoing_report(
 		<< ", hello_info_request:" << mcp::CapMetricsRecieved.hello_info_request
 		<< ", send_hello_info:" << mcp::CapMetricsRecieved.send_hello_info
 		<< ", hello_info:" << mcp::CapMetricsRecieved.hello_info
-		<< ", hello_info_ack:" << mcp::CapMetricsRecieved.hello_info_ack;
+		<< ", hello_info_ack:" << mcp::CapMetricsRecieved.hello_info_ack
+		<< ", snapshot_request:" << mcp::CapMetricsRecieved.snapshot_request
+		<< ", snapshot_response:" << mcp::CapMetricsRecieved.snapshot_response;
 
 	if (witness)
 		LOG(log.info) << "witness:" << witness->getInfo();
 
+	if (pruner)
+		LOG(log.info) << pruner->get_info();
+
 	LOG(log.info) << store.get_rocksdb_state(32 * 1024 * 1024);
 
 	auto elapseds = mcp::stopwatch_manager::list_elapseds();
@@ -992,9 +1158,9 @@ void mcp_daemon::ongoing_report(
 	}
 
 	alarm->add(std::chrono::steady_clock::now() + std::chrono::seconds(20), [&store, host, sync_async, background, cache,
-		sync, processor, capability, chain, alarm, tq, aq, witness, &log]() {
+		sync, processor, capability, chain, alarm, tq, aq, witness, pruner, &log]() {
 		ongoing_report(store, host, sync_async, background, cache,
-			sync, processor, capability, chain, alarm, tq, aq, witness, log);
+			sync, processor, capability, chain, alarm, tq, aq, witness, pruner, log);
 	});
 }
 
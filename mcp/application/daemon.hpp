@@ -2,6 +2,7 @@
 #include <mcp/rpc/rpc_ws.hpp>
 #include <boost/program_options.hpp> 
 #include <mcp/node/witness.hpp>
+#include <mcp/node/history_pruner.hpp>
 
 namespace mcp
 {
@@ -27,6 +28,7 @@ namespace mcp_daemon
 		std::shared_ptr<mcp::TransactionQueue> tq,
 		std::shared_ptr<mcp::ApproveQueue> aq,
 		std::shared_ptr<mcp::witness> witness,
+		std::shared_ptr<mcp::history_pruner> pruner,
 		mcp::log& log
 	);
     std::string get_home_directory(std::string path);
@@ -49,6 +51,10 @@ namespace mcp_daemon
 		unsigned bg_threads;
 		unsigned sync_threads;
 		unsigned work_threads;
+		unsigned exec_threads; ///parallel transaction execution, 0 is serial
+		unsigned txpool_txs; ///max transactions in transaction queue
+		unsigned txpool_mb; ///max megabytes of transactions in transaction queue
+		bool fast_sync; ///import state snapshot of a peer if database is empty
 	};
 	class daemon_config
 	{
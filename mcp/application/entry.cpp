@@ -13,6 +13,10 @@ int main(int argc, char * const * argv)
         ("account_list", "List all accounts")
         ("account", boost::program_options::value<std::string>(), "Defines <account> for other commands")
         ("file", boost::program_options::value<std::string>(), "Defines <file> for other commands")
+        ("snapshot_export", "Export state snapshot of chain database to <file> directory")
+        ("snapshot_import", "Import state snapshot from <file> directory into empty chain database")
+        ("summary", boost::program_options::value<std::string>(), "Summary of last stable mci from a trusted source, snapshot_import compares it and does not check witness signatures")
+        ("threads", boost::program_options::value<unsigned>(), "Number of threads of snapshot_export and snapshot_import")
         ("data_path", boost::program_options::value<std::string>(), "Use the supplied path as the data directory");
 
 
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace mcp
+{
+	/// bounded lock-free multi-producer multi-consumer queue, each slot has a sequence number
+	/// telling whether it is ready to be written or read in the current lap.
+	template <typename T>
+	class mpmc_queue
+	{
+	public:
+		/// capacity_a is rounded up to power of 2
+		explicit mpmc_queue(size_t const & capacity_a)
+		{
+			size_t capacity(2);
+			while (capacity < capacity_a)
+				capacity <<= 1;
+			m_mask = capacity - 1;
+			m_slots = std::unique_ptr<slot[]>(new slot[capacity]);
+			for (size_t i = 0; i < capacity; i++)
+				m_slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		mpmc_queue(mpmc_queue const &) = delete;
+		mpmc_queue & operator=(mpmc_queue const &) = delete;
+
+		/// return false if full
+		bool try_push(T value_a)
+		{
+			size_t pos(m_tail.load(std::memory_order_relaxed));
+			while (true)
+			{
+				slot & s(m_slots[pos & m_mask]);
+				size_t seq(s.sequence.load(std::memory_order_acquire));
+				intptr_t diff((intptr_t)seq - (intptr_t)pos);
+				if (diff == 0)
+				{
+					if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						s.value = std::move(value_a);
+						s.sequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+					return false;
+				else
+					pos = m_tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		/// return false if empty
+		bool try_pop(T & value_a)
+		{
+			size_t pos(m_head.load(std::memory_order_relaxed));
+			while (true)
+			{
+				slot & s(m_slots[pos & m_mask]);
+				size_t seq(s.sequence.load(std::memory_order_acquire));
+				intptr_t diff((intptr_t)seq - (intptr_t)(pos + 1));
+				if (diff == 0)
+				{
+					if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						value_a = std::move(s.value);
+						s.sequence.store(pos + m_mask + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+					return false;
+				else
+					pos = m_head.load(std::memory_order_relaxed);
+			}
+		}
+
+		/// approximate when used concurrently
+		size_t size() const
+		{
+			size_t tail(m_tail.load(std::memory_order_relaxed));
+			size_t head(m_head.load(std::memory_order_relaxed));
+			return tail > head ? tail - head : 0;
+		}
+
+		size_t capacity() const { return m_mask + 1; }
+
+	private:
+		struct slot
+		{
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		size_t m_mask;
+		std::unique_ptr<slot[]> m_slots;
+		alignas(64) std::atomic<size_t> m_head = { 0 };
+		alignas(64) std::atomic<size_t> m_tail = { 0 };
+	};
+}
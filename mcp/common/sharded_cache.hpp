@@ -0,0 +1,254 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mcp
+{
+	/// cache with byte capacity split over shards locked separately, evicted by CLOCK.
+	/// entries of a shard live in a node array reused through a free list, lookup only maps key to node index.
+	template <typename K, typename V, typename Hash = std::hash<K>>
+	class sharded_cache
+	{
+	public:
+		/// bytes charged for a value, besides key and per entry overhead
+		using size_function = std::function<size_t(V const &)>;
+
+		/// capacity_a in bytes, 0 disable cache
+		sharded_cache(std::string const & name_a, size_t const & capacity_a, size_function const & value_size_a = nullptr) :
+			m_name(name_a),
+			m_shard_capacity(capacity_a / shard_count),
+			m_value_size(value_size_a),
+			m_hits(0),
+			m_misses(0),
+			m_evictions(0)
+		{
+			for (size_t i = 0; i < shard_count; i++)
+				m_shards.push_back(std::make_unique<shard>());
+		}
+
+		/// return true if exist
+		bool tryGet(K const & key_a, V & value_a)
+		{
+			shard & s(shard_of(key_a));
+			std::lock_guard<std::mutex> lock(s.mutex);
+			auto it(s.index.find(key_a));
+			if (it == s.index.end())
+			{
+				m_misses++;
+				return false;
+			}
+
+			node & n(s.nodes[it->second]);
+			n.referenced = true;
+			value_a = n.value;
+			m_hits++;
+			return true;
+		}
+
+		void insert(K const & key_a, V const & value_a)
+		{
+			size_t size(entry_size(value_a));
+			shard & s(shard_of(key_a));
+			std::lock_guard<std::mutex> lock(s.mutex);
+			auto it(s.index.find(key_a));
+
+			///value too large to cache, cached value of key is stale
+			if (size > m_shard_capacity)
+			{
+				if (it != s.index.end())
+				{
+					uint32_t slot(it->second);
+					s.index.erase(it);
+					release(s, slot);
+				}
+				return;
+			}
+
+			if (it != s.index.end())
+			{
+				node & n(s.nodes[it->second]);
+				s.bytes = s.bytes - n.size + size;
+				n.value = value_a;
+				n.size = size;
+				n.referenced = true;
+			}
+			else
+			{
+				uint32_t slot;
+				if (!s.free.empty())
+				{
+					slot = s.free.back();
+					s.free.pop_back();
+				}
+				else
+				{
+					slot = s.nodes.size();
+					s.nodes.emplace_back();
+				}
+
+				node & n(s.nodes[slot]);
+				n.key = key_a;
+				n.value = value_a;
+				n.size = size;
+				n.used = true;
+				n.referenced = true;
+				s.index.emplace(key_a, slot);
+				s.bytes += size;
+			}
+
+			evict(s);
+		}
+
+		void remove(K const & key_a)
+		{
+			shard & s(shard_of(key_a));
+			std::lock_guard<std::mutex> lock(s.mutex);
+			auto it(s.index.find(key_a));
+			if (it == s.index.end())
+				return;
+
+			uint32_t slot(it->second);
+			s.index.erase(it);
+			release(s, slot);
+		}
+
+		void clear()
+		{
+			for (auto const & s : m_shards)
+			{
+				std::lock_guard<std::mutex> lock(s->mutex);
+				s->nodes.clear();
+				s->free.clear();
+				s->index.clear();
+				s->bytes = 0;
+				s->hand = 0;
+			}
+		}
+
+		size_t size()
+		{
+			size_t result(0);
+			for (auto const & s : m_shards)
+			{
+				std::lock_guard<std::mutex> lock(s->mutex);
+				result += s->index.size();
+			}
+			return result;
+		}
+
+		size_t bytes()
+		{
+			size_t result(0);
+			for (auto const & s : m_shards)
+			{
+				std::lock_guard<std::mutex> lock(s->mutex);
+				result += s->bytes;
+			}
+			return result;
+		}
+
+		uint64_t hits() const { return m_hits; }
+		uint64_t misses() const { return m_misses; }
+		uint64_t evictions() const { return m_evictions; }
+
+		std::string report()
+		{
+			std::stringstream s;
+			s << m_name << " entries:" << size()
+				<< " , bytes:" << bytes()
+				<< " , capacity:" << m_shard_capacity * shard_count
+				<< " , hits:" << m_hits
+				<< " , misses:" << m_misses
+				<< " , evictions:" << m_evictions;
+			return s.str();
+		}
+
+	private:
+		/// per entry bookkeeping besides key and value, node and index entry
+		static size_t const entry_overhead = 48;
+		static size_t const shard_count = 16;
+
+		class node
+		{
+		public:
+			K key;
+			V value;
+			size_t size = 0;
+			bool used = false;
+			bool referenced = false;
+		};
+
+		class shard
+		{
+		public:
+			std::mutex mutex;
+			std::vector<node> nodes;
+			std::vector<uint32_t> free;
+			std::unordered_map<K, uint32_t, Hash> index;
+			size_t hand = 0;
+			size_t bytes = 0;
+		};
+
+		shard & shard_of(K const & key_a)
+		{
+			///fibonacci hashing, high bits select shard so that shard index does not follow map buckets
+			uint64_t h(Hash()(key_a) * 0x9E3779B97F4A7C15ull);
+			return *m_shards[(h >> 56) % shard_count];
+		}
+
+		size_t entry_size(V const & value_a) const
+		{
+			return sizeof(K) + sizeof(V) + entry_overhead + (m_value_size ? m_value_size(value_a) : 0);
+		}
+
+		/// sweep the clock hand, clearing reference bits until enough unreferenced entries are evicted
+		void evict(shard & s_a)
+		{
+			while (s_a.bytes > m_shard_capacity && !s_a.index.empty())
+			{
+				if (s_a.hand >= s_a.nodes.size())
+					s_a.hand = 0;
+
+				uint32_t slot(s_a.hand++);
+				node & n(s_a.nodes[slot]);
+				if (!n.used)
+					continue;
+				if (n.referenced)
+				{
+					n.referenced = false;
+					continue;
+				}
+
+				s_a.index.erase(n.key);
+				release(s_a, slot);
+				m_evictions++;
+			}
+		}
+
+		void release(shard & s_a, uint32_t const & slot_a)
+		{
+			node & n(s_a.nodes[slot_a]);
+			s_a.bytes -= n.size;
+			n.value = V();
+			n.size = 0;
+			n.used = false;
+			n.referenced = false;
+			s_a.free.push_back(slot_a);
+		}
+
+		std::string const m_name;
+		size_t const m_shard_capacity;
+		size_function const m_value_size;
+		std::vector<std::unique_ptr<shard>> m_shards;
+		std::atomic<uint64_t> m_hits;
+		std::atomic<uint64_t> m_misses;
+		std::atomic<uint64_t> m_evictions;
+	};
+}
@@ -1,5 +1,6 @@
 #include "ledger.hpp"
 #include <mcp/core/genesis.hpp>
+#include <mcp/core/dag_index.hpp>
 #include <mcp/common/stopwatch.hpp>
 
 #include <queue>
@@ -64,29 +65,29 @@ bool mcp::ledger::check_majority_witness(mcp::db::db_transaction & transaction_a
 	if(majority_of_witnesses == 1)
 		return true;
 
-	std::unordered_set<dev::Address> collected_witnesses;
-	collected_witnesses.insert(block_from);
-	mcp::block_hash mc_block_hash(best_pblock_hash);
+	std::shared_ptr<mcp::dag_index> index(mcp::dag_index::of(cache_a));
+	///few witnesses, linear search is faster than hashing
+	std::vector<uint32_t> collected_witnesses;
+	collected_witnesses.push_back(index->address_id(block_from));
+	uint32_t mc_id(index->node(transaction_a, *cache_a, best_pblock_hash));
 	while (true)
 	{
-		if (mc_block_hash == mcp::genesis::block_hash)
+		if (index->hash(mc_id) == mcp::genesis::block_hash)
 			return true;
 
-		std::shared_ptr<mcp::block> mc_block = cache_a->block_get(transaction_a, mc_block_hash);
-		assert_x(mc_block);
-		if (collected_witnesses.count(mc_block->from()))
+		uint32_t from(index->from(mc_id));
+		if (std::find(collected_witnesses.begin(), collected_witnesses.end(), from) != collected_witnesses.end())
 			break;
 		else
 		{
-			collected_witnesses.insert(mc_block->from());
+			collected_witnesses.push_back(from);
 			assert_x(collected_witnesses.size() <= majority_of_witnesses);
 			if (collected_witnesses.size() == majority_of_witnesses)
 				return true;
 		}
 
-		std::shared_ptr<mcp::block_state> mc_block_state(cache_a->block_state_get(transaction_a, mc_block_hash));
-		assert_x(mc_block_state);
-		mc_block_hash = mc_block_state->best_parent;
+		mc_id = index->best_parent(transaction_a, *cache_a, mc_id);
+		assert_x(mc_id != mcp::dag_index::none);
 	}
 
 	return false;
@@ -101,36 +102,38 @@ std::shared_ptr<mcp::min_wl_result> mcp::ledger::find_mc_min_wl(mcp::db::db_tran
 		uint64_t const & mc_end_level(witnessed_level_a);
 		std::shared_ptr<mcp::min_wl_result> min_wl_result(std::make_shared<mcp::min_wl_result>());
 		min_wl_result->min_wl = witnessed_level_a;
-		mcp::block_hash best_pblock_hash(best_parent_block_hash_a);
+		std::shared_ptr<mcp::dag_index> index(mcp::dag_index::of(cache_a));
+		uint32_t best_pblock_id(index->node(transaction_a, *cache_a, best_parent_block_hash_a));
 
 		min_wl_result->witnesses.insert(block_from);
+		std::vector<uint32_t> witness_ids;
+		witness_ids.push_back(index->address_id(block_from));
 
 		while (true)
 		{
-			if (best_pblock_hash == mcp::genesis::block_hash)
+			if (index->hash(best_pblock_id) == mcp::genesis::block_hash)
 				break;
 
-			std::shared_ptr<mcp::block_state> mc_block_state(cache_a->block_state_get(transaction_a, best_pblock_hash));
-			assert_x(mc_block_state);
-
-			if (mc_block_state->level < mc_end_level)
+			if (index->level(best_pblock_id) < mc_end_level)
 				break;
 
-			std::shared_ptr<mcp::block> mc_block(cache_a->block_get(transaction_a, best_pblock_hash));
-			assert_x(mc_block);
-
-			if (!min_wl_result->witnesses.count(mc_block->from()))
+			uint32_t from(index->from(best_pblock_id));
+			if (std::find(witness_ids.begin(), witness_ids.end(), from) == witness_ids.end())
 			{
-				min_wl_result->witnesses.insert(mc_block->from());
-				if (mc_block_state->witnessed_level < min_wl_result->min_wl)
+				witness_ids.push_back(from);
+				if (index->witnessed_level(best_pblock_id) < min_wl_result->min_wl)
 				{
-					min_wl_result->min_wl = mc_block_state->witnessed_level;
+					min_wl_result->min_wl = index->witnessed_level(best_pblock_id);
 				}
 			}
 
-			best_pblock_hash = mc_block_state->best_parent;
+			best_pblock_id = index->best_parent(transaction_a, *cache_a, best_pblock_id);
+			assert_x(best_pblock_id != mcp::dag_index::none);
 		}
 
+		for (size_t i(1); i < witness_ids.size(); i++)
+			min_wl_result->witnesses.insert(index->address(witness_ids[i]));
+
 		return min_wl_result;
 	}
 }
@@ -148,27 +151,27 @@ bool mcp::ledger::check_stable(mcp::db::db_transaction & transaction_a, std::sha
 		return true;
 	}
 
-	std::shared_ptr<mcp::block_state> earlier_block_state;
-	std::shared_ptr<mcp::block_state> checked_stable_block_state;
+	std::shared_ptr<mcp::dag_index> index(mcp::dag_index::of(cache_a));
+	uint32_t earlier_id;
+	uint32_t checked_stable_id;
 	{
 		//mcp::stopwatch_guard sw("check_stable0");
 
-		earlier_block_state = cache_a->block_state_get(transaction_a, earlier_hash);
-		assert_x(earlier_block_state);
-		if (!earlier_block_state->is_on_main_chain)
+		earlier_id = index->node(transaction_a, *cache_a, earlier_hash);
+		if (!index->is_on_main_chain(earlier_id))
 			return false;
 
 		//if (earlier_block_state->is_free)
 		//	return false;
 
-		checked_stable_block_state = cache_a->block_state_get(transaction_a, checked_stable_block_hash);
-		assert_x(checked_stable_block_state);
-		assert_x(checked_stable_block_state->is_on_main_chain);
-		assert_x(checked_stable_block_state->main_chain_index);
+		checked_stable_id = index->node(transaction_a, *cache_a, checked_stable_block_hash);
+		assert_x(index->is_on_main_chain(checked_stable_id));
+		assert_x(index->mci(checked_stable_id) != mcp::dag_index::no_mci);
 	}
 
-	uint64_t const & earlier_mci(*earlier_block_state->main_chain_index);
-	uint64_t const & checked_stable_mci(*checked_stable_block_state->main_chain_index);
+	uint64_t const earlier_mci(index->mci(earlier_id));
+	uint64_t const earlier_level(index->level(earlier_id));
+	uint64_t const checked_stable_mci(index->mci(checked_stable_id));
 
 	//earlier block is stable in view of best parent
 	if (earlier_mci <= checked_stable_mci)
@@ -190,78 +193,81 @@ bool mcp::ledger::check_stable(mcp::db::db_transaction & transaction_a, std::sha
 		uint64_t min_wl_check(level > 2 * wl_diff ? level - 2 * wl_diff : 0);
 		assert_x(min_wl_result->min_wl == min_wl_check);
 
-		if (min_wl_result->min_wl < earlier_block_state->level)
+		if (min_wl_result->min_wl < earlier_level)
 			return false;
 	}
+	uint64_t const min_wl(min_wl_result->min_wl);
 
-	std::unordered_set<mcp::block_hash> searched_hashs;
-	std::queue<mcp::block_hash> to_search_hashs;
+	std::vector<uint32_t> witness_ids;
+	for (dev::Address const & witness : min_wl_result->witnesses)
+		witness_ids.push_back(index->address_id(witness));
+	auto is_witness = [&witness_ids](uint32_t const & from_a) {
+		return std::find(witness_ids.begin(), witness_ids.end(), from_a) != witness_ids.end();
+	};
+
+	std::unordered_set<uint32_t> searched_ids;
+	std::queue<uint32_t> to_search_ids;
 
 	for (mcp::block_hash const & pblock_hash : parents_a)
 	{
-		searched_hashs.insert(pblock_hash);
-		to_search_hashs.push(pblock_hash);
+		uint32_t pblock_id(index->node(transaction_a, *cache_a, pblock_hash));
+		searched_ids.insert(pblock_id);
+		to_search_ids.push(pblock_id);
 	}
 
-	std::unordered_set<mcp::block_hash> mc_hashs;
+	std::unordered_set<uint32_t> mc_ids;
 	{
 		//mcp::stopwatch_guard sw("check_stable2");
-		mcp::block_hash next_mc_hash(bp_block_hash);
+		uint32_t next_mc_id(index->node(transaction_a, *cache_a, bp_block_hash));
 		while (true)
 		{
-			mc_hashs.insert(next_mc_hash);
+			mc_ids.insert(next_mc_id);
 
-			if (next_mc_hash == earlier_hash)
+			if (next_mc_id == earlier_id)
 				break;
 
-			if (next_mc_hash == mcp::genesis::block_hash)
+			if (index->hash(next_mc_id) == mcp::genesis::block_hash)
 				return false;
 
-			auto mc_block_state(cache_a->block_state_get(transaction_a, next_mc_hash));
 			//best later block does not include earlier block
-			if (mc_block_state->level <= earlier_block_state->level)
+			if (index->level(next_mc_id) <= earlier_level)
 				return false;
 
-			next_mc_hash = mc_block_state->best_parent;
+			next_mc_id = index->best_parent(transaction_a, *cache_a, next_mc_id);
+			assert_x(next_mc_id != mcp::dag_index::none);
 		}
 	}
 
 	//int search_count(0);
-	std::unordered_set<mcp::block_hash> handled_branch_hashs;
-	while (!to_search_hashs.empty())
+	std::unordered_set<uint32_t> handled_branch_ids;
+	while (!to_search_ids.empty())
 	{
 		//search_count++;
 		//mcp::stopwatch_guard sw("check_stable3");
 
-		mcp::block_hash block_hash(std::move(to_search_hashs.front()));
-		to_search_hashs.pop();
+		uint32_t block_id(to_search_ids.front());
+		to_search_ids.pop();
 
-		auto block_state(cache_a->block_state_get(transaction_a, block_hash));
-		assert_x(block_state);
-		if (block_state->level < min_wl_result->min_wl)
+		if (index->level(block_id) < min_wl)
 			continue;
 
-		std::shared_ptr<mcp::block> block;
-		if(!mc_hashs.count(block_hash))
+		if(!mc_ids.count(block_id))
 		{
-			assert_x(block_state->latest_bp_included_mc_index);
-			if (*block_state->latest_bp_included_mc_index < checked_stable_mci)
+			assert_x(index->latest_bp_included_mci(block_id) != mcp::dag_index::no_mci);
+			if (index->latest_bp_included_mci(block_id) < checked_stable_mci)
 				continue;
 
-			assert_x(block_state->earliest_bp_included_mc_index);
-			if (*block_state->earliest_bp_included_mc_index >= earlier_mci)
+			assert_x(index->earliest_bp_included_mci(block_id) != mcp::dag_index::no_mci);
+			if (index->earliest_bp_included_mci(block_id) >= earlier_mci)
 				continue;
 
-			block = cache_a->block_get(transaction_a, block_hash);
-			assert_x(block);
-
-			if (min_wl_result->witnesses.count(block->from())
-				&& *block_state->bp_included_mc_index < earlier_mci
-				&& *block_state->bp_included_mc_index >= checked_stable_mci)
+			if (is_witness(index->from(block_id))
+				&& index->bp_included_mci(block_id) < earlier_mci
+				&& index->bp_included_mci(block_id) >= checked_stable_mci)
 			{
 				//mcp::stopwatch_guard sw("check_stable3_1");				
 
-				if (!handled_branch_hashs.count(block_hash))
+				if (!handled_branch_ids.count(block_id))
 				{
 					size_t const unknown_branch_witness_count((witness_param_a.witness_count - witness_param_a.majority_of_witnesses) * 2);
 					assert_x(witness_param_a.majority_of_witnesses > unknown_branch_witness_count);
@@ -271,31 +277,29 @@ bool mcp::ledger::check_stable(mcp::db::db_transaction & transaction_a, std::sha
 						return false;
 
 					// std::unordered_set<mcp::block_hash> branch_witnesses; changed by Daniel
-					std::unordered_set<dev::Address> branch_witnesses;
-					branch_witnesses.insert(block->from());
+					std::vector<uint32_t> branch_witnesses;
+					branch_witnesses.push_back(index->from(block_id));
 
 					//check block does not include earlier block along best parents
-					mcp::block_hash branch_bp_block_hash(block_state->best_parent);
+					uint32_t branch_bp_id(index->best_parent(transaction_a, *cache_a, block_id));
 
 					while (true)
 					{
-						handled_branch_hashs.insert(branch_bp_block_hash);
+						assert_x(branch_bp_id != mcp::dag_index::none);
+						handled_branch_ids.insert(branch_bp_id);
 
 						//mcp::stopwatch_guard sw("check_stable3_1_1");
 
-						auto branch_bp_block_state(cache_a->block_state_get(transaction_a, branch_bp_block_hash));
-						assert_x(branch_bp_block_state);
-
 						if (branch_witnesses.size() < branch_witness_check_count)
 						{
-							if (branch_bp_block_state->level < min_wl_result->min_wl)
+							if (index->level(branch_bp_id) < min_wl)
 								break;
 
-							auto branch_bp_block(cache_a->block_get(transaction_a, branch_bp_block_hash));
-							if (min_wl_result->witnesses.count(branch_bp_block->from())
-								&& !branch_witnesses.count(branch_bp_block->from()))
+							uint32_t branch_bp_from(index->from(branch_bp_id));
+							if (is_witness(branch_bp_from)
+								&& std::find(branch_witnesses.begin(), branch_witnesses.end(), branch_bp_from) == branch_witnesses.end())
 							{
-								branch_witnesses.insert(branch_bp_block->from());
+								branch_witnesses.push_back(branch_bp_from);
 
 								if (branch_witnesses.size() == branch_witness_check_count)
 								{
@@ -306,25 +310,21 @@ bool mcp::ledger::check_stable(mcp::db::db_transaction & transaction_a, std::sha
 							}
 						}
 
-						if (branch_bp_block_state->is_on_main_chain)
+						if (index->is_on_main_chain(branch_bp_id))
 							break;
 
-						branch_bp_block_hash = branch_bp_block_state->best_parent;
+						branch_bp_id = index->best_parent(transaction_a, *cache_a, branch_bp_id);
 					}
 				}
 			}
 		}
-		else
-		{
-			block = cache_a->block_get(transaction_a, block_hash);
-			assert_x(block);
-		}
 
-		for (mcp::block_hash const & pblock_hash : block->parents())
+		index->link(transaction_a, *cache_a, block_id);
+		for (uint32_t const & pblock_id : index->parents(block_id))
 		{
-			auto r = searched_hashs.insert(pblock_hash);
+			auto r = searched_ids.insert(pblock_id);
 			if (r.second)
-				to_search_hashs.push(pblock_hash);
+				to_search_ids.push(pblock_id);
 		}
 	}
 
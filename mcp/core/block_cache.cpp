@@ -1,23 +1,119 @@
 #include "block_cache.hpp"
 
+namespace
+{
+	/// byte budget of a cache, permille of block cache size
+	size_t cache_capacity(size_t const & permille_a)
+	{
+		return mcp::db::database_config::block_cache_size * 1024 * 1024 / 1000 * permille_a;
+	}
+}
+
 mcp::block_cache::block_cache(mcp::block_store &store_a) :
 	m_store(store_a),
-	m_blocks(500),
-	m_block_states(500),
-	m_latest_account_states(10000),
-	m_transactions(50000),
-	m_account_nonces(10000),
-	m_transaction_address(10000),
-	m_successors(300),
-	m_block_summarys(500),
-	m_block_numbers(1000),
-	m_number_blocks(1000),
-	m_transaction_receipts(10000),
-	m_approves(500),
-	m_approve_receipts(500),
-	m_epoch_param(10),
-	m_staking(10)
+	m_blocks("blocks", cache_capacity(100), [](std::shared_ptr<mcp::block> const & b) {
+		return sizeof(mcp::block) + (b->links().size() + b->approves().size()) * sizeof(h256);
+	}),
+	m_block_states("block_states", cache_capacity(50), [](std::shared_ptr<mcp::block_state> const &) {
+		return sizeof(mcp::block_state);
+	}),
+	m_latest_account_states("latest_account_states", cache_capacity(100), [](std::shared_ptr<mcp::account_state> const &) {
+		return sizeof(mcp::account_state);
+	}),
+	m_transactions("transactions", cache_capacity(355), [](std::shared_ptr<mcp::Transaction> const & t) {
+		return sizeof(mcp::Transaction) + t->data().size();
+	}),
+	m_account_nonces("account_nonces", cache_capacity(30)),
+	m_transaction_address("transaction_address", cache_capacity(50), [](std::shared_ptr<mcp::TransactionAddress> const &) {
+		return sizeof(mcp::TransactionAddress);
+	}),
+	m_successors("successors", cache_capacity(10)),
+	m_block_summarys("block_summarys", cache_capacity(20)),
+	m_block_numbers("block_numbers", cache_capacity(20)),
+	m_number_blocks("number_blocks", cache_capacity(20)),
+	m_transaction_receipts("transaction_receipts", cache_capacity(215), [](std::shared_ptr<dev::eth::TransactionReceipt> const & r) {
+		size_t size(sizeof(dev::eth::TransactionReceipt));
+		for (auto const & l : r->log())
+			size += sizeof(l) + l.topics.size() * sizeof(h256) + l.data.size();
+		return size;
+	}),
+	m_approves("approves", cache_capacity(20), [](std::shared_ptr<mcp::approve> const &) {
+		return sizeof(mcp::approve);
+	}),
+	m_approve_receipts("approve_receipts", cache_capacity(5), [](std::shared_ptr<dev::ApproveReceipt> const &) {
+		return sizeof(dev::ApproveReceipt);
+	}),
+	m_epoch_param("epoch_param", cache_capacity(3), [](std::shared_ptr<mcp::witness_param> const & p) {
+		return sizeof(mcp::witness_param) + p->witness_list.size() * sizeof(Address);
+	}),
+	m_staking("staking", cache_capacity(2), [](std::shared_ptr<mcp::StakingList> const & l) {
+		return sizeof(mcp::StakingList) + l->size() * (sizeof(Address) + sizeof(u256) + 32);
+	})
+{
+}
+
+template <typename K, typename V>
+bool mcp::block_cache::written(mcp::overlay_table<K, V> mcp::write_overlay::* table_a, K const & key_a)
+{
+	if (!table_a)
+		return false;
+	std::shared_ptr<mcp::write_overlay const> overlay(std::atomic_load(&m_overlay));
+	return overlay && ((*overlay).*table_a).contains(key_a);
+}
+
+template <typename K, typename V>
+void mcp::block_cache::cache_insert(mcp::sharded_cache<K, V> & cache_a, K const & key_a, V const & value_a, uint64_t const & generation_a)
+{
+	cache_a.insert(key_a, value_a);
+	///an overlay was published or applied meanwhile, value may be read before commit
+	if (m_generation != generation_a)
+		cache_a.remove(key_a);
+}
+
+template <typename K, typename V, typename StoreGet>
+void mcp::block_cache::cache_batch_get(mcp::overlay_table<K, std::shared_ptr<V>> mcp::write_overlay::* table_a, mcp::sharded_cache<K, std::shared_ptr<V>> & cache_a,
+	std::vector<K> const & keys_a, std::vector<std::shared_ptr<V>> & result_a, StoreGet const & store_get_a)
+{
+	result_a.assign(keys_a.size(), nullptr);
+	std::vector<K> misses;
+	std::vector<size_t> miss_indexs;
+	std::vector<bool> cacheables;
+
+	uint64_t generation(m_generation);
+	for (size_t i = 0; i < keys_a.size(); i++)
+	{
+		bool cacheable(!written(table_a, keys_a[i]));
+		if (!cacheable || !cache_a.tryGet(keys_a[i], result_a[i]))
+		{
+			misses.push_back(keys_a[i]);
+			miss_indexs.push_back(i);
+			cacheables.push_back(cacheable);
+		}
+	}
+
+	if (misses.empty())
+		return;
+
+	std::vector<std::shared_ptr<V>> values;
+	store_get_a(misses, values);
+	for (size_t i = 0; i < misses.size(); i++)
+	{
+		result_a[miss_indexs[i]] = values[i];
+		if (values[i] && cacheables[i])
+			cache_insert(cache_a, misses[i], values[i], generation);
+	}
+}
+
+template <typename K, typename V>
+void mcp::block_cache::apply_table(mcp::overlay_table<K, V> const & table_a, mcp::sharded_cache<K, V> & cache_a)
 {
+	for (auto const & i : table_a.entries())
+	{
+		if (i.second.flushed)
+			cache_a.remove(i.first);
+		else
+			cache_a.insert(i.first, i.second.value);
+	}
 }
 
 bool mcp::block_cache::block_exists(mcp::db::db_transaction &transaction_a, mcp::block_hash const &block_hash_a)
@@ -30,15 +126,15 @@ bool mcp::block_cache::block_exists(mcp::db::db_transaction &transaction_a, mcp:
 std::shared_ptr<mcp::block> mcp::block_cache::block_get(mcp::db::db_transaction &transaction_a, mcp::block_hash const &block_hash_a)
 {
 	std::shared_ptr<mcp::block> block;
-	std::lock_guard<std::mutex> lock(m_block_mutex);
-	if (!m_block_changings.count(block_hash_a))
+	uint64_t generation(m_generation);
+	if (!written(&mcp::write_overlay::blocks, block_hash_a))
 	{
 		bool exists = m_blocks.tryGet(block_hash_a, block);
 		if (!exists)
 		{
 			block = m_store.block_get(transaction_a, block_hash_a);
 			if (block)
-				m_blocks.insert(block_hash_a, block);
+				cache_insert(m_blocks, block_hash_a, block, generation);
 		}
 	}
 	else
@@ -53,63 +149,43 @@ std::shared_ptr<mcp::block> mcp::block_cache::block_get(mcp::db::db_transaction
 	if (block_number_get(transaction_a, index_a, bh))/// not exist
 		return nullptr;
 
-	std::shared_ptr<mcp::block> block = nullptr;
-	std::lock_guard<std::mutex> lock(m_block_mutex);
-	if (!m_block_changings.count(bh))
-	{
-		bool exists = m_blocks.tryGet(bh, block);
-		if (!exists)
-		{
-			block = m_store.block_get(transaction_a, bh);
-			if (block)
-				m_blocks.insert(bh, block);
-		}
-	}
-	else
-		block = m_store.block_get(transaction_a, bh);
+	return block_get(transaction_a, bh);
+}
 
-	return block;
+void mcp::block_cache::blocks_get(mcp::db::db_transaction & transaction_a, std::vector<mcp::block_hash> const & block_hashs_a, std::vector<std::shared_ptr<mcp::block>> & result_a)
+{
+	cache_batch_get(&mcp::write_overlay::blocks, m_blocks, block_hashs_a, result_a,
+		[&](std::vector<mcp::block_hash> const & misses_a, std::vector<std::shared_ptr<mcp::block>> & values_a)
+	{
+		m_store.blocks_get(transaction_a, misses_a, values_a);
+	});
 }
 
 void mcp::block_cache::block_put(mcp::block_hash const &block_hash_a, std::shared_ptr<mcp::block> block_a)
 {
-	std::lock_guard<std::mutex> lock(m_block_mutex);
 	m_blocks.insert(block_hash_a, block_a);
 }
 
 void mcp::block_cache::block_earse(std::unordered_set<mcp::block_hash> const & block_hashs_a)
 {
-	std::lock_guard<std::mutex> lock(m_block_mutex);
 	for (mcp::block_hash const & block_hash : block_hashs_a)
 		m_blocks.remove(block_hash);
 }
 
-void mcp::block_cache::mark_block_as_changing(std::unordered_set<mcp::block_hash> const & block_hashs_a)
-{
-	std::lock_guard<std::mutex> lock(m_block_mutex);
-	for (mcp::block_hash const & block_hash : block_hashs_a)
-		m_block_changings.insert(block_hash);
-}
-
-void mcp::block_cache::clear_block_changing()
-{
-	std::lock_guard<std::mutex> lock(m_block_mutex);
-	m_block_changings.clear();
-}
 
 
 std::shared_ptr<mcp::block_state> mcp::block_cache::block_state_get(mcp::db::db_transaction &transaction_a, mcp::block_hash const &block_hash_a)
 {
 	std::shared_ptr<mcp::block_state> state;
-	std::lock_guard<std::mutex> lock(m_block_state_mutex);
-	if (!m_block_state_changings.count(block_hash_a))
+	uint64_t generation(m_generation);
+	if (!written(&mcp::write_overlay::block_states, block_hash_a))
 	{
 		bool exists = m_block_states.tryGet(block_hash_a, state);
 		if (!exists)
 		{
 			state = m_store.block_state_get(transaction_a, block_hash_a);
 			if (state)
-				m_block_states.insert(block_hash_a, state);
+				cache_insert(m_block_states, block_hash_a, state, generation);
 		}
 	}
 	else
@@ -118,38 +194,34 @@ std::shared_ptr<mcp::block_state> mcp::block_cache::block_state_get(mcp::db::db_
 	return state;
 }
 
+void mcp::block_cache::block_states_get(mcp::db::db_transaction & transaction_a, std::vector<mcp::block_hash> const & block_hashs_a, std::vector<std::shared_ptr<mcp::block_state>> & result_a)
+{
+	cache_batch_get(&mcp::write_overlay::block_states, m_block_states, block_hashs_a, result_a,
+		[&](std::vector<mcp::block_hash> const & misses_a, std::vector<std::shared_ptr<mcp::block_state>> & values_a)
+	{
+		m_store.block_states_get(transaction_a, misses_a, values_a);
+	});
+}
+
 void mcp::block_cache::block_state_put(mcp::block_hash const &block_hash_a, std::shared_ptr<mcp::block_state> block_state_a)
 {
-	std::lock_guard<std::mutex> lock(m_block_state_mutex);
 	m_block_states.insert(block_hash_a, block_state_a);
 }
 
 void mcp::block_cache::block_state_earse(std::unordered_set<mcp::block_hash> const & block_hashs_a)
 {
-	std::lock_guard<std::mutex> lock(m_block_state_mutex);
 	for (mcp::block_hash const & block_hash : block_hashs_a)
 		m_block_states.remove(block_hash);
 }
 
-void mcp::block_cache::mark_block_state_as_changing(std::unordered_set<mcp::block_hash> const & block_hashs_a)
-{
-	std::lock_guard<std::mutex> lock(m_block_state_mutex);
-	for (mcp::block_hash const & block_hash : block_hashs_a)
-		m_block_state_changings.insert(block_hash);
-}
-
-void mcp::block_cache::clear_block_state_changing()
-{
-	std::lock_guard<std::mutex> lock(m_block_state_mutex);
-	m_block_state_changings.clear();
-}
 
 
 std::shared_ptr<mcp::account_state> mcp::block_cache::latest_account_state_get(mcp::db::db_transaction &transaction_a, Address const &account_a)
 {
 	std::shared_ptr<mcp::account_state> state;
-	std::lock_guard<std::mutex> lock(m_latest_account_state_mutex);
-	if (!m_latest_account_state_changings.count(account_a))
+	uint64_t generation(m_generation);
+	bool cacheable(!written(&mcp::write_overlay::latest_account_states, account_a));
+	if (cacheable)
 	{
 		bool exists = m_latest_account_states.tryGet(account_a, state);
 		if (exists)
@@ -163,7 +235,8 @@ std::shared_ptr<mcp::account_state> mcp::block_cache::latest_account_state_get(m
 	{
 		state = m_store.account_state_get(transaction_a, hash);
 		assert_x(state);
-		m_latest_account_states.insert(account_a, state);
+		if (cacheable)
+			cache_insert(m_latest_account_states, account_a, state, generation);
 	}
 
 	return state;
@@ -171,29 +244,15 @@ std::shared_ptr<mcp::account_state> mcp::block_cache::latest_account_state_get(m
 
 void mcp::block_cache::latest_account_state_put(Address const &account_a, std::shared_ptr<mcp::account_state> account_state_a)
 {
-	std::lock_guard<std::mutex> lock(m_latest_account_state_mutex);
 	m_latest_account_states.insert(account_a, account_state_a);
 }
 
 void mcp::block_cache::latest_account_state_earse(std::unordered_set<Address> const & accounts_a)
 {
-	std::lock_guard<std::mutex> lock(m_latest_account_state_mutex);
 	for (auto const & account : accounts_a)
 		m_latest_account_states.remove(account);
 }
 
-void mcp::block_cache::mark_latest_account_state_as_changing(std::unordered_set<Address> const & accounts_a)
-{
-	std::lock_guard<std::mutex> lock(m_latest_account_state_mutex);
-	for (auto const & account : accounts_a)
-		m_latest_account_state_changings.insert(account);
-}
-
-void mcp::block_cache::clear_latest_account_state_changing()
-{
-	std::lock_guard<std::mutex> lock(m_latest_account_state_mutex);
-	m_latest_account_state_changings.clear();
-}
 
 
 bool mcp::block_cache::transaction_exists(mcp::db::db_transaction & transaction_a, h256 const & hash)
@@ -205,15 +264,15 @@ bool mcp::block_cache::transaction_exists(mcp::db::db_transaction & transaction_
 std::shared_ptr<mcp::Transaction> mcp::block_cache::transaction_get(mcp::db::db_transaction &transaction_a, h256 const &hash)
 {
 	std::shared_ptr<mcp::Transaction> t = nullptr;
-	std::lock_guard<std::mutex> lock(m_transaction_mutex);
-	if (!m_transaction_changings.count(hash))
+	uint64_t generation(m_generation);
+	if (!written(&mcp::write_overlay::transactions, hash))
 	{
 		bool exists = m_transactions.tryGet(hash, t);
 		if (!exists)
 		{
 			t = m_store.transaction_get(transaction_a, hash);
 			if (t)
-				m_transactions.insert(hash, t);
+				cache_insert(m_transactions, hash, t, generation);
 		}
 	}
 	else
@@ -222,31 +281,26 @@ std::shared_ptr<mcp::Transaction> mcp::block_cache::transaction_get(mcp::db::db_
 	return t;
 }
 
+void mcp::block_cache::transactions_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<mcp::Transaction>> & result_a)
+{
+	cache_batch_get(&mcp::write_overlay::transactions, m_transactions, hashs_a, result_a,
+		[&](std::vector<h256> const & misses_a, std::vector<std::shared_ptr<mcp::Transaction>> & values_a)
+	{
+		m_store.transactions_get(transaction_a, misses_a, values_a);
+	});
+}
+
 void mcp::block_cache::transaction_put(h256 const &hash, std::shared_ptr<mcp::Transaction> const & t)
 {
-	std::lock_guard<std::mutex> lock(m_transaction_mutex);
 	m_transactions.insert(hash, t);
 }
 
 void mcp::block_cache::transaction_earse(std::unordered_set<h256> const & hashs)
 {
-	std::lock_guard<std::mutex> lock(m_transaction_mutex);
 	for (auto const & block_hash : hashs)
 		m_transactions.remove(block_hash);
 }
 
-void mcp::block_cache::mark_transaction_as_changing(std::unordered_set<h256> const & hashs)
-{
-	std::lock_guard<std::mutex> lock(m_transaction_mutex);
-	for (auto const & block_hash : hashs)
-		m_transaction_changings.insert(block_hash);
-}
-
-void mcp::block_cache::clear_transaction_changing()
-{
-	std::lock_guard<std::mutex> lock(m_transaction_mutex);
-	m_transaction_changings.clear();
-}
 
 
 bool mcp::block_cache::approve_exists(mcp::db::db_transaction & transaction_a, h256 const & hash)
@@ -258,8 +312,6 @@ bool mcp::block_cache::approve_exists(mcp::db::db_transaction & transaction_a, h
 std::shared_ptr<mcp::approve> mcp::block_cache::approve_get(mcp::db::db_transaction &transaction_a, h256 const &hash)
 {
 	std::shared_ptr<mcp::approve> t = nullptr;
-	std::lock_guard<std::mutex> lock(m_approve_mutex);
-
 	bool exists = m_approves.tryGet(hash, t);
 	if (!exists)
 	{
@@ -272,61 +324,44 @@ std::shared_ptr<mcp::approve> mcp::block_cache::approve_get(mcp::db::db_transact
 
 void mcp::block_cache::approve_put(h256 const &hash, std::shared_ptr<mcp::approve> const & t)
 {
-	std::lock_guard<std::mutex> lock(m_approve_mutex);
 	m_approves.insert(hash, t);
 }
 
 void mcp::block_cache::approve_earse(std::unordered_set<h256> const & hashs)
 {
-	std::lock_guard<std::mutex> lock(m_approve_mutex);
 	for (auto const & block_hash : hashs)
 		m_approves.remove(block_hash);
 }
 
 bool mcp::block_cache::account_nonce_get(mcp::db::db_transaction & transaction_a, Address const & account_a, u256 & nonce_a)
 {
-	std::lock_guard<std::mutex> lock(m_account_nonce_mutex);
+	uint64_t generation(m_generation);
 	bool exists = m_account_nonces.tryGet(account_a, nonce_a);
 	if (!exists)
 	{
 		exists = m_store.account_nonce_get(transaction_a, account_a, nonce_a);
 		if (exists)
-			m_account_nonces.insert(account_a, nonce_a);
+			cache_insert(m_account_nonces, account_a, nonce_a, generation);
 	}
 	return exists;
 }
 
 void mcp::block_cache::account_nonce_put(Address const & account_a, u256 const & nonce_a)
 {
-	std::lock_guard<std::mutex> lock(m_account_nonce_mutex);
 	m_account_nonces.insert(account_a, nonce_a);
 }
 
 void mcp::block_cache::account_nonce_earse(std::unordered_set<Address> const & accounts_a)
 {
-	std::lock_guard<std::mutex> lock(m_account_nonce_mutex);
 	for (Address const & accou : accounts_a)
 		m_account_nonces.remove(accou);
 }
 
-void mcp::block_cache::mark_account_nonce_as_changing(std::unordered_set<Address> const & accounts_a)
-{
-	std::lock_guard<std::mutex> lock(m_account_nonce_mutex);
-	for (Address const & acco : accounts_a)
-		m_account_nonce_changings.insert(acco);
-}
-
-void mcp::block_cache::clear_account_nonce_changing()
-{
-	std::lock_guard<std::mutex> lock(m_account_nonce_mutex);
-	m_account_nonce_changings.clear();
-}
 
 
 std::shared_ptr<mcp::TransactionAddress> mcp::block_cache::transaction_address_get(mcp::db::db_transaction & transaction_a, h256 const & hash)
 {
 	std::shared_ptr<mcp::TransactionAddress> td = nullptr;
-	std::lock_guard<std::mutex> lock(m_transaction_address_mutex);
 	bool exists = m_transaction_address.tryGet(hash, td);
 	if (!exists)
 	{
@@ -337,9 +372,17 @@ std::shared_ptr<mcp::TransactionAddress> mcp::block_cache::transaction_address_g
 	return td;
 }
 
+void mcp::block_cache::transaction_addresses_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<mcp::TransactionAddress>> & result_a)
+{
+	cache_batch_get<h256, mcp::TransactionAddress>(nullptr, m_transaction_address, hashs_a, result_a,
+		[&](std::vector<h256> const & misses_a, std::vector<std::shared_ptr<mcp::TransactionAddress>> & values_a)
+	{
+		m_store.transaction_addresses_get(transaction_a, misses_a, values_a);
+	});
+}
+
 void mcp::block_cache::transaction_address_put(h256 const & hash, std::shared_ptr<mcp::TransactionAddress> const& td)
 {
-	std::lock_guard<std::mutex> lock(m_transaction_address_mutex);
 	m_transaction_address.insert(hash, td);
 }
 
@@ -347,15 +390,15 @@ void mcp::block_cache::transaction_address_put(h256 const & hash, std::shared_pt
 bool mcp::block_cache::successor_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & root_a, mcp::block_hash & successor_a)
 {
 	bool exists;
-	std::lock_guard<std::mutex> lock(m_successor_mutex);
-	if (!m_successor_changings.count(root_a))
+	uint64_t generation(m_generation);
+	if (!written(&mcp::write_overlay::successors, root_a))
 	{
 		exists = m_successors.tryGet(root_a, successor_a);
 		if (!exists)
 		{
 			exists = !m_store.successor_get(transaction_a, root_a, successor_a);
 			if (exists)
-				m_successors.insert(root_a, successor_a);
+				cache_insert(m_successors, root_a, successor_a, generation);
 		}
 	}
 	else
@@ -365,43 +408,29 @@ bool mcp::block_cache::successor_get(mcp::db::db_transaction & transaction_a, mc
 
 void mcp::block_cache::successor_put(mcp::block_hash const & root_a, mcp::block_hash const & successor_a)
 {
-	std::lock_guard<std::mutex> lock(m_successor_mutex);
 	m_successors.insert(root_a, successor_a);
 }
 
 void mcp::block_cache::successor_earse(std::unordered_set<mcp::block_hash> const & successors_a)
 {
-	std::lock_guard<std::mutex> lock(m_successor_mutex);
 	for (mcp::block_hash const & successor : successors_a)
 		m_successors.remove(successor);
 }
 
-void mcp::block_cache::mark_successor_as_changing(std::unordered_set<mcp::block_hash> const & successors_a)
-{
-	std::lock_guard<std::mutex> lock(m_successor_mutex);
-	for (mcp::block_hash const & successor : successors_a)
-		m_successor_changings.insert(successor);
-}
-
-void mcp::block_cache::clear_successor_changing()
-{
-	std::lock_guard<std::mutex> lock(m_successor_mutex);
-	m_successor_changings.clear();
-}
 
 
 bool mcp::block_cache::block_summary_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & block_hash_a, mcp::summary_hash & summary_a)
 {
 	bool exists;
-	std::lock_guard<std::mutex> lock(m_block_summary_mutex);
-	if (!m_block_summary_changings.count(block_hash_a))
+	uint64_t generation(m_generation);
+	if (!written(&mcp::write_overlay::block_summarys, block_hash_a))
 	{
 		exists = m_block_summarys.tryGet(block_hash_a, summary_a);
 		if (!exists)
 		{
 			exists = !m_store.block_summary_get(transaction_a, block_hash_a, summary_a);
 			if (exists)
-				m_block_summarys.insert(block_hash_a, summary_a);
+				cache_insert(m_block_summarys, block_hash_a, summary_a, generation);
 		}
 	}
 	else
@@ -411,33 +440,18 @@ bool mcp::block_cache::block_summary_get(mcp::db::db_transaction & transaction_a
 
 void mcp::block_cache::block_summary_put(mcp::block_hash const & block_hash_a, mcp::block_hash const & summary_a)
 {
-	std::lock_guard<std::mutex> lock(m_block_summary_mutex);
 	m_block_summarys.insert(block_hash_a, summary_a);
 }
 
 void mcp::block_cache::block_summary_earse(std::unordered_set<mcp::block_hash> const & block_hashs_a)
 {
-	std::lock_guard<std::mutex> lock(m_block_summary_mutex);
 	for (mcp::block_hash const & block_hash : block_hashs_a)
 		m_block_summarys.remove(block_hash);
 }
 
-void mcp::block_cache::mark_block_summary_as_changing(std::unordered_set<mcp::block_hash> const & block_hashs_a)
-{
-	std::lock_guard<std::mutex> lock(m_block_summary_mutex);
-	for (mcp::block_hash const & block_hash : block_hashs_a)
-		m_block_summary_changings.insert(block_hash);
-}
-
-void mcp::block_cache::clear_block_summary_changing()
-{
-	std::lock_guard<std::mutex> lock(m_block_summary_mutex);
-	m_block_summary_changings.clear();
-}
 
 bool mcp::block_cache::block_number_get(mcp::db::db_transaction & transaction_a, uint64_t const & index_a, mcp::block_hash & hash_a)
 {
-	std::lock_guard<std::mutex> lock(m_block_number_mutex);
 	bool exists = m_block_numbers.tryGet(index_a, hash_a);
 	if (!exists)
 	{
@@ -450,7 +464,6 @@ bool mcp::block_cache::block_number_get(mcp::db::db_transaction & transaction_a,
 
 bool mcp::block_cache::block_number_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & hash_a, uint64_t & index_a)
 {
-	std::lock_guard<std::mutex> lock(m_block_number_mutex);
 	bool exists = m_number_blocks.tryGet(hash_a,index_a);
 	if (!exists)
 	{
@@ -463,7 +476,6 @@ bool mcp::block_cache::block_number_get(mcp::db::db_transaction & transaction_a,
 
 void mcp::block_cache::block_number_put(uint64_t const & index_a, mcp::block_hash const & hash_a)
 {
-	std::lock_guard<std::mutex> lock(m_block_number_mutex);
 	m_block_numbers.insert(index_a, hash_a);
 	m_number_blocks.insert(hash_a, index_a);
 }
@@ -477,15 +489,15 @@ bool mcp::block_cache::transaction_receipt_exists(mcp::db::db_transaction & tran
 std::shared_ptr<dev::eth::TransactionReceipt> mcp::block_cache::transaction_receipt_get(mcp::db::db_transaction &transaction_a, h256 const &hash)
 {
 	std::shared_ptr<dev::eth::TransactionReceipt> t = nullptr;
-	std::lock_guard<std::mutex> lock(m_transaction_receipt_mutex);
-	if (!m_transaction_receipt_changings.count(hash))
+	uint64_t generation(m_generation);
+	if (!written(&mcp::write_overlay::transaction_receipts, hash))
 	{
 		bool exists = m_transaction_receipts.tryGet(hash, t);
 		if (!exists)
 		{
 			t = m_store.transaction_receipt_get(transaction_a, hash);
 			if (t)
-				m_transaction_receipts.insert(hash, t);
+				cache_insert(m_transaction_receipts, hash, t, generation);
 		}
 	}
 	else
@@ -494,31 +506,26 @@ std::shared_ptr<dev::eth::TransactionReceipt> mcp::block_cache::transaction_rece
 	return t;
 }
 
+void mcp::block_cache::transaction_receipts_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> & result_a)
+{
+	cache_batch_get(&mcp::write_overlay::transaction_receipts, m_transaction_receipts, hashs_a, result_a,
+		[&](std::vector<h256> const & misses_a, std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> & values_a)
+	{
+		m_store.transaction_receipts_get(transaction_a, misses_a, values_a);
+	});
+}
+
 void mcp::block_cache::transaction_receipt_put(h256 const &hash, std::shared_ptr<dev::eth::TransactionReceipt> const & t)
 {
-	std::lock_guard<std::mutex> lock(m_transaction_receipt_mutex);
 	m_transaction_receipts.insert(hash, t);
 }
 
 void mcp::block_cache::transaction_receipt_earse(std::unordered_set<h256> const & hashs)
 {
-	std::lock_guard<std::mutex> lock(m_transaction_receipt_mutex);
 	for (auto const & block_hash : hashs)
 		m_transaction_receipts.remove(block_hash);
 }
 
-void mcp::block_cache::mark_transaction_receipt_as_changing(std::unordered_set<h256> const & hashs)
-{
-	std::lock_guard<std::mutex> lock(m_transaction_receipt_mutex);
-	for (auto const & block_hash : hashs)
-		m_transaction_receipt_changings.insert(block_hash);
-}
-
-void mcp::block_cache::clear_transaction_receipt_changing()
-{
-	std::lock_guard<std::mutex> lock(m_transaction_receipt_mutex);
-	m_transaction_receipt_changings.clear();
-}
 
 bool mcp::block_cache::approve_receipt_exists(mcp::db::db_transaction & transaction_a, h256 const & hash)
 {
@@ -529,7 +536,6 @@ bool mcp::block_cache::approve_receipt_exists(mcp::db::db_transaction & transact
 std::shared_ptr<dev::ApproveReceipt> mcp::block_cache::approve_receipt_get(mcp::db::db_transaction &transaction_a, h256 const &hash)
 {
 	std::shared_ptr<dev::ApproveReceipt> t = nullptr;
-	std::lock_guard<std::mutex> lock(m_approve_receipt_mutex);
 	bool exists = m_approve_receipts.tryGet(hash, t);
 	if (!exists)
 	{
@@ -543,14 +549,12 @@ std::shared_ptr<dev::ApproveReceipt> mcp::block_cache::approve_receipt_get(mcp::
 
 void mcp::block_cache::approve_receipt_put(h256 const &hash, std::shared_ptr<dev::ApproveReceipt> const & t)
 {
-	std::lock_guard<std::mutex> lock(m_approve_receipt_mutex);
 	m_approve_receipts.insert(hash, t);
 }
 
 std::shared_ptr<mcp::witness_param> mcp::block_cache::epoch_param_get(mcp::db::db_transaction & transaction_a, Epoch const & epoch)
 {
 	std::shared_ptr<mcp::witness_param> param = nullptr;
-	std::lock_guard<std::mutex> lock(m_epoch_param_mutex);
 	bool exists = m_epoch_param.tryGet(epoch, param);
 	if (!exists)
 	{
@@ -563,7 +567,6 @@ std::shared_ptr<mcp::witness_param> mcp::block_cache::epoch_param_get(mcp::db::d
 
 void mcp::block_cache::epoch_param_put(mcp::db::db_transaction & transaction_a, Epoch const & epoch, std::shared_ptr<witness_param> param)
 {
-	std::lock_guard<std::mutex> lock(m_epoch_param_mutex);
 	m_store.epoch_param_put(transaction_a, epoch, *param);
 	m_epoch_param.insert(epoch, param);
 }
@@ -571,8 +574,6 @@ void mcp::block_cache::epoch_param_put(mcp::db::db_transaction & transaction_a,
 mcp::StakingList mcp::block_cache::GetStakingList(mcp::db::db_transaction & _transaction, Epoch const & _epoch)
 {
 	std::shared_ptr<mcp::StakingList> sl = nullptr;
-	std::lock_guard<std::mutex> lock(m_staking_mutex);
-	bool exists = m_staking.tryGet(_epoch, sl);
 	if (m_staking.tryGet(_epoch, sl))
 		return *sl;
 	return m_store.GetStakingList(_transaction, _epoch);
@@ -582,21 +583,47 @@ mcp::StakingList mcp::block_cache::GetStakingList(mcp::db::db_transaction & _tra
 
 void mcp::block_cache::PutStakingList(mcp::db::db_transaction & _transaction, Epoch const & _epoch, mcp::StakingList const & _sl)
 {
-	std::lock_guard<std::mutex> lock(m_staking_mutex);
 	m_store.PutStakingList(_transaction, _epoch, _sl);
 	m_staking.insert(_epoch, std::make_shared<mcp::StakingList>(_sl));
 }
 
-std::string mcp::block_cache::report_cache_size()
+void mcp::block_cache::publish(std::shared_ptr<mcp::write_overlay const> overlay_a)
+{
+	///reads in progress do not cache their values
+	std::atomic_store(&m_overlay, overlay_a);
+	m_generation++;
+}
+
+void mcp::block_cache::apply(mcp::write_overlay const & overlay_a)
+{
+	apply_table(overlay_a.blocks, m_blocks);
+	apply_table(overlay_a.block_states, m_block_states);
+	apply_table(overlay_a.latest_account_states, m_latest_account_states);
+	apply_table(overlay_a.account_nonces, m_account_nonces);
+	apply_table(overlay_a.transactions, m_transactions);
+	apply_table(overlay_a.successors, m_successors);
+	apply_table(overlay_a.block_summarys, m_block_summarys);
+	apply_table(overlay_a.transaction_receipts, m_transaction_receipts);
+}
+
+std::string mcp::block_cache::report()
 {
 	std::stringstream s;
-	s << "m_blocks:" << m_blocks.size()
-		<< " , m_block_states:" << m_block_states.size()
-		<< " , m_latest_account_states:" << m_latest_account_states.size()
-		<< " , m_successors:" << m_successors.size()
-		<< " , m_block_summarys:" << m_block_summarys.size()
-		<< " , m_transactions:" << m_transactions.size()
-		<< " , m_transaction_receipts:" << m_transaction_receipts.size();
+	s << m_blocks.report() << std::endl
+		<< m_block_states.report() << std::endl
+		<< m_latest_account_states.report() << std::endl
+		<< m_transactions.report() << std::endl
+		<< m_account_nonces.report() << std::endl
+		<< m_transaction_address.report() << std::endl
+		<< m_successors.report() << std::endl
+		<< m_block_summarys.report() << std::endl
+		<< m_block_numbers.report() << std::endl
+		<< m_number_blocks.report() << std::endl
+		<< m_transaction_receipts.report() << std::endl
+		<< m_approves.report() << std::endl
+		<< m_approve_receipts.report() << std::endl
+		<< m_epoch_param.report() << std::endl
+		<< m_staking.report();
 
 	return s.str();
-}
\ No newline at end of file
+}
@@ -3,7 +3,7 @@
 #include "blocks.hpp"
 #include <mcp/core/common.hpp>
 #include <mcp/core/block_store.hpp>
-#include <mcp/common/lruc_cache.hpp>
+#include <mcp/common/sharded_cache.hpp>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
@@ -13,6 +13,8 @@
 
 namespace mcp
 {
+class dag_index;
+
 class iblock_cache
 {
 public:
@@ -27,6 +29,106 @@ public:
 	virtual bool account_nonce_get(mcp::db::db_transaction & transaction_a, Address const & account_a, u256 & nonce_a) = 0;
 	virtual bool successor_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & root_a, mcp::block_hash & successor_a) = 0;
 	virtual bool block_summary_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & block_hash_a, mcp::summary_hash & summary_a) = 0;
+
+	/// batched get, cache hits are served first and the misses are read by one MultiGet. result_a[i] is nullptr if not exist
+	virtual void blocks_get(mcp::db::db_transaction & transaction_a, std::vector<mcp::block_hash> const & block_hashs_a, std::vector<std::shared_ptr<mcp::block>> & result_a) = 0;
+	virtual void block_states_get(mcp::db::db_transaction & transaction_a, std::vector<mcp::block_hash> const & block_hashs_a, std::vector<std::shared_ptr<mcp::block_state>> & result_a) = 0;
+	virtual void transactions_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<Transaction>> & result_a) = 0;
+	virtual void transaction_receipts_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> & result_a) = 0;
+
+	/// dag index kept in step with writes of this cache, nullptr if none is kept
+	virtual std::shared_ptr<mcp::dag_index> get_dag_index() { return nullptr; }
+};
+
+/// uncommitted writes of one table. value of a flushed key is not kept and is read from store,
+/// the same as a deleted key.
+template <typename K, typename V>
+class overlay_table
+{
+public:
+	class entry
+	{
+	public:
+		V value = V();
+		bool flushed = true;
+	};
+
+	explicit overlay_table(size_t const & max_values_a = 10000) :
+		m_max_values(max_values_a)
+	{
+	}
+
+	/// return true if key is written, value_a is set if key is not flushed
+	bool find(K const & key_a, V & value_a, bool & flushed_a) const
+	{
+		auto it(m_entries.find(key_a));
+		if (it == m_entries.end())
+			return false;
+
+		flushed_a = it->second.flushed;
+		if (!flushed_a)
+			value_a = it->second.value;
+		return true;
+	}
+
+	bool contains(K const & key_a) const { return m_entries.count(key_a); }
+
+	void put(K const & key_a, V const & value_a)
+	{
+		entry & e(m_entries[key_a]);
+		if (e.flushed)
+			m_values++;
+		e.value = value_a;
+		e.flushed = false;
+
+		if (m_values > m_max_values)
+		{
+			for (auto & i : m_entries)
+			{
+				if (m_values <= m_max_values / 2)
+					break;
+				if (!i.second.flushed)
+					drop(i.second);
+			}
+		}
+	}
+
+	/// key is written to store, value is read from there
+	void flush(K const & key_a)
+	{
+		entry & e(m_entries[key_a]);
+		if (!e.flushed)
+			drop(e);
+	}
+
+	std::unordered_map<K, entry> const & entries() const { return m_entries; }
+
+private:
+	void drop(entry & entry_a)
+	{
+		entry_a.value = V();
+		entry_a.flushed = true;
+		m_values--;
+	}
+
+	size_t const m_max_values;
+	size_t m_values = 0;
+	std::unordered_map<K, entry> m_entries;
+};
+
+/// writes of block processing not yet committed to db, one table per cached table.
+/// published to block_cache at commit so that written keys bypass the cache until their values are applied.
+class write_overlay
+{
+public:
+	mcp::overlay_table<mcp::block_hash, std::shared_ptr<mcp::block>> blocks;
+	mcp::overlay_table<mcp::block_hash, std::shared_ptr<mcp::block_state>> block_states;
+	mcp::overlay_table<Address, std::shared_ptr<mcp::account_state>> latest_account_states;
+	mcp::overlay_table<h256, std::shared_ptr<mcp::Transaction>> transactions;
+	mcp::overlay_table<Address, u256> account_nonces;
+	mcp::overlay_table<mcp::block_hash, mcp::block_hash> successors;
+	mcp::overlay_table<mcp::block_hash, mcp::summary_hash> block_summarys;
+	mcp::overlay_table<h256, std::shared_ptr<dev::eth::TransactionReceipt>> transaction_receipts;
 };
 
 class block_cache : public mcp::iblock_cache
@@ -37,29 +139,24 @@ class block_cache : public mcp::iblock_cache
 	bool block_exists(mcp::db::db_transaction & transaction_a, mcp::block_hash const &block_hash_a);
 	std::shared_ptr<mcp::block> block_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const &block_hash_a);
 	std::shared_ptr<mcp::block> block_get(mcp::db::db_transaction & transaction_a, uint64_t const & index_a);
+	void blocks_get(mcp::db::db_transaction & transaction_a, std::vector<mcp::block_hash> const & block_hashs_a, std::vector<std::shared_ptr<mcp::block>> & result_a);
 	void block_put(mcp::block_hash const & block_hash_a, std::shared_ptr<mcp::block> blocks_a);
 	void block_earse(std::unordered_set<mcp::block_hash> const & block_hashs_a);
-	void mark_block_as_changing(std::unordered_set<mcp::block_hash> const & block_hashs_a);
-	void clear_block_changing();
 
 	std::shared_ptr<mcp::block_state> block_state_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const &block_hash_a);
+	void block_states_get(mcp::db::db_transaction & transaction_a, std::vector<mcp::block_hash> const & block_hashs_a, std::vector<std::shared_ptr<mcp::block_state>> & result_a);
 	void block_state_put(mcp::block_hash const & block_hash_a, std::shared_ptr<mcp::block_state> block_state_a);
 	void block_state_earse(std::unordered_set<mcp::block_hash> const & block_hashs_a);
-	void mark_block_state_as_changing(std::unordered_set<mcp::block_hash> const & block_hashs_a);
-	void clear_block_state_changing();
 
 	std::shared_ptr<mcp::account_state> latest_account_state_get(mcp::db::db_transaction & transaction_a, Address const & account_a);
 	void latest_account_state_put(Address const & account_a, std::shared_ptr<mcp::account_state> account_state_a);
 	void latest_account_state_earse(std::unordered_set<Address> const & accounts_a);
-	void mark_latest_account_state_as_changing(std::unordered_set<Address> const & accounts_a);
-	void clear_latest_account_state_changing();
 
 	bool transaction_exists(mcp::db::db_transaction & transaction_a, h256 const & hash);
 	std::shared_ptr<Transaction> transaction_get(mcp::db::db_transaction & transaction_a, h256 const & hash);
+	void transactions_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<Transaction>> & result_a);
 	void transaction_put(h256 const & hash, std::shared_ptr<mcp::Transaction> const& t);
 	void transaction_earse(std::unordered_set<h256> const & hash);
-	void mark_transaction_as_changing(std::unordered_set<h256> const & hash);
-	void clear_transaction_changing();
 
 	bool approve_exists(mcp::db::db_transaction & transaction_a, h256 const & hash);
 	std::shared_ptr<approve> approve_get(mcp::db::db_transaction & transaction_a, h256 const & hash);
@@ -70,23 +167,18 @@ class block_cache : public mcp::iblock_cache
 	bool account_nonce_get(mcp::db::db_transaction & transaction_a, Address const & account_a, u256 & nonce_a);
 	void account_nonce_put(Address const & account_a, u256 const & nonce_a);
 	void account_nonce_earse(std::unordered_set<Address> const & accounts_a);
-	void mark_account_nonce_as_changing(std::unordered_set<Address> const & accounts_a);
-	void clear_account_nonce_changing();
 
 	std::shared_ptr<TransactionAddress> transaction_address_get(mcp::db::db_transaction & transaction_a, h256 const & hash);
+	void transaction_addresses_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<TransactionAddress>> & result_a);
 	void transaction_address_put(h256 const & hash, std::shared_ptr<mcp::TransactionAddress> const& td);
 
 	bool successor_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & root_a, mcp::block_hash & successor_a);
 	void successor_put(mcp::block_hash const & root_a, mcp::block_hash const & summary_a);
 	void successor_earse(std::unordered_set<mcp::block_hash> const & roots_a);
-	void mark_successor_as_changing(std::unordered_set<mcp::block_hash> const & roots_a);
-	void clear_successor_changing();
 
 	bool block_summary_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & block_hash_a, mcp::summary_hash & summary_a);
 	void block_summary_put(mcp::block_hash const & block_hash_a, mcp::block_hash const & summary_a);
 	void block_summary_earse(std::unordered_set<mcp::block_hash> const & block_hashs_a);
-	void mark_block_summary_as_changing(std::unordered_set<mcp::block_hash> const & block_hashs_a);
-	void clear_block_summary_changing();
 
 	bool block_number_get(mcp::db::db_transaction & transaction_a, uint64_t const & index_a, mcp::block_hash & hash_a);
 	bool block_number_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & hash_a, uint64_t & index_a);
@@ -94,10 +186,9 @@ class block_cache : public mcp::iblock_cache
 
 	bool transaction_receipt_exists(mcp::db::db_transaction & transaction_a, h256 const & hash);
 	std::shared_ptr<dev::eth::TransactionReceipt> transaction_receipt_get(mcp::db::db_transaction & transaction_a, h256 const & hash);
+	void transaction_receipts_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> & result_a);
 	void transaction_receipt_put(h256 const & hash, std::shared_ptr<dev::eth::TransactionReceipt> const& t);
 	void transaction_receipt_earse(std::unordered_set<h256> const & hash);
-	void mark_transaction_receipt_as_changing(std::unordered_set<h256> const & hash);
-	void clear_transaction_receipt_changing();
 
 	bool approve_receipt_exists(mcp::db::db_transaction & transaction_a, h256 const & hash);
 	std::shared_ptr<dev::ApproveReceipt> approve_receipt_get(mcp::db::db_transaction & transaction_a, h256 const & hash);
@@ -109,60 +200,47 @@ class block_cache : public mcp::iblock_cache
 	mcp::StakingList GetStakingList(mcp::db::db_transaction & _transaction, Epoch const & _epoch);
 	void PutStakingList(mcp::db::db_transaction & _transaction, Epoch const & _epoch, mcp::StakingList const & _sl);
 
-	std::string report_cache_size();
-
-private:
-	mcp::block_store & m_store;
-
-	std::mutex m_block_mutex;
-	std::unordered_set<mcp::block_hash> m_block_changings;
-	mcp::Cache<mcp::block_hash, std::shared_ptr<mcp::block>> m_blocks;
-
-	std::mutex m_block_state_mutex;
-	std::unordered_set<mcp::block_hash> m_block_state_changings;
-	mcp::Cache<mcp::block_hash, std::shared_ptr<mcp::block_state>> m_block_states;
-
-	std::mutex m_latest_account_state_mutex;
-	std::unordered_set<Address> m_latest_account_state_changings;
-	mcp::Cache<Address, std::shared_ptr<mcp::account_state>> m_latest_account_states;
-
-	std::mutex m_transaction_mutex;
-	std::unordered_set<h256> m_transaction_changings;
-	mcp::Cache<h256, std::shared_ptr<mcp::Transaction>> m_transactions;
-
-	std::mutex m_account_nonce_mutex;
-	std::unordered_set<Address> m_account_nonce_changings;
-	mcp::Cache<Address, u256> m_account_nonces;
+	/// written keys of overlay_a bypass the cache until apply, nullptr after apply
+	void publish(std::shared_ptr<mcp::write_overlay const> overlay_a);
+	/// put committed values of overlay_a, flushed keys are erased and read from store again
+	void apply(mcp::write_overlay const & overlay_a);
 
-	std::mutex m_transaction_address_mutex;
-	mcp::Cache<h256, std::shared_ptr<mcp::TransactionAddress>> m_transaction_address;
+	/// entries, bytes, hits, misses and evictions of each cache
+	std::string report();
 
-	std::mutex m_successor_mutex;
-	std::unordered_set<mcp::block_hash> m_successor_changings;
-	mcp::Cache<mcp::block_hash, mcp::block_hash> m_successors;
-
-	std::mutex m_block_summary_mutex;
-	std::unordered_set<mcp::block_hash> m_block_summary_changings;
-	mcp::Cache<mcp::block_hash, mcp::block_hash> m_block_summarys;
-
-	std::mutex m_block_number_mutex;
-	mcp::Cache<uint64_t, mcp::block_hash> m_block_numbers;
-	mcp::Cache<mcp::block_hash, uint64_t> m_number_blocks;
-
-	std::mutex m_transaction_receipt_mutex;
-	std::unordered_set<h256> m_transaction_receipt_changings;
-	mcp::Cache<h256, std::shared_ptr<dev::eth::TransactionReceipt>> m_transaction_receipts;
-
-	std::mutex m_approve_mutex;
-	mcp::Cache<h256, std::shared_ptr<mcp::approve>> m_approves;
-
-	std::mutex m_approve_receipt_mutex;
-	mcp::Cache<h256, std::shared_ptr<dev::ApproveReceipt>> m_approve_receipts;
+private:
+	/// return true if key_a is written by published overlay, value must be read from store
+	template <typename K, typename V>
+	bool written(mcp::overlay_table<K, V> mcp::write_overlay::* table_a, K const & key_a);
+	/// insert value read from store, it is dropped if an overlay was published since generation_a
+	template <typename K, typename V>
+	void cache_insert(mcp::sharded_cache<K, V> & cache_a, K const & key_a, V const & value_a, uint64_t const & generation_a);
+	/// serve hits from cache_a, read misses from store with one batched get and fill the cache
+	template <typename K, typename V, typename StoreGet>
+	void cache_batch_get(mcp::overlay_table<K, std::shared_ptr<V>> mcp::write_overlay::* table_a, mcp::sharded_cache<K, std::shared_ptr<V>> & cache_a,
+		std::vector<K> const & keys_a, std::vector<std::shared_ptr<V>> & result_a, StoreGet const & store_get_a);
+	template <typename K, typename V>
+	static void apply_table(mcp::overlay_table<K, V> const & table_a, mcp::sharded_cache<K, V> & cache_a);
 
-	std::mutex m_epoch_param_mutex;
-	mcp::Cache<Epoch, std::shared_ptr<mcp::witness_param>> m_epoch_param;
+	mcp::block_store & m_store;
 
-	std::mutex m_staking_mutex;
-	mcp::Cache<Epoch, std::shared_ptr<mcp::StakingList>> m_staking;
+	std::shared_ptr<mcp::write_overlay const> m_overlay;
+	std::atomic<uint64_t> m_generation = { 0 };
+
+	mcp::sharded_cache<mcp::block_hash, std::shared_ptr<mcp::block>> m_blocks;
+	mcp::sharded_cache<mcp::block_hash, std::shared_ptr<mcp::block_state>> m_block_states;
+	mcp::sharded_cache<Address, std::shared_ptr<mcp::account_state>> m_latest_account_states;
+	mcp::sharded_cache<h256, std::shared_ptr<mcp::Transaction>> m_transactions;
+	mcp::sharded_cache<Address, u256> m_account_nonces;
+	mcp::sharded_cache<h256, std::shared_ptr<mcp::TransactionAddress>> m_transaction_address;
+	mcp::sharded_cache<mcp::block_hash, mcp::block_hash> m_successors;
+	mcp::sharded_cache<mcp::block_hash, mcp::block_hash> m_block_summarys;
+	mcp::sharded_cache<uint64_t, mcp::block_hash> m_block_numbers;
+	mcp::sharded_cache<mcp::block_hash, uint64_t> m_number_blocks;
+	mcp::sharded_cache<h256, std::shared_ptr<dev::eth::TransactionReceipt>> m_transaction_receipts;
+	mcp::sharded_cache<h256, std::shared_ptr<mcp::approve>> m_approves;
+	mcp::sharded_cache<h256, std::shared_ptr<dev::ApproveReceipt>> m_approve_receipts;
+	mcp::sharded_cache<Epoch, std::shared_ptr<mcp::witness_param>> m_epoch_param;
+	mcp::sharded_cache<Epoch, std::shared_ptr<mcp::StakingList>> m_staking;
 };
 } // namespace mcp
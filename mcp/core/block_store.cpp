@@ -4,8 +4,36 @@
 #include <boost/endian/conversion.hpp>
 #include <mcp/common/log.hpp>
 
+namespace
+{
+	/// one MultiGet for all hashs, decode_a is called for each found value
+	template <typename T, typename Decode>
+	void multi_get_decode(mcp::db::db_transaction & transaction_a, int const & index_a, std::vector<dev::h256> const & hashs_a,
+		std::vector<std::shared_ptr<T>> & result_a, Decode const & decode_a)
+	{
+		std::vector<dev::Slice> keys;
+		keys.reserve(hashs_a.size());
+		for (dev::h256 const & hash : hashs_a)
+			keys.push_back(mcp::h256_to_slice(hash));
+
+		std::vector<rocksdb::PinnableSlice> values;
+		std::vector<bool> exists;
+		transaction_a.multi_get(index_a, keys, values, exists);
+
+		result_a.assign(hashs_a.size(), nullptr);
+		for (size_t i = 0; i < hashs_a.size(); i++)
+		{
+			if (!exists[i])
+				continue;
+			dev::RLP r(dev::bytesConstRef((dev::byte const*)values[i].data(), values[i].size()));
+			result_a[i] = decode_a(hashs_a[i], r);
+		}
+	}
+}
+
 mcp::block_store::block_store(bool & error_a, boost::filesystem::path const & path_a) :
 	m_db(std::make_shared<mcp::db::database>(path_a)),
+	m_trie_node_cache(std::make_shared<mcp::trie_node_cache>(mcp::db::database_config::trie_cache_size * 1024 * 1024)),
 	dag_account_info(0),
 	account_info(0),
 	account_state(0),
@@ -45,82 +73,90 @@ mcp::block_store::block_store(bool & error_a, boost::filesystem::path const & pa
 	transaction_account_state(0),
 	epoch_work_transaction(0),
 	stakingList(0),
-	receiptsRoot(0)
+	receiptsRoot(0),
+	history_index(0),
+	log_index(0),
+	log_bloom_section(0),
+	legacy_default(0)
 {
 	if (error_a)
 		return;
 
-	auto tbops_prefix = mcp::db::db_column::default_table_options(mcp::db::database::get_table_cache());
+	auto cache = mcp::db::database::get_table_cache();
+	//legacy layout: all tables shared the default column family with a 3 bytes key prefix.
+	//default column family is always opened so that old databases can be migrated in upgrade()
+	auto tbops_prefix = mcp::db::db_column::default_table_options(cache);
 	if (rocksdb::BlockBasedTableOptions::IndexType::kBinarySearch == tbops_prefix->index_type)
 		tbops_prefix->index_type = rocksdb::BlockBasedTableOptions::IndexType::kHashSearch;
 	
 	auto cfops_prefix = mcp::db::db_column::default_column_family_options(tbops_prefix);
 	cfops_prefix->prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(3));
 	cfops_prefix->memtable_prefix_bloom_size_ratio = 0.02;
-	//cfops_prefix->max_write_buffer_number = 6;
-	//cfops_prefix->min_write_buffer_number_to_merge = 2;
-	//default
+	cfops_prefix->write_buffer_size = 4 * 1024 * 1024;
 	int default_col = m_db->create_column_family(rocksdb::kDefaultColumnFamilyName, cfops_prefix);
-	dag_account_info = m_db->set_column_family(default_col, "001");
-	account_info = m_db->set_column_family(default_col, "002");
-	account_state = m_db->set_column_family(default_col, "003");
-	latest_account_state = m_db->set_column_family(default_col, "004");
-	blocks = m_db->set_column_family(default_col, "005");
-	transactions = m_db->set_column_family(default_col, "006");
-	transaction_address = m_db->set_column_family(default_col, "007");
-	account_nonce = m_db->set_column_family(default_col, "008");
-	block_state = m_db->set_column_family(default_col, "009");
-	successor = m_db->set_column_family(default_col, "010");
-	main_chain = m_db->set_column_family(default_col, "011");
-	skiplist = m_db->set_column_family(default_col, "012");
-	block_summary = m_db->set_column_family(default_col, "013");
-	summary_block = m_db->set_column_family(default_col, "014");
-	stable_block = m_db->set_column_family(default_col, "015");
-	stable_block_number = m_db->set_column_family(default_col, "016");
-	contract_main = m_db->set_column_family(default_col, "017");
-	prop = m_db->set_column_family(default_col, "018");
-	catchup_chain_summaries = m_db->set_column_family(default_col, "019");
-	catchup_chain_block_summary = m_db->set_column_family(default_col, "020");
-	catchup_chain_summary_block = m_db->set_column_family(default_col, "021");
-	hash_tree_summary = m_db->set_column_family(default_col, "022");
-	unlink_block = m_db->set_column_family(default_col, "023");
-	traces = m_db->set_column_family(default_col, "024");
-	next_unlink = m_db->set_column_family(default_col, "025");
-	next_unlink_index = m_db->set_column_family(default_col, "026");
-	contract_aux = m_db->set_column_family(default_col, "027");
-	transaction_receipt = m_db->set_column_family(default_col, "028");
-	approves = m_db->set_column_family(default_col, "029");
-	approve_receipt = m_db->set_column_family(default_col, "030");
-	epoch_approves = m_db->set_column_family(default_col, "031");
-	epoch_param = m_db->set_column_family(default_col, "032");
-	transaction_account_state = m_db->set_column_family(default_col, "033");
-	epoch_work_transaction = m_db->set_column_family(default_col, "034");
-	stakingList = m_db->set_column_family(default_col, "035");
-	receiptsRoot = m_db->set_column_family(default_col, "036");
+	legacy_default = m_db->set_column_family(default_col);
 
-	//use iterator
-	dag_free = m_db->set_column_family(default_col, "101");
-	block_child = m_db->set_column_family(default_col, "102");
-	unlink_info = m_db->set_column_family(default_col, "103");
-	head_unlink = m_db->set_column_family(default_col, "104");
-
-
-	////column have used iterator 
-	//auto tbops_iter = mcp::db::db_column::default_table_options(mcp::db::database::get_table_cache());
-	//if (rocksdb::BlockBasedTableOptions::IndexType::kBinarySearch == tbops_iter->index_type)
-	//	tbops_iter->index_type = rocksdb::BlockBasedTableOptions::IndexType::kHashSearch;
+	auto point_ops = mcp::db::db_column::point_lookup_column_family_options(cache);
+	auto small_ops = mcp::db::db_column::small_column_family_options(cache);
+	auto ordered_iter_ops = mcp::db::db_column::iterator_column_family_options(0, cache);
+	auto hash_iter_ops = mcp::db::db_column::iterator_column_family_options(sizeof(mcp::block_hash), cache);
+	auto epoch_iter_ops = mcp::db::db_column::iterator_column_family_options(sizeof(mcp::Epoch), cache);
 
-	//auto cfops_iter = mcp::db::db_column::default_column_family_options(tbops_iter);
-	//cfops_iter->prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(3));
-	//cfops_iter->memtable_prefix_bloom_size_ratio = 0.02;
-	////cfops_iter->max_write_buffer_number = 6;
-	////cfops_iter->min_write_buffer_number_to_merge = 2;
-	//int iter_col = m_db->create_column_family("iter", cfops_iter);
+	auto table = [&](std::string const & name_a, std::string const & legacy_prefix_a, std::shared_ptr<rocksdb::ColumnFamilyOptions> cfops_a)
+	{
+		int index = m_db->set_column_family(m_db->create_column_family(name_a, cfops_a));
+		legacy_tables.push_back(std::make_pair(legacy_prefix_a, index));
+		return index;
+	};
+
+	//point lookup
+	dag_account_info = table("dag_account_info", "001", point_ops);
+	account_info = table("account_info", "002", point_ops);
+	account_state = table("account_state", "003", point_ops);
+	latest_account_state = table("latest_account_state", "004", point_ops);
+	blocks = table("blocks", "005", point_ops);
+	transactions = table("transactions", "006", point_ops);
+	transaction_address = table("transaction_address", "007", point_ops);
+	account_nonce = table("account_nonce", "008", point_ops);
+	block_state = table("block_state", "009", point_ops);
+	successor = table("successor", "010", point_ops);
+	main_chain = table("main_chain", "011", point_ops);
+	skiplist = table("skiplist", "012", point_ops);
+	block_summary = table("block_summary", "013", point_ops);
+	summary_block = table("summary_block", "014", point_ops);
+	stable_block = table("stable_block", "015", point_ops);
+	stable_block_number = table("stable_block_number", "016", point_ops);
+	contract_main = table("contract_main", "017", point_ops);
+	catchup_chain_summaries = table("catchup_chain_summaries", "019", point_ops);
+	catchup_chain_block_summary = table("catchup_chain_block_summary", "020", point_ops);
+	catchup_chain_summary_block = table("catchup_chain_summary_block", "021", point_ops);
+	hash_tree_summary = table("hash_tree_summary", "022", point_ops);
+	unlink_block = table("unlink_block", "023", point_ops);
+	traces = table("traces", "024", point_ops);
+	next_unlink = table("next_unlink", "025", point_ops);
+	next_unlink_index = table("next_unlink_index", "026", point_ops);
+	contract_aux = table("contract_aux", "027", point_ops);
+	transaction_receipt = table("transaction_receipt", "028", point_ops);
+	approves = table("approves", "029", point_ops);
+	approve_receipt = table("approve_receipt", "030", point_ops);
+	transaction_account_state = table("transaction_account_state", "033", point_ops);
+	receiptsRoot = table("receiptsRoot", "036", point_ops);
+
+	//tiny metadata
+	prop = table("prop", "018", small_ops);
+	epoch_param = table("epoch_param", "032", small_ops);
+	epoch_work_transaction = table("epoch_work_transaction", "034", small_ops);
+	stakingList = table("stakingList", "035", small_ops);
 
-	//dag_free = m_db->set_column_family(iter_col, "001");
-	//block_child = m_db->set_column_family(iter_col, "002");
-	//unlink_info = m_db->set_column_family(iter_col, "003");
-	//head_unlink = m_db->set_column_family(iter_col, "004");
+	//use iterator
+	dag_free = table("dag_free", "101", ordered_iter_ops);
+	block_child = table("block_child", "102", hash_iter_ops);
+	unlink_info = table("unlink_info", "103", ordered_iter_ops);
+	head_unlink = table("head_unlink", "104", ordered_iter_ops);
+	epoch_approves = table("epoch_approves", "031", epoch_iter_ops);
+	history_index = table("history_index", "105", ordered_iter_ops);
+	log_index = table("log_index", "106", ordered_iter_ops);
+	log_bloom_section = table("log_bloom_section", "107", point_ops);
 
 	error_a = !m_db->open();
 	if (error_a)
@@ -140,13 +176,87 @@ mcp::block_store::block_store(bool & error_a, boost::filesystem::path const & pa
 bool mcp::block_store::upgrade()
 {
 	bool ok(true);
-	if (version_get() == 1)
+	if (version_get() < 2)
 	{
+		ok = migrate_legacy_tables();
+		if (ok)
+		{
+			mcp::db::db_transaction transaction(create_transaction());
+			version_put(transaction, 2);
+		}
 	}
 
 	return ok;
 }
 
+bool mcp::block_store::migrate_legacy_tables()
+{
+	//database created before version 2 stored every table in the default column family with a key prefix.
+	//move each prefix to its own column family in bounded transactions, then drop the prefix range.
+	auto read_ops = mcp::db::database::default_read_options();
+	read_ops->total_order_seek = true;
+	{
+		mcp::db::db_transaction transaction(create_transaction());
+		mcp::db::forward_iterator it(transaction.begin(legacy_default, nullptr, read_ops));
+		if (!it.valid())
+			return true;
+	}
+
+	std::cout << "Migrating database to column family layout, this may take a while..." << std::endl;
+
+	size_t const batch_size = 10000;
+	for (auto const & t : legacy_tables)
+	{
+		std::string const & prefix = t.first;
+		uint64_t moved = 0;
+		std::string last_key;
+		while (true)
+		{
+			mcp::db::db_transaction transaction(create_transaction());
+			auto snapshot = create_snapshot();
+			mcp::db::forward_iterator it(transaction.begin(legacy_default, dev::Slice(last_key.empty() ? &prefix : &last_key), snapshot, read_ops));
+
+			size_t count = 0;
+			bool finished = true;
+			for (; it.valid(); ++it)
+			{
+				dev::Slice key(it.key());
+				if (key.size() < prefix.size() || memcmp(key.data(), prefix.data(), prefix.size()) != 0)
+					break;
+
+				std::string raw_key(key.data(), key.size());
+				if (raw_key == last_key)
+					continue;
+
+				if (count >= batch_size)
+				{
+					finished = false;
+					break;
+				}
+
+				transaction.put(t.second, key.cropped(prefix.size()), it.value());
+				last_key = raw_key;
+				count++;
+			}
+			transaction.commit();
+			moved += count;
+
+			if (finished)
+				break;
+		}
+
+		if (moved > 0)
+		{
+			std::string end(prefix);
+			end.back()++;
+			m_db->del_range(legacy_default, dev::Slice(&prefix), dev::Slice(&end));
+			std::cout << "Migrated table " << prefix << " to column family, keys:" << moved << std::endl;
+		}
+	}
+
+	return true;
+}
+
 std::string mcp::block_store::get_rocksdb_state(uint64_t limit)
 {
 	std::string str = "";
@@ -184,26 +294,25 @@ int mcp::block_store::version_get()
 
 std::shared_ptr<mcp::block> mcp::block_store::block_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & hash_a)
 {
-	std::string value;
+	rocksdb::PinnableSlice value;
 	bool exists(transaction_a.get(blocks, mcp::h256_to_slice(hash_a), value));
 	std::shared_ptr<mcp::block> result = nullptr;
 	if (exists)
 	{
-		dev::RLP r(value);
+		dev::RLP r(dev::bytesConstRef((dev::byte const*)value.data(), value.size()));
 		//auto mode = IncludeSignature::WithSignature;
 		//if (hash_a == mcp::genesis::block_hash)
 		//	mode = IncludeSignature::WithoutSignature;
 
 		result = std::make_shared<mcp::block>(r);
-		assert_x_msg(result != nullptr, "hash:" + hash_a.hex() + " ,data:" + value);
+		assert_x_msg(result != nullptr, "hash:" + hash_a.hex() + " ,data:" + value.ToString());
 	}
 	return result;
 }
 
 bool mcp::block_store::block_exists(mcp::db::db_transaction & transaction_a, mcp::block_hash const & hash_a)
 {
-	std::string result;
-	bool exists(transaction_a.get(blocks, mcp::h256_to_slice(hash_a), result));
+	bool exists(transaction_a.exists(blocks, mcp::h256_to_slice(hash_a)));
 	return exists;
 }
 
@@ -222,6 +331,14 @@ void mcp::block_store::block_put(mcp::db::db_transaction & transaction_a, mcp::b
 	transaction_a.count_add("block", 1);
 }
 
+void mcp::block_store::blocks_get(mcp::db::db_transaction & transaction_a, std::vector<mcp::block_hash> const & hashs_a, std::vector<std::shared_ptr<mcp::block>> & result_a)
+{
+	multi_get_decode(transaction_a, blocks, hashs_a, result_a, [](mcp::block_hash const &, dev::RLP const & r)
+	{
+		return std::make_shared<mcp::block>(r);
+	});
+}
+
 ///////////
 mcp::db::forward_iterator mcp::block_store::block_begin(mcp::db::db_transaction & transaction_a, std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a)
 {
@@ -237,19 +354,18 @@ size_t mcp::block_store::block_count(mcp::db::db_transaction & transaction_a)
 
 bool mcp::block_store::transaction_exists(mcp::db::db_transaction & transaction_a, h256 const& hash_a)
 {
-	std::string result;
-	bool exists(transaction_a.get(transactions, mcp::h256_to_slice(hash_a), result));
+	bool exists(transaction_a.exists(transactions, mcp::h256_to_slice(hash_a)));
 	return exists;
 }
 
 std::shared_ptr<mcp::Transaction> mcp::block_store::transaction_get(mcp::db::db_transaction & transaction_a, h256 const& hash_a)
 {
-	std::string value;
+	rocksdb::PinnableSlice value;
 	bool exists(transaction_a.get(transactions, mcp::h256_to_slice(hash_a), value));
 	std::shared_ptr<mcp::Transaction> result = nullptr;
 	if (exists)
 	{
-		dev::RLP r(value);
+		dev::RLP r(dev::bytesConstRef((dev::byte const*)value.data(), value.size()));
 		result = std::make_shared<mcp::Transaction>(r,CheckTransaction::None);
 
 		/// genesis set sender.
@@ -260,6 +376,19 @@ std::shared_ptr<mcp::Transaction> mcp::block_store::transaction_get(mcp::db::db_
 	return result;
 }
 
+void mcp::block_store::transactions_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<mcp::Transaction>> & result_a)
+{
+	multi_get_decode(transaction_a, transactions, hashs_a, result_a, [](h256 const & hash_a, dev::RLP const & r)
+	{
+		auto result = std::make_shared<mcp::Transaction>(r, CheckTransaction::None);
+		/// genesis set sender.
+		auto isGenesisT = mcp::genesis::isGenesisTransaction(hash_a);
+		if (isGenesisT.first)
+			result->forceSender(isGenesisT.second);
+		return result;
+	});
+}
+
 void mcp::block_store::transaction_put(mcp::db::db_transaction & transaction_a, h256 const& hash_a, mcp::Transaction const& _t)
 {
 	// all parts of block except data
@@ -290,17 +419,25 @@ void mcp::block_store::account_nonce_put(mcp::db::db_transaction & transaction_a
 
 std::shared_ptr<mcp::TransactionAddress> mcp::block_store::transaction_address_get(mcp::db::db_transaction & transaction_a, h256 const& hash_a)
 {
-	std::string value;
+	rocksdb::PinnableSlice value;
 	bool exists(transaction_a.get(transaction_address, mcp::h256_to_slice(hash_a), value));
 	std::shared_ptr<mcp::TransactionAddress> result = nullptr;
 	if (exists)
 	{
-		dev::RLP r(value);
+		dev::RLP r(dev::bytesConstRef((dev::byte const*)value.data(), value.size()));
 		result = std::make_shared<mcp::TransactionAddress>(r);
 	}
 	return result;
 }
 
+void mcp::block_store::transaction_addresses_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<mcp::TransactionAddress>> & result_a)
+{
+	multi_get_decode(transaction_a, transaction_address, hashs_a, result_a, [](h256 const &, dev::RLP const & r)
+	{
+		return std::make_shared<mcp::TransactionAddress>(r);
+	});
+}
+
 void mcp::block_store::transaction_address_put(mcp::db::db_transaction & transaction_a, h256 const& hash_a, mcp::TransactionAddress const& _td)
 {
 	dev::bytes b_value = _td.rlp();
@@ -310,8 +447,7 @@ void mcp::block_store::transaction_address_put(mcp::db::db_transaction & transac
 
 bool mcp::block_store::approve_exists(mcp::db::db_transaction & transaction_a, h256 const& hash_a)
 {
-	std::string result;
-	bool exists(transaction_a.get(approves, mcp::h256_to_slice(hash_a), result));
+	bool exists(transaction_a.exists(approves, mcp::h256_to_slice(hash_a)));
 	return exists;
 }
 
@@ -373,11 +509,11 @@ void mcp::block_store::dag_account_put(mcp::db::db_transaction & transaction_a,
 std::shared_ptr<mcp::account_state> mcp::block_store::account_state_get(mcp::db::db_transaction & transaction_a, h256 const& hash_a)
 {
 	std::shared_ptr<mcp::account_state> result;
-	std::string value;
+	rocksdb::PinnableSlice value;
 	bool exists(transaction_a.get(account_state, mcp::h256_to_slice(hash_a), value));
 	if (exists)
 	{
-		dev::RLP r(value);
+		dev::RLP r(dev::bytesConstRef((dev::byte const*)value.data(), value.size()));
 		bool error(false);
 		result = std::make_shared<mcp::account_state>(error, r);
 		assert_x(!error);
@@ -397,6 +533,11 @@ void mcp::block_store::account_state_put(mcp::db::db_transaction & transaction_a
 	transaction_a.put(account_state, mcp::h256_to_slice(hash_a), s_value);
 }
 
+void mcp::block_store::account_state_del(mcp::db::db_transaction & transaction_a, h256 const& hash_a)
+{
+	transaction_a.del(account_state, mcp::h256_to_slice(hash_a));
+}
+
 
 bool mcp::block_store::latest_account_state_get(mcp::db::db_transaction & transaction_a, Address const & account_a, h256& hash_a)
 {
@@ -447,12 +588,12 @@ void mcp::block_store::summary_block_put(mcp::db::db_transaction & transaction_a
 
 std::shared_ptr<mcp::block_state> mcp::block_store::block_state_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & hash_a)
 {
-	std::string value;
+	rocksdb::PinnableSlice value;
 	bool exists(transaction_a.get(block_state, mcp::h256_to_slice(hash_a), value));
 	std::shared_ptr<mcp::block_state> result;
 	if (exists)
 	{
-		dev::RLP r(value);
+		dev::RLP r(dev::bytesConstRef((dev::byte const*)value.data(), value.size()));
 		bool error(false);
 		result = std::make_shared<mcp::block_state>(error, r);
 		assert_x(!error);
@@ -461,6 +602,17 @@ std::shared_ptr<mcp::block_state> mcp::block_store::block_state_get(mcp::db::db_
 	return result;
 }
 
+void mcp::block_store::block_states_get(mcp::db::db_transaction & transaction_a, std::vector<mcp::block_hash> const & hashs_a, std::vector<std::shared_ptr<mcp::block_state>> & result_a)
+{
+	multi_get_decode(transaction_a, block_state, hashs_a, result_a, [](mcp::block_hash const &, dev::RLP const & r)
+	{
+		bool error(false);
+		auto result = std::make_shared<mcp::block_state>(error, r);
+		assert_x(!error);
+		return result;
+	});
+}
+
 void mcp::block_store::block_state_put(mcp::db::db_transaction & transaction_a, mcp::block_hash const & hash_a, mcp::block_state const & state_a)
 {
 	dev::bytes b_value;
@@ -746,11 +898,11 @@ void mcp::block_store::block_child_put(mcp::db::db_transaction & transaction_a,
 
 bool mcp::block_store::skiplist_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & hash_a, mcp::skiplist_info & skiplist_a)
 {
-	std::string value;
+	rocksdb::PinnableSlice value;
 	bool exists(transaction_a.get(skiplist, mcp::h256_to_slice(hash_a), value));
 	if (exists)
 	{
-		dev::RLP r(value);
+		dev::RLP r(dev::bytesConstRef((dev::byte const*)value.data(), value.size()));
 		skiplist_a = mcp::skiplist_info(r);
 	}
 	return !exists;
@@ -904,8 +1056,7 @@ void mcp::block_store::catchup_chain_summary_block_clear(std::shared_ptr<rocksdb
 
 bool mcp::block_store::hash_tree_summary_exists(mcp::db::db_transaction & transaction_a, mcp::summary_hash const & summary_a)
 {
-	std::string value;
-	bool exists(transaction_a.get(hash_tree_summary, mcp::h256_to_slice(summary_a), value));
+	bool exists(transaction_a.exists(hash_tree_summary, mcp::h256_to_slice(summary_a)));
 	return exists;
 }
 
@@ -1047,19 +1198,32 @@ void mcp::block_store::traces_put(mcp::db::db_transaction & transaction_a, mcp::
 	transaction_a.put(traces, mcp::h256_to_slice(block_hash_a), s_value);
 }
 
+void mcp::block_store::traces_del(mcp::db::db_transaction & transaction_a, mcp::block_hash const & block_hash_a)
+{
+	transaction_a.del(traces, mcp::h256_to_slice(block_hash_a));
+}
+
 std::shared_ptr<dev::eth::TransactionReceipt> mcp::block_store::transaction_receipt_get(mcp::db::db_transaction & transaction_a, h256 const & hash_a)
 {
-	std::string value;
+	rocksdb::PinnableSlice value;
 	bool exists(transaction_a.get(transaction_receipt, mcp::h256_to_slice(hash_a), value));
 	std::shared_ptr<dev::eth::TransactionReceipt> result;
 	if (exists)
 	{
-		dev::RLP r(value);
+		dev::RLP r(dev::bytesConstRef((dev::byte const*)value.data(), value.size()));
 		result = std::make_shared<dev::eth::TransactionReceipt>(r);
 	}
 	return result;
 }
 
+void mcp::block_store::transaction_receipts_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> & result_a)
+{
+	multi_get_decode(transaction_a, transaction_receipt, hashs_a, result_a, [](h256 const &, dev::RLP const & r)
+	{
+		return std::make_shared<dev::eth::TransactionReceipt>(r);
+	});
+}
+
 void mcp::block_store::transaction_receipt_put(mcp::db::db_transaction & transaction_a, h256 const& hash_a, dev::eth::TransactionReceipt const& receipt)
 {
 	dev::bytes b_value;
@@ -1167,6 +1331,110 @@ void mcp::block_store::transaction_previous_account_state_put(mcp::db::db_transa
 	transaction_a.put(transaction_account_state, mcp::h256_to_slice(link_a), s_value);
 }
 
+void mcp::block_store::transaction_previous_account_state_del(mcp::db::db_transaction & transaction_a, dev::h256 const & link_a)
+{
+	transaction_a.del(transaction_account_state, mcp::h256_to_slice(link_a));
+}
+
+void mcp::block_store::history_index_put(mcp::db::db_transaction & transaction_a, mcp::history_index_key const & key_a, Address const & account_a)
+{
+	transaction_a.put(history_index, key_a.val(), mcp::account_to_slice(account_a));
+}
+
+void mcp::block_store::history_index_get(mcp::db::db_transaction & transaction_a, mcp::history_index_key const & from_a, uint64_t const & to_mci_a, size_t const & limit_a, std::vector<std::pair<mcp::history_index_key, Address>> & result_a)
+{
+	mcp::db::forward_iterator it(transaction_a.begin(history_index, from_a.val()));
+	while (result_a.size() < limit_a)
+	{
+		if (!it.valid())
+			break;
+		mcp::history_index_key key(it.key());
+		if (key.get_mci() >= to_mci_a)
+			break;
+
+		result_a.push_back(std::make_pair(key, mcp::slice_to_account(it.value())));
+
+		++it;
+	}
+}
+
+void mcp::block_store::history_index_del_range(uint64_t const & to_mci_a)
+{
+	mcp::history_index_key begin(0, mcp::history_kind::account_state, h256(0));
+	mcp::history_index_key end(to_mci_a, mcp::history_kind::account_state, h256(0));
+	m_db->del_range(history_index, begin.val(), end.val());
+}
+
+bool mcp::block_store::history_pruned_mci_get(mcp::db::db_transaction & transaction_a, uint64_t & mci_a)
+{
+	std::string value;
+	bool exists(transaction_a.get(prop, mcp::h256_to_slice(history_pruned_mci_key), value));
+	if (exists)
+		mci_a = ((dev::h64::Arith)mcp::slice_to_h64(value)).convert_to<uint64_t>();
+	return !exists;
+}
+
+void mcp::block_store::history_pruned_mci_put(mcp::db::db_transaction & transaction_a, uint64_t const & mci_a)
+{
+	dev::h64 mci(mci_a);
+	transaction_a.put(prop, mcp::h256_to_slice(history_pruned_mci_key), mcp::h64_to_slice(mci));
+}
+
+void mcp::block_store::log_index_put(mcp::db::db_transaction & transaction_a, mcp::log_index_key const & key_a)
+{
+	transaction_a.put(log_index, key_a.val(), dev::Slice());
+}
+
+void mcp::block_store::log_index_get(mcp::db::db_transaction & transaction_a, uint8_t const & kind_a, h256 const & value_a, uint64_t const & from_a, uint64_t const & to_a, std::set<uint64_t> & stable_indexs_a)
+{
+	mcp::log_index_key key(kind_a, value_a, from_a);
+	mcp::db::forward_iterator it(transaction_a.begin(log_index, key.val()));
+	while (true)
+	{
+		if (!it.valid())
+			break;
+		mcp::log_index_key index_key(it.key());
+		if (index_key.kind != kind_a || index_key.value != value_a || index_key.get_stable_index() > to_a)
+			break;
+
+		stable_indexs_a.insert(index_key.get_stable_index());
+
+		++it;
+	}
+}
+
+bool mcp::block_store::log_bloom_get(mcp::db::db_transaction & transaction_a, uint64_t const & section_a, log_bloom & bloom_a)
+{
+	std::string value;
+	bool exists(transaction_a.get(log_bloom_section, mcp::h64_to_slice(h64(section_a)), value));
+	if (exists)
+	{
+		assert_x(value.size() == bloom_a.size);
+		bloom_a = log_bloom(dev::bytesConstRef((dev::byte const *)value.data(), value.size()));
+	}
+	return !exists;
+}
+
+void mcp::block_store::log_bloom_put(mcp::db::db_transaction & transaction_a, uint64_t const & section_a, log_bloom const & bloom_a)
+{
+	transaction_a.put(log_bloom_section, mcp::h64_to_slice(h64(section_a)), dev::Slice((char const *)bloom_a.data(), bloom_a.size));
+}
+
+bool mcp::block_store::log_index_from_get(mcp::db::db_transaction & transaction_a, uint64_t & stable_index_a)
+{
+	std::string value;
+	bool exists(transaction_a.get(prop, mcp::h256_to_slice(log_index_from_key), value));
+	if (exists)
+		stable_index_a = ((dev::h64::Arith)mcp::slice_to_h64(value)).convert_to<uint64_t>();
+	return !exists;
+}
+
+void mcp::block_store::log_index_from_put(mcp::db::db_transaction & transaction_a, uint64_t const & stable_index_a)
+{
+	dev::h64 stable_index(stable_index_a);
+	transaction_a.put(prop, mcp::h256_to_slice(log_index_from_key), mcp::h64_to_slice(stable_index));
+}
+
 bool mcp::block_store::epoch_work_transaction_get(mcp::db::db_transaction & transaction_a, Epoch const & epoch, h256 & hash_a)
 {
 	std::string value;
@@ -1240,3 +1508,5 @@ dev::h256 const mcp::block_store::advance_info_key(5);
 dev::h256 const mcp::block_store::last_stable_index_key(6);
 dev::h256 const mcp::block_store::catchup_index(7);
 dev::h256 const mcp::block_store::catchup_max_index(8);
+dev::h256 const mcp::block_store::history_pruned_mci_key(9);
+dev::h256 const mcp::block_store::log_index_from_key(10);
@@ -5,6 +5,7 @@
 #include <mcp/db/database.hpp>
 #include <mcp/core/transaction_receipt.hpp>
 #include <mcp/core/approve_receipt.hpp>
+#include <mcp/core/trie_node_cache.hpp>
 
 namespace mcp
 {
@@ -17,12 +18,16 @@ namespace mcp
 		block_store(bool &, boost::filesystem::path const &);
 
 		bool upgrade();
+		/// move tables of the shared prefix layout (version < 2) to their own column families
+		bool migrate_legacy_tables();
 
 		std::string get_rocksdb_state(uint64_t limit);
 
 		bool block_exists(mcp::db::db_transaction &, mcp::block_hash const &);
 		std::shared_ptr<mcp::block> block_get(mcp::db::db_transaction &, mcp::block_hash const &);
 		void block_put(mcp::db::db_transaction &, mcp::block_hash const &, mcp::block const &);
+		/// batched get, result_a[i] is nullptr if hashs_a[i] not exist
+		void blocks_get(mcp::db::db_transaction &, std::vector<mcp::block_hash> const & hashs_a, std::vector<std::shared_ptr<mcp::block>> & result_a);
 		mcp::db::forward_iterator block_begin(mcp::db::db_transaction & transaction_a, std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a = nullptr);
 
 		size_t block_count(mcp::db::db_transaction &);
@@ -31,6 +36,7 @@ namespace mcp
 		bool transaction_exists(mcp::db::db_transaction &, h256 const &);
 		std::shared_ptr<mcp::Transaction> transaction_get(mcp::db::db_transaction &, h256 const &);
 		void transaction_put(mcp::db::db_transaction &, h256 const &, mcp::Transaction const &);
+		void transactions_get(mcp::db::db_transaction &, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<mcp::Transaction>> & result_a);
 
 		/// account processed nonce, but maybe not stable
 		/// return true if exist
@@ -40,6 +46,7 @@ namespace mcp
 		/// transaction -> block
 		std::shared_ptr<mcp::TransactionAddress> transaction_address_get(mcp::db::db_transaction &, h256 const &);
 		void transaction_address_put(mcp::db::db_transaction &, h256 const &, mcp::TransactionAddress const &);
+		void transaction_addresses_get(mcp::db::db_transaction &, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<mcp::TransactionAddress>> & result_a);
 		
 		/// approves
 		bool approve_exists(mcp::db::db_transaction &, h256 const &);
@@ -80,6 +87,7 @@ namespace mcp
 
 		std::shared_ptr<mcp::block_state> block_state_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & hash_a);
 		void block_state_put(mcp::db::db_transaction &, mcp::block_hash const &, mcp::block_state const &);
+		void block_states_get(mcp::db::db_transaction & transaction_a, std::vector<mcp::block_hash> const & hashs_a, std::vector<std::shared_ptr<mcp::block_state>> & result_a);
 
 		size_t stable_block_count(mcp::db::db_transaction & transaction_a);
 		bool stable_block_get(mcp::db::db_transaction & transaction_a, uint64_t const & index, mcp::block_hash & hash_a, std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a = nullptr);
@@ -159,6 +167,7 @@ namespace mcp
 
 		std::shared_ptr<dev::eth::TransactionReceipt> transaction_receipt_get(mcp::db::db_transaction & transaction_a, h256 const& hash_a);
 		void transaction_receipt_put(mcp::db::db_transaction &, h256 const& hash_a, dev::eth::TransactionReceipt const& receipt);
+		void transaction_receipts_get(mcp::db::db_transaction & transaction_a, std::vector<h256> const & hashs_a, std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> & result_a);
 
 		std::shared_ptr<dev::ApproveReceipt> approve_receipt_get(mcp::db::db_transaction & transaction_a, h256 const& hash_a);
 		void approve_receipt_put(mcp::db::db_transaction &, h256 const& hash_a, dev::ApproveReceipt const& receipt);
@@ -174,6 +183,28 @@ namespace mcp
 
 		bool transaction_previous_account_state_get(mcp::db::db_transaction & transaction_a, dev::h256 const & link_a, std::vector<h256> & hashs_a);
 		void transaction_previous_account_state_put(mcp::db::db_transaction & transaction_a, dev::h256 const & link_a, std::vector<h256> & hashs_a);
+		void transaction_previous_account_state_del(mcp::db::db_transaction & transaction_a, dev::h256 const & link_a);
+
+		void account_state_del(mcp::db::db_transaction & transaction_a, h256 const& hash_a);
+		void traces_del(mcp::db::db_transaction & transaction_a, mcp::block_hash const & block_hash_a);
+
+		/// value is account of account state
+		void history_index_put(mcp::db::db_transaction & transaction_a, mcp::history_index_key const & key_a, Address const & account_a = Address());
+		/// get at most limit_a index from from_a, with mci less than to_mci_a
+		void history_index_get(mcp::db::db_transaction & transaction_a, mcp::history_index_key const & from_a, uint64_t const & to_mci_a, size_t const & limit_a, std::vector<std::pair<mcp::history_index_key, Address>> & result_a);
+		/// delete index of pruned mcis less than to_mci_a, not in transaction
+		void history_index_del_range(uint64_t const & to_mci_a);
+		bool history_pruned_mci_get(mcp::db::db_transaction & transaction_a, uint64_t & mci_a);
+		void history_pruned_mci_put(mcp::db::db_transaction & transaction_a, uint64_t const & mci_a);
+
+		void log_index_put(mcp::db::db_transaction & transaction_a, mcp::log_index_key const & key_a);
+		/// add stable indexes in [from_a, to_a] having logs with value_a of kind_a
+		void log_index_get(mcp::db::db_transaction & transaction_a, uint8_t const & kind_a, h256 const & value_a, uint64_t const & from_a, uint64_t const & to_a, std::set<uint64_t> & stable_indexs_a);
+		bool log_bloom_get(mcp::db::db_transaction & transaction_a, uint64_t const & section_a, log_bloom & bloom_a);
+		void log_bloom_put(mcp::db::db_transaction & transaction_a, uint64_t const & section_a, log_bloom const & bloom_a);
+		/// first stable index written to log index, older blocks are not indexed
+		bool log_index_from_get(mcp::db::db_transaction & transaction_a, uint64_t & stable_index_a);
+		void log_index_from_put(mcp::db::db_transaction & transaction_a, uint64_t const & stable_index_a);
 
 		bool epoch_work_transaction_get(mcp::db::db_transaction & transaction_a, Epoch const & epoch, h256 & hash_a);
 		void epoch_work_transaction_put(mcp::db::db_transaction & transaction_a, Epoch const & epoch, h256 const& hash_a);
@@ -191,9 +222,13 @@ namespace mcp
 		}
 
 		std::shared_ptr<rocksdb::ManagedSnapshot> create_snapshot() { return m_db->create_snapshot(); }
+
+		/// contract trie nodes cache shared by all overlay_db
+		mcp::trie_node_cache & trie_node_cache() { return *m_trie_node_cache; }
 		//void release_snapshot(std::shared_ptr<rocksdb::ManagedSnapshot> _snapshot) { m_db->release_snapshot(_snapshot); }
 
 		std::shared_ptr<mcp::db::database> m_db;
+		std::shared_ptr<mcp::trie_node_cache> m_trie_node_cache;
 		// account -> dag account info                                 
 		int dag_account_info;
 		// account -> account info                                        
@@ -277,6 +312,20 @@ namespace mcp
 		// block hash -> receiptsRoot hash
 		int receiptsRoot;
 
+		// mci + kind + hash -> account, historical data to prune
+		int history_index;
+
+		// kind + address or topic + stable index -> nothing
+		int log_index;
+
+		// section -> aggregated log bloom of stable blocks in section
+		int log_bloom_section;
+
+		//default column family without prefix, used to migrate the legacy shared layout
+		int legacy_default;
+		//legacy key prefix -> table index
+		std::vector<std::pair<std::string, int>> legacy_tables;
+
 		//genesis hash key
 		static dev::h256 const genesis_hash_key;
 		//genesis transaction hash key
@@ -293,5 +342,9 @@ namespace mcp
 		static dev::h256 const catchup_index;
 		//catch up max index key
 		static dev::h256 const catchup_max_index;
+		//history pruned to mci key
+		static dev::h256 const history_pruned_mci_key;
+		//log index from stable index key
+		static dev::h256 const log_index_from_key;
 	};
 }
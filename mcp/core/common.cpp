@@ -331,6 +331,15 @@ bool mcp::free_key::operator==(mcp::free_key const & other) const
         && hash_asc == other.hash_asc;
 }
 
+bool mcp::free_key::operator<(mcp::free_key const & other) const
+{
+    if (witnessed_level_desc != other.witnessed_level_desc)
+        return witnessed_level_desc > other.witnessed_level_desc;
+    if (level_desc != other.level_desc)
+        return level_desc > other.level_desc;
+    return hash_asc < other.hash_asc;
+}
+
 void mcp::free_key::serialize(mcp::stream & stream_a) const
 {
     uint64_t be_witnessed_level_desc(boost::endian::native_to_big(std::numeric_limits<uint64_t>::max() - witnessed_level_desc));
@@ -839,3 +848,14 @@ mcp::epoch_approves_key::epoch_approves_key(dev::Slice const & val_a)
     std::copy(reinterpret_cast<uint8_t const *> (val_a.data()), reinterpret_cast<uint8_t const *> (val_a.data()) + sizeof(*this), reinterpret_cast<uint8_t *> (this));
 }
 
+mcp::history_index_key::history_index_key(dev::Slice const & val_a)
+{
+    assert_x(val_a.size() == sizeof(*this));
+    std::copy(reinterpret_cast<uint8_t const *> (val_a.data()), reinterpret_cast<uint8_t const *> (val_a.data()) + sizeof(*this), reinterpret_cast<uint8_t *> (this));
+}
+
+mcp::log_index_key::log_index_key(dev::Slice const & val_a)
+{
+    assert_x(val_a.size() == sizeof(*this));
+    std::copy(reinterpret_cast<uint8_t const *> (val_a.data()), reinterpret_cast<uint8_t const *> (val_a.data()) + sizeof(*this), reinterpret_cast<uint8_t *> (this));
+}
@@ -27,6 +27,8 @@ namespace mcp
 		free_key(uint64_t const &, uint64_t const &, mcp::block_hash const &);
 		free_key(dev::Slice const & val_a);
 		bool operator== (mcp::free_key const &) const;
+		/// same order as serialized key, best free block first
+		bool operator< (mcp::free_key const &) const;
 		void serialize(mcp::stream & stream_a) const;
 		void deserialize(mcp::stream & stream_a);
 		uint64_t witnessed_level_desc;
@@ -617,4 +619,50 @@ namespace mcp
 		Epoch epoch;
 		h256 hash;
 	};
+
+	/// historical data which can be pruned
+	enum class history_kind : uint8_t
+	{
+		account_state = 0,
+		traces = 1,
+		transaction_account_state = 2
+	};
+
+	/// mci is big endian, iterated in mci order
+	class history_index_key
+	{
+	public:
+		history_index_key(uint64_t const & mci_a, mcp::history_kind const & kind_a, h256 const & hash_a) : mci(mci_a), kind((uint8_t)kind_a), hash(hash_a) { }
+		history_index_key(dev::Slice const &);
+		dev::Slice val() const { return dev::Slice((char *)this, sizeof(*this)); }
+		uint64_t get_mci() const { return ((dev::h64::Arith)mci).convert_to<uint64_t>(); }
+		mcp::history_kind get_kind() const { return (mcp::history_kind)kind; }
+		dev::h64 mci;
+		uint8_t kind;
+		h256 hash;
+	};
+
+	/// stable indexes per section of aggregated log bloom
+	static const uint64_t LogBloomSectionSize = 4096;
+
+	/// address or topic of logs, topic kind is 1 + topic position
+	enum class log_index_kind : uint8_t
+	{
+		address = 0,
+		topic = 1
+	};
+
+	/// posting of address or topic, stable index is big endian, iterated in stable order
+	class log_index_key
+	{
+	public:
+		log_index_key(uint8_t const & kind_a, h256 const & value_a, uint64_t const & stable_index_a) : kind(kind_a), value(value_a), stable_index(stable_index_a) { }
+		log_index_key(dev::Slice const &);
+		dev::Slice val() const { return dev::Slice((char *)this, sizeof(*this)); }
+		uint64_t get_stable_index() const { return ((dev::h64::Arith)stable_index).convert_to<uint64_t>(); }
+		static h256 address_value(Address const & address_a) { return h256(address_a, h256::AlignRight); }
+		uint8_t kind;
+		h256 value;
+		dev::h64 stable_index;
+	};
 }
@@ -0,0 +1,349 @@
+#include "dag_index.hpp"
+
+#include <sstream>
+
+namespace
+{
+	uint64_t mci_or_none(boost::optional<uint64_t> const & mci_a)
+	{
+		return mci_a ? *mci_a : mcp::dag_index::no_mci;
+	}
+}
+
+mcp::dag_index::dag_index(bool const & labels_a) :
+	m_labels_enabled(labels_a)
+{
+}
+
+std::shared_ptr<mcp::dag_index> mcp::dag_index::of(std::shared_ptr<mcp::iblock_cache> cache_a)
+{
+	std::shared_ptr<mcp::dag_index> index(cache_a->get_dag_index());
+	if (index == nullptr)
+		index = std::make_shared<mcp::dag_index>();
+	return index;
+}
+
+uint32_t mcp::dag_index::node(mcp::db::db_transaction & transaction_a, mcp::iblock_cache & cache_a, mcp::block_hash const & hash_a)
+{
+	auto it(m_ids.find(hash_a));
+	if (it != m_ids.end())
+		return it->second;
+
+	std::shared_ptr<mcp::block> block(cache_a.block_get(transaction_a, hash_a));
+	std::shared_ptr<mcp::block_state> state(cache_a.block_state_get(transaction_a, hash_a));
+	return insert(hash_a, block, state);
+}
+
+uint32_t mcp::dag_index::insert(mcp::block_hash const & hash_a, std::shared_ptr<mcp::block> const & block_a, std::shared_ptr<mcp::block_state> const & state_a)
+{
+	assert_x_msg(block_a, "dag index block not found, hash: " + hash_a.hex());
+	assert_x_msg(state_a, "dag index block state not found, hash: " + hash_a.hex());
+
+	uint32_t id;
+	if (!m_free_ids.empty())
+	{
+		id = m_free_ids.back();
+		m_free_ids.pop_back();
+	}
+	else
+	{
+		id = m_hashs.size();
+		m_hashs.emplace_back();
+		m_parents.emplace_back();
+		m_best_parents.emplace_back();
+		m_previous.emplace_back();
+		m_best_parent_hashs.emplace_back();
+		m_froms.emplace_back();
+		m_levels.emplace_back();
+		m_witnessed_levels.emplace_back();
+		m_mcis.emplace_back();
+		m_earliest_included_mcis.emplace_back();
+		m_latest_included_mcis.emplace_back();
+		m_bp_included_mcis.emplace_back();
+		m_earliest_bp_included_mcis.emplace_back();
+		m_latest_bp_included_mcis.emplace_back();
+		m_flags.emplace_back();
+		m_labels.emplace_back();
+	}
+
+	m_hashs[id] = hash_a;
+	m_parents[id].clear();
+	m_best_parents[id] = none;
+	m_previous[id] = none;
+	m_labels[id].clear();
+	m_best_parent_hashs[id] = state_a->best_parent;
+	m_froms[id] = address_id(block_a->from());
+	m_flags[id] = 0;
+	set_state(id, *state_a);
+	m_ids.emplace(hash_a, id);
+	m_nodes++;
+	m_loads++;
+
+	///new blocks are loaded after their parents, link them now without reading block again
+	bool parents_indexed(true);
+	for (mcp::block_hash const & p_hash : block_a->parents())
+	{
+		auto p_it(m_ids.find(p_hash));
+		if (p_it == m_ids.end())
+		{
+			parents_indexed = false;
+			break;
+		}
+		m_parents[id].push_back(p_it->second);
+		if (p_hash == state_a->best_parent)
+			m_best_parents[id] = p_it->second;
+		if (p_hash == block_a->previous())
+			m_previous[id] = p_it->second;
+	}
+	if (parents_indexed)
+		m_flags[id] |= flag_linked;
+	else
+	{
+		m_parents[id].clear();
+		m_best_parents[id] = none;
+		m_previous[id] = none;
+	}
+
+	return id;
+}
+
+void mcp::dag_index::link(mcp::db::db_transaction & transaction_a, mcp::iblock_cache & cache_a, uint32_t const & id_a)
+{
+	if (m_flags[id_a] & flag_linked)
+		return;
+
+	std::shared_ptr<mcp::block> block(cache_a.block_get(transaction_a, m_hashs[id_a]));
+	assert_x(block);
+
+	///parents not indexed are read by one batch
+	std::vector<mcp::block_hash> missing_hashs;
+	for (mcp::block_hash const & p_hash : block->parents())
+	{
+		if (!m_ids.count(p_hash))
+			missing_hashs.push_back(p_hash);
+	}
+	if (!missing_hashs.empty())
+	{
+		std::vector<std::shared_ptr<mcp::block>> missing_blocks;
+		std::vector<std::shared_ptr<mcp::block_state>> missing_states;
+		cache_a.blocks_get(transaction_a, missing_hashs, missing_blocks);
+		cache_a.block_states_get(transaction_a, missing_hashs, missing_states);
+		for (size_t i(0); i < missing_hashs.size(); i++)
+			insert(missing_hashs[i], missing_blocks[i], missing_states[i]);
+	}
+
+	std::vector<uint32_t> parents;
+	parents.reserve(block->parents().size());
+	for (mcp::block_hash const & p_hash : block->parents())
+	{
+		uint32_t p_id(m_ids.at(p_hash));
+		parents.push_back(p_id);
+		if (p_hash == m_best_parent_hashs[id_a])
+			m_best_parents[id_a] = p_id;
+		if (p_hash == block->previous())
+			m_previous[id_a] = p_id;
+	}
+	m_parents[id_a] = std::move(parents);
+	m_flags[id_a] |= flag_linked;
+}
+
+uint32_t mcp::dag_index::best_parent(mcp::db::db_transaction & transaction_a, mcp::iblock_cache & cache_a, uint32_t const & id_a)
+{
+	if (m_best_parents[id_a] == none && m_best_parent_hashs[id_a] != mcp::block_hash(0))
+	{
+		mcp::block_hash bp_hash(m_best_parent_hashs[id_a]);
+		uint32_t bp_id(node(transaction_a, cache_a, bp_hash));
+		m_best_parents[id_a] = bp_id;
+	}
+	return m_best_parents[id_a];
+}
+
+uint32_t mcp::dag_index::address_id(dev::Address const & address_a)
+{
+	auto r(m_address_ids.emplace(address_a, m_addresses.size()));
+	if (r.second)
+		m_addresses.push_back(address_a);
+	return r.first->second;
+}
+
+mcp::dag_reach mcp::dag_index::included(mcp::db::db_transaction & transaction_a, mcp::iblock_cache & cache_a, uint32_t const & earlier_a, uint32_t const & later_a)
+{
+	mcp::dag_reach result(mcp::dag_reach::unknown);
+	if (m_labels_enabled && earlier_a != later_a)
+	{
+		if (m_labeled_level == UINT64_MAX)
+			m_labeled_level = m_levels[earlier_a];
+
+		if (m_levels[earlier_a] >= m_levels[later_a])
+			result = mcp::dag_reach::no;
+		else if (m_levels[earlier_a] >= m_labeled_level)
+		{
+			label(transaction_a, cache_a, later_a);
+			uint32_t const author(m_froms[earlier_a]);
+			std::vector<uint32_t> const & later_label(m_labels[later_a]);
+			uint32_t latest(author < later_label.size() ? later_label[author] : none);
+
+			///no block from author at or above level of earlier block is included
+			if (latest == none || m_levels[latest] < m_levels[earlier_a])
+				result = mcp::dag_reach::no;
+			else
+			{
+				///previous chain of the latest block from author, a block from a forked author may be off the chain
+				for (size_t i(0); i < max_previous_walk && latest != none && m_levels[latest] > m_levels[earlier_a]; i++)
+				{
+					link(transaction_a, cache_a, latest);
+					latest = m_previous[latest];
+				}
+				if (latest == earlier_a)
+					result = mcp::dag_reach::yes;
+			}
+		}
+	}
+
+	if (result == mcp::dag_reach::unknown)
+		m_reach_unknown++;
+	else
+		m_reach_answered++;
+	return result;
+}
+
+void mcp::dag_index::label(mcp::db::db_transaction & transaction_a, mcp::iblock_cache & cache_a, uint32_t const & id_a)
+{
+	///parents are labeled first, without recursion
+	std::vector<uint32_t> to_label{ id_a };
+	while (!to_label.empty())
+	{
+		uint32_t id(to_label.back());
+		if (m_flags[id] & flag_labeled)
+		{
+			to_label.pop_back();
+			continue;
+		}
+
+		link(transaction_a, cache_a, id);
+		bool parents_labeled(true);
+		for (uint32_t const & p_id : m_parents[id])
+		{
+			if (m_levels[p_id] >= m_labeled_level && !(m_flags[p_id] & flag_labeled))
+			{
+				to_label.push_back(p_id);
+				parents_labeled = false;
+			}
+		}
+		if (!parents_labeled)
+			continue;
+
+		std::vector<uint32_t> label(m_addresses.size(), none);
+		for (uint32_t const & p_id : m_parents[id])
+		{
+			if (m_levels[p_id] < m_labeled_level)
+				continue;
+
+			std::vector<uint32_t> const & p_label(m_labels[p_id]);
+			for (size_t a(0); a < p_label.size(); a++)
+			{
+				if (p_label[a] != none && (label[a] == none || m_levels[p_label[a]] > m_levels[label[a]]))
+					label[a] = p_label[a];
+			}
+		}
+		label[m_froms[id]] = id;
+		m_labels[id] = std::move(label);
+		m_flags[id] |= flag_labeled;
+		to_label.pop_back();
+	}
+}
+
+void mcp::dag_index::update(mcp::block_hash const & hash_a, mcp::block_state const & state_a)
+{
+	auto it(m_ids.find(hash_a));
+	if (it != m_ids.end())
+		set_state(it->second, state_a);
+}
+
+void mcp::dag_index::prune(uint64_t const & level_a)
+{
+	std::vector<bool> removed(m_hashs.size(), false);
+	size_t count(0);
+	for (auto it(m_ids.begin()); it != m_ids.end();)
+	{
+		uint32_t id(it->second);
+		if ((m_flags[id] & flag_stable) && m_levels[id] < level_a)
+		{
+			removed[id] = true;
+			m_parents[id].clear();
+			m_labels[id].clear();
+			m_free_ids.push_back(id);
+			it = m_ids.erase(it);
+			count++;
+		}
+		else
+			it++;
+	}
+
+	if (m_labeled_level != UINT64_MAX && m_labeled_level < level_a)
+		m_labeled_level = level_a;
+
+	if (count == 0)
+		return;
+	m_nodes -= count;
+	m_pruned += count;
+
+	for (auto const & pair : m_ids)
+	{
+		uint32_t id(pair.second);
+		if (m_best_parents[id] != none && removed[m_best_parents[id]])
+			m_best_parents[id] = none;
+		if (m_previous[id] != none && removed[m_previous[id]])
+			m_previous[id] = none;
+
+		///removed blocks are below labeled level, the same as not included
+		for (uint32_t & latest : m_labels[id])
+		{
+			if (latest != none && removed[latest])
+				latest = none;
+		}
+
+		for (uint32_t const & p_id : m_parents[id])
+		{
+			if (removed[p_id])
+			{
+				m_parents[id].clear();
+				m_flags[id] &= ~flag_linked;
+				break;
+			}
+		}
+	}
+}
+
+std::string mcp::dag_index::report()
+{
+	std::stringstream s;
+	s << "dag index nodes:" << m_nodes
+		<< " , loads:" << m_loads
+		<< " , pruned:" << m_pruned
+		<< " , reach answered:" << m_reach_answered
+		<< " , reach unknown:" << m_reach_unknown
+		<< " , searched:" << m_searched;
+	return s.str();
+}
+
+void mcp::dag_index::set_state(uint32_t const & id_a, mcp::block_state const & state_a)
+{
+	m_levels[id_a] = state_a.level;
+	m_witnessed_levels[id_a] = state_a.witnessed_level;
+	m_mcis[id_a] = mci_or_none(state_a.main_chain_index);
+	m_earliest_included_mcis[id_a] = mci_or_none(state_a.earliest_included_mc_index);
+	m_latest_included_mcis[id_a] = mci_or_none(state_a.latest_included_mc_index);
+	m_bp_included_mcis[id_a] = mci_or_none(state_a.bp_included_mc_index);
+	m_earliest_bp_included_mcis[id_a] = mci_or_none(state_a.earliest_bp_included_mc_index);
+	m_latest_bp_included_mcis[id_a] = mci_or_none(state_a.latest_bp_included_mc_index);
+
+	uint8_t flags(m_flags[id_a] & (flag_linked | flag_labeled));
+	if (state_a.is_on_main_chain)
+		flags |= flag_on_main_chain;
+	if (state_a.is_stable)
+		flags |= flag_stable;
+	if (state_a.is_free)
+		flags |= flag_free;
+	m_flags[id_a] = flags;
+}
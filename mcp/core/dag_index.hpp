@@ -0,0 +1,127 @@
+#pragma once
+
+#include <mcp/core/block_cache.hpp>
+
+#include <atomic>
+
+namespace mcp
+{
+	enum class dag_reach
+	{
+		no = 0,
+		yes,
+		/// labels can not tell, search the dag
+		unknown,
+	};
+
+	/// dag blocks walked by consensus, one array per field indexed by node id, parents are node ids.
+	/// nodes are loaded from cache on first access and updated when their block state is written,
+	/// so index shows the same dag as the cache it is filled from. not thread safe, except counters and report.
+	class dag_index
+	{
+	public:
+		static constexpr uint32_t none = UINT32_MAX;
+		/// main chain index of a block not set
+		static constexpr uint64_t no_mci = UINT64_MAX;
+
+		/// labels_a: keep reachability labels, only for an index kept over many traversals
+		explicit dag_index(bool const & labels_a = false);
+
+		/// index kept by cache_a, or an empty index filled for one traversal if cache_a keeps none
+		static std::shared_ptr<mcp::dag_index> of(std::shared_ptr<mcp::iblock_cache> cache_a);
+
+		/// node of block, loaded from cache_a if not indexed
+		uint32_t node(mcp::db::db_transaction & transaction_a, mcp::iblock_cache & cache_a, mcp::block_hash const & hash_a);
+		/// load parents of node, parents(id_a) is valid until next node is loaded
+		void link(mcp::db::db_transaction & transaction_a, mcp::iblock_cache & cache_a, uint32_t const & id_a);
+		std::vector<uint32_t> const & parents(uint32_t const & id_a) const { return m_parents[id_a]; }
+		/// best parent node, none for genesis
+		uint32_t best_parent(mcp::db::db_transaction & transaction_a, mcp::iblock_cache & cache_a, uint32_t const & id_a);
+
+		/// id of block author, ids are not reused
+		uint32_t address_id(dev::Address const & address_a);
+		dev::Address const & address(uint32_t const & address_id_a) const { return m_addresses[address_id_a]; }
+
+		mcp::block_hash const & hash(uint32_t const & id_a) const { return m_hashs[id_a]; }
+		uint32_t from(uint32_t const & id_a) const { return m_froms[id_a]; }
+		uint64_t level(uint32_t const & id_a) const { return m_levels[id_a]; }
+		uint64_t witnessed_level(uint32_t const & id_a) const { return m_witnessed_levels[id_a]; }
+		bool is_on_main_chain(uint32_t const & id_a) const { return m_flags[id_a] & flag_on_main_chain; }
+		bool is_stable(uint32_t const & id_a) const { return m_flags[id_a] & flag_stable; }
+		bool is_free(uint32_t const & id_a) const { return m_flags[id_a] & flag_free; }
+		uint64_t mci(uint32_t const & id_a) const { return m_mcis[id_a]; }
+		uint64_t earliest_included_mci(uint32_t const & id_a) const { return m_earliest_included_mcis[id_a]; }
+		uint64_t latest_included_mci(uint32_t const & id_a) const { return m_latest_included_mcis[id_a]; }
+		uint64_t bp_included_mci(uint32_t const & id_a) const { return m_bp_included_mcis[id_a]; }
+		uint64_t earliest_bp_included_mci(uint32_t const & id_a) const { return m_earliest_bp_included_mcis[id_a]; }
+		uint64_t latest_bp_included_mci(uint32_t const & id_a) const { return m_latest_bp_included_mcis[id_a]; }
+
+		/// whether earlier_a is an ancestor of later_a. label of a node is the latest ancestor from each author,
+		/// earlier_a is included if it is on the previous chain of the latest ancestor from its author.
+		/// unknown for nodes below labeled levels and for forked authors.
+		mcp::dag_reach included(mcp::db::db_transaction & transaction_a, mcp::iblock_cache & cache_a, uint32_t const & earlier_a, uint32_t const & later_a);
+		/// blocks visited by searches labels could not answer
+		void searched(uint64_t const & count_a) { m_searched += count_a; }
+
+		/// block state of block written, nothing is done if block is not indexed
+		void update(mcp::block_hash const & hash_a, mcp::block_state const & state_a);
+		/// remove stable nodes below level_a, nodes linked to them are linked again on access.
+		/// labels are kept for ancestors from level_a on.
+		void prune(uint64_t const & level_a);
+
+		size_t size() const { return m_nodes; }
+		uint64_t reach_answered() const { return m_reach_answered; }
+		uint64_t reach_unknown() const { return m_reach_unknown; }
+		/// reads counters only, called from other threads
+		std::string report();
+
+	private:
+		static constexpr uint8_t flag_on_main_chain = 1;
+		static constexpr uint8_t flag_stable = 2;
+		static constexpr uint8_t flag_free = 4;
+		static constexpr uint8_t flag_linked = 8;
+		static constexpr uint8_t flag_labeled = 16;
+		/// previous chain walked at most for an included answer
+		static constexpr size_t max_previous_walk = 64;
+
+		uint32_t insert(mcp::block_hash const & hash_a, std::shared_ptr<mcp::block> const & block_a, std::shared_ptr<mcp::block_state> const & state_a);
+		void set_state(uint32_t const & id_a, mcp::block_state const & state_a);
+		void label(mcp::db::db_transaction & transaction_a, mcp::iblock_cache & cache_a, uint32_t const & id_a);
+
+		std::unordered_map<mcp::block_hash, uint32_t> m_ids;
+		std::vector<uint32_t> m_free_ids;
+
+		std::vector<mcp::block_hash> m_hashs;
+		std::vector<std::vector<uint32_t>> m_parents;
+		std::vector<uint32_t> m_best_parents;
+		std::vector<uint32_t> m_previous;
+		std::vector<mcp::block_hash> m_best_parent_hashs;
+		std::vector<uint32_t> m_froms;
+		std::vector<uint64_t> m_levels;
+		std::vector<uint64_t> m_witnessed_levels;
+		std::vector<uint64_t> m_mcis;
+		std::vector<uint64_t> m_earliest_included_mcis;
+		std::vector<uint64_t> m_latest_included_mcis;
+		std::vector<uint64_t> m_bp_included_mcis;
+		std::vector<uint64_t> m_earliest_bp_included_mcis;
+		std::vector<uint64_t> m_latest_bp_included_mcis;
+		std::vector<uint8_t> m_flags;
+		/// latest ancestor or self from each author by address id, from labeled level on
+		std::vector<std::vector<uint32_t>> m_labels;
+
+		std::unordered_map<dev::Address, uint32_t> m_address_ids;
+		std::vector<dev::Address> m_addresses;
+
+		bool const m_labels_enabled;
+		/// ancestors below are not in labels, set by first query
+		uint64_t m_labeled_level = UINT64_MAX;
+
+		/// size of m_ids, read by report
+		std::atomic<uint64_t> m_nodes = { 0 };
+		std::atomic<uint64_t> m_loads = { 0 };
+		std::atomic<uint64_t> m_pruned = { 0 };
+		std::atomic<uint64_t> m_reach_answered = { 0 };
+		std::atomic<uint64_t> m_reach_unknown = { 0 };
+		std::atomic<uint64_t> m_searched = { 0 };
+	};
+}
@@ -57,7 +57,7 @@ std::string const live_genesis_data = R"%%%({
 	"exec_timestamp":"1700625600"
 })%%%";
 
-std::pair<bool, mcp::Transactions> mcp::genesis::try_initialize(mcp::db::db_transaction & transaction_a, mcp::block_store & store_a)
+std::unique_ptr<mcp::block> mcp::genesis::create(mcp::Transaction & genesis_transaction_a, mcp::Transactions & staking_a)
 {
 	std::string genesis_data;
 	switch (mcp::mcp_network)
@@ -87,7 +87,8 @@ std::pair<bool, mcp::Transactions> mcp::genesis::try_initialize(mcp::db::db_tran
 	_t.nonce = 0;
 	_t.gas = mcp::tx_max_gas;
 	_t.gasPrice = mcp::gas_price;
-	Transaction ts(_t);
+	genesis_transaction_a = Transaction(_t);
+	Transaction & ts(genesis_transaction_a);
 	ts.setSignature(h256(0), h256(0), 0);
 	GenesisAddress = ts.sender();
 
@@ -101,8 +102,8 @@ std::pair<bool, mcp::Transactions> mcp::genesis::try_initialize(mcp::db::db_tran
 	initHashes.push_back(ts.sha3());
 	GenesisTransactions.insert(std::pair(ts.sha3(), ts.sender()));
 	/// genesis block linked initialized transaction 
-	Transactions _tstaking = InitMainContractTransaction();
-	for (Transaction _t : _tstaking)
+	staking_a = InitMainContractTransaction();
+	for (Transaction _t : staking_a)
 	{
 		initHashes.push_back(_t.sha3());
 		GenesisTransactions.insert(std::pair(_t.sha3(), _t.sender()));
@@ -112,6 +113,15 @@ std::pair<bool, mcp::Transactions> mcp::genesis::try_initialize(mcp::db::db_tran
 	block->init_from_genesis_transaction(ts.sender(), initHashes, json["exec_timestamp"]);
 
 	block_hash = block->hash();
+	return block;
+}
+
+std::pair<bool, mcp::Transactions> mcp::genesis::try_initialize(mcp::db::db_transaction & transaction_a, mcp::block_store & store_a)
+{
+	Transaction ts;
+	Transactions _tstaking;
+	std::unique_ptr<mcp::block> block(create(ts, _tstaking));
+
 	mcp::block_hash genesis_hash;
 	bool exists(!store_a.genesis_hash_get(transaction_a, genesis_hash));
 	if (exists)
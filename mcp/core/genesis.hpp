@@ -9,6 +9,8 @@ namespace mcp
 	class genesis
 	{
 	public:
+		/// genesis block of network, sets block_hash, GenesisAddress and genesis transactions, nothing is written
+		static std::unique_ptr<mcp::block> create(Transaction & genesis_transaction_a, Transactions & staking_a);
 		static std::pair<bool, Transactions> try_initialize(mcp::db::db_transaction & transaction_a, mcp::block_store & store_a);
 		
 		static std::pair<bool, dev::Address> isGenesisTransaction(mcp::block_hash const& _h);
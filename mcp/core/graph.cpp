@@ -1,5 +1,6 @@
 #include "graph.hpp"
 #include <mcp/core/genesis.hpp>
+#include <mcp/core/dag_index.hpp>
 
 #include <queue>
 #include <unordered_set>
@@ -59,6 +60,14 @@ mcp::graph_compare_result mcp::graph::compare(mcp::db::db_transaction & transact
 	mcp::graph_compare_result result_if_found = state1->level < state2->level ? graph_compare_result::hash1_included_by_hash2 
 																		: graph_compare_result::hash2_included_by_hash1;
 
+	///labels answer most comparisons without search
+	std::shared_ptr<mcp::dag_index> index(mcp::dag_index::of(cache_a));
+	uint32_t earlier_id(index->node(transaction_a, *cache_a, earlier_hash));
+	uint32_t later_id(index->node(transaction_a, *cache_a, later_hash));
+	mcp::dag_reach reach(index->included(transaction_a, *cache_a, earlier_id, later_id));
+	if (reach != mcp::dag_reach::unknown)
+		return reach == mcp::dag_reach::yes ? result_if_found : graph_compare_result::non_related;
+
 	uint64_t earlier_delta((earlier_state->main_chain_index ? *earlier_state->main_chain_index : 0) - *earlier_state->latest_included_mc_index);
 	uint64_t later_delta((later_state->main_chain_index ? *later_state->main_chain_index : 0) - *later_state->latest_included_mc_index);
 
@@ -133,6 +142,21 @@ bool mcp::graph::determine_if_included(mcp::db::db_transaction & transaction_a,
 	if (max_later_level < earlier_state->level)
 		return false;
 
+	///labels answer most checks without search
+	std::shared_ptr<mcp::dag_index> index(mcp::dag_index::of(cache_a));
+	uint32_t earlier_id(index->node(transaction_a, *cache_a, earlier_hash));
+	bool reach_unknown(false);
+	for (mcp::block_hash const & later_hash : later_hashs)
+	{
+		mcp::dag_reach reach(index->included(transaction_a, *cache_a, earlier_id, index->node(transaction_a, *cache_a, later_hash)));
+		if (reach == mcp::dag_reach::yes)
+			return true;
+		if (reach == mcp::dag_reach::unknown)
+			reach_unknown = true;
+	}
+	if (!reach_unknown)
+		return false;
+
 	return go_up_check_included(transaction_a, cache_a, earlier_hash, later_hashs, is_trace);
 }
 
@@ -145,74 +169,78 @@ bool mcp::graph::determine_if_included_or_equal(mcp::db::db_transaction & transa
 
 bool mcp::graph::go_up_check_included(mcp::db::db_transaction & transaction_a, std::shared_ptr<mcp::iblock_cache> cache_a, mcp::block_hash const & earlier_hash, std::vector<mcp::block_hash> const &  later_hashs, bool const & is_trace)
 {
-	std::shared_ptr<mcp::block_state> earlier_state(cache_a->block_state_get(transaction_a, earlier_hash));
-	assert_x(earlier_state);
-	assert_x(earlier_state->earliest_included_mc_index);
-	assert_x(earlier_state->latest_included_mc_index);
-
-	std::unordered_set<mcp::block_hash> searched_hashs;
-	std::queue<mcp::block_hash> search_hashs;
-	for (mcp::block_hash const & hash : later_hashs)
-		search_hashs.push(hash);
+	std::shared_ptr<mcp::dag_index> index(mcp::dag_index::of(cache_a));
+	uint32_t earlier_id(index->node(transaction_a, *cache_a, earlier_hash));
+	uint64_t const earlier_level(index->level(earlier_id));
+	uint64_t const earlier_mci(index->mci(earlier_id));
+	uint64_t const earlier_eimci(index->earliest_included_mci(earlier_id));
+	uint64_t const earlier_limci(index->latest_included_mci(earlier_id));
+	assert_x(earlier_eimci != mcp::dag_index::no_mci);
+	assert_x(earlier_limci != mcp::dag_index::no_mci);
+
+	///search level by level, parents not indexed are read by one batch per block
+	std::unordered_set<uint32_t> searched_ids;
+	std::vector<uint32_t> search_ids;
+	std::vector<uint32_t> next_search_ids;
+	for (mcp::block_hash const & later_hash : later_hashs)
+		search_ids.push_back(index->node(transaction_a, *cache_a, later_hash));
 
 	int search_count(0);
-	while (search_hashs.size() > 0)
+	while (search_ids.size() > 0)
 	{
-		search_count++;
-		mcp::block_hash hash(std::move(search_hashs.front()));
-		search_hashs.pop();
-
-		std::shared_ptr<mcp::block> block(cache_a->block_get(transaction_a, hash));
-		assert_x(block != nullptr);
+		search_count += search_ids.size();
 
-		for (mcp::block_hash const & p_hash : block->parents())
+		next_search_ids.clear();
+		for (uint32_t const & id : search_ids)
 		{
-			auto r = searched_hashs.insert(p_hash);
-			if (!r.second)
-				continue;
-
-			if (p_hash == earlier_hash)
-			{
-				//LOG(m_log.trace) << "go_up_check_included search count: " << search_count;
-				return true;
-			}
-
-			std::shared_ptr<mcp::block_state> p_state(cache_a->block_state_get(transaction_a, p_hash));
-			assert_x(p_state);
-
-			if (is_trace)
+			index->link(transaction_a, *cache_a, id);
+			for (uint32_t const & p_id : index->parents(id))
 			{
-                LOG(m_log.info) << "p_hash: " << p_hash.hex()
-					<< ", is_stable: " << p_state->is_stable
-					<< ", is_on_mc: " << p_state->is_on_main_chain
-					<< ", mci: " << (p_state->main_chain_index ? *p_state->main_chain_index : 0)
-					<< ", limci: " << p_state->latest_included_mc_index ? *p_state->latest_included_mc_index : 0;
-			}
+				auto r = searched_ids.insert(p_id);
+				if (!r.second)
+					continue;
 
-			if (p_state->is_on_main_chain)
-			{
-				if (earlier_state->main_chain_index
-					&& *p_state->main_chain_index >= *earlier_state->main_chain_index)
+				if (p_id == earlier_id)
 				{
-					//LOG(m_log.trace) << "go_up_check_included search count: " << search_count;
+					index->searched(search_count);
 					return true;
 				}
-			}
-			else
-			{
-				assert_x(p_state->earliest_included_mc_index);
-				assert_x(p_state->latest_included_mc_index);
-				if (*p_state->earliest_included_mc_index > *earlier_state->latest_included_mc_index
-					|| *p_state->latest_included_mc_index < *earlier_state->earliest_included_mc_index)
-					continue;
 
-				if (p_state->level > earlier_state->level)
-					search_hashs.push(p_hash);
+				if (is_trace)
+				{
+					LOG(m_log.info) << "p_hash: " << index->hash(p_id).hex()
+						<< ", is_stable: " << index->is_stable(p_id)
+						<< ", is_on_mc: " << index->is_on_main_chain(p_id)
+						<< ", mci: " << (index->mci(p_id) != mcp::dag_index::no_mci ? index->mci(p_id) : 0)
+						<< ", limci: " << (index->latest_included_mci(p_id) != mcp::dag_index::no_mci ? index->latest_included_mci(p_id) : 0);
+				}
+
+				if (index->is_on_main_chain(p_id))
+				{
+					if (earlier_mci != mcp::dag_index::no_mci
+						&& index->mci(p_id) >= earlier_mci)
+					{
+						index->searched(search_count);
+						return true;
+					}
+				}
+				else
+				{
+					assert_x(index->earliest_included_mci(p_id) != mcp::dag_index::no_mci);
+					assert_x(index->latest_included_mci(p_id) != mcp::dag_index::no_mci);
+					if (index->earliest_included_mci(p_id) > earlier_limci
+						|| index->latest_included_mci(p_id) < earlier_eimci)
+						continue;
+
+					if (index->level(p_id) > earlier_level)
+						next_search_ids.push_back(p_id);
+				}
 			}
 		}
+		search_ids.swap(next_search_ids);
 	}
 
-	//LOG(m_log.trace) << "go_up_check_included search count: " << search_count;
+	index->searched(search_count);
 	return false;
 }
 
@@ -223,6 +251,7 @@ bool mcp::graph::go_down_check_included(mcp::db::db_transaction & transaction_a,
 	assert_x(later_state->earliest_included_mc_index);
 	assert_x(later_state->latest_included_mc_index);
 
+	std::shared_ptr<mcp::dag_index> index(mcp::dag_index::of(cache_a));
 	std::unordered_set<mcp::block_hash> searched_hashs;
 	std::queue<mcp::block_hash> search_hashs;
 	for (mcp::block_hash const & hash : earlier_hashs)
@@ -246,7 +275,10 @@ bool mcp::graph::go_down_check_included(mcp::db::db_transaction & transaction_a,
 				continue;
 
 			if (hash == later_hash)
+			{
+				index->searched(searched_hashs.size());
 				return true;
+			}
 
 			std::shared_ptr<mcp::block_state> p_state(cache_a->block_state_get(transaction_a, c_hash));
 			assert_x(p_state);
@@ -255,7 +287,10 @@ bool mcp::graph::go_down_check_included(mcp::db::db_transaction & transaction_a,
 			{
 				if (p_state->main_chain_index
 					&& *later_state->main_chain_index >= *p_state->main_chain_index)
+				{
+					index->searched(searched_hashs.size());
 					return true;
+				}
 			}
 			else
 			{
@@ -271,6 +306,7 @@ bool mcp::graph::go_down_check_included(mcp::db::db_transaction & transaction_a,
 		}
 	}
 
+	index->searched(searched_hashs.size());
 	return false;
 }
 
@@ -36,6 +36,7 @@ void overlay_db::commit()
         if (i.second.second)
         {
             store.contract_main_trie_node_put(transaction, mcp::code_hash(i.first), i.second.first);
+            store.trie_node_cache().put(i.first, i.second.first);
             //std::cout << "commit: " << mcp::uint256_union(i.first).to_string() << " string: " << i.second.first <<std::endl;
         }
     }
@@ -63,6 +64,7 @@ bytes overlay_db::lookupAux(dev::h256 const& _h) const
     bytes b = _h.asBytes();
     b.push_back(255);   // for aux
 
+    auto lock(read_lock());
     bytes value;
     bool error = store.contract_aux_state_key_get(transaction, b, value);
     return value;
@@ -82,8 +84,14 @@ std::string overlay_db::lookup(dev::h256 const& _h) const
     if (!ret.empty())
         return ret;
 
+    auto lock(read_lock());
     std::string value;
+    if (store.trie_node_cache().get(_h, value))
+        return value;
+
     bool error = store.contract_main_trie_node_get(transaction, mcp::code_hash(_h), value);
+    if (!error)
+        store.trie_node_cache().put(_h, value);
     //std::cout << "looktup: " << mcp::uint256_union(_h).to_string() << " string: " << value.size() << std::endl;
     return value;
 }
@@ -93,14 +101,28 @@ bool overlay_db::exists(dev::h256 const& _h) const
     if (StateCacheDB::exists(_h))
         return true;
 
+    auto lock(read_lock());
     std::string value;
-    return !store.contract_main_trie_node_get(transaction, mcp::code_hash(_h), value);
+    if (store.trie_node_cache().get(_h, value))
+        return true;
+
+    bool error = store.contract_main_trie_node_get(transaction, mcp::code_hash(_h), value);
+    if (!error)
+        store.trie_node_cache().put(_h, value);
+    return !error;
 
     /*
     return m_db && m_db->exists(toSlice(_h));
     */
 }
 
+std::unique_lock<std::mutex> overlay_db::read_lock() const
+{
+    if (m_read_mutex)
+        return std::unique_lock<std::mutex>(*m_read_mutex);
+    return std::unique_lock<std::mutex>();
+}
+
 void overlay_db::kill(dev::h256 const& _h)
 {
 /*
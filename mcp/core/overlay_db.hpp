@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <libdevcore/db.h>
 #include <libdevcore/Common.h>
 #include <libdevcore/Log.h>
@@ -37,10 +38,16 @@ namespace mcp
 
 		bytes lookupAux(h256 const& _h) const;
 
+		/// lock held while reading store, set when transaction is shared by threads
+		void set_read_mutex(std::mutex * mutex_a) { m_read_mutex = mutex_a; }
+
 	private:
+		std::unique_lock<std::mutex> read_lock() const;
+
 		using StateCacheDB::clear;
 
 		mcp::block_store &store;
 		mcp::db::db_transaction &transaction;
+		std::mutex * m_read_mutex = nullptr;
 	};
 }
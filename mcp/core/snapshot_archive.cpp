@@ -0,0 +1,284 @@
+#include "snapshot_archive.hpp"
+
+#include <boost/crc.hpp>
+#include <boost/format.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	/// run task_a for 0 .. count_a - 1 on threads_a threads, return true if a task failed
+	bool run_parallel(unsigned const & threads_a, size_t const & count_a, std::function<bool(size_t)> const & task_a, mcp::log & log_a)
+	{
+		std::atomic<size_t> next(0);
+		std::atomic<bool> error(false);
+		auto run = [&]() {
+			for (size_t i(next++); i < count_a && !error; i = next++)
+			{
+				try
+				{
+					if (task_a(i))
+						error = true;
+				}
+				catch (std::exception const & e)
+				{
+					LOG(log_a.error) << "Snapshot archive error:" << e.what();
+					error = true;
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned i(1); i < threads_a && i < count_a; i++)
+			threads.emplace_back(run);
+		run();
+		for (auto & t : threads)
+			t.join();
+		return error;
+	}
+}
+
+mcp::snapshot_archive_file::snapshot_archive_file(bool & error_a, dev::RLP const & r)
+{
+	error_a = !r.isList() || r.itemCount() != 5;
+	if (error_a)
+		return;
+
+	try
+	{
+		table = (mcp::snapshot_table)r[0].toInt<uint8_t>();
+		name = r[1].toString();
+		size = r[2].toInt<uint64_t>();
+		entries = r[3].toInt<uint64_t>();
+		checksum = r[4].toInt<uint32_t>();
+		///file must be in archive directory
+		error_a = table >= mcp::snapshot_table::table_count || name.empty() || boost::filesystem::path(name).filename().string() != name;
+	}
+	catch (std::exception const &)
+	{
+		error_a = true;
+	}
+}
+
+void mcp::snapshot_archive_file::stream_RLP(dev::RLPStream & s) const
+{
+	s.appendList(5);
+	s << (uint8_t)table << name << size << entries << checksum;
+}
+
+mcp::snapshot_archive::snapshot_archive(boost::filesystem::path const & path_a) :
+	m_path(path_a)
+{
+}
+
+bool mcp::snapshot_archive::write(mcp::block_store & store_a, unsigned const & threads_a)
+{
+	auto start(std::chrono::steady_clock::now());
+	boost::system::error_code ec;
+	boost::filesystem::create_directories(m_path, ec);
+	if (ec || !boost::filesystem::is_empty(m_path))
+	{
+		LOG(m_log.error) << "Snapshot archive directory is not empty or can not be created:" << m_path.string();
+		return true;
+	}
+
+	mcp::state_snapshot_reader reader(store_a);
+	m_manifest = reader.manifest();
+	m_files.clear();
+
+	size_t const count((size_t)mcp::snapshot_table::table_count);
+	std::vector<std::vector<mcp::snapshot_archive_file>> table_files(count);
+	bool error(run_parallel(threads_a, count, [&](size_t i) {
+		return write_table(reader, store_a, (mcp::snapshot_table)i, table_files[i]);
+	}, m_log));
+	if (error)
+		return true;
+
+	for (auto & files : table_files)
+		m_files.insert(m_files.end(), files.begin(), files.end());
+	error = write_manifest();
+	m_duration = std::chrono::steady_clock::now() - start;
+	return error;
+}
+
+bool mcp::snapshot_archive::write_table(mcp::state_snapshot_reader & reader_a, mcp::block_store & store_a, mcp::snapshot_table const & table_a, std::vector<mcp::snapshot_archive_file> & files_a)
+{
+	int index;
+	if (mcp::snapshot_table_index(store_a, table_a, index))
+		return true;
+
+	std::unique_ptr<rocksdb::SstFileWriter> writer;
+	mcp::snapshot_archive_file file;
+	auto finish_file = [&]() {
+		mcp::db::check_status(writer->Finish());
+		writer.reset();
+		boost::filesystem::path path(m_path / file.name);
+		file.size = boost::filesystem::file_size(path);
+		file.checksum = checksum(path);
+		files_a.push_back(file);
+	};
+
+	dev::bytes from;
+	mcp::snapshot_chunk chunk;
+	do
+	{
+		if (reader_a.read(table_a, from, (size_t)c_chunk_bytes, chunk))
+			return true;
+
+		for (auto const & e : chunk.entries)
+		{
+			if (!writer)
+			{
+				file = mcp::snapshot_archive_file();
+				file.table = table_a;
+				file.name = boost::str(boost::format("%1%-%2%.sst") % (unsigned)table_a % files_a.size());
+				writer = store_a.m_db->create_sst_file_writer(index);
+				mcp::db::check_status(writer->Open((m_path / file.name).string()));
+			}
+			mcp::db::check_status(writer->Put(rocksdb::Slice((char const *)e.first.data(), e.first.size()),
+				rocksdb::Slice((char const *)e.second.data(), e.second.size())));
+			file.entries++;
+
+			if (writer->FileSize() >= c_file_bytes)
+				finish_file();
+		}
+		from = chunk.next_key;
+	} while (!from.empty());
+
+	if (writer)
+		finish_file();
+	return false;
+}
+
+bool mcp::snapshot_archive::read(mcp::block_store & store_a, unsigned const & threads_a, mcp::summary_hash const & trusted_summary_a)
+{
+	auto start(std::chrono::steady_clock::now());
+	if (read_manifest())
+		return true;
+
+	bool error(false);
+	mcp::state_snapshot_writer writer(error, store_a, m_manifest);
+	if (error)
+		return true;
+
+	///nothing is loaded until all files are verified
+	error = run_parallel(threads_a, m_files.size(), [&](size_t i) {
+		mcp::snapshot_archive_file const & file(m_files[i]);
+		boost::filesystem::path path(m_path / file.name);
+		if (!boost::filesystem::exists(path) || boost::filesystem::file_size(path) != file.size || checksum(path) != file.checksum)
+		{
+			LOG(m_log.error) << "Snapshot archive file is missing or corrupted:" << path.string();
+			return true;
+		}
+		return false;
+	}, m_log);
+	if (error)
+		return true;
+
+	for (size_t t(0); t < (size_t)mcp::snapshot_table::table_count; t++)
+	{
+		std::vector<std::string> files;
+		uint64_t entries(0);
+		for (auto const & file : m_files)
+		{
+			if ((size_t)file.table != t)
+				continue;
+			files.push_back((m_path / file.name).string());
+			entries += file.entries;
+		}
+		if (writer.ingest((mcp::snapshot_table)t, files, entries))
+			return true;
+	}
+
+	error = writer.finish(trusted_summary_a);
+	m_duration = std::chrono::steady_clock::now() - start;
+	return error;
+}
+
+bool mcp::snapshot_archive::write_manifest()
+{
+	dev::RLPStream s;
+	s.appendList(3);
+	s << (unsigned)c_format_version;
+	m_manifest.stream_RLP(s);
+	s.appendList(m_files.size());
+	for (auto const & file : m_files)
+		file.stream_RLP(s);
+
+	dev::bytes const & data(s.out());
+	std::ofstream stream((m_path / "manifest").string(), std::ios::binary | std::ios::trunc);
+	stream.write((char const *)data.data(), data.size());
+	stream.close();
+	if (!stream)
+	{
+		LOG(m_log.error) << "Snapshot archive manifest write error";
+		return true;
+	}
+	return false;
+}
+
+bool mcp::snapshot_archive::read_manifest()
+{
+	std::ifstream stream((m_path / "manifest").string(), std::ios::binary);
+	dev::bytes data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	bool error(data.empty());
+	try
+	{
+		dev::RLP r(data);
+		error = error || !r.isList() || r.itemCount() != 3 || r[0].toInt<unsigned>() != c_format_version;
+		if (!error)
+			m_manifest = mcp::snapshot_manifest(error, r[1]);
+		m_files.clear();
+		for (auto it(r[2].begin()); !error && it != r[2].end(); ++it)
+		{
+			m_files.push_back(mcp::snapshot_archive_file(error, *it));
+		}
+	}
+	catch (std::exception const &)
+	{
+		error = true;
+	}
+
+	if (error)
+		LOG(m_log.error) << "Snapshot archive manifest is missing or invalid:" << m_path.string();
+	return error;
+}
+
+uint32_t mcp::snapshot_archive::checksum(boost::filesystem::path const & file_a)
+{
+	boost::crc_32_type crc;
+	std::ifstream stream(file_a.string(), std::ios::binary);
+	std::vector<char> buffer(1024 * 1024);
+	while (stream)
+	{
+		stream.read(buffer.data(), buffer.size());
+		crc.process_bytes(buffer.data(), stream.gcount());
+	}
+	return crc.checksum();
+}
+
+std::string mcp::snapshot_archive::get_info()
+{
+	uint64_t entries(0);
+	uint64_t bytes(0);
+	for (auto const & file : m_files)
+	{
+		entries += file.entries;
+		bytes += file.size;
+	}
+	uint64_t ms(std::chrono::duration_cast<std::chrono::milliseconds>(m_duration).count());
+
+	std::stringstream s;
+	s << "snapshot archive mci:" << m_manifest.last_stable_mci
+		<< " ,summary:" << m_manifest.stable_summary.hex()
+		<< " ,files:" << m_files.size()
+		<< " ,entries:" << entries
+		<< " ,bytes:" << bytes
+		<< " ,time:" << ms << "ms"
+		<< " ,MB/s:" << (ms ? bytes * 1000 / ms / 1024 / 1024 : 0);
+	return s.str();
+}
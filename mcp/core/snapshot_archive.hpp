@@ -0,0 +1,54 @@
+#pragma once
+
+#include <mcp/core/state_snapshot.hpp>
+
+namespace mcp
+{
+	/// sst file holding a key range of one snapshot table
+	class snapshot_archive_file
+	{
+	public:
+		snapshot_archive_file() = default;
+		snapshot_archive_file(bool & error_a, dev::RLP const & r);
+		void stream_RLP(dev::RLPStream & s) const;
+
+		mcp::snapshot_table table = mcp::snapshot_table::prop;
+		std::string name;
+		uint64_t size = 0;
+		uint64_t entries = 0;
+		/// crc32 of file
+		uint32_t checksum = 0;
+	};
+
+	/// offline state snapshot: a directory with compressed sst files of every table and a manifest listing them.
+	/// sst files are bulk loaded on import, keys are not written one by one.
+	class snapshot_archive
+	{
+	public:
+		snapshot_archive(boost::filesystem::path const & path_a);
+
+		/// export consistent snapshot of store into empty directory, tables are written by threads_a threads, return true on error
+		bool write(mcp::block_store & store_a, unsigned const & threads_a);
+		/// verify checksums and ingest into empty store, trusted_summary_a is checked if not zero, return true on error
+		bool read(mcp::block_store & store_a, unsigned const & threads_a, mcp::summary_hash const & trusted_summary_a);
+
+		std::string get_info();
+
+		static constexpr unsigned c_format_version = 1;
+		/// new file is started when sst file is larger than this
+		static constexpr uint64_t c_file_bytes = 256 * 1024 * 1024;
+		static constexpr size_t c_chunk_bytes = 4 * 1024 * 1024;
+
+	private:
+		bool write_table(mcp::state_snapshot_reader & reader_a, mcp::block_store & store_a, mcp::snapshot_table const & table_a, std::vector<mcp::snapshot_archive_file> & files_a);
+		bool write_manifest();
+		bool read_manifest();
+		static uint32_t checksum(boost::filesystem::path const & file_a);
+
+		boost::filesystem::path const m_path;
+		mcp::snapshot_manifest m_manifest;
+		std::vector<mcp::snapshot_archive_file> m_files;
+		std::chrono::steady_clock::duration m_duration = std::chrono::steady_clock::duration(0);
+		mcp::log m_log = { mcp::log("db") };
+	};
+}
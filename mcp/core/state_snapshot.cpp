@@ -0,0 +1,542 @@
+#include "state_snapshot.hpp"
+
+#include <libdevcore/TrieHash.h>
+
+#include <limits>
+#include <sstream>
+
+namespace
+{
+	/// counters of count column family
+	std::vector<std::string> const snapshot_counters = { "block", "dag_free", "transaction", "transaction_unstable", "approve", "approve_unstable" };
+
+	/// version, catchup, history and log index props are local to a node
+	bool is_snapshot_prop(dev::bytes const & key_a)
+	{
+		if (key_a.size() != dev::h256::size)
+			return false;
+		dev::h256 key(key_a);
+		return key == mcp::block_store::genesis_hash_key
+			|| key == mcp::block_store::genesis_transaction_hash_key
+			|| key == mcp::block_store::last_mci_key
+			|| key == mcp::block_store::last_stable_mci_key
+			|| key == mcp::block_store::advance_info_key
+			|| key == mcp::block_store::last_stable_index_key;
+	}
+}
+
+bool mcp::snapshot_table_index(mcp::block_store & store_a, mcp::snapshot_table const & table_a, int & index_a)
+{
+	switch (table_a)
+	{
+	case mcp::snapshot_table::prop: index_a = store_a.prop; break;
+	case mcp::snapshot_table::dag_account_info: index_a = store_a.dag_account_info; break;
+	case mcp::snapshot_table::account_info: index_a = store_a.account_info; break;
+	case mcp::snapshot_table::latest_account_state: index_a = store_a.latest_account_state; break;
+	case mcp::snapshot_table::account_state: index_a = store_a.account_state; break;
+	case mcp::snapshot_table::blocks: index_a = store_a.blocks; break;
+	case mcp::snapshot_table::transactions: index_a = store_a.transactions; break;
+	case mcp::snapshot_table::transaction_address: index_a = store_a.transaction_address; break;
+	case mcp::snapshot_table::approves: index_a = store_a.approves; break;
+	case mcp::snapshot_table::account_nonce: index_a = store_a.account_nonce; break;
+	case mcp::snapshot_table::block_state: index_a = store_a.block_state; break;
+	case mcp::snapshot_table::block_child: index_a = store_a.block_child; break;
+	case mcp::snapshot_table::dag_free: index_a = store_a.dag_free; break;
+	case mcp::snapshot_table::main_chain: index_a = store_a.main_chain; break;
+	case mcp::snapshot_table::stable_block: index_a = store_a.stable_block; break;
+	case mcp::snapshot_table::stable_block_number: index_a = store_a.stable_block_number; break;
+	case mcp::snapshot_table::block_summary: index_a = store_a.block_summary; break;
+	case mcp::snapshot_table::summary_block: index_a = store_a.summary_block; break;
+	case mcp::snapshot_table::skiplist: index_a = store_a.skiplist; break;
+	case mcp::snapshot_table::successor: index_a = store_a.successor; break;
+	case mcp::snapshot_table::contract_main: index_a = store_a.contract_main; break;
+	case mcp::snapshot_table::contract_aux: index_a = store_a.contract_aux; break;
+	case mcp::snapshot_table::transaction_receipt: index_a = store_a.transaction_receipt; break;
+	case mcp::snapshot_table::approve_receipt: index_a = store_a.approve_receipt; break;
+	case mcp::snapshot_table::epoch_approves: index_a = store_a.epoch_approves; break;
+	case mcp::snapshot_table::epoch_param: index_a = store_a.epoch_param; break;
+	case mcp::snapshot_table::epoch_work_transaction: index_a = store_a.epoch_work_transaction; break;
+	case mcp::snapshot_table::stakingList: index_a = store_a.stakingList; break;
+	case mcp::snapshot_table::receiptsRoot: index_a = store_a.receiptsRoot; break;
+	case mcp::snapshot_table::unlink_block: index_a = store_a.unlink_block; break;
+	case mcp::snapshot_table::unlink_info: index_a = store_a.unlink_info; break;
+	case mcp::snapshot_table::next_unlink: index_a = store_a.next_unlink; break;
+	case mcp::snapshot_table::next_unlink_index: index_a = store_a.next_unlink_index; break;
+	case mcp::snapshot_table::head_unlink: index_a = store_a.head_unlink; break;
+	default:
+		return true;
+	}
+	return false;
+}
+
+mcp::snapshot_manifest::snapshot_manifest(bool & error_a, dev::RLP const & r)
+{
+	error_a = !r.isList() || r.itemCount() != 7;
+	if (error_a)
+		return;
+
+	try
+	{
+		version = r[0].toInt<int>();
+		genesis_hash = (mcp::block_hash)r[1];
+		last_stable_mci = r[2].toInt<uint64_t>();
+		last_stable_index = r[3].toInt<uint64_t>();
+		stable_block = (mcp::block_hash)r[4];
+		stable_summary = (mcp::summary_hash)r[5];
+		for (dev::RLP const & c : r[6])
+		{
+			error_a = c.itemCount() != 2;
+			if (error_a)
+				return;
+			counters.push_back(std::make_pair(c[0].toString(), c[1].toInt<uint64_t>()));
+		}
+	}
+	catch (std::exception const &)
+	{
+		error_a = true;
+	}
+}
+
+void mcp::snapshot_manifest::stream_RLP(dev::RLPStream & s) const
+{
+	s.appendList(7);
+	s << (unsigned)version << genesis_hash << last_stable_mci << last_stable_index << stable_block << stable_summary;
+	s.appendList(counters.size());
+	for (auto const & c : counters)
+	{
+		s.appendList(2);
+		s << c.first << c.second;
+	}
+}
+
+mcp::snapshot_chunk::snapshot_chunk(bool & error_a, dev::RLP const & r)
+{
+	error_a = !r.isList() || r.itemCount() != 4;
+	if (error_a)
+		return;
+
+	try
+	{
+		table = (mcp::snapshot_table)r[0].toInt<uint8_t>();
+		from_key = r[1].toBytes();
+		for (dev::RLP const & e : r[2])
+		{
+			error_a = e.itemCount() != 2;
+			if (error_a)
+				return;
+			entries.push_back(std::make_pair(e[0].toBytes(), e[1].toBytes()));
+		}
+		next_key = r[3].toBytes();
+	}
+	catch (std::exception const &)
+	{
+		error_a = true;
+	}
+}
+
+void mcp::snapshot_chunk::stream_RLP(dev::RLPStream & s) const
+{
+	s.appendList(4);
+	s << (uint8_t)table << from_key;
+	s.appendList(entries.size());
+	for (auto const & e : entries)
+	{
+		s.appendList(2);
+		s << e.first << e.second;
+	}
+	s << next_key;
+}
+
+mcp::state_snapshot_reader::state_snapshot_reader(mcp::block_store & store_a) :
+	m_store(store_a),
+	m_snapshot(store_a.create_snapshot()),
+	m_created(std::chrono::steady_clock::now())
+{
+	mcp::db::db_transaction transaction(m_store.create_transaction());
+	auto prop_get = [&](dev::h256 const & key_a, std::string & value_a) {
+		return transaction.get(m_store.prop, mcp::h256_to_slice(key_a), value_a, m_snapshot);
+	};
+
+	std::string value;
+	m_manifest.version = m_store.version_get();
+	if (prop_get(mcp::block_store::genesis_hash_key, value))
+		m_manifest.genesis_hash = mcp::slice_to_h256(value);
+	if (prop_get(mcp::block_store::last_stable_mci_key, value))
+		m_manifest.last_stable_mci = ((dev::h64::Arith)mcp::slice_to_h64(value)).convert_to<uint64_t>();
+	if (prop_get(mcp::block_store::last_stable_index_key, value))
+		m_manifest.last_stable_index = ((dev::h64::Arith)mcp::slice_to_h64(value)).convert_to<uint64_t>();
+
+	if (!m_store.main_chain_get(transaction, m_manifest.last_stable_mci, m_manifest.stable_block, m_snapshot)
+		&& transaction.get(m_store.block_summary, mcp::h256_to_slice(m_manifest.stable_block), value, m_snapshot))
+		m_manifest.stable_summary = mcp::slice_to_h256(value);
+
+	for (auto const & c : snapshot_counters)
+		m_manifest.counters.push_back(std::make_pair(c, transaction.count_get(c, m_snapshot)));
+}
+
+bool mcp::state_snapshot_reader::read(mcp::snapshot_table const & table_a, dev::bytes const & from_a, size_t const & max_bytes_a, mcp::snapshot_chunk & chunk_a)
+{
+	chunk_a.table = table_a;
+	chunk_a.from_key = from_a;
+	chunk_a.entries.clear();
+	chunk_a.next_key.clear();
+
+	int index;
+	if (mcp::snapshot_table_index(m_store, table_a, index))
+		return true;
+	bool const referenced(table_a == mcp::snapshot_table::account_state);
+
+	mcp::db::db_transaction transaction(m_store.create_transaction());
+	mcp::db::forward_iterator it;
+	if (from_a.empty())
+		it = transaction.begin(index, m_snapshot);
+	else
+		it = transaction.begin(index, dev::Slice((char const *)from_a.data(), from_a.size()), m_snapshot);
+
+	size_t size(0);
+	for (; it.valid(); ++it)
+	{
+		if (size >= max_bytes_a && !chunk_a.entries.empty())
+		{
+			chunk_a.next_key = it.key().toBytes();
+			break;
+		}
+
+		dev::bytes key(it.key().toBytes());
+		if (table_a == mcp::snapshot_table::prop && !is_snapshot_prop(key))
+			continue;
+		if (referenced)
+		{
+			///historical account states are skipped, account is first field of account state
+			dev::Slice value(it.value());
+			dev::Address account((dev::Address)dev::RLP(dev::bytesConstRef((dev::byte const *)value.data(), value.size()))[0]);
+			std::string latest;
+			if (!transaction.get(m_store.latest_account_state, mcp::account_to_slice(account), latest, m_snapshot)
+				|| mcp::slice_to_h256(latest) != dev::h256(key))
+				continue;
+		}
+		dev::bytes value(it.value().toBytes());
+
+		size += key.size() + value.size();
+		chunk_a.entries.push_back(std::make_pair(std::move(key), std::move(value)));
+	}
+	return false;
+}
+
+mcp::state_snapshot_writer::state_snapshot_writer(bool & error_a, mcp::block_store & store_a, mcp::snapshot_manifest const & manifest_a) :
+	m_store(store_a),
+	m_manifest(manifest_a),
+	m_next_keys((size_t)mcp::snapshot_table::table_count),
+	m_complete((size_t)mcp::snapshot_table::table_count, false)
+{
+	mcp::db::db_transaction transaction(m_store.create_transaction());
+	mcp::block_hash genesis;
+	error_a = m_manifest.version != m_store.version_get() || m_manifest.genesis_hash == mcp::block_hash(0)
+		|| !m_store.genesis_hash_get(transaction, genesis);
+	if (error_a)
+		LOG(m_log.error) << "State snapshot can only be imported into an empty store of version " << m_store.version_get();
+}
+
+bool mcp::state_snapshot_writer::next(mcp::snapshot_table & table_a, dev::bytes & from_a) const
+{
+	for (size_t i(0); i < m_complete.size(); i++)
+	{
+		if (m_complete[i])
+			continue;
+		table_a = (mcp::snapshot_table)i;
+		from_a = m_next_keys[i];
+		return true;
+	}
+	return false;
+}
+
+bool mcp::state_snapshot_writer::write(mcp::snapshot_chunk const & chunk_a)
+{
+	size_t const t((size_t)chunk_a.table);
+	int index;
+	bool error(t >= m_complete.size() || m_complete[t] || chunk_a.from_key != m_next_keys[t]
+		|| (chunk_a.entries.empty() && !chunk_a.next_key.empty())
+		|| mcp::snapshot_table_index(m_store, chunk_a.table, index));
+	for (auto it(chunk_a.entries.begin()); !error && it != chunk_a.entries.end(); it++)
+		error = verify(chunk_a.table, it->first, it->second);
+	if (error)
+	{
+		m_rejected++;
+		LOG(m_log.warning) << "State snapshot chunk rejected, table:" << t;
+		return true;
+	}
+
+	mcp::db::db_transaction transaction(m_store.create_transaction());
+	for (auto const & e : chunk_a.entries)
+	{
+		transaction.put(index, dev::Slice((char const *)e.first.data(), e.first.size()), dev::Slice((char const *)e.second.data(), e.second.size()));
+		m_bytes += e.first.size() + e.second.size();
+	}
+	transaction.commit();
+
+	m_next_keys[t] = chunk_a.next_key;
+	m_complete[t] = chunk_a.next_key.empty();
+	m_chunks++;
+	m_entries += chunk_a.entries.size();
+	return false;
+}
+
+bool mcp::state_snapshot_writer::ingest(mcp::snapshot_table const & table_a, std::vector<std::string> const & files_a, uint64_t const & entries_a)
+{
+	size_t const t((size_t)table_a);
+	int index;
+	if (t >= m_complete.size() || m_complete[t] || !m_next_keys[t].empty() || mcp::snapshot_table_index(m_store, table_a, index))
+	{
+		m_rejected++;
+		return true;
+	}
+
+	if (!files_a.empty())
+	{
+		m_store.m_db->ingest_external_files(index, files_a);
+		for (auto const & f : files_a)
+			m_bytes += boost::filesystem::file_size(f);
+	}
+	m_complete[t] = true;
+	m_chunks += files_a.size();
+	m_entries += entries_a;
+	return false;
+}
+
+bool mcp::state_snapshot_writer::verify(mcp::snapshot_table const & table_a, dev::bytes const & key_a, dev::bytes const & value_a)
+{
+	try
+	{
+		switch (table_a)
+		{
+		case mcp::snapshot_table::prop:
+			return !is_snapshot_prop(key_a);
+		case mcp::snapshot_table::latest_account_state:
+		case mcp::snapshot_table::account_nonce:
+			return key_a.size() != dev::Address::size || value_a.size() != dev::h256::size;
+		case mcp::snapshot_table::dag_account_info:
+		{
+			if (key_a.size() != dev::Address::size)
+				return true;
+			bool error(false);
+			mcp::dag_account_info info(error, dev::RLP(value_a));
+			return error;
+		}
+		case mcp::snapshot_table::transaction_receipt:
+		{
+			if (key_a.size() != dev::h256::size)
+				return true;
+			dev::RLP r(value_a);
+			dev::eth::TransactionReceipt receipt(r);
+			return false;
+		}
+		case mcp::snapshot_table::contract_aux:
+			///secure trie key preimage, keyed by its hash and aux marker
+			return key_a.size() != dev::h256::size + 1 || key_a.back() != 255;
+		case mcp::snapshot_table::account_state:
+		{
+			if (key_a.size() != dev::h256::size || dev::sha3(value_a) != dev::h256(key_a))
+				return true;
+			bool error(false);
+			mcp::account_state state(error, dev::RLP(value_a));
+			return error;
+		}
+		case mcp::snapshot_table::contract_main:
+			return key_a.size() != dev::h256::size || dev::sha3(value_a) != dev::h256(key_a);
+		case mcp::snapshot_table::blocks:
+			return key_a.size() != dev::h256::size || mcp::block(dev::RLP(value_a)).hash() != dev::h256(key_a);
+		default:
+			return false;
+		}
+	}
+	catch (std::exception const &)
+	{
+		return true;
+	}
+}
+
+bool mcp::state_snapshot_writer::verify_summary()
+{
+	mcp::db::db_transaction transaction(m_store.create_transaction());
+	mcp::block_hash genesis;
+	if (m_store.genesis_hash_get(transaction, genesis) || genesis != m_manifest.genesis_hash
+		|| m_store.last_stable_mci_get(transaction) != m_manifest.last_stable_mci
+		|| m_store.last_stable_index_get(transaction) != m_manifest.last_stable_index)
+	{
+		LOG(m_log.error) << "State snapshot props differ from manifest";
+		return true;
+	}
+
+	mcp::block_hash block_hash;
+	if (m_store.main_chain_get(transaction, m_manifest.last_stable_mci, block_hash) || block_hash != m_manifest.stable_block)
+		return true;
+	std::shared_ptr<mcp::block> block(m_store.block_get(transaction, block_hash));
+	std::shared_ptr<mcp::block_state> state(m_store.block_state_get(transaction, block_hash));
+	if (!block || !state || !state->is_stable)
+		return true;
+
+	mcp::summary_hash previous(0);
+	if (block->previous() != mcp::block_hash(0) && m_store.block_summary_get(transaction, block->previous(), previous))
+		return true;
+
+	std::list<mcp::summary_hash> parents;
+	for (mcp::block_hash const & p : block->parents())
+	{
+		mcp::summary_hash summary;
+		if (m_store.block_summary_get(transaction, p, summary))
+			return true;
+		parents.push_back(summary);
+	}
+
+	std::set<mcp::summary_hash> skiplist;
+	mcp::skiplist_info info;
+	m_store.skiplist_get(transaction, block_hash, info);
+	for (mcp::block_hash const & s : info.list)
+	{
+		mcp::summary_hash summary;
+		if (m_store.block_summary_get(transaction, s, summary))
+			return true;
+		skiplist.insert(summary);
+	}
+
+	dev::h256 receipts_root;
+	if (!m_store.GetBlockReceiptsRoot(transaction, block_hash, receipts_root))
+		return true;
+
+	///receipts of links and approves in order, as when block became stable
+	std::vector<dev::bytes> receipts;
+	for (dev::h256 const & link : block->links())
+	{
+		std::shared_ptr<dev::eth::TransactionReceipt> receipt(m_store.transaction_receipt_get(transaction, link));
+		if (!receipt)
+			return true;
+		dev::RLPStream s;
+		receipt->streamRLP(s);
+		receipts.push_back(s.out());
+	}
+	for (dev::h256 const & approve : block->approves())
+	{
+		std::shared_ptr<dev::ApproveReceipt> receipt(m_store.approve_receipt_get(transaction, approve));
+		if (!receipt)
+			return true;
+		dev::RLPStream s;
+		receipt->streamRLP(s);
+		receipts.push_back(s.out());
+	}
+	if (dev::orderedTrieRoot(receipts) != receipts_root)
+	{
+		LOG(m_log.error) << "State snapshot receipts of last stable main chain block differ from receipts root";
+		return true;
+	}
+
+	mcp::summary_hash summary(mcp::summary::gen_summary_hash(block_hash, previous, parents, receipts_root, skiplist,
+		state->status, state->stable_index, state->mc_timestamp));
+	mcp::block_hash summary_block;
+	if (summary != m_manifest.stable_summary || m_store.summary_block_get(transaction, summary, summary_block) || summary_block != block_hash)
+	{
+		LOG(m_log.error) << "State snapshot summary of last stable mci differs, manifest:" << m_manifest.stable_summary.hex() << " ,imported:" << summary.hex();
+		return true;
+	}
+	return false;
+}
+
+bool mcp::state_snapshot_writer::verify_references()
+{
+	try
+	{
+		mcp::db::db_transaction transaction(m_store.create_transaction());
+		for (mcp::db::forward_iterator it(transaction.begin(m_store.latest_account_state)); it.valid(); ++it)
+		{
+			dev::Address account(mcp::slice_to_account(it.key()));
+			std::shared_ptr<mcp::account_state> state(m_store.account_state_get(transaction, mcp::slice_to_h256(it.value())));
+			if (!state || state->account() != account)
+			{
+				LOG(m_log.error) << "State snapshot latest account state without account state, account:" << account.hex();
+				return true;
+			}
+		}
+
+		///latest stable block of an account is its own stable block
+		for (mcp::db::forward_iterator it(transaction.begin(m_store.dag_account_info)); it.valid(); ++it)
+		{
+			dev::Address account(mcp::slice_to_account(it.key()));
+			dev::bytes value(it.value().toBytes());
+			bool error(false);
+			mcp::dag_account_info info(error, dev::RLP(value));
+			std::shared_ptr<mcp::block> block(error ? nullptr : m_store.block_get(transaction, info.latest_stable_block));
+			std::shared_ptr<mcp::block_state> state(error ? nullptr : m_store.block_state_get(transaction, info.latest_stable_block));
+			if (!block || block->from() != account || !state || !state->is_stable)
+			{
+				LOG(m_log.error) << "State snapshot dag account info without stable block, account:" << account.hex();
+				return true;
+			}
+		}
+
+		for (mcp::db::forward_iterator it(transaction.begin(m_store.transaction_receipt)); it.valid(); ++it)
+		{
+			if (!transaction.exists(m_store.transactions, it.key()))
+			{
+				LOG(m_log.error) << "State snapshot receipt without transaction:" << mcp::slice_to_h256(it.key()).hex();
+				return true;
+			}
+		}
+	}
+	catch (std::exception const &)
+	{
+		LOG(m_log.error) << "State snapshot table entry can not be decoded";
+		return true;
+	}
+	return false;
+}
+
+bool mcp::state_snapshot_writer::finish(mcp::summary_hash const & trusted_summary_a)
+{
+	for (size_t i(0); i < m_complete.size(); i++)
+	{
+		if (!m_complete[i])
+		{
+			LOG(m_log.error) << "State snapshot table " << i << " is incomplete";
+			return true;
+		}
+	}
+	if (trusted_summary_a != mcp::summary_hash(0) && trusted_summary_a != m_manifest.stable_summary)
+	{
+		LOG(m_log.error) << "State snapshot summary is not the trusted summary:" << trusted_summary_a.hex();
+		return true;
+	}
+	if (verify_summary() || verify_references())
+		return true;
+
+	mcp::db::db_transaction transaction(m_store.create_transaction());
+	for (auto const & c : m_manifest.counters)
+	{
+		uint64_t left(c.second);
+		while (left > 0)
+		{
+			uint32_t v(left > std::numeric_limits<uint32_t>::max() ? std::numeric_limits<uint32_t>::max() : (uint32_t)left);
+			transaction.count_add(c.first, v);
+			left -= v;
+		}
+	}
+	///account states and traces before last stable mci are not in snapshot
+	m_store.history_pruned_mci_put(transaction, m_manifest.last_stable_mci);
+	transaction.commit();
+	return false;
+}
+
+std::string mcp::state_snapshot_writer::get_info()
+{
+	size_t complete(0);
+	for (bool c : m_complete)
+		if (c)
+			complete++;
+
+	std::stringstream s;
+	s << "state snapshot mci:" << m_manifest.last_stable_mci
+		<< " ,tables:" << complete << "/" << m_complete.size()
+		<< " ,chunks:" << m_chunks
+		<< " ,entries:" << m_entries
+		<< " ,bytes:" << m_bytes
+		<< " ,rejected:" << m_rejected;
+	return s.str();
+}
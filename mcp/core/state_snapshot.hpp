@@ -0,0 +1,150 @@
+#pragma once
+
+#include <mcp/core/block_store.hpp>
+#include <mcp/common/log.hpp>
+
+#include <chrono>
+
+namespace mcp
+{
+	/// tables of a state snapshot, ids are part of the snapshot format and must not be reused.
+	/// blocks, transactions, receipts and summaries are complete, a snapshot is as large as the dag.
+	/// history tables (traces, transaction account states, history and log indexes) and local sync state are not in snapshot.
+	enum class snapshot_table : uint8_t
+	{
+		prop = 0,
+		dag_account_info,
+		account_info,
+		latest_account_state,
+		/// account states referenced by latest_account_state, historical account states are not in snapshot
+		account_state,
+		blocks,
+		transactions,
+		transaction_address,
+		approves,
+		account_nonce,
+		block_state,
+		block_child,
+		dag_free,
+		main_chain,
+		stable_block,
+		stable_block_number,
+		block_summary,
+		summary_block,
+		skiplist,
+		successor,
+		contract_main,
+		contract_aux,
+		transaction_receipt,
+		approve_receipt,
+		epoch_approves,
+		epoch_param,
+		epoch_work_transaction,
+		stakingList,
+		receiptsRoot,
+		unlink_block,
+		unlink_info,
+		next_unlink,
+		next_unlink_index,
+		head_unlink,
+		table_count
+	};
+
+	/// column family of snapshot table, return true if table is unknown
+	bool snapshot_table_index(mcp::block_store & store_a, mcp::snapshot_table const & table_a, int & index_a);
+
+	class snapshot_manifest
+	{
+	public:
+		snapshot_manifest() = default;
+		snapshot_manifest(bool & error_a, dev::RLP const & r);
+		void stream_RLP(dev::RLPStream & s) const;
+
+		int version = 0;
+		mcp::block_hash genesis_hash = mcp::block_hash(0);
+		uint64_t last_stable_mci = 0;
+		uint64_t last_stable_index = 0;
+		/// main chain block of last stable mci and its summary, summary is recomputed from imported tables
+		mcp::block_hash stable_block = mcp::block_hash(0);
+		mcp::summary_hash stable_summary = mcp::summary_hash(0);
+		std::vector<std::pair<std::string, uint64_t>> counters;
+	};
+
+	/// entries of one table from from_key, next chunk of the table starts at next_key
+	class snapshot_chunk
+	{
+	public:
+		snapshot_chunk() = default;
+		snapshot_chunk(bool & error_a, dev::RLP const & r);
+		void stream_RLP(dev::RLPStream & s) const;
+
+		mcp::snapshot_table table = mcp::snapshot_table::prop;
+		dev::bytes from_key;
+		std::vector<std::pair<dev::bytes, dev::bytes>> entries;
+		/// empty if table is complete
+		dev::bytes next_key;
+	};
+
+	/// export and import of a stable store, served to fast syncing peers by node_sync or copied locally,
+	/// caller moves chunks and the manifest.
+	/// reading side, all chunks of a reader are read from the same db snapshot
+	class state_snapshot_reader
+	{
+	public:
+		state_snapshot_reader(mcp::block_store & store_a);
+
+		mcp::snapshot_manifest const & manifest() const { return m_manifest; }
+		std::chrono::steady_clock::time_point const & created() const { return m_created; }
+
+		/// read entries of table_a from from_a until max_bytes_a are read, return true on error
+		bool read(mcp::snapshot_table const & table_a, dev::bytes const & from_a, size_t const & max_bytes_a, mcp::snapshot_chunk & chunk_a);
+
+	private:
+		mcp::block_store & m_store;
+		std::shared_ptr<rocksdb::ManagedSnapshot> m_snapshot;
+		std::chrono::steady_clock::time_point m_created;
+		mcp::snapshot_manifest m_manifest;
+	};
+
+	/// importing side, writes verified chunks of every table in order into an empty store
+	class state_snapshot_writer
+	{
+	public:
+		/// error_a is set if store is not empty or has another version
+		state_snapshot_writer(bool & error_a, mcp::block_store & store_a, mcp::snapshot_manifest const & manifest_a);
+
+		/// return true if chunk is not the next chunk of its table or has an invalid entry, nothing is written then
+		bool write(mcp::snapshot_chunk const & chunk_a);
+		/// bulk load checksummed sst files holding all entries of table_a, entries are not verified one by one
+		bool ingest(mcp::snapshot_table const & table_a, std::vector<std::string> const & files_a, uint64_t const & entries_a);
+		/// return true if a table is incomplete, references between imported tables are broken, or summary of
+		/// last stable mci recomputed from imported tables differs from manifest or from trusted_summary_a.
+		/// trusted_summary_a is compared as given, not checked if zero. witness signatures are not checked here,
+		/// caller takes it from a source it trusts, fast sync from a witness proof. only receipts of last stable main chain block are bound to a summary,
+		/// account_nonce and contract_aux are checked for format only.
+		bool finish(mcp::summary_hash const & trusted_summary_a = mcp::summary_hash(0));
+		/// next table to read and its start key, return false if all tables are complete
+		bool next(mcp::snapshot_table & table_a, dev::bytes & from_a) const;
+
+		std::string get_info();
+
+	private:
+		bool verify(mcp::snapshot_table const & table_a, dev::bytes const & key_a, dev::bytes const & value_a);
+		/// summary of last stable mci and receipts of its block, recomputed from imported tables
+		bool verify_summary();
+		/// latest account states, dag account infos and receipts point to imported entries
+		bool verify_references();
+
+		mcp::block_store & m_store;
+		mcp::snapshot_manifest const m_manifest;
+		/// start key of next chunk of each table
+		std::vector<dev::bytes> m_next_keys;
+		std::vector<bool> m_complete;
+
+		uint64_t m_chunks = 0;
+		uint64_t m_entries = 0;
+		uint64_t m_bytes = 0;
+		uint64_t m_rejected = 0;
+		mcp::log m_log = { mcp::log("db") };
+	};
+}
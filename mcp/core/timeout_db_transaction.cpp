@@ -1,5 +1,41 @@
 #include "timeout_db_transaction.hpp"
 
+#include <sstream>
+
+mcp::commit_stats mcp::timeout_db_transaction::stats;
+
+void mcp::commit_stats::add(std::chrono::steady_clock::duration const & duration_a, uint64_t const & bytes_a, uint32_t const & blocks_a)
+{
+	uint64_t us(std::chrono::duration_cast<std::chrono::microseconds>(duration_a).count());
+	size_t bucket(0);
+	while (bucket + 1 < bucket_count && us >= (1000ull << bucket))
+		bucket++;
+	m_buckets[bucket]++;
+	m_commits++;
+	m_bytes += bytes_a;
+	m_blocks += blocks_a;
+	m_us += us;
+}
+
+std::string mcp::commit_stats::report()
+{
+	uint64_t commits(m_commits);
+	std::stringstream s;
+	s << "commits:" << commits
+		<< " , avg us:" << (commits ? m_us / commits : 0)
+		<< " , avg bytes:" << (commits ? m_bytes / commits : 0)
+		<< " , avg blocks:" << (commits ? m_blocks / commits : 0)
+		<< " , latency ms:";
+	for (size_t i(0); i < bucket_count; i++)
+	{
+		if (i + 1 < bucket_count)
+			s << " <" << (1 << i) << ":" << m_buckets[i];
+		else
+			s << " >=" << (1 << (i - 1)) << ":" << m_buckets[i];
+	}
+	return s.str();
+}
+
 mcp::timeout_db_transaction::timeout_db_transaction(mcp::block_store & store_a, uint32_t const & timeout_a, 
 	std::shared_ptr<rocksdb::WriteOptions> write_options_a,
 	std::shared_ptr<rocksdb::TransactionOptions> txn_ops_a,
@@ -21,9 +57,17 @@ mcp::db::db_transaction & mcp::timeout_db_transaction::get_transaction()
 	return m_transaction;
 }
 
-void mcp::timeout_db_transaction::commit_if_timeout()
+void mcp::timeout_db_transaction::set_limits(uint64_t const & max_bytes_a, uint32_t const & max_blocks_a)
 {
-	if (std::chrono::steady_clock::now() - m_last_create_time >= m_timeout)
+	m_max_bytes = max_bytes_a;
+	m_max_blocks = max_blocks_a;
+}
+
+void mcp::timeout_db_transaction::commit_if_needed()
+{
+	if (std::chrono::steady_clock::now() - m_last_create_time >= m_timeout
+		|| (m_max_blocks && m_blocks >= m_max_blocks)
+		|| (m_max_bytes && m_transaction.data_size() >= m_max_bytes))
 	{
 		commit_and_continue();
 	}
@@ -35,19 +79,22 @@ void mcp::timeout_db_transaction::commit_and_continue()
 
 	m_transaction = m_store.create_transaction(m_write_options, m_txn_ops);
 	m_last_create_time = std::chrono::steady_clock::now();
+	m_blocks = 0;
 }
 
 void mcp::timeout_db_transaction::commit()
 {
+	auto start(std::chrono::steady_clock::now());
+	uint64_t bytes(m_transaction.data_size());
 	if (m_before_commit_event)
 		m_before_commit_event();
 	m_transaction.commit();
 	if (m_after_commit_event)
 		m_after_commit_event();
+	stats.add(std::chrono::steady_clock::now() - start, bytes, m_blocks);
 }
 
 void mcp::timeout_db_transaction::rollback()
 {
 	m_transaction.rollback();
 }
-
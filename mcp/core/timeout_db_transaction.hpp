@@ -3,8 +3,29 @@
 #include <mcp/core/block_store.hpp>
 #include <mcp/db/db_transaction.hpp>
 
+#include <array>
+#include <atomic>
+
 namespace mcp
 {
+	/// commit latency of all timeout_db_transaction, bucket i counts commits taking less than 2^i ms
+	class commit_stats
+	{
+	public:
+		void add(std::chrono::steady_clock::duration const & duration_a, uint64_t const & bytes_a, uint32_t const & blocks_a);
+		std::string report();
+
+		static size_t const bucket_count = 12;
+
+	private:
+		std::array<std::atomic<uint64_t>, bucket_count> m_buckets = {};
+		std::atomic<uint64_t> m_commits = { 0 };
+		std::atomic<uint64_t> m_bytes = { 0 };
+		std::atomic<uint64_t> m_blocks = { 0 };
+		std::atomic<uint64_t> m_us = { 0 };
+	};
+
+	/// transaction committed and continued when bytes written, blocks processed or elapsed time reach a limit
 	class timeout_db_transaction
 	{
 	public:
@@ -14,17 +35,25 @@ namespace mcp
 			std::function<void()> const & brefore_commit_event_a = nullptr,
 			std::function<void()> const & after_commit_event_a= nullptr);
 		mcp::db::db_transaction & get_transaction();
-		void commit_if_timeout();
+		/// bytes and blocks limits besides timeout, 0 disables a limit
+		void set_limits(uint64_t const & max_bytes_a, uint32_t const & max_blocks_a);
+		void block_processed() { m_blocks++; }
+		void commit_if_needed();
 		void commit_and_continue();
 		void commit();
 		void rollback();
 
+		static mcp::commit_stats stats;
+
 	private:
 		mcp::block_store & m_store;
 		std::shared_ptr<rocksdb::WriteOptions> m_write_options;
 		std::shared_ptr<rocksdb::TransactionOptions> m_txn_ops;
 		mcp::db::db_transaction m_transaction;
 		std::chrono::milliseconds m_timeout;
+		uint64_t m_max_bytes = 0;
+		uint32_t m_max_blocks = 0;
+		uint32_t m_blocks = 0;
 		std::chrono::steady_clock::time_point m_last_create_time;
 		std::function<void()> m_before_commit_event;
 		std::function<void()> m_after_commit_event;
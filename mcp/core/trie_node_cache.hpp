@@ -0,0 +1,24 @@
+#pragma once
+
+#include <mcp/common/sharded_cache.hpp>
+
+#include <libdevcore/FixedHash.h>
+
+namespace mcp
+{
+	/// contract trie nodes shared by all overlay_db, keyed by node hash.
+	/// nodes are content addressed, so entries never need invalidation, only eviction by byte budget.
+	class trie_node_cache : public mcp::sharded_cache<dev::h256, std::string>
+	{
+	public:
+		/// capacity_a in bytes, 0 disable cache
+		explicit trie_node_cache(size_t const & capacity_a) :
+			mcp::sharded_cache<dev::h256, std::string>("trie nodes", capacity_a, [](std::string const & value_a) { return value_a.size(); })
+		{
+		}
+
+		/// return true if exist
+		bool get(dev::h256 const & hash_a, std::string & value_a) { return tryGet(hash_a, value_a); }
+		void put(dev::h256 const & hash_a, std::string const & value_a) { insert(hash_a, value_a); }
+	};
+}
@@ -52,6 +52,60 @@ std::shared_ptr<rocksdb::BlockBasedTableOptions> mcp::db::db_column::default_tab
 	return std::make_shared<rocksdb::BlockBasedTableOptions>(table_options);
 }
 
+std::shared_ptr<rocksdb::ColumnFamilyOptions> mcp::db::db_column::point_lookup_column_family_options(std::shared_ptr<rocksdb::Cache> cache)
+{
+	auto table_options = default_table_options(cache);
+	table_options->block_size = 32 * 1024;
+	table_options->whole_key_filtering = true;
+	table_options->cache_index_and_filter_blocks = database_config::cache_filter;
+	table_options->pin_l0_filter_and_index_blocks_in_cache = database_config::cache_filter;
+
+	auto cfops = default_column_family_options(table_options);
+	cfops->write_buffer_size = 64 * 1024 * 1024;
+	cfops->memtable_whole_key_filtering = true;
+	cfops->memtable_prefix_bloom_size_ratio = 0.02;
+	return cfops;
+}
+
+std::shared_ptr<rocksdb::ColumnFamilyOptions> mcp::db::db_column::iterator_column_family_options(size_t const & prefix_len_a, std::shared_ptr<rocksdb::Cache> cache)
+{
+	auto table_options = default_table_options(cache);
+	table_options->block_size = 16 * 1024;
+	if (prefix_len_a > 0)
+	{
+		table_options->whole_key_filtering = false;
+		if (rocksdb::BlockBasedTableOptions::IndexType::kBinarySearch == table_options->index_type)
+			table_options->index_type = rocksdb::BlockBasedTableOptions::IndexType::kHashSearch;
+	}
+	else
+	{
+		//ordered scan over the whole table, bloom filter is useless
+		table_options->filter_policy.reset();
+	}
+
+	auto cfops = default_column_family_options(table_options);
+	cfops->write_buffer_size = 32 * 1024 * 1024;
+	if (prefix_len_a > 0)
+	{
+		cfops->prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(prefix_len_a));
+		cfops->memtable_prefix_bloom_size_ratio = 0.05;
+	}
+	return cfops;
+}
+
+std::shared_ptr<rocksdb::ColumnFamilyOptions> mcp::db::db_column::small_column_family_options(std::shared_ptr<rocksdb::Cache> cache)
+{
+	auto table_options = default_table_options(cache);
+	table_options->block_size = 4 * 1024;
+
+	auto cfops = default_column_family_options(table_options);
+	cfops->write_buffer_size = 4 * 1024 * 1024;
+	cfops->max_write_buffer_number = 2;
+	cfops->target_file_size_base = 8 * 1024 * 1024;
+	cfops->max_bytes_for_level_base = 64 * 1024 * 1024;
+	return cfops;
+}
+
 rocksdb::ColumnFamilyHandle * mcp::db::db_column::get_column_family_handle(int index)
 {
 	//auto it = m_index.find(index);
@@ -18,6 +18,13 @@ namespace mcp
 			~db_column();
 			static std::shared_ptr<rocksdb::ColumnFamilyOptions> default_column_family_options(std::shared_ptr<rocksdb::BlockBasedTableOptions> table_options = nullptr);
 			static std::shared_ptr<rocksdb::BlockBasedTableOptions> default_table_options(std::shared_ptr<rocksdb::Cache> cache = nullptr);
+
+			/// tables read by key only (blocks, receipts, trie nodes...): bloom filter and larger blocks
+			static std::shared_ptr<rocksdb::ColumnFamilyOptions> point_lookup_column_family_options(std::shared_ptr<rocksdb::Cache> cache = nullptr);
+			/// tables scanned by iterator; prefix_len_a > 0 enables prefix bloom and hash index on the first prefix_len_a bytes
+			static std::shared_ptr<rocksdb::ColumnFamilyOptions> iterator_column_family_options(size_t const & prefix_len_a, std::shared_ptr<rocksdb::Cache> cache = nullptr);
+			/// tiny metadata tables (prop, catchup index...): small write buffers
+			static std::shared_ptr<rocksdb::ColumnFamilyOptions> small_column_family_options(std::shared_ptr<rocksdb::Cache> cache = nullptr);
 			rocksdb::ColumnFamilyHandle* get_column_family_handle(int index);
 			int insert_column_families(std::string const& name, std::shared_ptr<rocksdb::ColumnFamilyOptions> cfops);
 			//void preserve_index();
@@ -5,7 +5,11 @@ using namespace mcp::db;
 std::shared_ptr<rocksdb::Cache> mcp::db::database::table_cache = nullptr;
 std::shared_ptr<rocksdb::SstFileManager> mcp::db::database::rocksdb_sst_file_manager = std::shared_ptr<rocksdb::SstFileManager>(rocksdb::NewSstFileManager(rocksdb::Env::Default(), nullptr, "", 0));
 uint64_t mcp::db::database_config::write_buffer_size = 1024;
+uint64_t mcp::db::database_config::trie_cache_size = 256;
+uint64_t mcp::db::database_config::block_cache_size = 256;
 bool mcp::db::database_config::cache_filter = true;
+uint64_t mcp::db::database_config::prune_mcis = 0;
+bool mcp::db::database_config::record_traces = true;
 //check return status
 void mcp::db::check_status(rocksdb::Status const& _status)
 {
@@ -23,7 +27,11 @@ void mcp::db::database_config::serialize_json(mcp::json &json_a) const
 {
 	json_a["cache"] = cache_size;
 	json_a["write_buffer"] = write_buffer_size;
+	json_a["trie_cache"] = trie_cache_size;
+	json_a["block_cache"] = block_cache_size;
 	json_a["cache_filter"] = cache_filter ? "true" : "false";
+	json_a["prune_mcis"] = prune_mcis;
+	json_a["record_traces"] = record_traces ? "true" : "false";
 }
 
 bool mcp::db::database_config::deserialize_json(mcp::json const & json_a)
@@ -35,8 +43,16 @@ bool mcp::db::database_config::deserialize_json(mcp::json const & json_a)
 			cache_size = json_a["cache"].get<std::uint64_t>();
 		if (json_a.count("write_buffer") && json_a["write_buffer"].is_number_unsigned())
 			write_buffer_size = json_a["write_buffer"].get<std::uint64_t>();
+		if (json_a.count("trie_cache") && json_a["trie_cache"].is_number_unsigned())
+			trie_cache_size = json_a["trie_cache"].get<std::uint64_t>();
+		if (json_a.count("block_cache") && json_a["block_cache"].is_number_unsigned())
+			block_cache_size = json_a["block_cache"].get<std::uint64_t>();
 		if (json_a.count("cache_filter") && json_a["cache_filter"].is_string())
 			cache_filter = (json_a["cache_filter"].get<std::string>() == "true" ? true : false);
+		if (json_a.count("prune_mcis") && json_a["prune_mcis"].is_number_unsigned())
+			prune_mcis = json_a["prune_mcis"].get<std::uint64_t>();
+		if (json_a.count("record_traces") && json_a["record_traces"].is_string())
+			record_traces = (json_a["record_traces"].get<std::string>() == "true" ? true : false);
 	}
 	catch (std::runtime_error const &)
 	{
@@ -120,30 +136,14 @@ bool mcp::db::database::open()
 void mcp::db::database::put(int const& _index, dev::Slice const& _k, dev::Slice const& _v,
 	std::shared_ptr<rocksdb::WriteOptions> write_ops_a)
 {
-	std::shared_ptr<rocksdb::WriteOptions> write_ops(write_ops_a);
-	if (nullptr == write_ops)
-		write_ops = m_write_options;
-
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	index_info const* info;
 	auto handle = get_column_family_handle(_index, info);
-
-	dev::Slicebytes key;
-	if (info->shared)
-	{
-		key.resize(info->prefix.size() + _k.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key));
-		_k.copyTo(dev::SliceRef(&key).cropped(info->prefix.size()));
-	}
-	else
-	{
-		key.resize(_k.size());
-		_k.copyTo(dev::SliceRef(&key));
-	}
+	key_builder builder;
 
 	rocksdb::Status status = m_db->Put(
-		*write_ops,
+		write_ops_a ? *write_ops_a : *m_write_options,
 		handle,
-		rocksdb::Slice(key.data(), key.size()),
+		make_key(*info, _k, builder),
 		rocksdb::Slice(_v.data(), _v.size())
 	);
 
@@ -153,71 +153,63 @@ void mcp::db::database::put(int const& _index, dev::Slice const& _k, dev::Slice
 bool mcp::db::database::get(int const& _index, dev::Slice const& _k, std::string& _v,
 	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	index_info const* info;
 	auto handle = get_column_family_handle(_index, info);
+	key_builder builder;
 
-	std::shared_ptr<rocksdb::ReadOptions> read_ops(read_ops_a);
-	if (nullptr == read_ops)
-		read_ops = m_read_options;
+	rocksdb::Status status = m_db->Get(
+		read_ops_a ? *read_ops_a : *m_read_options,
+		handle,
+		make_key(*info, _k, builder),
+		&_v
+	);
 
-	dev::Slicebytes key;
-	if (info->shared)
+	if (status.ok())
 	{
-		key.resize(info->prefix.size() + _k.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key));
-		_k.copyTo(dev::SliceRef(&key).cropped(info->prefix.size()));
+		return true;
 	}
-	else
+	else if (status.IsNotFound())
 	{
-		key.resize(_k.size());
-		_k.copyTo(dev::SliceRef(&key));
+		return false;
 	}
+	check_status(status);
+	return false;
+}
+
+bool mcp::db::database::get(int const& _index, dev::Slice const& _k, rocksdb::PinnableSlice& _v,
+	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
+{
+	index_info const* info;
+	auto handle = get_column_family_handle(_index, info);
+	key_builder builder;
 
+	_v.Reset();
 	rocksdb::Status status = m_db->Get(
-		*read_ops,
+		read_ops_a ? *read_ops_a : *m_read_options,
 		handle,
-		rocksdb::Slice(key.data(), key.size()),
+		make_key(*info, _k, builder),
 		&_v
 	);
 
 	if (status.ok())
-	{
 		return true;
-	}
-	else if (status.IsNotFound())
-	{
+	if (status.IsNotFound())
 		return false;
-	}
 	check_status(status);
+	return false;
 }
 
 void mcp::db::database::del(int const& _index, dev::Slice const& _k,
 	std::shared_ptr<rocksdb::WriteOptions> write_ops_a)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	index_info const* info;
 	auto handle = get_column_family_handle(_index, info);
-
-	dev::Slicebytes key;
-	if (info->shared)
-	{
-		key.resize(info->prefix.size() + _k.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key));
-		_k.copyTo(dev::SliceRef(&key).cropped(info->prefix.size()));
-	}
-	else
-	{
-		key.resize(_k.size());
-		_k.copyTo(dev::SliceRef(&key));
-	}
-
-	std::shared_ptr<rocksdb::WriteOptions> write_ops(write_ops_a);
-	if (nullptr == write_ops)
-		write_ops = m_write_options;
+	key_builder builder;
 
 	rocksdb::Status status = m_db->Delete(
-		*write_ops,
+		write_ops_a ? *write_ops_a : *m_write_options,
 		handle,
-		rocksdb::Slice(key.data(), key.size()));
+		make_key(*info, _k, builder));
 	check_status(status);
 }
 
@@ -225,38 +217,15 @@ void mcp::db::database::del(int const& _index, dev::Slice const& _k,
 void mcp::db::database::del_range(int const& index, dev::Slice const& start, dev::Slice const& end,
 	std::shared_ptr<rocksdb::WriteOptions> write_ops_a)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	index_info const* info;
 	auto handle = get_column_family_handle(index, info);
-
-	dev::Slicebytes key_start, key_end;
-	if (info->shared)
-	{
-		key_start.resize(info->prefix.size() + start.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key_start));
-		start.copyTo(dev::SliceRef(&key_start).cropped(info->prefix.size()));
-
-		key_end.resize(info->prefix.size() + end.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key_end));
-		end.copyTo(dev::SliceRef(&key_end).cropped(info->prefix.size()));
-	}
-	else
-	{
-		key_start.resize(start.size());
-		start.copyTo(dev::SliceRef(&key_start));
-
-		key_end.resize(end.size());
-		end.copyTo(dev::SliceRef(&key_end));
-	}
-
-	std::shared_ptr<rocksdb::WriteOptions> write_ops(write_ops_a);
-	if (nullptr == write_ops)
-		write_ops = m_write_options;
+	key_builder builder_start, builder_end;
 
 	rocksdb::Status status = m_db->GetBaseDB()->DeleteRange(
-		*write_ops,
+		write_ops_a ? *write_ops_a : *m_write_options,
 		handle,
-		rocksdb::Slice(key_start.data(), key_start.size()),
-		rocksdb::Slice(key_end.data(), key_end.size())
+		make_key(*info, start, builder_start),
+		make_key(*info, end, builder_end)
 	);
 	check_status(status);
 }
@@ -264,31 +233,15 @@ void mcp::db::database::del_range(int const& index, dev::Slice const& start, dev
 bool mcp::db::database::exists(int const& _index, dev::Slice const & _k,
 	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
 {
-	std::shared_ptr<rocksdb::ReadOptions> read_ops(read_ops_a);
-	if (nullptr == read_ops)
-		read_ops = m_read_options;
-
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	index_info const* info;
 	auto handle = get_column_family_handle(_index, info);
+	key_builder builder;
 
-	dev::Slicebytes key;
-	if (info->shared)
-	{
-		key.resize(info->prefix.size() + _k.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key));
-		_k.copyTo(dev::SliceRef(&key).cropped(info->prefix.size()));
-	}
-	else
-	{
-		key.resize(_k.size());
-		_k.copyTo(dev::SliceRef(&key));
-	}
-
-	std::string value;
+	rocksdb::PinnableSlice value;
 	rocksdb::Status status = m_db->Get(
-		*read_ops,
+		read_ops_a ? *read_ops_a : *m_read_options,
 		handle,
-		rocksdb::Slice(key.data(), key.size()),
+		make_key(*info, _k, builder),
 		&value);
 	if (status.ok())
 		return true;
@@ -340,7 +293,7 @@ int mcp::db::database::set_column_family(int index_a, std::string const & name_a
 		info.shared = true;
 	}
 
-	m_index.insert(std::make_pair(index, info));
+	m_index.push_back(info);
 	return index;
 }
 
@@ -349,6 +302,31 @@ std::shared_ptr<rocksdb::ManagedSnapshot> mcp::db::database::create_snapshot()
 	return std::make_shared<rocksdb::ManagedSnapshot>(m_db, m_db->GetSnapshot());
 }
 
+std::unique_ptr<rocksdb::SstFileWriter> mcp::db::database::create_sst_file_writer(int index)
+{
+	index_info const* info;
+	auto handle = get_column_family_handle(index, info);
+	assert_x_msg(!info->shared, "sst file of shared column family:" + std::to_string(index));
+
+	rocksdb::ColumnFamilyDescriptor descriptor;
+	check_status(handle->GetDescriptor(&descriptor));
+	rocksdb::Options options(m_db->GetDBOptions(), descriptor.options);
+	return std::unique_ptr<rocksdb::SstFileWriter>(new rocksdb::SstFileWriter(rocksdb::EnvOptions(), options, handle));
+}
+
+void mcp::db::database::ingest_external_files(int index, std::vector<std::string> const& files_a)
+{
+	index_info const* info;
+	auto handle = get_column_family_handle(index, info);
+	assert_x_msg(!info->shared, "ingest into shared column family:" + std::to_string(index));
+
+	rocksdb::IngestExternalFileOptions ops;
+	ops.move_files = false;
+	ops.verify_checksums_before_ingest = true;
+	rocksdb::Status status = m_db->IngestExternalFile(handle, files_a, ops);
+	check_status(status);
+}
+
 
 std::shared_ptr<rocksdb::ReadOptions> mcp::db::database::default_read_options()
 {
@@ -379,7 +357,8 @@ rocksdb::Options mcp::db::database::default_DB_options()
 	options.atomic_flush = true;
 	options.max_total_wal_size = 512 * 1024 * 1024;
 	//options.wal_bytes_per_sync = 8 * 1024 * 1024;;
-	//options.enable_pipelined_write = true;
+	///write committed transactions keep their order with pipelined write, unordered_write would break snapshot reads
+	options.enable_pipelined_write = true;
 	//options.new_table_reader_for_compaction_inputs = true;
 	//options.table_factory.reset(NewBlockBasedTableFactory(m_column->default_table_options()));
 	//options.row_cache = rocksdb::NewLRUCache(6 * 1024 * 1024 * 1024);
@@ -424,20 +403,29 @@ rocksdb::Status mcp::db::database::open_rocksdb(std::string path_a)
 //	}
 //}
 
-rocksdb::ColumnFamilyHandle* mcp::db::database::get_column_family_handle(int index, std::shared_ptr<index_info> info)
+rocksdb::ColumnFamilyHandle* mcp::db::database::get_column_family_handle(int index)
 {
-	auto it = m_index.find(index);
-	if (it == m_index.end())
+	if (index < 0 || index >= m_index.size())
 		return nullptr;
 
-	if (info)
-	{
-		info->col_index = it->second.col_index;
-		info->prefix = it->second.prefix;
-		info->shared = it->second.shared;
-	}
+	return m_column->get_column_family_handle(m_index[index].col_index);
+}
+
+rocksdb::ColumnFamilyHandle* mcp::db::database::get_column_family_handle(int index, index_info const*& info)
+{
+	assert_x_msg(index >= 0 && index < m_index.size(), "column family index not exist:" + std::to_string(index));
 
-	return m_column->get_column_family_handle(it->second.col_index);
+	info = &m_index[index];
+	return m_column->get_column_family_handle(info->col_index);
+}
+
+rocksdb::Slice mcp::db::database::make_key(index_info const& info_a, dev::Slice const& _k, key_builder& builder_a)
+{
+	if (!info_a.shared)
+		return rocksdb::Slice(_k.data(), _k.size());
+
+	builder_a.append(info_a.prefix).append(_k);
+	return builder_a.slice();
 }
 
 std::string mcp::db::database::get_rocksdb_state(uint64_t limit)
@@ -469,6 +457,27 @@ std::string mcp::db::database::get_rocksdb_state(uint64_t limit)
 	}
 
 	str = str + "filter and memtable size:" + std::to_string(total) + " \n " + size;
+	str = str + "column families:\n" + get_column_family_state();
 	return str;
 }
 
+std::string mcp::db::database::get_column_family_state()
+{
+	std::string str = "";
+	for (auto it : m_column->m_handles)
+	{
+		std::string keys, sst_size, pending_compaction, running_compactions, immutable_memtables;
+		m_db->GetProperty(it, "rocksdb.estimate-num-keys", &keys);
+		m_db->GetProperty(it, "rocksdb.total-sst-files-size", &sst_size);
+		m_db->GetProperty(it, "rocksdb.estimate-pending-compaction-bytes", &pending_compaction);
+		m_db->GetProperty(it, "rocksdb.num-running-compactions", &running_compactions);
+		m_db->GetProperty(it, "rocksdb.num-immutable-mem-table", &immutable_memtables);
+
+		str = str + it->GetName() + ":[keys:" + keys
+			+ " , sst:" + sst_size
+			+ " , pending_compaction:" + pending_compaction
+			+ " , running_compactions:" + running_compactions
+			+ " , immutable_memtables:" + immutable_memtables + "] \n";
+	}
+	return str;
+}
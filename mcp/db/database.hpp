@@ -8,11 +8,13 @@
 #include <mcp/db/db_transaction.hpp>
 #include <mcp/db/db_iterator.hpp>
 #include <mcp/db/column.hpp>
+#include <mcp/db/key_builder.hpp>
 #include <mcp/common/log.hpp>
 #include <rocksdb/advanced_cache.h>
 #include <rocksdb/sst_file_manager.h>
 #include <rocksdb/rate_limiter.h>
 #include <rocksdb/slice_transform.h>
+#include <rocksdb/sst_file_writer.h>
 #include <mcp/common/mcp_json.hpp>
 
 namespace mcp
@@ -40,7 +42,11 @@ namespace mcp
 			bool parse_old_version_data(mcp::json const &, uint64_t const&);
 			uint64_t cache_size; //MB
 			static uint64_t write_buffer_size; //MB
+			static uint64_t trie_cache_size; //MB, contract trie nodes cache
+			static uint64_t block_cache_size; //MB, cache of blocks, transactions, receipts and states
 			static bool cache_filter; //Caching Index and Filter Blocks
+			static uint64_t prune_mcis; //keep historical account states and traces of last prune_mcis mcis, 0 is archive node
+			static bool record_traces; //record call traces of transactions
 		};
 
 		struct index_info
@@ -66,11 +72,16 @@ namespace mcp
 			bool open();
 
 			std::string get_rocksdb_state(uint64_t limit);
+			/// per column family keys, sst size and compaction state
+			std::string get_column_family_state();
 
 			void put(int const& _index, dev::Slice const& _k, dev::Slice const& _v,
 				std::shared_ptr<rocksdb::WriteOptions> write_ops_a = nullptr);
 			bool get(int const& _index, dev::Slice const& _k, std::string& _v,
 				std::shared_ptr<rocksdb::ReadOptions> read_ops_a = nullptr);
+			/// value is pinned in block cache or memtable, no copy into std::string
+			bool get(int const& _index, dev::Slice const& _k, rocksdb::PinnableSlice& _v,
+				std::shared_ptr<rocksdb::ReadOptions> read_ops_a = nullptr);
 			void del(int const& _index, dev::Slice const& _k,
 				std::shared_ptr<rocksdb::WriteOptions> write_ops_a = nullptr);
 			void del_range(int const& index, dev::Slice const& start, dev::Slice const& end,
@@ -85,6 +96,10 @@ namespace mcp
 			int create_column_family(std::string const& name_a, std::shared_ptr<rocksdb::ColumnFamilyOptions> cfops);
 			int set_column_family(int index_a, std::string const & name_a="");
 			std::shared_ptr<rocksdb::ManagedSnapshot> create_snapshot();
+			/// writer of sst file with options of column family, keys must be added in order
+			std::unique_ptr<rocksdb::SstFileWriter> create_sst_file_writer(int index);
+			/// bulk load sst files into column family, files are copied
+			void ingest_external_files(int index, std::vector<std::string> const& files_a);
 			//void release_snapshot(std::shared_ptr<rocksdb::ManagedSnapshot> _snapshot) { m_db->ReleaseSnapshot(_snapshot.snapshot()); };
 
 			static std::shared_ptr<rocksdb::ReadOptions> default_read_options();
@@ -99,7 +114,10 @@ namespace mcp
 			rocksdb::Status open_rocksdb(std::string path_a);
 			//void create_column();
 
-			rocksdb::ColumnFamilyHandle* get_column_family_handle(int index, std::shared_ptr<index_info> info = nullptr);
+			rocksdb::ColumnFamilyHandle* get_column_family_handle(int index);
+			rocksdb::ColumnFamilyHandle* get_column_family_handle(int index, index_info const*& info);
+			/// key of shared column family is prefix + key composed in builder_a, otherwise key is used as is
+			static rocksdb::Slice make_key(index_info const& info_a, dev::Slice const& _k, key_builder& builder_a);
 
 			rocksdb::TransactionDB* get_db() { return m_db; }
 			//std::shared_ptr<rocksdb::ReadOptions> get_read_options() { return m_read_options; }
@@ -115,7 +133,7 @@ namespace mcp
 
 			int m_count;
 
-			std::map<int, index_info> m_index;
+			std::vector<index_info> m_index;
 
 			mcp::log m_log = { mcp::log("db") };
 		};
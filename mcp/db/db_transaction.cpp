@@ -9,15 +9,10 @@ mcp::db::db_transaction::db_transaction(mcp::db::database& m_db_a,
 	m_commited_or_rollbacked(false),
 	m_read_only(true)
 {
-	std::shared_ptr<rocksdb::WriteOptions> write_ops(write_options_a);
-	std::shared_ptr<rocksdb::TransactionOptions> txn_ops(txn_ops_a);
-	
-	if (nullptr == write_ops)
-		write_ops = m_db.default_write_options();
-	if (nullptr == txn_ops)
-		txn_ops = default_trans_options();
-
-	m_txn = m_db_a.get_db()->BeginTransaction(*write_ops, *txn_ops);
+	static rocksdb::TransactionOptions const default_txn_ops;
+	m_txn = m_db_a.get_db()->BeginTransaction(
+		write_options_a ? *write_options_a : *m_db.m_write_options,
+		txn_ops_a ? *txn_ops_a : default_txn_ops);
 }
 
 mcp::db::db_transaction::db_transaction(mcp::db::db_transaction && other_a):
@@ -44,24 +39,13 @@ std::shared_ptr<rocksdb::TransactionOptions> mcp::db::db_transaction::default_tr
 
 void mcp::db::db_transaction::put(int const& index, dev::Slice const& _k, dev::Slice const& _v)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	index_info const* info;
 	auto handle = m_db.get_column_family_handle(index, info);
-	dev::Slicebytes key;
-	if (info->shared)
-	{
-		key.resize(info->prefix.size() + _k.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key));
-		_k.copyTo(dev::SliceRef(&key).cropped(info->prefix.size()));
-	}
-	else
-	{
-		key.resize(_k.size());
-		_k.copyTo(dev::SliceRef(&key));
-	}
+	key_builder builder;
 
 	rocksdb::Status status = m_txn->Put(
 		handle,
-		rocksdb::Slice(key.data(), key.size()),
+		database::make_key(*info, _k, builder),
 		rocksdb::Slice(_v.data(), _v.size())
 	);
 	m_read_only = false;
@@ -78,36 +62,34 @@ bool mcp::db::db_transaction::get(int const& index, dev::Slice const& _k, std::s
 	std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a,
 	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	rocksdb::PinnableSlice value(&_v);
+	bool exists(get(index, _k, value, snapshot_a, read_ops_a));
+	if (exists && value.IsPinned())
+		_v.assign(value.data(), value.size());
+	return exists;
+}
+
+bool mcp::db::db_transaction::get(int const& index, dev::Slice const& _k, rocksdb::PinnableSlice& _v,
+	std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a,
+	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
+{
+	index_info const* info;
 	auto handle = m_db.get_column_family_handle(index, info);
-	
-	dev::Slicebytes key;
-	if (info->shared)
+	key_builder builder;
+
+	rocksdb::Status status;
+	_v.Reset();
+	if (snapshot_a)
 	{
-		key.resize(info->prefix.size() + _k.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key));
-		_k.copyTo(dev::SliceRef(&key).cropped(info->prefix.size()));
+		rocksdb::ReadOptions read_ops(read_ops_a ? *read_ops_a : *m_db.m_read_options);
+		read_ops.snapshot = snapshot_a->snapshot();
+		status = m_txn->Get(read_ops, handle, database::make_key(*info, _k, builder), &_v);
 	}
 	else
 	{
-		key.resize(_k.size());
-		_k.copyTo(dev::SliceRef(&key));
+		status = m_txn->Get(read_ops_a ? *read_ops_a : *m_db.m_read_options, handle, database::make_key(*info, _k, builder), &_v);
 	}
 
-	std::shared_ptr<rocksdb::ReadOptions> read_ops(read_ops_a);
-	if (nullptr == read_ops)
-		read_ops = mcp::db::database::default_read_options();
-
-	if (snapshot_a)
-		read_ops->snapshot = snapshot_a->snapshot();
-
-	rocksdb::Status status = m_txn->Get(
-		*read_ops,
-		handle,
-		rocksdb::Slice(key.data(), key.size()),
-		&_v
-	);
-
 	if (status.ok())
 		return true;
 
@@ -118,27 +100,64 @@ bool mcp::db::db_transaction::get(int const& index, dev::Slice const& _k, std::s
 	return false;
 }
 
-void mcp::db::db_transaction::del(int const& index, dev::Slice const& _k)
+void mcp::db::db_transaction::multi_get(int const& index, std::vector<dev::Slice> const& keys_a,
+	std::vector<rocksdb::PinnableSlice>& values_a, std::vector<bool>& exists_a,
+	std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a,
+	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	size_t const size(keys_a.size());
+	values_a = std::vector<rocksdb::PinnableSlice>(size);
+	exists_a.assign(size, false);
+	if (size == 0)
+		return;
+
+	index_info const* info;
 	auto handle = m_db.get_column_family_handle(index, info);
-	
-	dev::Slicebytes key;
+
+	std::vector<rocksdb::Slice> keys;
+	keys.reserve(size);
+	std::vector<std::string> prefixed_keys;
 	if (info->shared)
 	{
-		key.resize(info->prefix.size() + _k.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key));
-		_k.copyTo(dev::SliceRef(&key).cropped(info->prefix.size()));
+		prefixed_keys.reserve(size);
+		for (dev::Slice const& _k : keys_a)
+		{
+			prefixed_keys.push_back(info->prefix);
+			prefixed_keys.back().append(_k.data(), _k.size());
+			keys.push_back(rocksdb::Slice(prefixed_keys.back()));
+		}
 	}
 	else
 	{
-		key.resize(_k.size());
-		_k.copyTo(dev::SliceRef(&key));
+		for (dev::Slice const& _k : keys_a)
+			keys.push_back(rocksdb::Slice(_k.data(), _k.size()));
+	}
+
+	rocksdb::ReadOptions read_ops(read_ops_a ? *read_ops_a : *m_db.m_read_options);
+	if (snapshot_a)
+		read_ops.snapshot = snapshot_a->snapshot();
+
+	std::vector<rocksdb::Status> statuses(size);
+	m_txn->MultiGet(read_ops, handle, size, keys.data(), values_a.data(), statuses.data());
+
+	for (size_t i = 0; i < size; i++)
+	{
+		if (statuses[i].ok())
+			exists_a[i] = true;
+		else if (!statuses[i].IsNotFound())
+			check_status(statuses[i]);
 	}
+}
+
+void mcp::db::db_transaction::del(int const& index, dev::Slice const& _k)
+{
+	index_info const* info;
+	auto handle = m_db.get_column_family_handle(index, info);
+	key_builder builder;
 
 	rocksdb::Status status = m_txn->Delete(
 		handle,
-		rocksdb::Slice(key.data(), key.size())
+		database::make_key(*info, _k, builder)
 	);
 	m_read_only = false;
 
@@ -149,40 +168,8 @@ bool mcp::db::db_transaction::exists(int const& index, dev::Slice const & _k,
 	std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a,
 	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
-	auto handle = m_db.get_column_family_handle(index, info);
-	
-	dev::Slicebytes key;
-	if (info->shared)
-	{
-		key.resize(info->prefix.size() + _k.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key));
-		_k.copyTo(dev::SliceRef(&key).cropped(info->prefix.size()));
-	}
-	else
-	{
-		key.resize(_k.size());
-		_k.copyTo(dev::SliceRef(&key));
-	}
-
-	std::shared_ptr<rocksdb::ReadOptions> read_ops(read_ops_a);
-	if (nullptr == read_ops)
-		read_ops = mcp::db::database::default_read_options();
-
-	if (snapshot_a)
-		read_ops->snapshot = snapshot_a->snapshot();
-
-	std::string value;
-	rocksdb::Status status = m_txn->Get(
-		*read_ops,
-		handle,
-		rocksdb::Slice(key.data(), key.size()),
-		&value
-	);
-
-	if (status.ok())
-		return true;
-	return false;
+	rocksdb::PinnableSlice value;
+	return get(index, _k, value, snapshot_a, read_ops_a);
 }
 
 void mcp::db::db_transaction::count_add(std::string const& _k, uint32_t const& _v)
@@ -232,13 +219,13 @@ void mcp::db::db_transaction::count_del(std::string const& _k)
 uint64_t mcp::db::db_transaction::count_get(std::string const& _k, std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a)
 {
 	auto handle = m_db.get_column_family_handle(m_db.m_count);
-	std::shared_ptr<rocksdb::ReadOptions> read_ops = mcp::db::database::default_read_options();
+	rocksdb::ReadOptions read_ops(*m_db.m_read_options);
 	if (snapshot_a)
-		read_ops->snapshot = snapshot_a->snapshot();
-	std::string value = "";
+		read_ops.snapshot = snapshot_a->snapshot();
+	rocksdb::PinnableSlice value;
 
 	rocksdb::Status status = m_txn->Get(
-		*read_ops,
+		read_ops,
 		handle,
 		rocksdb::Slice(_k.data(), _k.size()),
 		&value
@@ -247,8 +234,9 @@ uint64_t mcp::db::db_transaction::count_get(std::string const& _k, std::shared_p
 	uint64_t i_value = 0;
 	if (status.ok())
 	{
-		uint64_t* orig_value = (uint64_t*)value.data();
-		i_value = boost::endian::big_to_native(*orig_value);
+		uint64_t orig_value;
+		memcpy(&orig_value, value.data(), sizeof(orig_value));
+		i_value = boost::endian::big_to_native(orig_value);
 	}
 	else if (status.IsNotFound())
 	{ }
@@ -271,6 +259,13 @@ void mcp::db::db_transaction::commit()
 	}
 }
 
+size_t mcp::db::db_transaction::data_size()
+{
+	if (m_read_only || m_commited_or_rollbacked)
+		return 0;
+	return m_txn->GetWriteBatch()->GetWriteBatch()->GetDataSize();
+}
+
 void mcp::db::db_transaction::rollback()
 {
 	if (m_commited_or_rollbacked)
@@ -285,7 +280,7 @@ mcp::db::forward_iterator mcp::db::db_transaction::begin(int const& index,
 	std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a,
 	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	index_info const* info;
 	auto handle = m_db.get_column_family_handle(index, info);
 	if (info->shared)//prefix begin
 	{
@@ -309,7 +304,7 @@ mcp::db::forward_iterator mcp::db::db_transaction::begin(int const& index,
 	std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a,
 	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	index_info const* info;
 	auto handle = m_db.get_column_family_handle(index, info);
 
 	std::shared_ptr<rocksdb::ReadOptions> read_ops(read_ops_a);
@@ -320,29 +315,19 @@ mcp::db::forward_iterator mcp::db::db_transaction::begin(int const& index,
 	if (snapshot_a != nullptr)
 		read_ops->snapshot = snapshot_a->snapshot();
 	
-	dev::Slicebytes key;
+	key_builder builder;
 	if (info->shared)
-	{
-		key.resize(info->prefix.size() + _k.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key));
-		_k.copyTo(dev::SliceRef(&key).cropped(info->prefix.size()));
 		read_ops->prefix_same_as_start = true;
-	}
-	else
-	{
-		key.resize(_k.size());
-		_k.copyTo(dev::SliceRef(&key));
-	}
 
 	auto it = m_txn->GetIterator(*read_ops, handle);
-	return forward_iterator(it, rocksdb::Slice(key.data(),key.size()), info->prefix);
+	return forward_iterator(it, database::make_key(*info, _k, builder), info->prefix);
 }
 
 mcp::db::backward_iterator mcp::db::db_transaction::rbegin(int const& index, 
 	std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a,
 	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	index_info const* info;
 	auto handle = m_db.get_column_family_handle(index, info);
 	if (info->shared)//prefix begin
 	{
@@ -368,7 +353,7 @@ mcp::db::backward_iterator mcp::db::db_transaction::rbegin(int const& index,
 	std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a,
 	std::shared_ptr<rocksdb::ReadOptions> read_ops_a)
 {
-	std::shared_ptr<mcp::db::index_info> info = std::make_shared<mcp::db::index_info>();
+	index_info const* info;
 	auto handle = m_db.get_column_family_handle(index, info);
 
 	std::shared_ptr<rocksdb::ReadOptions> read_ops(read_ops_a);
@@ -379,22 +364,12 @@ mcp::db::backward_iterator mcp::db::db_transaction::rbegin(int const& index,
 	if (snapshot_a != nullptr)
 		read_ops->snapshot = snapshot_a->snapshot();
 
-	dev::Slicebytes key;
+	key_builder builder;
 	if (info->shared)
-	{
-		key.resize(info->prefix.size() + _k.size());
-		dev::Slice(&info->prefix).copyTo(dev::SliceRef(&key));
-		_k.copyTo(dev::SliceRef(&key).cropped(info->prefix.size()));
 		read_ops->prefix_same_as_start = true;
-	}
-	else
-	{
-		key.resize(_k.size());
-		_k.copyTo(dev::SliceRef(&key));
-	}
 
 	auto it = m_txn->GetIterator(*read_ops, handle);
-	return backward_iterator(it, rocksdb::Slice(key.data(), key.size()), info->prefix);
+	return backward_iterator(it, database::make_key(*info, _k, builder), info->prefix);
 }
 
 bool mcp::db::db_transaction::merge(int const& index, std::string const& _k, dev::Slice const& _v)
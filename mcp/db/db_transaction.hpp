@@ -31,6 +31,17 @@ namespace mcp
 				std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a = nullptr, 
 				std::shared_ptr<rocksdb::ReadOptions> read_ops_a = nullptr
 			);
+			/// value is pinned in block cache or memtable, no copy into std::string
+			bool get(int const& index, dev::Slice const& _k, rocksdb::PinnableSlice& _v,
+				std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a = nullptr,
+				std::shared_ptr<rocksdb::ReadOptions> read_ops_a = nullptr
+			);
+			/// batched point lookup in one rocksdb MultiGet, exists_a[i] is false if keys_a[i] not exist
+			void multi_get(int const& index, std::vector<dev::Slice> const& keys_a, 
+				std::vector<rocksdb::PinnableSlice>& values_a, std::vector<bool>& exists_a,
+				std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a = nullptr,
+				std::shared_ptr<rocksdb::ReadOptions> read_ops_a = nullptr
+			);
 			void del(int const& index, dev::Slice const& _k);
 			bool exists(int const& index, dev::Slice const& _k, 
 				std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a = nullptr,
@@ -44,6 +55,8 @@ namespace mcp
 
 			void commit();
 			void rollback();
+			/// bytes written and not committed yet
+			size_t data_size();
 
 			forward_iterator begin(int const& index, 
 				std::shared_ptr<rocksdb::ManagedSnapshot> snapshot_a = nullptr,
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <rocksdb/slice.h>
+#include <cstring>
+
+namespace mcp
+{
+	namespace db
+	{
+		/*compose table prefix and key parts in a stack buffer, falls back to heap only for keys longer than inline_size*/
+		class key_builder
+		{
+		public:
+			static size_t const inline_size = 128;
+
+			key_builder() :
+				m_size(0)
+			{
+			}
+
+			key_builder(std::string const& prefix_a, dev::Slice const& key_a) :
+				m_size(0)
+			{
+				append(prefix_a);
+				append(key_a);
+			}
+
+			key_builder(key_builder const &) = delete;
+			key_builder& operator= (key_builder const &) = delete;
+
+			key_builder& append(dev::Slice const& part_a)
+			{
+				if (part_a.empty())
+					return *this;
+
+				if (m_heap.empty() && m_size + part_a.size() <= inline_size)
+				{
+					memcpy(m_inline + m_size, part_a.data(), part_a.size());
+				}
+				else
+				{
+					if (m_heap.empty())
+						m_heap.assign(m_inline, m_size);
+					m_heap.append(part_a.data(), part_a.size());
+				}
+				m_size += part_a.size();
+				return *this;
+			}
+
+			key_builder& append(std::string const& part_a)
+			{
+				return append(dev::Slice(part_a.data(), part_a.size()));
+			}
+
+			template <unsigned N>
+			key_builder& append(dev::FixedHash<N> const& hash_a)
+			{
+				return append(dev::Slice((char const*)hash_a.data(), N));
+			}
+
+			/// big endian, so that keys sort by value
+			key_builder& append(uint64_t const& value_a)
+			{
+				char buf[sizeof(uint64_t)];
+				for (size_t i = 0; i < sizeof(uint64_t); i++)
+					buf[i] = static_cast<char>((value_a >> (8 * (sizeof(uint64_t) - 1 - i))) & 0xff);
+				return append(dev::Slice(buf, sizeof(buf)));
+			}
+
+			char const* data() const { return m_heap.empty() ? m_inline : m_heap.data(); }
+			size_t size() const { return m_size; }
+			bool on_heap() const { return !m_heap.empty(); }
+
+			rocksdb::Slice slice() const { return rocksdb::Slice(data(), m_size); }
+			dev::Slice ref() const { return dev::Slice(data(), m_size); }
+
+		private:
+			char m_inline[inline_size];
+			std::string m_heap;
+			size_t m_size;
+		};
+	}
+}
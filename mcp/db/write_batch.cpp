@@ -12,10 +12,12 @@ mcp::db::write_batch::~write_batch()
 
 void mcp::db::write_batch::put(int const& index, dev::Slice const& _k, dev::Slice const& _v)
 {
-	auto handle = m_db.get_column_family_handle(index);
+	index_info const* info;
+	auto handle = m_db.get_column_family_handle(index, info);
+	key_builder builder;
 	rocksdb::Status status = m_write_batch.Put(
 		handle,
-		rocksdb::Slice(_k.data(), _k.size()),
+		database::make_key(*info, _k, builder),
 		rocksdb::Slice(_v.data(), _v.size())
 	);
 
@@ -24,8 +26,10 @@ void mcp::db::write_batch::put(int const& index, dev::Slice const& _k, dev::Slic
 
 void mcp::db::write_batch::del(int const& index, dev::Slice const& _k)
 {
-	auto handle = m_db.get_column_family_handle(index);
-	rocksdb::Slice const key(_k.data(), _k.size());
+	index_info const* info;
+	auto handle = m_db.get_column_family_handle(index, info);
+	key_builder builder;
+	rocksdb::Slice const key(database::make_key(*info, _k, builder));
 
 	rocksdb::Status status = m_write_batch.Delete(
 		handle,
@@ -37,6 +41,6 @@ void mcp::db::write_batch::del(int const& index, dev::Slice const& _k)
 
 void mcp::db::write_batch::commit()
 {
-	auto const status = m_db.get_db()->Write(*m_db.default_write_options(), &m_write_batch);
+	auto const status = m_db.get_db()->Write(*m_db.m_write_options, &m_write_batch);
 	check_status(status);
 }
\ No newline at end of file
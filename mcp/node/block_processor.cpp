@@ -5,7 +5,11 @@
 #include <libdevcore/CommonJS.h>
 
 constexpr uint32_t tx_timeout_ms = 1000;
+/// blocks processed together are committed when their writes or count reach these limits
+constexpr uint64_t tx_max_bytes = 64 * 1024 * 1024;
+constexpr uint32_t tx_max_blocks = 50;
 constexpr unsigned max_mt_count = 16;
+constexpr size_t max_mt_window = 4096;
 constexpr unsigned max_pending_size = 5000;
 constexpr unsigned max_local_processing_size = 100;
 
@@ -71,6 +75,7 @@ mcp::block_processor::block_processor(bool & error_a,
 	m_aq(aq),
 	m_alarm(alarm_a),
 	m_stopped(false),
+	m_mt_validate_queue(max_mt_window),
 	m_local_cache(std::make_shared<process_block_cache>(cache_a, store_a, tq, aq)),
 	m_last_request_unknown_missing_time(std::chrono::steady_clock::now()),
 	unhandle(std::make_shared<mcp::unhandle_cache>(tq, aq))
@@ -109,6 +114,12 @@ mcp::block_processor::block_processor(bool & error_a,
 	m_tq->onReady([this](h256 const& _h) { onTransactionReady(_h); });
 	m_aq->onReady([this](h256 const& _h) { onApproveImported(_h); });
 
+	unsigned validators = std::max(std::thread::hardware_concurrency(), 2U) - 1U;
+	for (unsigned i = 0; i < validators; i++)
+		m_mt_validators.emplace_back([this, i]() {
+			dev::setThreadName("validator" + std::to_string(i));
+			this->mt_validator();
+		});
 	m_mt_process_block_thread = std::thread([this]() { this->mt_process_blocks(); });
 	m_process_block_thread = std::thread([this]() { this->process_blocks(); });
 	m_ready_hashs_thread = std::thread([this]() { this->process_ready_func(); });
@@ -134,6 +145,11 @@ void mcp::block_processor::stop()
 		m_mt_process_condition.notify_all();
 	}
 
+	{
+		std::lock_guard<std::mutex> lock(m_mt_validate_mutex);
+		m_mt_validate_condition.notify_all();
+	}
+
 	{
 		std::lock_guard<std::mutex> lock(m_process_mutex);
 		m_process_condition.notify_all();
@@ -146,6 +162,11 @@ void mcp::block_processor::stop()
 
 	if (m_mt_process_block_thread.joinable())
 		m_mt_process_block_thread.join();
+	for (auto & t : m_mt_validators)
+	{
+		if (t.joinable())
+			t.join();
+	}
 	if (m_process_block_thread.joinable())
 		m_process_block_thread.join();
 	if (m_ready_hashs_thread.joinable())
@@ -222,142 +243,169 @@ void mcp::block_processor::add_to_mt_process(std::shared_ptr<mcp::block_processo
 
 void mcp::block_processor::mt_process_blocks()
 {
+	std::deque<std::shared_ptr<mt_validate_job>> validating;
 	std::unique_lock<std::mutex> lock(m_mt_process_mutex);
-	std::shared_ptr<mcp::db::db_transaction> transaction(std::make_shared<mcp::db::db_transaction>(m_store.create_transaction()));
 	while (!m_stopped)
 	{
-		if (!m_mt_blocks_pending.empty())
+		///window adapts to load, a slow block only holds back hand-off, validators go on with the rest
+		size_t window(std::min(max_mt_window, std::max<size_t>(m_mt_validators.size() * 2, m_mt_blocks_pending.size())));
+		m_mt_window = window;
+		bool pushed(false);
+		while (!m_mt_blocks_pending.empty() && validating.size() < window)
 		{
-			mcp::stopwatch_guard sw("mt_process_blocks");
+			std::shared_ptr<mt_validate_job> job(std::make_shared<mt_validate_job>());
+			job->item = m_mt_blocks_pending.front();
+			if (!m_mt_validate_queue.try_push(job))
+				break;
+			m_mt_blocks_pending.pop_front();
+			validating.push_back(job);
+			pushed = true;
+		}
+		m_mt_blocks_validating = validating.size();
+		if (pushed)
+		{
+			std::lock_guard<std::mutex> validate_lock(m_mt_validate_mutex);
+			m_mt_validate_condition.notify_all();
+		}
 
-			std::swap(m_mt_blocks_processing, m_mt_blocks_pending);
+		///hand off validated blocks in received order
+		std::vector<std::shared_ptr<mt_validate_job>> validated;
+		while (!validating.empty() && validating.front()->done.load(std::memory_order_acquire))
+		{
+			validated.push_back(validating.front());
+			validating.pop_front();
+		}
+		if (!validated.empty())
+		{
+			m_mt_blocks_validating = validating.size();
 			lock.unlock();
-
-			while (!m_mt_blocks_processing.empty())
+			try
 			{
-				try
+				for (std::shared_ptr<mt_validate_job> const & job : validated)
 				{
-					std::list<std::shared_ptr<std::promise<mcp::validate_status>>> results;
-					unsigned count = std::min((unsigned)m_mt_blocks_processing.size(), max_mt_count);
-					for (unsigned i = 0; i < count; i++)
+					if (job->status.ok)
 					{
-						std::shared_ptr<mcp::block_processor_item> item(m_mt_blocks_processing[i]);
-						std::shared_ptr<std::promise<mcp::validate_status>> p(std::make_shared<std::promise<mcp::validate_status>>());
-						m_async_task->sync_async([this, item, p, transaction]() {
-
-							auto block = item->joint.block;
-							mcp::block_hash const & block_hash(block->hash());
-
-							if (block_hash == mcp::genesis::block_hash)
-							{
-								p->set_value(mcp::validate_status(false, "Genesis block"));
-								return;
-							}
-
-							bool ok(true);
-							std::string err_msg;
-							try
-							{
-								mcp::base_validate_result result = m_validation->base_validate(*transaction, m_cache, item);
-								switch (result.code)
-								{
-								case base_validate_result_codes::ok:
-								{
-									//check timestamp
-									//put it at end for no need to do base validete when block release from late_message_cache
-									if (mcp::seconds_since_epoch() < block->exec_timestamp())
-									{
-										ok = false;
-										err_msg = boost::str(boost::format("Exec timestamp too late, block: %1%, exec_timestamp: %2%, sys_timestamp: %3%") % block_hash.hex() % block->exec_timestamp() % mcp::seconds_since_epoch());
-										LOG(m_log.debug) << err_msg;
-										//cache late message
-										if (block->exec_timestamp() < mcp::seconds_since_epoch() + 300) //5 minutes
-										{
-                                            m_late_message_cache.add(item);
-										}
-									}
-
-									break;
-								}
-								case base_validate_result_codes::old:
-								{
-									ok = false;
-									base_validate_old_size++;
-									break;
-								}
-								case base_validate_result_codes::invalid_signature:
-								{
-									ok = false;
-									err_msg = "Invalid signature, hash:" + block_hash.hex() + ",from:" + block->from().hexPrefixed() + ",signature:" + ((Signature)block->signature()).hex();
-									LOG(m_log.debug) << err_msg;
-									if (!item->is_local())
-										m_onImport(ImportResult::Malformed, item->remote_node_id());///  Notify capability and P2P to process peer. diconnect peer.  
-									
-									break;
-								}
-								case base_validate_result_codes::invalid_block:
-								{
-									ok = false;
-									err_msg = boost::str(boost::format("Invalid block: %1%, error message: %2%") % block->hash().hex() % result.err_msg);
-									LOG(m_log.debug) << err_msg;
-
-									//cache invalid block
-									InvalidBlockCache.add(block_hash);
-									if (!item->is_local())
-										m_onImport(ImportResult::Malformed, item->remote_node_id());///  Notify capability and P2P to process peer. diconnect peer.  
-									break;
-								}
-								case base_validate_result_codes::known_invalid_block:
-								{
-									ok = false;
-									err_msg = boost::str(boost::format("Know invalid block: %1%") % block->hash().hex());
-									LOG(m_log.trace) << err_msg;
-									if (!item->is_local())
-										m_onImport(ImportResult::Malformed, item->remote_node_id());///  Notify capability and P2P to process peer. diconnect peer.  
-									break;
-								}
-								}
-								p->set_value(mcp::validate_status(ok, err_msg));
-							}
-							catch (std::exception const & e)
-							{
-								LOG(m_log.error) << "mt_process_blocks async error:" << e.what();
-								throw;
-							}
-						});
-
-						results.push_back(p);
+						add_to_process(job->item);
 					}
-
-					for (std::shared_ptr<std::promise<mcp::validate_status>> p : results)
+					else
 					{
-						mcp::validate_status status = p->get_future().get();
-						std::shared_ptr<mcp::block_processor_item> item(m_mt_blocks_processing.front());
-						if (status.ok)
-						{
-							add_to_process(item);
-						}
-						else
-						{
-							if (item->is_local())
-								item->set_local_promise(status);
-						}
-						m_mt_blocks_processing.pop_front();
+						if (job->item->is_local())
+							job->item->set_local_promise(job->status);
 					}
 				}
-				catch (std::exception const & e)
+			}
+			catch (std::exception const & e)
+			{
+				LOG(m_log.error) << "mt_process_blocks error:" << e.what();
+				throw;
+			}
+			lock.lock();
+			continue;
+		}
+
+		m_mt_process_condition.wait(lock);
+	}
+}
+
+void mcp::block_processor::mt_validator()
+{
+	mcp::db::db_transaction transaction(m_store.create_transaction());
+	while (!m_stopped)
+	{
+		std::shared_ptr<mt_validate_job> job;
+		if (!m_mt_validate_queue.try_pop(job))
+		{
+			std::unique_lock<std::mutex> lock(m_mt_validate_mutex);
+			m_mt_validate_condition.wait(lock, [this]() { return m_stopped || m_mt_validate_queue.size() > 0; });
+			continue;
+		}
+
+		job->status = mt_validate(transaction, job->item);
+		job->done.store(true, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(m_mt_process_mutex);
+			m_mt_process_condition.notify_all();
+		}
+	}
+}
+
+mcp::validate_status mcp::block_processor::mt_validate(mcp::db::db_transaction & transaction_a, std::shared_ptr<mcp::block_processor_item> item)
+{
+	auto block = item->joint.block;
+	mcp::block_hash const & block_hash(block->hash());
+
+	if (block_hash == mcp::genesis::block_hash)
+		return mcp::validate_status(false, "Genesis block");
+
+	bool ok(true);
+	std::string err_msg;
+	try
+	{
+		mcp::base_validate_result result = m_validation->base_validate(transaction_a, m_cache, item);
+		switch (result.code)
+		{
+		case base_validate_result_codes::ok:
+		{
+			//check timestamp
+			//put it at end for no need to do base validete when block release from late_message_cache
+			if (mcp::seconds_since_epoch() < block->exec_timestamp())
+			{
+				ok = false;
+				err_msg = boost::str(boost::format("Exec timestamp too late, block: %1%, exec_timestamp: %2%, sys_timestamp: %3%") % block_hash.hex() % block->exec_timestamp() % mcp::seconds_since_epoch());
+				LOG(m_log.debug) << err_msg;
+				//cache late message
+				if (block->exec_timestamp() < mcp::seconds_since_epoch() + 300) //5 minutes
 				{
-					LOG(m_log.error) << "mt_process_blocks error:" << e.what();
-					throw;
+					m_late_message_cache.add(item);
 				}
 			}
 
-			lock.lock();
+			break;
 		}
-		else
+		case base_validate_result_codes::old:
+		{
+			ok = false;
+			base_validate_old_size++;
+			break;
+		}
+		case base_validate_result_codes::invalid_signature:
 		{
-			m_mt_process_condition.wait(lock);
+			ok = false;
+			err_msg = "Invalid signature, hash:" + block_hash.hex() + ",from:" + block->from().hexPrefixed() + ",signature:" + ((Signature)block->signature()).hex();
+			LOG(m_log.debug) << err_msg;
+			if (!item->is_local())
+				m_onImport(ImportResult::Malformed, item->remote_node_id());///  Notify capability and P2P to process peer. diconnect peer.  
+			
+			break;
 		}
+		case base_validate_result_codes::invalid_block:
+		{
+			ok = false;
+			err_msg = boost::str(boost::format("Invalid block: %1%, error message: %2%") % block->hash().hex() % result.err_msg);
+			LOG(m_log.debug) << err_msg;
+
+			//cache invalid block
+			InvalidBlockCache.add(block_hash);
+			if (!item->is_local())
+				m_onImport(ImportResult::Malformed, item->remote_node_id());///  Notify capability and P2P to process peer. diconnect peer.  
+			break;
+		}
+		case base_validate_result_codes::known_invalid_block:
+		{
+			ok = false;
+			err_msg = boost::str(boost::format("Know invalid block: %1%") % block->hash().hex());
+			LOG(m_log.trace) << err_msg;
+			if (!item->is_local())
+				m_onImport(ImportResult::Malformed, item->remote_node_id());///  Notify capability and P2P to process peer. diconnect peer.  
+			break;
+		}
+		}
+		return mcp::validate_status(ok, err_msg);
+	}
+	catch (std::exception const & e)
+	{
+		LOG(m_log.error) << "mt_process_blocks async error:" << e.what();
+		throw;
 	}
 }
 
@@ -465,7 +513,7 @@ void mcp::block_processor::process_blocks()
 	}
 }
 
-bool mcp::block_processor::try_process_local_item_first()
+bool mcp::block_processor::try_process_local_item_first(mcp::timeout_db_transaction & timeout_tx)
 {
 	bool has_local(false);
 	if (!m_local_blocks_pending.empty())
@@ -482,7 +530,7 @@ bool mcp::block_processor::try_process_local_item_first()
 			}
 		}
 		if (has_local)
-			do_process_one(local_item);
+			do_process_one(timeout_tx, local_item);
 	}
 	return has_local;
 }
@@ -491,26 +539,61 @@ void mcp::block_processor::do_process(std::deque<std::shared_ptr<mcp::block_proc
 {
 	//mcp::stopwatch_guard sw("process_blocks: do_process");
 
-	while (!blocks_processing.empty())
+	std::shared_ptr<rocksdb::WriteOptions> write_option(mcp::db::database::default_write_options());
+	std::shared_ptr<rocksdb::TransactionOptions> tx_option(mcp::db::db_transaction::default_trans_options());
+	tx_option->skip_concurrency_control = true;
+	mcp::timeout_db_transaction timeout_tx(m_store, tx_timeout_ms, write_option, tx_option,
+		std::bind(&block_processor::before_db_commit_event, this),
+		std::bind(&block_processor::after_db_commit_event, this));
+	timeout_tx.set_limits(tx_max_bytes, tx_max_blocks);
+
+	try
 	{
-		if (m_stopped)
-			break;
+		while (!blocks_processing.empty())
+		{
+			if (m_stopped)
+				break;
 
-		std::shared_ptr<mcp::block_processor_item> item(blocks_processing.front());
+			std::shared_ptr<mcp::block_processor_item> item(blocks_processing.front());
 
-		if (!item->is_local())
-		{
-			bool has_local(try_process_local_item_first());
-			if (has_local)
-				continue;
+			if (!item->is_local())
+			{
+				bool has_local(try_process_local_item_first(timeout_tx));
+				if (has_local)
+				{
+					///local block waits for commit
+					timeout_tx.commit_and_continue();
+					continue;
+				}
+			}
+
+			blocks_processing.pop_front();
+			do_process_one(timeout_tx, item);
+			timeout_tx.block_processed();
+			if (item->is_local())
+				timeout_tx.commit_and_continue();
+			else
+				timeout_tx.commit_if_needed();
 		}
 
-		blocks_processing.pop_front();
-		do_process_one(item);
+		///nothing left to group with, commit now
+		timeout_tx.commit();
+	}
+	catch (std::exception const &e)
+	{
+		LOG(m_log.error) << "Block process do_process error: " << e.what() << std::endl << boost::stacktrace::stacktrace();
+		timeout_tx.rollback();
+		throw;
+	}
+	catch (...)
+	{
+		LOG(m_log.error) << "Block process do_process unknown error." << std::endl << boost::stacktrace::stacktrace();
+		timeout_tx.rollback();
+		throw;
 	}
 }
 
-void mcp::block_processor::do_process_one(std::shared_ptr<mcp::block_processor_item> item)
+void mcp::block_processor::do_process_one(mcp::timeout_db_transaction & timeout_tx, std::shared_ptr<mcp::block_processor_item> item)
 {
 	mcp::joint_message const & joint(item->joint);
 	std::shared_ptr<mcp::block> block(joint.block);
@@ -522,144 +605,119 @@ void mcp::block_processor::do_process_one(std::shared_ptr<mcp::block_processor_i
 		return;
 	}
 
-	std::shared_ptr<rocksdb::WriteOptions> write_option(mcp::db::database::default_write_options());
-	std::shared_ptr<rocksdb::TransactionOptions> tx_option(mcp::db::db_transaction::default_trans_options());
-	tx_option->skip_concurrency_control = true;
-	std::shared_ptr<mcp::chain> chain(m_chain);
-	mcp::timeout_db_transaction timeout_tx(m_store, tx_timeout_ms, write_option, tx_option,
-		std::bind(&block_processor::before_db_commit_event, this),
-		std::bind(&block_processor::after_db_commit_event, this));
-
-	try
-	{
-		mcp::db::db_transaction & transaction(timeout_tx.get_transaction());
-		//dag validate
-		mcp::validate_result result(m_validation->dag_validate(transaction, m_local_cache, joint));
-
-		//LOG(m_log.info) << "do_process_one, block:" << block_hash.hex() << " ,result:" << int(result.code);
-
-		switch (result.code)
-		{
-		case mcp::validate_result_codes::ok:
-		{
-			//broadcast
-			if (!item->is_local() && !item->is_sync() && item->joint.summary_hash == mcp::summary_hash(0))
-			{
-				m_async_task->sync_async([this, joint]() {
-					m_capability->broadcast_block(joint);
-				});
-			}
-
-			do_process_dag_item(timeout_tx, item);
-			break;
-		}
-		case mcp::validate_result_codes::old:
-		{
-			dag_old_size++;
-			LOG(m_log.trace) << boost::str(boost::format("Old block: %1%") % block_hash.hex());
-			break;
-		}
-		case mcp::validate_result_codes::missing_parents_and_previous:
-		{
-			assert_x(!(item->is_local() && result.missing_links.size() > 0));
-			assert_x(!item->is_sync());
-			if (result.missing_parents_and_previous.size() > 0 || result.missing_links.size() > 0 || result.missing_approves.size() > 0)
-			{
-				if (result.missing_parents_and_previous.size() > 0)
-				{
-					assert_x(!item->is_local());
-				}
-				process_missing(item, result.missing_parents_and_previous, result.missing_links, result.missing_approves);
-			}
+	mcp::db::db_transaction & transaction(timeout_tx.get_transaction());
+	//dag validate
+	mcp::validate_result result(m_validation->dag_validate(transaction, m_local_cache, joint));
 
-			LOG(m_log.trace) << boost::str(boost::format("Missing parents and previous for: %1%") % block_hash.hex());
+	//LOG(m_log.info) << "do_process_one, block:" << block_hash.hex() << " ,result:" << int(result.code);
 
-			break;
-		}
-		case mcp::validate_result_codes::invalid_block:
-		{
-			LOG(m_log.info) << boost::str(boost::format("Invalid block: %1%, error message: %2%") % block_hash.hex() % result.err_msg);
-			assert_x(!item->is_local());
-			//cache invalid block
-			InvalidBlockCache.add(block_hash);
-			break;
-		}
-		case mcp::validate_result_codes::parents_and_previous_include_invalid_block:
-		{
-			LOG(m_log.info) << boost::str(boost::format("Invalid block: %1%, error message: %2%") % block_hash.hex() % result.err_msg);
-			assert_x(!item->is_local());
-			//cache invalid block
-			InvalidBlockCache.add(block_hash);
-			break;
-		}
-		case mcp::validate_result_codes::known_invalid_block:
+	switch (result.code)
+	{
+	case mcp::validate_result_codes::ok:
+	{
+		//broadcast
+		if (!item->is_local() && !item->is_sync() && item->joint.summary_hash == mcp::summary_hash(0))
 		{
-			LOG(m_log.trace) << boost::str(boost::format("Known invalid block: %1%") % block_hash.hex());
-			assert_x(!item->is_local());
-			break;
-		}
+			m_async_task->sync_async([this, joint]() {
+				m_capability->broadcast_block(joint);
+			});
 		}
 
-		//local dag
-		if (item->is_local())
+		do_process_dag_item(timeout_tx, item);
+		break;
+	}
+	case mcp::validate_result_codes::old:
+	{
+		dag_old_size++;
+		LOG(m_log.trace) << boost::str(boost::format("Old block: %1%") % block_hash.hex());
+		break;
+	}
+	case mcp::validate_result_codes::missing_parents_and_previous:
+	{
+		assert_x(!(item->is_local() && result.missing_links.size() > 0));
+		assert_x(!item->is_sync());
+		if (result.missing_parents_and_previous.size() > 0 || result.missing_links.size() > 0 || result.missing_approves.size() > 0)
 		{
-			switch (result.code)
+			if (result.missing_parents_and_previous.size() > 0)
 			{
-			case mcp::validate_result_codes::ok:
-			case mcp::validate_result_codes::old:
-				m_ok_local_promises.push_back(item->get_local_promise());
-				break;
-			case mcp::validate_result_codes::missing_parents_and_previous:
-			{
-				std::string msg = "missing parents or previous or links";
-				item->set_local_promise(mcp::validate_status(false, msg));
-				break;
-			}
-			default:
-			{
-				std::string msg = "validate error";
-				item->set_local_promise(mcp::validate_status(false, msg));
-				break;
-			}
+				assert_x(!item->is_local());
 			}
+			process_missing(item, result.missing_parents_and_previous, result.missing_links, result.missing_approves);
 		}
 
-		//unhandle
+		LOG(m_log.trace) << boost::str(boost::format("Missing parents and previous for: %1%") % block_hash.hex());
+
+		break;
+	}
+	case mcp::validate_result_codes::invalid_block:
+	{
+		LOG(m_log.info) << boost::str(boost::format("Invalid block: %1%, error message: %2%") % block_hash.hex() % result.err_msg);
+		assert_x(!item->is_local());
+		//cache invalid block
+		InvalidBlockCache.add(block_hash);
+		break;
+	}
+	case mcp::validate_result_codes::parents_and_previous_include_invalid_block:
+	{
+		LOG(m_log.info) << boost::str(boost::format("Invalid block: %1%, error message: %2%") % block_hash.hex() % result.err_msg);
+		assert_x(!item->is_local());
+		//cache invalid block
+		InvalidBlockCache.add(block_hash);
+		break;
+	}
+	case mcp::validate_result_codes::known_invalid_block:
+	{
+		LOG(m_log.trace) << boost::str(boost::format("Known invalid block: %1%") % block_hash.hex());
+		assert_x(!item->is_local());
+		break;
+	}
+	}
+
+	//local dag
+	if (item->is_local())
+	{
 		switch (result.code)
 		{
 		case mcp::validate_result_codes::ok:
-		{
-			try_process_unhandle(item);
+		case mcp::validate_result_codes::old:
+			m_ok_local_promises.push_back(item->get_local_promise());
 			break;
-		}
-		case mcp::validate_result_codes::invalid_block:
-		case mcp::validate_result_codes::parents_and_previous_include_invalid_block:
-		case mcp::validate_result_codes::known_invalid_block:
+		case mcp::validate_result_codes::missing_parents_and_previous:
 		{
-			try_remove_invalid_unhandle(item->block_hash);
-
-			/// Notify capability and P2P to process peer. diconnect peer.  
-			/// must not a local block.remote node id existed.
-			m_onImport(ImportResult::Malformed, item->remote_node_id());
+			std::string msg = "missing parents or previous or links";
+			item->set_local_promise(mcp::validate_status(false, msg));
 			break;
 		}
 		default:
+		{
+			std::string msg = "validate error";
+			item->set_local_promise(mcp::validate_status(false, msg));
 			break;
 		}
-
-		timeout_tx.commit();
+		}
 	}
-	catch (std::exception const &e)
+
+	//unhandle
+	switch (result.code)
 	{
-		LOG(m_log.error) << "Block process do_process_one error: " << e.what() << std::endl << boost::stacktrace::stacktrace();
-		timeout_tx.rollback();
-		throw;
+	case mcp::validate_result_codes::ok:
+	{
+		try_process_unhandle(item);
+		break;
 	}
-	catch (...)
+	case mcp::validate_result_codes::invalid_block:
+	case mcp::validate_result_codes::parents_and_previous_include_invalid_block:
+	case mcp::validate_result_codes::known_invalid_block:
 	{
-		LOG(m_log.error) << "Block process do_process_one unknown error." << std::endl << boost::stacktrace::stacktrace();
-		timeout_tx.rollback();
-		throw;
+		try_remove_invalid_unhandle(item->block_hash);
+
+		/// Notify capability and P2P to process peer. diconnect peer.  
+		/// must not a local block.remote node id existed.
+		m_onImport(ImportResult::Malformed, item->remote_node_id());
+		break;
+	}
+	default:
+		break;
 	}
 }
 
@@ -902,12 +960,12 @@ void mcp::block_processor::onApproveImported(h256 const& _t)
 
 void mcp::block_processor::before_db_commit_event()
 {
-	m_local_cache->mark_as_changing();
+	m_local_cache->before_commit();
 }
 
 void mcp::block_processor::after_db_commit_event()
 {
-	m_local_cache->commit_and_clear_changing();
+	m_local_cache->after_commit();
 
 	m_chain->update_cache();
 
@@ -927,13 +985,15 @@ std::string mcp::block_processor::get_processor_info()
 	std::string str = "m_blocks_pending:" + std::to_string(m_blocks_pending.size())
 		+ " ,m_local_blocks_pending:" + std::to_string(m_local_blocks_pending.size())
 		+ " ,m_mt_blocks_pending:" + std::to_string(m_mt_blocks_pending.size())
-		+ " ,m_mt_blocks_processing:" + std::to_string(m_mt_blocks_processing.size())
+		+ " ,m_mt_blocks_validating:" + std::to_string(m_mt_blocks_validating) + "/" + std::to_string(m_mt_window)
 		+ " ,m_ok_local_dag_promises:" + std::to_string(m_ok_local_promises.size())
 		+ " ,ok:" + std::to_string(block_processor_add)
 		+ ", invalid:" + std::to_string(InvalidBlockCache.size())
 		+ ", block arrival: " + std::to_string(BlockArrival.arrival.size())
 		+ ", dag_old_size: " + std::to_string(dag_old_size)
 		+ ", base_validate_old_size: " + std::to_string(base_validate_old_size)
+		+ ", " + m_chain->get_stable_pipeline_info()
+		+ ", " + m_local_cache->get_dag_index()->report()
 		;
 
 	return str;
@@ -13,6 +13,7 @@
 #include <mcp/consensus/validation.hpp>
 #include <mcp/common/async_task.hpp>
 #include <mcp/common/alarm.hpp>
+#include <mcp/common/mpmc_queue.hpp>
 
 #include <chrono>
 #include <queue>
@@ -95,12 +96,23 @@ namespace mcp
 	private:
 		void add_item(std::shared_ptr<mcp::block_processor_item> item_a);
 
+		/// block validated by mt validators, handed to add_to_process in received order
+		class mt_validate_job
+		{
+		public:
+			std::shared_ptr<mcp::block_processor_item> item;
+			mcp::validate_status status;
+			std::atomic<bool> done = { false };
+		};
+
 		void mt_process_blocks();
+		void mt_validator();
+		mcp::validate_status mt_validate(mcp::db::db_transaction & transaction_a, std::shared_ptr<mcp::block_processor_item> item_a);
 
 		void process_blocks();
-		bool try_process_local_item_first();
+		bool try_process_local_item_first(mcp::timeout_db_transaction & timeout_tx);
 		void do_process(std::deque<std::shared_ptr<mcp::block_processor_item>>& dag_blocks_processing);
-		void do_process_one(std::shared_ptr<mcp::block_processor_item> item);
+		void do_process_one(mcp::timeout_db_transaction & timeout_tx, std::shared_ptr<mcp::block_processor_item> item);
 		void do_process_dag_item(mcp::timeout_db_transaction & timeout_tx, std::shared_ptr<mcp::block_processor_item> item_a);
 
 		void process_missing(std::shared_ptr<mcp::block_processor_item> item_a, std::unordered_set<mcp::block_hash> const & missings, h256Hash const & transactions, h256Hash const & approves);
@@ -132,9 +144,16 @@ namespace mcp
 		std::mutex m_mt_process_mutex;
 		std::condition_variable m_mt_process_condition;
 		std::deque<std::shared_ptr<mcp::block_processor_item>> m_mt_blocks_pending;
-		std::deque<std::shared_ptr<mcp::block_processor_item>> m_mt_blocks_processing;
 		std::thread m_mt_process_block_thread;
 
+		///validators pull jobs from lock-free queue, each validator reads by its own db transaction
+		mcp::mpmc_queue<std::shared_ptr<mt_validate_job>> m_mt_validate_queue;
+		std::mutex m_mt_validate_mutex;
+		std::condition_variable m_mt_validate_condition;
+		std::vector<std::thread> m_mt_validators;
+		std::atomic<size_t> m_mt_blocks_validating = { 0 };
+		std::atomic<size_t> m_mt_window = { 0 };
+
 		std::mutex m_process_mutex;
 		std::condition_variable m_process_condition;
 		std::deque<std::shared_ptr<mcp::block_processor_item>> m_local_blocks_pending;
@@ -12,11 +12,41 @@
 #include <mcp/node/approve_queue.hpp>
 #include <mcp/consensus/ledger.hpp>
 
+#include <algorithm>
 #include <queue>
+#include <unordered_set>
+
+namespace
+{
+	/// link executed with Permanence::Uncommitted on a worker thread, receipt is nullptr if it threw
+	class speculative_execution
+	{
+	public:
+		std::unique_ptr<mcp::chain_state> state;
+		mcp::ExecutionResult result;
+		std::shared_ptr<dev::eth::TransactionReceipt> receipt;
+	};
+
+	/// stable block waiting for its receipts root to write summary
+	class pending_summary
+	{
+	public:
+		std::shared_ptr<mcp::block> block;
+		std::shared_ptr<mcp::block_state> state;
+		std::future<dev::h256> receipts_root;
+	};
+
+	/// blocks of an mci waiting for summary at most
+	size_t const stable_pipeline_depth = 4;
+
+	/// stable blocks more levels below last stable main chain block are removed from dag index and children kept in memory
+	uint64_t const dag_index_stable_levels = 256;
+}
 
 mcp::chain::chain(mcp::block_store& store_a, std::shared_ptr<mcp::block_cache> cache_a) :
 	m_store(store_a),
 	m_cache(cache_a),
+	m_stable_pipeline(stable_pipeline_depth),
 	m_stopped(false)
 {
 }
@@ -103,7 +133,12 @@ void mcp::chain::init(bool & error_a, mcp::timeout_db_transaction & timeout_tx_a
 	}
 
 	m_last_stable_index_internal = m_store.last_stable_index_get(transaction);
+	uint64_t log_index_from;
+	if (m_store.log_index_from_get(transaction, log_index_from))
+		m_store.log_index_from_put(transaction, m_last_stable_index_internal + 1);
 	m_advance_info = m_store.advance_info_get(transaction);
+	for (mcp::db::forward_iterator it(m_store.dag_free_begin(transaction)); it.valid(); ++it)
+		m_free_blocks.insert(mcp::free_key(it.key()));
 	init_vrf_outputs(transaction);
 	InitWork(transaction, cache_a);
 	m_last_stable_epoch = mcp::epoch(m_last_stable_mci_internal);
@@ -116,6 +151,28 @@ void mcp::chain::stop()
 	m_stopped = true;
 }
 
+void mcp::chain::set_exec_threads(unsigned const & threads_a)
+{
+	if (threads_a > 1)
+		m_parallel_executor = std::make_unique<mcp::parallel_executor>(threads_a);
+	else
+		m_parallel_executor = nullptr;
+}
+
+std::string mcp::chain::get_exec_info()
+{
+	std::stringstream s;
+	s << "exec threads:" << (m_parallel_executor ? m_parallel_executor->threads() : 1)
+		<< " , speculative committed:" << m_speculative_committed
+		<< " , speculative reexecuted:" << m_speculative_reexecuted;
+	return s.str();
+}
+
+std::string mcp::chain::get_stable_pipeline_info()
+{
+	return m_stable_pipeline.get_info();
+}
+
 void mcp::chain::save_dag_block(mcp::timeout_db_transaction & timeout_tx_a, std::shared_ptr<mcp::process_block_cache> cache_a, std::shared_ptr<mcp::block> block_a)
 {
 	if (m_stopped)
@@ -137,11 +194,9 @@ void mcp::chain::save_dag_block(mcp::timeout_db_transaction & timeout_tx_a, std:
 			{
 				//mcp::stopwatch_guard sw("save_block:best_free");
 
-				///search best free block by witnessed_level desc, level asc, block hash asc
-				mcp::db::forward_iterator free_iter(m_store.dag_free_begin(transaction));
-				assert_x(free_iter.valid());
-				mcp::free_key free_key(free_iter.key());
-				best_free_block_hash = free_key.hash_asc;
+				///best free block by witnessed_level desc, level desc, block hash asc
+				assert_x(!m_free_blocks.empty());
+				best_free_block_hash = m_free_blocks.begin()->hash_asc;
 
 				if (best_free_block_hash == mcp::genesis::block_hash) //genesis block
 					return;
@@ -487,7 +542,7 @@ void mcp::chain::try_advance(mcp::timeout_db_transaction & timeout_tx_a, std::sh
 		{
 			m_store.last_stable_mci_put(transaction, m_last_stable_mci_internal);
 			mcp::block_hash mc_stable_hash;
-			bool mc_stable_hash_error(m_store.main_chain_get(transaction, m_last_stable_mci_internal, mc_stable_hash));
+			bool mc_stable_hash_error(main_chain_get(transaction, m_last_stable_mci_internal, mc_stable_hash));
 			assert_x(!mc_stable_hash_error);
 			auto mc_stable_block = cache_a->block_get(transaction, mc_stable_hash);
 			assert_x(mc_stable_block);
@@ -496,6 +551,15 @@ void mcp::chain::try_advance(mcp::timeout_db_transaction & timeout_tx_a, std::sh
 			assert_x(min_retrievable_state->main_chain_index);
 			m_min_retrievable_mci_internal = *min_retrievable_state->main_chain_index;
 
+			///consensus walks few levels below stable main chain, pruned blocks are loaded again if walked
+			auto mc_stable_state = cache_a->block_state_get(transaction, mc_stable_hash);
+			assert_x(mc_stable_state);
+			if (mc_stable_state->level > dag_index_stable_levels)
+			{
+				cache_a->get_dag_index()->prune(mc_stable_state->level - dag_index_stable_levels);
+				prune_dag_memory(mc_stable_state->level - dag_index_stable_levels);
+			}
+
 			/// send approve if witness
 			m_onMciStable(m_last_stable_mci_internal);
 
@@ -516,6 +580,93 @@ void mcp::chain::try_advance(mcp::timeout_db_transaction & timeout_tx_a, std::sh
 	}
 }
 
+bool mcp::chain::main_chain_get(mcp::db::db_transaction & transaction_a, uint64_t const & mci_a, mcp::block_hash & hash_a)
+{
+	auto it(m_unstable_main_chain.find(mci_a));
+	if (it == m_unstable_main_chain.end())
+		return m_store.main_chain_get(transaction_a, mci_a, hash_a);
+
+	hash_a = it->second;
+	return false;
+}
+
+void mcp::chain::block_children_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & hash_a, std::list<mcp::block_hash> & children_a)
+{
+	///block written before start may have children not in memory
+	auto it(m_children.find(hash_a));
+	if (it == m_children.end())
+	{
+		m_store.block_children_get(transaction_a, hash_a, children_a);
+		return;
+	}
+	children_a.insert(children_a.end(), it->second.begin(), it->second.end());
+}
+
+bool mcp::chain::dag_memory_consistent(mcp::db::db_transaction & transaction_a)
+{
+	bool result(true);
+
+	auto f_it(m_free_blocks.begin());
+	for (mcp::db::forward_iterator it(m_store.dag_free_begin(transaction_a)); it.valid(); ++it, ++f_it)
+	{
+		mcp::free_key key(it.key());
+		if (f_it == m_free_blocks.end() || !(*f_it == key))
+		{
+			LOG(m_log.error) << "Free block differs from dag free table: " << key.hash_asc.hex();
+			return false;
+		}
+	}
+	if (f_it != m_free_blocks.end())
+	{
+		LOG(m_log.error) << "Free block not in dag free table: " << f_it->hash_asc.hex();
+		return false;
+	}
+
+	for (auto const & mc : m_unstable_main_chain)
+	{
+		mcp::block_hash hash;
+		if (mc.first > m_last_mci_internal || m_store.main_chain_get(transaction_a, mc.first, hash) || hash != mc.second)
+		{
+			LOG(m_log.error) << "Main chain block differs from main chain table, mci: " << mc.first;
+			result = false;
+		}
+	}
+	mcp::block_hash hash;
+	if (!m_store.main_chain_get(transaction_a, m_last_mci_internal + 1, hash))
+	{
+		LOG(m_log.error) << "Main chain table has block after last mci: " << hash.hex();
+		result = false;
+	}
+
+	for (auto const & c : m_children)
+	{
+		std::list<mcp::block_hash> children;
+		m_store.block_children_get(transaction_a, c.first, children);
+		std::unordered_set<mcp::block_hash> stored(children.begin(), children.end());
+		if (stored.size() != c.second.size()
+			|| !std::all_of(c.second.begin(), c.second.end(), [&stored](mcp::block_hash const & h) { return stored.count(h) > 0; }))
+		{
+			LOG(m_log.error) << "Children differ from block child table: " << c.first.hex();
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+void mcp::chain::prune_dag_memory(uint64_t const & level_a)
+{
+	m_unstable_main_chain.erase(m_unstable_main_chain.begin(), m_unstable_main_chain.lower_bound(m_last_stable_mci_internal));
+
+	auto end(m_children_levels.lower_bound(level_a));
+	for (auto it(m_children_levels.begin()); it != end; it++)
+	{
+		for (mcp::block_hash const & hash : it->second)
+			m_children.erase(hash);
+	}
+	m_children_levels.erase(m_children_levels.begin(), end);
+}
+
 bool mcp::chain::IsStakingList(mcp::db::db_transaction & _transaction, Epoch const& _epoch, dev::Address const & _address)
 {
 	auto sl = m_cache->GetStakingList(_transaction, _epoch);
@@ -553,11 +704,15 @@ void mcp::chain::write_dag_block(mcp::db::db_transaction & transaction_a, std::s
 			///remove parent block from dag free
 			mcp::free_key f_key(pblock_state->witnessed_level, pblock_state->level, pblock_hash);
 			m_store.dag_free_del(transaction_a, f_key);
+			m_free_blocks.erase(f_key);
 		}
 
 		{
 			//save child
 			m_store.block_child_put(transaction_a, mcp::block_child_key(pblock_hash, block_hash));
+			auto c_it(m_children.find(pblock_hash));
+			if (c_it != m_children.end())
+				c_it->second.push_back(block_hash);
 		}
 	}
 
@@ -585,6 +740,10 @@ void mcp::chain::write_dag_block(mcp::db::db_transaction & transaction_a, std::s
 	cache_a->block_state_put(transaction_a, block_hash, state);
 
 	m_store.dag_free_put(transaction_a, mcp::free_key(witnessed_level, level, block_hash));
+	m_free_blocks.insert(mcp::free_key(witnessed_level, level, block_hash));
+
+	m_children.emplace(block_hash, std::vector<mcp::block_hash>());
+	m_children_levels[level].push_back(block_hash);
 }
 
 
@@ -592,23 +751,22 @@ void mcp::chain::find_main_chain_changes(mcp::db::db_transaction & transaction_a
 	bool & is_mci_retreat, uint64_t &retreat_mci, uint64_t &retreat_level, std::list<mcp::block_hash> &new_mc_block_hashs)
 {
 	uint64_t old_last_mci(m_last_mci_internal);
-	mcp::block_hash prev_mc_block_hash(best_free_block_hash);
-	std::shared_ptr<mcp::block_state> prev_mc_block_state(cache_a->block_state_get(transaction_a, prev_mc_block_hash));
-	assert_x(prev_mc_block_state);
+	std::shared_ptr<mcp::dag_index> index(cache_a->get_dag_index());
+	uint32_t prev_mc_id(index->node(transaction_a, *cache_a, best_free_block_hash));
 
-	while (!prev_mc_block_state->is_on_main_chain)
+	///best parent chain is walked in dag index, new block mostly extends main chain by one
+	while (!index->is_on_main_chain(prev_mc_id))
 	{
-		new_mc_block_hashs.push_front(prev_mc_block_hash);
+		new_mc_block_hashs.push_front(index->hash(prev_mc_id));
 
 		///get previous best parent block
-		prev_mc_block_hash = prev_mc_block_state->best_parent;
-		prev_mc_block_state = cache_a->block_state_get(transaction_a, prev_mc_block_hash);
-		assert_x(prev_mc_block_state);
+		prev_mc_id = index->best_parent(transaction_a, *cache_a, prev_mc_id);
+		assert_x(prev_mc_id != mcp::dag_index::none);
 	}
-	assert_x(prev_mc_block_state->main_chain_index);
+	assert_x(index->mci(prev_mc_id) != mcp::dag_index::no_mci);
 
-	retreat_mci = *prev_mc_block_state->main_chain_index;
-	retreat_level = prev_mc_block_state->level;
+	retreat_mci = index->mci(prev_mc_id);
+	retreat_level = index->level(prev_mc_id);
 	is_mci_retreat = retreat_mci < old_last_mci;
 
 	///check stable mci not retreat
@@ -634,7 +792,7 @@ void mcp::chain::update_mci(mcp::db::db_transaction & transaction_a, std::shared
 			break;
 
 		mcp::block_hash old_last_mc_block_hash;
-		bool mc_exists(!m_store.main_chain_get(transaction_a, old_mci, old_last_mc_block_hash));
+		bool mc_exists(!main_chain_get(transaction_a, old_mci, old_last_mc_block_hash));
 		assert_x(mc_exists);
 
 		std::shared_ptr<mcp::block_state> old_mci_block_state_in_cache(cache_a->block_state_get(transaction_a, old_last_mc_block_hash));
@@ -649,6 +807,7 @@ void mcp::chain::update_mci(mcp::db::db_transaction & transaction_a, std::shared
 
 		///delete old main chian block
 		m_store.main_chain_del(transaction_a, old_mci);
+		m_unstable_main_chain.erase(old_mci);
 
 		old_mci--;
 	}
@@ -677,6 +836,7 @@ void mcp::chain::update_mci(mcp::db::db_transaction & transaction_a, std::shared
 		cache_a->block_state_put(transaction_a, new_mc_block_hash, new_mc_block_state_copy);
 
 		m_store.main_chain_put(transaction_a, new_mci, new_mc_block_hash);
+		m_unstable_main_chain[new_mci] = new_mc_block_hash;
 	}
 
 #pragma endregion
@@ -691,6 +851,7 @@ void mcp::chain::update_latest_included_mci(mcp::db::db_transaction & transactio
 {
 	bool is_curr_block_set(false);
 	mcp::block_hash block_hash(block_a->hash());
+	std::shared_ptr<mcp::dag_index> index(cache_a->get_dag_index());
 
 	std::map<uint64_t, std::unordered_set<mcp::block_hash>> to_update_hashs;
 	if (is_mci_retreat)
@@ -699,7 +860,7 @@ void mcp::chain::update_latest_included_mci(mcp::db::db_transaction & transactio
 			//mcp::stopwatch_guard sw2("update_latest_included_mci1");
 
 			mcp::block_hash retreat_mci_block_hash;
-			bool error(m_store.main_chain_get(transaction_a, retreat_mci, retreat_mci_block_hash));
+			bool error(main_chain_get(transaction_a, retreat_mci, retreat_mci_block_hash));
 			assert_x(!error);
 			std::queue<mcp::block_hash> to_search_child_hashs;
 			to_search_child_hashs.push(retreat_mci_block_hash);
@@ -710,17 +871,13 @@ void mcp::chain::update_latest_included_mci(mcp::db::db_transaction & transactio
 				to_search_child_hashs.pop();
 
 				std::shared_ptr<std::list<mcp::block_hash>> child_hashs(std::make_shared<std::list<mcp::block_hash>>());
-				m_store.block_children_get(transaction_a, p_hash, *child_hashs);
+				block_children_get(transaction_a, p_hash, *child_hashs);
 				for (auto it(child_hashs->begin()); it != child_hashs->end(); it++)
 				{
 					mcp::block_hash const &child_hash(*it);
-					std::shared_ptr<mcp::block> child_block(cache_a->block_get(transaction_a, child_hash));
-					assert_x(child_block);
-
-					std::shared_ptr<mcp::block_state> child_state(cache_a->block_state_get(transaction_a, child_hash));
-					assert_x(child_state);
+					uint32_t child_id(index->node(transaction_a, *cache_a, child_hash));
 
-					auto r = to_update_hashs[child_state->level].insert(child_hash);
+					auto r = to_update_hashs[index->level(child_id)].insert(child_hash);
 					if (r.second)
 						to_search_child_hashs.push(child_hash);
 				}
@@ -761,51 +918,53 @@ void mcp::chain::update_latest_included_mci(mcp::db::db_transaction & transactio
 
 				if (!u_block_state_copy->main_chain_index || (*u_block_state_copy->main_chain_index) > retreat_mci)
 				{
-					std::shared_ptr<mcp::block> u_block = cache_a->block_get(transaction_a, u_block_hash);
-					assert_x(u_block != nullptr);
+					///parents are read from dag index, their states written before in this loop are updated there
+					uint32_t u_id(index->node(transaction_a, *cache_a, u_block_hash));
+					index->link(transaction_a, *cache_a, u_id);
+					uint32_t u_bp_id(index->best_parent(transaction_a, *cache_a, u_id));
+					std::vector<uint32_t> const & u_pblock_ids(index->parents(u_id));
 
 					boost::optional<uint64_t> min_limci;
 					boost::optional<uint64_t> max_limci;
 					boost::optional<uint64_t> bp_limci;
-					auto const &u_pblock_hashs(u_block->parents());
-					for (mcp::block_hash const &u_pblock_hash : u_pblock_hashs)
+					for (uint32_t const & u_pblock_id : u_pblock_ids)
 					{
-						std::shared_ptr<mcp::block_state> u_pblock_state(cache_a->block_state_get(transaction_a, u_pblock_hash));
-						assert_x(u_pblock_state);
-
-						if (u_pblock_state->is_on_main_chain)
+						if (index->is_on_main_chain(u_pblock_id))
 						{
-							assert_x(u_pblock_state->main_chain_index);
+							uint64_t const p_mci(index->mci(u_pblock_id));
+							assert_x(p_mci != mcp::dag_index::no_mci);
 
-							if (!min_limci || *min_limci > *u_pblock_state->main_chain_index)
-								min_limci = u_pblock_state->main_chain_index;
+							if (!min_limci || *min_limci > p_mci)
+								min_limci = p_mci;
 
-							if (!max_limci || *max_limci < *u_pblock_state->main_chain_index)
-								max_limci = u_pblock_state->main_chain_index;
+							if (!max_limci || *max_limci < p_mci)
+								max_limci = p_mci;
 						}
 						else
 						{
-							assert_x(u_pblock_state->latest_included_mc_index);
+							uint64_t const p_eimci(index->earliest_included_mci(u_pblock_id));
+							uint64_t const p_limci(index->latest_included_mci(u_pblock_id));
+							assert_x(p_limci != mcp::dag_index::no_mci);
 
-							if (!min_limci || *min_limci > *u_pblock_state->earliest_included_mc_index)
-								min_limci = u_pblock_state->earliest_included_mc_index;
+							if (!min_limci || *min_limci > p_eimci)
+								min_limci = p_eimci;
 
-							if (!max_limci || *max_limci < *u_pblock_state->latest_included_mc_index)
-								max_limci = u_pblock_state->latest_included_mc_index;
+							if (!max_limci || *max_limci < p_limci)
+								max_limci = p_limci;
 						}
 
 						///best parent limci
-						if (u_pblock_hash == u_block_state_copy->best_parent)
+						if (u_pblock_id == u_bp_id)
 						{
-							if (u_pblock_state->is_on_main_chain)
+							if (index->is_on_main_chain(u_pblock_id))
 							{
-								assert_x(u_pblock_state->main_chain_index);
-								bp_limci = u_pblock_state->main_chain_index;
+								assert_x(index->mci(u_pblock_id) != mcp::dag_index::no_mci);
+								bp_limci = index->mci(u_pblock_id);
 							}
 							else
 							{
-								assert_x(u_pblock_state->bp_included_mc_index);
-								bp_limci = u_pblock_state->bp_included_mc_index;
+								assert_x(index->bp_included_mci(u_pblock_id) != mcp::dag_index::no_mci);
+								bp_limci = index->bp_included_mci(u_pblock_id);
 							}
 						}
 					}
@@ -815,22 +974,21 @@ void mcp::chain::update_latest_included_mci(mcp::db::db_transaction & transactio
 
 					boost::optional<uint64_t> min_bp_limci = bp_limci;
 					boost::optional<uint64_t> max_bp_limci = bp_limci;
-					for (mcp::block_hash const &u_pblock_hash : u_pblock_hashs)
+					for (uint32_t const & u_pblock_id : u_pblock_ids)
 					{
-						std::shared_ptr<mcp::block_state> u_pblock_state(cache_a->block_state_get(transaction_a, u_pblock_hash));
-						assert_x(u_pblock_state);
-
-						if (!u_pblock_state->is_on_main_chain)
+						if (!index->is_on_main_chain(u_pblock_id))
 						{
-							assert_x(u_pblock_state->latest_bp_included_mc_index);
+							uint64_t const p_lbpimci(index->latest_bp_included_mci(u_pblock_id));
+							assert_x(p_lbpimci != mcp::dag_index::no_mci);
 							///max_bp_limci
-							if (*max_bp_limci < *u_pblock_state->latest_bp_included_mc_index)
-								max_bp_limci = u_pblock_state->latest_bp_included_mc_index;
+							if (*max_bp_limci < p_lbpimci)
+								max_bp_limci = p_lbpimci;
 
-							assert_x(u_pblock_state->earliest_bp_included_mc_index);
+							uint64_t const p_ebpimci(index->earliest_bp_included_mci(u_pblock_id));
+							assert_x(p_ebpimci != mcp::dag_index::no_mci);
 							///min_bp_limci
-							if (*min_bp_limci > *u_pblock_state->earliest_bp_included_mc_index)
-								min_bp_limci = u_pblock_state->earliest_bp_included_mc_index;
+							if (*min_bp_limci > p_ebpimci)
+								min_bp_limci = p_ebpimci;
 						}
 					}
 
@@ -856,7 +1014,7 @@ void mcp::chain::advance_stable_mci(mcp::timeout_db_transaction & timeout_tx_a,
 	mcp::db::db_transaction & transaction_a(timeout_tx_a.get_transaction());
 
 	mcp::block_hash mc_stable_hash;
-	bool mc_stable_hash_error(m_store.main_chain_get(transaction_a, mci, mc_stable_hash));
+	bool mc_stable_hash_error(main_chain_get(transaction_a, mci, mc_stable_hash));
 	assert_x(!mc_stable_hash_error);
 
 	std::map<uint64_t, std::set<mcp::block_hash>> dag_stable_block_hashs; //order by block level and hash
@@ -876,10 +1034,33 @@ void mcp::chain::advance_stable_mci(mcp::timeout_db_transaction & timeout_tx_a,
 	uint64_t const & stable_timestamp = block_to_advance->exec_timestamp();
 	uint64_t const & mc_timestamp = mc_stable_block->exec_timestamp();
 
+	///blocks are immutable, read all stable blocks of this mci by one batch
+	std::vector<mcp::block_hash> dag_stable_block_list;
+	for (auto iter_p(dag_stable_block_hashs.begin()); iter_p != dag_stable_block_hashs.end(); iter_p++)
+		dag_stable_block_list.insert(dag_stable_block_list.end(), iter_p->second.begin(), iter_p->second.end());
+	std::vector<std::shared_ptr<mcp::block>> dag_stable_blocks;
+	cache_a->blocks_get(transaction_a, dag_stable_block_list, dag_stable_blocks);
+
+	///receipts root of a block is built on pipeline thread while next block is executed,
+	///summaries are written in stable order, a summary reads summaries of its previous and parents.
+	std::deque<pending_summary> pending_summaries;
+	auto write_summary = [&]()
+	{
+		pending_summary & pending(pending_summaries.front());
+		h256 receiptsRoot(pending.receipts_root.get());
+		{
+			mcp::stable_pipeline_timer timer(m_stable_pipeline, mcp::stable_pipeline::stage::persist);
+			set_block_summary(timeout_tx_a, cache_a, pending.block, pending.state, receiptsRoot);
+		}
+		pending_summaries.pop_front();
+		m_stable_pipeline.set_pending(pending_summaries.size());
+	};
+
+	size_t dag_stable_block_index(0);
 	for (auto iter_p(dag_stable_block_hashs.begin()); iter_p != dag_stable_block_hashs.end(); iter_p++)
 	{
 		std::set<mcp::block_hash> const & hashs(iter_p->second);
-		for (auto iter(hashs.begin()); iter != hashs.end(); iter++)
+		for (auto iter(hashs.begin()); iter != hashs.end(); iter++, dag_stable_block_index++)
 		{
 			mcp::block_hash const & dag_stable_block_hash(*iter);
 
@@ -887,11 +1068,14 @@ void mcp::chain::advance_stable_mci(mcp::timeout_db_transaction & timeout_tx_a,
 
 			m_last_stable_index_internal++;
 			std::vector<bytes> receipts;
+			///receipts of links executed by this block, logs are indexed by it
+			std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> executed_receipts;
 			{
 				//mcp::stopwatch_guard sw("advance_stable_mci2_1");
+				mcp::stable_pipeline_timer timer(m_stable_pipeline, mcp::stable_pipeline::stage::execute);
 
 				///handle dag stable block 
-				std::shared_ptr<mcp::block> dag_stable_block = cache_a->block_get(transaction_a, dag_stable_block_hash);
+				std::shared_ptr<mcp::block> dag_stable_block = dag_stable_blocks[dag_stable_block_index];
 				assert_x(dag_stable_block);
 
 				///handle light stable block 
@@ -899,11 +1083,49 @@ void mcp::chain::advance_stable_mci(mcp::timeout_db_transaction & timeout_tx_a,
 				///account B : b1, b2, b3
 				///account c : b2, b3
 				auto links(dag_stable_block->links());
+
+				///receipts must be read after previous blocks executed, so batch per block.
+				///transactions only needed for links without receipt
+				std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> link_receipts;
+				cache_a->transaction_receipts_get(transaction_a, links, link_receipts);
+				std::vector<h256> unexecuted_links;
+				for (auto i = 0; i < links.size(); i++)
+				{
+					if (!link_receipts[i])
+						unexecuted_links.push_back(links[i]);
+				}
+				std::vector<std::shared_ptr<mcp::Transaction>> unexecuted_transactions;
+				cache_a->transactions_get(transaction_a, unexecuted_links, unexecuted_transactions);
+				std::vector<std::shared_ptr<mcp::Transaction>> link_transactions(links.size());
+				for (auto i = 0, j = 0; i < links.size(); i++)
+				{
+					if (!link_receipts[i])
+						link_transactions[i] = unexecuted_transactions[j++];
+				}
+				///links without receipt are executed once, linked twice in this block reads receipt of first
+				std::vector<size_t> exec_indexs;
+				std::vector<std::shared_ptr<mcp::Transaction>> exec_transactions;
+				std::unordered_set<h256> executed_links;
+				for (auto i = 0; i < links.size(); i++)
+				{
+					if (!link_receipts[i] && executed_links.insert(links[i]).second)
+					{
+						exec_indexs.push_back(i);
+						exec_transactions.push_back(link_transactions[i]);
+					}
+				}
+				dev::eth::McInfo mc_info(m_last_stable_index_internal, mci, mc_timestamp, mc_last_summary_mci);
+				std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> exec_receipts(execute_links(transaction_a, cache_a, mc_info, exec_transactions));
+
 				unsigned index = 0;
+				size_t exec_index = 0;
 				for (auto i = 0; i < links.size(); i++)
 				{
 					h256 const& link_hash = links[i];
-					auto receipt = cache_a->transaction_receipt_get(transaction_a, link_hash);
+					auto receipt = link_receipts[i];
+					bool const executed(exec_index < exec_indexs.size() && exec_indexs[exec_index] == i);
+					if (!receipt && !executed)/// linked twice in this block, executed above
+						receipt = cache_a->transaction_receipt_get(transaction_a, link_hash);
 					if (receipt)/// transaction maybe processed yet,but summary need used receipt even if it has been processed.
 					{
 						RLPStream receiptRLP;
@@ -913,53 +1135,19 @@ void mcp::chain::advance_stable_mci(mcp::timeout_db_transaction & timeout_tx_a,
 						index++;
 						continue;
 					}
-					auto _t = cache_a->transaction_get(transaction_a, link_hash);
-					/// exec transactions
-					bool invalid = false;
-					try
-					{
-						dev::eth::McInfo mc_info(m_last_stable_index_internal, mci, mc_timestamp, mc_last_summary_mci);
-						//mcp::stopwatch_guard sw("set_block_stable2_1");
-						std::pair<ExecutionResult, dev::eth::TransactionReceipt> result = execute(transaction_a, cache_a, *_t, mc_info, Permanence::Committed, dev::eth::OnOpFunc());
 
+					receipt = exec_receipts[exec_index++];
+					if (receipt)
+					{
 						/// commit transaction receipt
 						/// the account states were committed in Executive::go()
-						cache_a->transaction_receipt_put(transaction_a, link_hash, std::make_shared<dev::eth::TransactionReceipt>(result.second));
+						cache_a->transaction_receipt_put(transaction_a, link_hash, receipt);
+						executed_receipts.push_back(receipt);
 						RLPStream receiptRLP;
-						result.second.streamRLP(receiptRLP);
+						receipt->streamRLP(receiptRLP);
 						receipts.push_back(receiptRLP.out());
 					}
-					catch (dev::eth::NotEnoughCash const& _e)
-					{
-						LOG(m_log.info) << "transaction exec not enough cash,hash: " << _t->sha3().hex()
-							<< ", from: " << dev::toJS(_t->sender())
-							<< ", to: " << dev::toJS(_t->to())
-							<< ", value: " << _t->value();
-						invalid = true;
-					}
-					catch (dev::eth::InvalidNonce const& _e)
-					{
-						LOG(m_log.info) << "transaction exec not expect nonce,hash: " << _t->sha3().hexPrefixed()
-							<< ", from: " << dev::toJS(_t->sender())
-							<< ", to: " << dev::toJS(_t->to())
-							<< ", value: " << _t->value();
-						invalid = true;
-					}
-					//catch (Exception const& _e)
-					//{
-					//	cerror << "Unexpected exception in VM. There may be a bug in this implementation. "
-					//		<< diagnostic_information(_e);
-					//	exit(1);
-					//}
-					catch (std::exception const& _e)
-					{
-						std::cerr << _e.what() << std::endl;
-						throw;
-					}
-
-					//LOG(m_log.info) << "exec transaction,hash: " << link_hash.hexPrefixed() << " ,nonce:" << _t->nonce();
-
-					if (invalid)
+					else
 					{
 						TransactionReceipt const receipt = TransactionReceipt(0, 0, mcp::log_entries());
 						cache_a->transaction_receipt_put(transaction_a, link_hash, std::make_shared<dev::eth::TransactionReceipt>(receipt));
@@ -1037,25 +1225,126 @@ void mcp::chain::advance_stable_mci(mcp::timeout_db_transaction & timeout_tx_a,
 				}
 			}
 
-			/// set block stable
+			/// set block stable, summary is written when receipts root is ready
 			{
-				h256 receiptsRoot = dev::orderedTrieRoot(receipts);
 				//mcp::stopwatch_guard sw("advance_stable_mci2_2");
-				set_block_stable(timeout_tx_a, cache_a, dag_stable_block_hash, mci, mc_timestamp, mc_last_summary_mci, stable_timestamp, m_last_stable_index_internal, receiptsRoot);
+				std::shared_ptr<mcp::block> const & dag_stable_block(dag_stable_blocks[dag_stable_block_index]);
+				pending_summary pending;
+				{
+					mcp::stable_pipeline_timer timer(m_stable_pipeline, mcp::stable_pipeline::stage::persist);
+					pending.state = set_block_stable(timeout_tx_a, cache_a, dag_stable_block, mci, mc_timestamp, mc_last_summary_mci, stable_timestamp, m_last_stable_index_internal, executed_receipts);
+				}
+				pending.block = dag_stable_block;
+				pending.receipts_root = m_stable_pipeline.receipts_root(std::move(receipts));
+				pending_summaries.push_back(std::move(pending));
+				m_stable_pipeline.set_pending(pending_summaries.size());
+
+				if (pending_summaries.size() > m_stable_pipeline.depth())
+					write_summary();
+			}
+		}
+	}
+
+	while (!pending_summaries.empty())
+		write_summary();
+}
+
+std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> mcp::chain::execute_links(mcp::db::db_transaction & transaction_a, std::shared_ptr<mcp::process_block_cache> cache_a, dev::eth::McInfo const & mc_info_a, std::vector<std::shared_ptr<mcp::Transaction>> const & transactions_a)
+{
+	///execute speculatively on worker threads, commit below in order.
+	///earlier blocks of this mci are written in transaction_a only, so workers read it too,
+	///reads of transaction_a, store and cache_a are serialized, execution runs concurrently.
+	std::mutex speculative_read_mutex;
+	std::vector<std::shared_ptr<speculative_execution>> speculations(transactions_a.size());
+	if (m_parallel_executor && transactions_a.size() > 1)
+	{
+		for (auto & speculation : speculations)
+			speculation = std::make_shared<speculative_execution>();
+
+		auto chain_ptr(shared_from_this());
+		m_parallel_executor->run(transactions_a.size(), [&](size_t const & i)
+		{
+			std::shared_ptr<speculative_execution> speculation(speculations[i]);
+			try
+			{
+				dev::eth::EnvInfo env(transaction_a, m_store, cache_a, mc_info_a, mcp::chainID());
+				speculation->state = std::make_unique<mcp::chain_state>(transaction_a, 0, m_store, chain_ptr, cache_a);
+				speculation->state->set_read_mutex(&speculative_read_mutex);
+				auto result = speculation->state->execute(env, Permanence::Uncommitted, *transactions_a[i], dev::eth::OnOpFunc());
+				speculation->result = result.first;
+				speculation->receipt = std::make_shared<dev::eth::TransactionReceipt>(result.second);
 			}
+			catch (...)
+			{
+				///re-execute in order, exceptions are handled same as serial execution
+				speculation->receipt = nullptr;
+			}
+		});
+	}
+	mcp::optimistic_batch batch;
+
+	std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> receipts(transactions_a.size());
+	for (size_t i = 0; i < transactions_a.size(); i++)
+	{
+		auto _t = transactions_a[i];
+		try
+		{
+			std::shared_ptr<speculative_execution> speculation(speculations[i]);
+			if (speculation && speculation->receipt && batch.valid(speculation->state->accessed()))
+			{
+				speculation->state->commitExecution(speculation->result);
+				batch.commit(speculation->state->accessed());
+				receipts[i] = speculation->receipt;
+				m_speculative_committed++;
+			}
+			else if (m_parallel_executor)
+			{
+				dev::eth::EnvInfo env(transaction_a, m_store, cache_a, mc_info_a, mcp::chainID());
+				chain_state c_state(transaction_a, 0, m_store, shared_from_this(), cache_a);
+				std::pair<ExecutionResult, dev::eth::TransactionReceipt> result = c_state.execute(env, Permanence::Committed, *_t, dev::eth::OnOpFunc());
+				batch.commit(c_state.accessed());
+				receipts[i] = std::make_shared<dev::eth::TransactionReceipt>(result.second);
+				if (speculation)
+					m_speculative_reexecuted++;
+			}
+			else
+			{
+				std::pair<ExecutionResult, dev::eth::TransactionReceipt> result = execute(transaction_a, cache_a, *_t, mc_info_a, Permanence::Committed, dev::eth::OnOpFunc());
+				receipts[i] = std::make_shared<dev::eth::TransactionReceipt>(result.second);
+			}
+		}
+		catch (dev::eth::NotEnoughCash const& _e)
+		{
+			LOG(m_log.info) << "transaction exec not enough cash,hash: " << _t->sha3().hex()
+				<< ", from: " << dev::toJS(_t->sender())
+				<< ", to: " << dev::toJS(_t->to())
+				<< ", value: " << _t->value();
+		}
+		catch (dev::eth::InvalidNonce const& _e)
+		{
+			LOG(m_log.info) << "transaction exec not expect nonce,hash: " << _t->sha3().hexPrefixed()
+				<< ", from: " << dev::toJS(_t->sender())
+				<< ", to: " << dev::toJS(_t->to())
+				<< ", value: " << _t->value();
+		}
+		catch (std::exception const& _e)
+		{
+			std::cerr << _e.what() << std::endl;
+			throw;
 		}
 	}
+	return receipts;
 }
 
-void mcp::chain::set_block_stable(mcp::timeout_db_transaction & timeout_tx_a, std::shared_ptr<mcp::process_block_cache> cache_a, mcp::block_hash const & stable_block_hash, 
+std::shared_ptr<mcp::block_state> mcp::chain::set_block_stable(mcp::timeout_db_transaction & timeout_tx_a, std::shared_ptr<mcp::process_block_cache> cache_a, std::shared_ptr<mcp::block> stable_block, 
 	uint64_t const & mci, uint64_t const & mc_timestamp, uint64_t const & mc_last_summary_mci, 
-	uint64_t const & stable_timestamp, uint64_t const & stable_index, h256 receiptsRoot)
+	uint64_t const & stable_timestamp, uint64_t const & stable_index, std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> const & receipts_a)
 {
 	mcp::db::db_transaction & transaction_a(timeout_tx_a.get_transaction());
 	try
 	{
-		std::shared_ptr<mcp::block> stable_block(cache_a->block_get(transaction_a, stable_block_hash));
 		assert_x(stable_block);
+		mcp::block_hash const & stable_block_hash(stable_block->hash());
 
 		std::shared_ptr<mcp::block_state> stable_block_state_in_cache(cache_a->block_state_get(transaction_a, stable_block_hash));
 		assert_x(stable_block_state_in_cache);
@@ -1124,7 +1413,59 @@ void mcp::chain::set_block_stable(mcp::timeout_db_transaction & timeout_tx_a, st
 			//m_store.stable_block_put(transaction_a, stable_index, stable_block_hash);
 			cache_a->block_number_put(transaction_a, stable_index, stable_block_hash);
 			m_store.last_stable_index_put(transaction_a, stable_index);
+			put_log_index(transaction_a, stable_index, receipts_a);
+
+			///Statistical witness block
+			///if fork, this block was sent much later than the other nodes, invalid.
+			m_statistics.Insert(stable_block->from(), stable_block_state_copy->is_on_main_chain);
+		}
+
+		//m_stable_blocks.push(stable_block);
+		return stable_block_state_copy;
+	}
+	catch (std::exception const & e)
+	{
+		LOG(m_log.error) << "Chain Set block stable error: " << e.what();
+		throw;
+	}
+}
+
+void mcp::chain::put_log_index(mcp::db::db_transaction & transaction_a, uint64_t const & stable_index_a, std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> const & receipts_a)
+{
+	///one posting per address or topic of this block, exact logs are matched by receipts when queried
+	std::set<std::pair<uint8_t, h256>> values;
+	log_bloom bloom;
+	for (auto const & receipt : receipts_a)
+	{
+		for (log_entry const & e : receipt->log())
+		{
+			bloom |= e.bloom();
+			values.insert(std::make_pair((uint8_t)mcp::log_index_kind::address, mcp::log_index_key::address_value(e.address)));
+			for (size_t i = 0; i < e.topics.size() && i < 4; i++)
+				values.insert(std::make_pair((uint8_t)((uint8_t)mcp::log_index_kind::topic + i), e.topics[i]));
+		}
+	}
+	if (values.empty())
+		return;
 
+	for (auto const & v : values)
+		m_store.log_index_put(transaction_a, mcp::log_index_key(v.first, v.second, stable_index_a));
+
+	uint64_t section(stable_index_a / mcp::LogBloomSectionSize);
+	log_bloom section_bloom;
+	m_store.log_bloom_get(transaction_a, section, section_bloom);
+	section_bloom |= bloom;
+	m_store.log_bloom_put(transaction_a, section, section_bloom);
+}
+
+void mcp::chain::set_block_summary(mcp::timeout_db_transaction & timeout_tx_a, std::shared_ptr<mcp::process_block_cache> cache_a, std::shared_ptr<mcp::block> stable_block, 
+	std::shared_ptr<mcp::block_state> stable_block_state_copy, h256 const & receiptsRoot)
+{
+	mcp::db::db_transaction & transaction_a(timeout_tx_a.get_transaction());
+	try
+	{
+		mcp::block_hash const & stable_block_hash(stable_block->hash());
+		{
 #pragma region summary
 
 			///previous summary hash
@@ -1178,17 +1519,11 @@ void mcp::chain::set_block_stable(mcp::timeout_db_transaction & timeout_tx_a, st
 			m_store.PutBlockReceiptsRoot(transaction_a, stable_block_hash, receiptsRoot);
 
 #pragma endregion
-
-			///Statistical witness block
-			///if fork, this block was sent much later than the other nodes, invalid.
-			m_statistics.Insert(stable_block->from(), stable_block_state_copy->is_on_main_chain);
 		}
-
-		//m_stable_blocks.push(stable_block);
 	}
 	catch (std::exception const & e)
 	{
-		LOG(m_log.error) << "Chain Set block stable error: " << e.what();
+		LOG(m_log.error) << "Chain Set block summary error: " << e.what();
 		throw;
 	}
 }
@@ -8,6 +8,8 @@
 #include <set>
 #include <queue>
 #include <mcp/node/chain_state.hpp>
+#include <mcp/node/parallel_executor.hpp>
+#include <mcp/node/stable_pipeline.hpp>
 #include <mcp/node/sync.hpp>
 #include <mcp/core/approve_receipt.hpp>
 
@@ -62,10 +64,17 @@ namespace mcp
 		void stop();
 
 		void set_TQ(std::shared_ptr<mcp::TransactionQueue> tq) { m_tq = tq; }
+		/// execute transactions of stable blocks speculatively on threads_a threads, 0 is serial
+		void set_exec_threads(unsigned const & threads_a);
+		std::string get_exec_info();
+		std::string get_stable_pipeline_info();
 
 		std::pair<u256, mcp::ExecutionResult> estimate_gas(mcp::db::db_transaction& transaction_a, std::shared_ptr<mcp::iblock_cache> cache_a,
 			Address const& _from, u256 const& _value, Address const& _dest, bytes const& _data, int64_t const& _maxGas, u256 const& _gasPrice, dev::eth::McInfo const & mc_info, GasEstimationCallback const& _callback = GasEstimationCallback());
 		std::pair<ExecutionResult, dev::eth::TransactionReceipt> execute(mcp::db::db_transaction& transaction_a, std::shared_ptr<mcp::iblock_cache> cache_a, Transaction const& _t, dev::eth::McInfo const & mc_info_a, Permanence _p, dev::eth::OnOpFunc const& _onOp);
+		/// execute transactions of links of a stable block in order, speculatively in parallel if exec threads set.
+		/// receipt is nullptr if transaction is rejected by nonce or balance
+		std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> execute_links(mcp::db::db_transaction & transaction_a, std::shared_ptr<mcp::process_block_cache> cache_a, dev::eth::McInfo const & mc_info_a, std::vector<std::shared_ptr<mcp::Transaction>> const & transactions_a);
 		//mcp::json traceTransaction(Executive& _e, Transaction const& _t, mcp::json const& _json);
 		void call(dev::Address const& _from, dev::Address const& _contractAddress, dev::bytes const& _data, dev::bytes& result);
 
@@ -118,13 +127,20 @@ namespace mcp
 		Epoch last_epoch();
 		Epoch last_stable_epoch();
 
+		/// compare free blocks, main chain and children kept in memory with dag_free, main_chain and block_child tables.
+		/// called by block processor thread which writes them, return true if same
+		bool dag_memory_consistent(mcp::db::db_transaction & transaction_a);
+
 	private:
 		void write_dag_block(mcp::db::db_transaction & transaction_a, std::shared_ptr<mcp::process_block_cache> cache_a, std::shared_ptr<mcp::block> block_a);
 		void find_main_chain_changes(mcp::db::db_transaction & transaction_a, std::shared_ptr<mcp::process_block_cache> cache_a, std::shared_ptr<mcp::block> block_a, mcp::block_hash const & best_free_block_hash, bool & is_mci_retreat, uint64_t & retreat_mci, uint64_t &retreat_level, std::list<mcp::block_hash>& new_mc_block_hashs);
 		void update_mci(mcp::db::db_transaction & transaction_a, std::shared_ptr<mcp::process_block_cache> cache_a, std::shared_ptr<mcp::block> block_a, uint64_t const & retreat_mci, std::list<mcp::block_hash> const & new_mc_block_hashs);
 		void update_latest_included_mci(mcp::db::db_transaction & transaction_a, std::shared_ptr<mcp::process_block_cache> cache_a, std::shared_ptr<mcp::block> block_a, bool const &is_mci_retreat, uint64_t const & retreat_mci, uint64_t const &retreat_level);
 		void advance_stable_mci(mcp::timeout_db_transaction & timeout_tx_a, std::shared_ptr<mcp::process_block_cache> cache_a, uint64_t const & mci, mcp::block_hash const & block_hash_a);
-		void set_block_stable(mcp::timeout_db_transaction & timeout_tx_a, std::shared_ptr<mcp::process_block_cache> cache_a, mcp::block_hash const & stable_block_hash, uint64_t const & mci, uint64_t const & mc_timestamp, uint64_t const & mc_last_summary_mci, uint64_t const & stable_timestamp, uint64_t const & stable_index, h256 receiptsRoot);
+		std::shared_ptr<mcp::block_state> set_block_stable(mcp::timeout_db_transaction & timeout_tx_a, std::shared_ptr<mcp::process_block_cache> cache_a, std::shared_ptr<mcp::block> stable_block, uint64_t const & mci, uint64_t const & mc_timestamp, uint64_t const & mc_last_summary_mci, uint64_t const & stable_timestamp, uint64_t const & stable_index, std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> const & receipts_a);
+		/// postings of addresses and topics, and section bloom of logs in stable block
+		void put_log_index(mcp::db::db_transaction & transaction_a, uint64_t const & stable_index_a, std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> const & receipts_a);
+		void set_block_summary(mcp::timeout_db_transaction & timeout_tx_a, std::shared_ptr<mcp::process_block_cache> cache_a, std::shared_ptr<mcp::block> stable_block, std::shared_ptr<mcp::block_state> stable_block_state, h256 const & receiptsRoot);
 		void search_stable_block(mcp::db::db_transaction & transaction_a, std::shared_ptr<mcp::process_block_cache> cache_a, mcp::block_hash const & block_hash, uint64_t const & mci, std::map<uint64_t, std::set<mcp::block_hash>>& stable_block_hashs);
 		void UpdateCommittee(mcp::timeout_db_transaction & timeout_tx_a, Epoch const& epoch);
 		void init_vrf_outputs(mcp::db::db_transaction & transaction_a);
@@ -135,10 +151,20 @@ namespace mcp
 		void UpdateStaking(mcp::timeout_db_transaction & timeout_tx_a, Epoch const& epoch);
 		void EpochFinalize(mcp::timeout_db_transaction & timeout_tx_a, std::shared_ptr<mcp::process_block_cache> cache_a, uint64_t const &mci, mcp::block_hash const& hash);
 		bool IsEpochFinalized(uint64_t const& mci);
+		/// main chain block of mci, unstable main chain is read from memory. return true if not found
+		bool main_chain_get(mcp::db::db_transaction & transaction_a, uint64_t const & mci_a, mcp::block_hash & hash_a);
+		/// children of block, blocks written since start are read from memory
+		void block_children_get(mcp::db::db_transaction & transaction_a, mcp::block_hash const & hash_a, std::list<mcp::block_hash> & children_a);
+		/// drop main chain and children kept in memory for blocks stable before, level_a is the lowest level kept
+		void prune_dag_memory(uint64_t const & level_a);
 
 		mcp::block_store m_store;
 		std::shared_ptr<mcp::block_cache> m_cache;
 		std::shared_ptr<mcp::TransactionQueue> m_tq;
+		std::unique_ptr<mcp::parallel_executor> m_parallel_executor;
+		std::atomic<uint64_t> m_speculative_committed = { 0 };
+		std::atomic<uint64_t> m_speculative_reexecuted = { 0 };
+		mcp::stable_pipeline m_stable_pipeline;
 		//std::list<std::function<void(std::shared_ptr<mcp::block>)> > m_new_block_observer;
 		//std::queue<std::shared_ptr<mcp::block>> m_new_blocks;
 		//std::list<std::function<void(std::shared_ptr<mcp::block>)> > m_stable_block_observer;
@@ -159,6 +185,14 @@ namespace mcp
 		
 		mcp::advance_info m_advance_info;
 
+		/// same blocks as dag free table, ordered best first
+		std::set<mcp::free_key> m_free_blocks;
+		/// main chain from last stable mci on
+		std::map<uint64_t, mcp::block_hash> m_unstable_main_chain;
+		/// children of blocks written since start, by block and by level for pruning
+		std::unordered_map<mcp::block_hash, std::vector<mcp::block_hash>> m_children;
+		std::map<uint64_t, std::vector<mcp::block_hash>> m_children_levels;
+
 		std::unordered_map<Address, dev::eth::PrecompiledContract> m_precompiled;
 
 		std::map<Epoch, std::map<h256, dev::ApproveReceipt>> vrf_outputs;
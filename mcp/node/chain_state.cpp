@@ -65,6 +65,8 @@ void mcp::chain_state::noteAccountStartNonce(u256 const& _actual)
 
 std::shared_ptr<mcp::account_state> mcp::chain_state::account(Address const& _addr) const
 {
+    m_accessed.insert(_addr);
+
     // If the account is already modified, return immediately
     auto it = m_cache.find(_addr);
 	if (it != m_cache.end())
@@ -77,7 +79,11 @@ std::shared_ptr<mcp::account_state> mcp::chain_state::account(Address const& _ad
         return nullptr;
 
     // Populate basic info.
-    std::shared_ptr<mcp::account_state> as(block_cache->latest_account_state_get(transaction, _addr));
+    std::shared_ptr<mcp::account_state> as;
+    {
+        auto lock(read_lock());
+        as = block_cache->latest_account_state_get(transaction, _addr);
+    }
     if (!as)
     {
         m_nonExistingAccountsCache.insert(_addr);
@@ -92,6 +98,19 @@ std::shared_ptr<mcp::account_state> mcp::chain_state::account(Address const& _ad
     return i.first->second;
 }
 
+void mcp::chain_state::set_read_mutex(std::mutex * mutex_a)
+{
+    m_read_mutex = mutex_a;
+    m_db.set_read_mutex(mutex_a);
+}
+
+std::unique_lock<std::mutex> mcp::chain_state::read_lock() const
+{
+    if (m_read_mutex)
+        return std::unique_lock<std::mutex>(*m_read_mutex);
+    return std::unique_lock<std::mutex>();
+}
+
 void mcp::chain_state::clearCacheIfTooLarge() const
 {
 }
@@ -103,6 +122,7 @@ std::pair<mcp::ExecutionResult, dev::eth::TransactionReceipt> mcp::chain_state::
     e.setResultRecipient(res);
 
 	ts = _t;
+	m_mci = _envInfo.mci();
 
     auto onOp = _onOp;
 #if ETH_VMTRACE
@@ -120,11 +140,7 @@ std::pair<mcp::ExecutionResult, dev::eth::TransactionReceipt> mcp::chain_state::
 		m_cache.clear();
 		break;
 	case Permanence::Committed:
-		for (auto const& i : m_cache)
-		{
-			res.modified_accounts.insert(i.first);
-		}
-		commit(); // Remove empty accounts
+		commitExecution(res);
 		break;
 	case Permanence::Uncommitted:
 		break;
@@ -134,6 +150,15 @@ std::pair<mcp::ExecutionResult, dev::eth::TransactionReceipt> mcp::chain_state::
 	return std::make_pair(res, receipt);
 }
 
+void mcp::chain_state::commitExecution(ExecutionResult& _res)
+{
+	for (auto const& i : m_cache)
+	{
+		_res.modified_accounts.insert(i.first);
+	}
+	commit(); // Remove empty accounts
+}
+
 bool mcp::chain_state::addressInUse(Address const& _address) const
 {
     return !!account(_address);
@@ -218,6 +243,18 @@ void mcp::chain_state::commit()
         save_previous_account_state();
     }
     removeEmptyAccounts();
+
+	bool prune(mcp::db::database_config::prune_mcis > 0);
+	if (prune)
+	{
+		//account states replaced by this transaction become history at current mci
+		for (auto const& i : m_cache)
+		{
+			if (i.second->isDirty() && i.second->init_hash != h256(0))
+				store.history_index_put(transaction, mcp::history_index_key(m_mci, mcp::history_kind::account_state, i.second->init_hash), i.first);
+		}
+	}
+
 	std::shared_ptr<mcp::process_block_cache> process_block_cache = std::dynamic_pointer_cast<mcp::process_block_cache>(block_cache);
     m_touched += mcp::commit(transaction, m_cache, &m_db, process_block_cache, store, ts.sha3());
     m_changeLog.clear();
@@ -225,7 +262,12 @@ void mcp::chain_state::commit()
     m_unchangedCacheEntries.clear();
 
 	//save traces
-	store.traces_put(transaction, ts.sha3(), traces);
+	if (mcp::db::database_config::record_traces)
+	{
+		store.traces_put(transaction, ts.sha3(), traces);
+		if (prune)
+			store.history_index_put(transaction, mcp::history_index_key(m_mci, mcp::history_kind::traces, ts.sha3()));
+	}
 	traces.clear();
 }
 
@@ -249,6 +291,8 @@ void mcp::chain_state::save_previous_account_state()
         }
     }
     store.transaction_previous_account_state_put(transaction, ts.sha3(), hs);
+	if (mcp::db::database_config::prune_mcis > 0)
+		store.history_index_put(transaction, mcp::history_index_key(m_mci, mcp::history_kind::transaction_account_state, ts.sha3()));
 }
 
 bool mcp::chain_state::addressHasCode(Address const& _id) const
@@ -11,6 +11,7 @@
 #include <mcp/core/approve.hpp>
 #include <mcp/common/log.hpp>
 #include <mcp/common/CodeSizeCache.h>
+#include <mutex>
 #include <set>
 #include <unordered_set>
 
@@ -91,6 +92,16 @@ public:
 
     std::pair<ExecutionResult, dev::eth::TransactionReceipt> execute(dev::eth::EnvInfo const& _envInfo, Permanence _p, mcp::Transaction const& _t, dev::eth::OnOpFunc const& _onOp = dev::eth::OnOpFunc());
 
+    /// Commit an execution run with Permanence::Uncommitted, same as if it was run with Permanence::Committed.
+    void commitExecution(ExecutionResult& _res);
+
+    /// All addresses read or written since construction, used to validate speculative execution.
+    AddressHash const& accessed() const { return m_accessed; }
+
+    /// Serialize reads of transaction, store and block cache with other chain states sharing them on other threads.
+    void set_read_mutex(std::mutex * mutex_a);
+    std::unique_lock<std::mutex> read_lock() const;
+
     /// @returns the account at the given address or a null pointer if it does not exist.
     /// The pointer is valid until the next access to the state or account.
 	std::shared_ptr<mcp::account_state> account(Address const& _addr) const;
@@ -245,9 +256,16 @@ private:
     mutable std::set<Address> m_nonExistingAccountsCache;
     /// Tracks all addresses touched so far.
 	AddressHash m_touched;
+    /// Tracks all addresses passed to account().
+    mutable AddressHash m_accessed;
+    /// Held while reading transaction, store and block cache if set.
+    std::mutex * m_read_mutex = nullptr;
 
     u256 m_accountStartNonce;
 
+	/// mci of current transaction, history written by it is indexed at this mci
+	uint64_t m_mci = 0;
+
     ChangeLog m_changeLog;
     mcp::log m_log = { mcp::log("node") };
 };
@@ -25,7 +25,9 @@ namespace mcp
 		hello_info, //12
 		hello_info_request, //13
 		hello_info_ack, //14
-		packet_count = 0x10
+		snapshot_request, //15
+		snapshot_response, //16
+		packet_count = 0x20
 	};
 
 	class requesting_item
@@ -93,6 +95,10 @@ namespace mcp
 		uint64_t  hello_info = 0;
 		
 		uint64_t  hello_info_ack = 0;	
+
+		uint64_t  snapshot_request = 0;
+		uint64_t  send_snapshot = 0;
+		uint64_t  snapshot_response = 0;
 	};
 
 	extern capability_metrics CapMetricsRecieved;
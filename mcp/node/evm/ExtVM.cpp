@@ -207,6 +207,7 @@ h256 ExtVM::blockHash(u256 _number)
     mcp::block_store& store(envInfo().store);
     mcp::db::db_transaction& transaction(envInfo().transaction);
     h256 _h(0);
+    auto lock(m_s.read_lock());
     store.stable_block_get(transaction, uint64_t(_number), _h);
     return _h;
 }
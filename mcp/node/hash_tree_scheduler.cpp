@@ -0,0 +1,226 @@
+#include "hash_tree_scheduler.hpp"
+
+#include <sstream>
+#include <tuple>
+
+mcp::hash_tree_range::hash_tree_range(uint64_t const & index_a, mcp::summary_hash const & from_summary_a, mcp::summary_hash const & to_summary_a) :
+	index(index_a),
+	from_summary(from_summary_a),
+	to_summary(to_summary_a)
+{
+}
+
+void mcp::hash_tree_scheduler::start(p2p::node_id const & primary_a, uint64_t const & head_index_a)
+{
+	clear();
+	m_active = true;
+	m_primary = primary_a;
+	m_head_index = head_index_a;
+	m_start_time = std::chrono::steady_clock::now();
+}
+
+void mcp::hash_tree_scheduler::clear()
+{
+	m_active = false;
+	m_primary.clear();
+	m_ranges.clear();
+	m_head_index = 0;
+	m_buffered = 0;
+	m_excluded.clear();
+	m_received_pages = 0;
+	m_received_summaries = 0;
+	m_processed_ranges = 0;
+	m_timeouts = 0;
+	m_served_peers.clear();
+}
+
+bool mcp::hash_tree_scheduler::next_range_index(uint64_t & index_a) const
+{
+	if (!m_active || m_ranges.size() >= c_window)
+		return false;
+	uint64_t index(m_ranges.empty() ? m_head_index : m_ranges.back().index - 1);
+	///range of index 0 has no to summary
+	if (index < 1)
+		return false;
+	index_a = index;
+	return true;
+}
+
+void mcp::hash_tree_scheduler::add_range(mcp::hash_tree_range && range_a)
+{
+	m_ranges.push_back(std::move(range_a));
+}
+
+void mcp::hash_tree_scheduler::assign(std::vector<p2p::node_id> const & peers_a, std::vector<mcp::hash_tree_request_item> & requests_a)
+{
+	if (!m_active)
+		return;
+
+	std::map<p2p::node_id, size_t> load;
+	for (auto const & id : peers_a)
+		if (!m_excluded.count(id))
+			load[id] = 0;
+	if (load.empty())
+		return;
+	for (auto const & r : m_ranges)
+		if (r.request_id != mcp::sync_request_hash(0) && load.count(r.peer))
+			load[r.peer]++;
+
+	for (auto & r : m_ranges)
+	{
+		if (m_buffered >= c_max_buffered)
+			break;
+		if (r.complete || r.request_id != mcp::sync_request_hash(0))
+			continue;
+
+		///least loaded peer, primary peer and peers not timed out on this range first
+		auto best(load.end());
+		for (auto it(load.begin()); it != load.end(); it++)
+		{
+			if (best == load.end())
+			{
+				best = it;
+				continue;
+			}
+			auto rank = [&](std::map<p2p::node_id, size_t>::iterator const & p) {
+				return std::make_tuple(p->first == r.slow_peer, p->second, p->first != m_primary);
+			};
+			if (rank(it) < rank(best))
+				best = it;
+		}
+		best->second++;
+
+		mcp::sub_packet_type ty(mcp::sub_packet_type::hash_tree_request);
+		mcp::hash_tree_request_item item{ best->first, mcp::hash_tree_request_message(r.from_summary, r.to_summary) };
+		item.message.next_start_index = r.next_start_index;
+		item.message.request_id = mcp::gen_sync_request_hash(best->first, mcp::seconds_since_epoch(), ty);
+
+		r.request_id = item.message.request_id;
+		r.peer = best->first;
+		r.request_time = std::chrono::steady_clock::now();
+		requests_a.push_back(std::move(item));
+	}
+}
+
+bool mcp::hash_tree_scheduler::expire(std::chrono::steady_clock::time_point const & now_a)
+{
+	for (auto & r : m_ranges)
+	{
+		if (r.request_id == mcp::sync_request_hash(0) || now_a - r.request_time < std::chrono::seconds((uint64_t)c_timeout_seconds))
+			continue;
+		m_timeouts++;
+		r.slow_peer = r.peer;
+		r.request_id.clear();
+		r.peer.clear();
+		if (++r.retries > c_max_retries)
+			return false;
+	}
+	return true;
+}
+
+void mcp::hash_tree_scheduler::exclude(p2p::node_id const & id_a)
+{
+	m_excluded.insert(id_a);
+	for (auto & r : m_ranges)
+	{
+		if (r.request_id != mcp::sync_request_hash(0) && r.peer == id_a)
+		{
+			r.request_id.clear();
+			r.peer.clear();
+		}
+	}
+}
+
+bool mcp::hash_tree_scheduler::is_stalled() const
+{
+	if (!m_active || m_buffered > 0)
+		return false;
+	bool waiting(false);
+	for (auto const & r : m_ranges)
+	{
+		if (r.request_id != mcp::sync_request_hash(0))
+			return false;
+		if (!r.complete)
+			waiting = true;
+	}
+	return waiting;
+}
+
+bool mcp::hash_tree_scheduler::on_response(p2p::node_id const & id_a, std::shared_ptr<mcp::hash_tree_response_message> const & response_a)
+{
+	for (auto & r : m_ranges)
+	{
+		if (r.request_id != response_a->request_id || r.peer != id_a)
+			continue;
+
+		///range always has from block, empty response means peer has not the summaries
+		if (response_a->arr_summaries.empty() && response_a->next_start_index == 0 && id_a != m_primary)
+		{
+			exclude(id_a);
+			return false;
+		}
+
+		r.request_id.clear();
+		r.peer.clear();
+		r.retries = 0;
+		r.next_start_index = response_a->next_start_index;
+		r.complete = response_a->next_start_index == 0;
+		r.responses.push_back(std::make_pair(id_a, response_a));
+		m_buffered++;
+
+		m_received_pages++;
+		m_received_summaries += response_a->arr_summaries.size();
+		m_served_peers.insert(id_a);
+		return true;
+	}
+	return false;
+}
+
+std::shared_ptr<mcp::hash_tree_response_message> mcp::hash_tree_scheduler::front(p2p::node_id & id_a, mcp::hash_tree_range const *& range_a) const
+{
+	if (m_ranges.empty() || m_ranges.front().responses.empty())
+		return nullptr;
+	mcp::hash_tree_range const & head(m_ranges.front());
+	id_a = head.responses.front().first;
+	range_a = &head;
+	return head.responses.front().second;
+}
+
+void mcp::hash_tree_scheduler::pop_front()
+{
+	if (m_ranges.empty() || m_ranges.front().responses.empty())
+		return;
+	mcp::hash_tree_range & head(m_ranges.front());
+	head.responses.pop_front();
+	m_buffered--;
+	if (head.complete && head.responses.empty())
+	{
+		m_ranges.pop_front();
+		m_head_index--;
+		m_processed_ranges++;
+	}
+}
+
+std::string mcp::hash_tree_scheduler::get_info()
+{
+	size_t outstanding(0);
+	for (auto const & r : m_ranges)
+		if (r.request_id != mcp::sync_request_hash(0))
+			outstanding++;
+	uint64_t elapsed(std::max<uint64_t>(1, std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - m_start_time).count()));
+
+	std::stringstream s;
+	s << "hash tree active:" << m_active
+		<< " ,head index:" << m_head_index
+		<< " ,open ranges:" << m_ranges.size() << "/" << c_window
+		<< " ,outstanding:" << outstanding
+		<< " ,buffered:" << m_buffered
+		<< " ,processed ranges:" << m_processed_ranges
+		<< " ,pages:" << m_received_pages
+		<< " ,summaries:" << m_received_summaries
+		<< " ,summaries/s:" << (m_active ? m_received_summaries / elapsed : 0)
+		<< " ,peers:" << m_served_peers.size()
+		<< " ,excluded peers:" << m_excluded.size()
+		<< " ,timeouts:" << m_timeouts;
+	return s.str();
+}
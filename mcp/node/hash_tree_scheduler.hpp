@@ -0,0 +1,102 @@
+#pragma once
+
+#include <mcp/node/common.hpp>
+#include <mcp/p2p/common.hpp>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+
+namespace mcp
+{
+	/// hash tree between summaries of catchup chain index and index - 1, requested page by page
+	class hash_tree_range
+	{
+	public:
+		hash_tree_range(uint64_t const & index_a, mcp::summary_hash const & from_summary_a, mcp::summary_hash const & to_summary_a);
+
+		uint64_t index;
+		mcp::summary_hash from_summary;
+		mcp::summary_hash to_summary;
+		/// start index of next page, 0 for first page
+		uint64_t next_start_index = 0;
+		/// last page received
+		bool complete = false;
+		/// received pages not processed yet, in page order
+		std::deque<std::pair<p2p::node_id, std::shared_ptr<mcp::hash_tree_response_message>>> responses;
+
+		/// outstanding request, request_id is 0 if none
+		mcp::sync_request_hash request_id = mcp::sync_request_hash(0);
+		p2p::node_id peer = p2p::node_id(0);
+		std::chrono::steady_clock::time_point request_time;
+		/// peer of timed out request, avoided on retry
+		p2p::node_id slow_peer = p2p::node_id(0);
+		uint32_t retries = 0;
+	};
+
+	class hash_tree_request_item
+	{
+	public:
+		p2p::node_id peer;
+		mcp::hash_tree_request_message message;
+	};
+
+	/// window of catchup chain ranges requested at the same time from several peers.
+	/// a range has one outstanding page request, responses are handed out in catchup chain order.
+	class hash_tree_scheduler
+	{
+	public:
+		void start(p2p::node_id const & primary_a, uint64_t const & head_index_a);
+		void clear();
+		bool is_active() const { return m_active; }
+		p2p::node_id primary() const { return m_primary; }
+
+		/// index of next range to open, return false if window is full or all ranges are opened
+		bool next_range_index(uint64_t & index_a) const;
+		void add_range(mcp::hash_tree_range && range_a);
+
+		/// build requests of ranges waiting for next page, least loaded peers first
+		void assign(std::vector<p2p::node_id> const & peers_a, std::vector<mcp::hash_tree_request_item> & requests_a);
+		/// requeue requests older than c_timeout, return false if a range has no retry left
+		bool expire(std::chrono::steady_clock::time_point const & now_a);
+		/// peer can not serve ranges, outstanding requests to it are requeued
+		void exclude(p2p::node_id const & id_a);
+		/// ranges wait for requests but nothing is outstanding or received
+		bool is_stalled() const;
+
+		/// return false if response is not for an outstanding request
+		bool on_response(p2p::node_id const & id_a, std::shared_ptr<mcp::hash_tree_response_message> const & response_a);
+		/// next response in catchup chain order, nullptr if not received yet
+		std::shared_ptr<mcp::hash_tree_response_message> front(p2p::node_id & id_a, mcp::hash_tree_range const *& range_a) const;
+		/// processed front response, head range is closed after its last page
+		void pop_front();
+
+		std::string get_info();
+
+		/// ranges requested at the same time
+		static constexpr size_t c_window = 8;
+		/// requests stop when so many responses are waiting for block processor
+		static constexpr size_t c_max_buffered = 32;
+		static constexpr uint32_t c_timeout_seconds = 30;
+		static constexpr uint32_t c_max_retries = 3;
+
+	private:
+		bool m_active = false;
+		p2p::node_id m_primary = p2p::node_id(0);
+		/// open ranges, head range first, index decreasing
+		std::deque<mcp::hash_tree_range> m_ranges;
+		/// index of head range
+		uint64_t m_head_index = 0;
+		size_t m_buffered = 0;
+		std::set<p2p::node_id> m_excluded;
+
+		std::chrono::steady_clock::time_point m_start_time;
+		uint64_t m_received_pages = 0;
+		uint64_t m_received_summaries = 0;
+		uint64_t m_processed_ranges = 0;
+		uint64_t m_timeouts = 0;
+		std::set<p2p::node_id> m_served_peers;
+	};
+}
@@ -0,0 +1,158 @@
+#include "history_pruner.hpp"
+
+#include <libdevcore/Log.h>
+
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <sstream>
+
+mcp::history_pruner::history_pruner(mcp::block_store & store_a, uint64_t const & keep_mcis_a) :
+	m_store(store_a),
+	m_keep_mcis(std::max(c_min_keep_mcis, keep_mcis_a))
+{
+	{
+		mcp::db::db_transaction transaction(m_store.create_transaction());
+		uint64_t pruned_mci(0);
+		if (!m_store.history_pruned_mci_get(transaction, pruned_mci))
+			m_pruned_mci = pruned_mci;
+		m_stable_mci = m_store.last_stable_mci_get(transaction);
+	}
+	///index may be left if stopped after pruned mci commited
+	if (m_pruned_mci > 0)
+		m_store.history_index_del_range(m_pruned_mci);
+
+	m_thread = std::thread([this]() {
+		dev::setThreadName("history_pruner");
+		run();
+	});
+}
+
+mcp::history_pruner::~history_pruner()
+{
+	stop();
+}
+
+void mcp::history_pruner::on_stable(uint64_t const & mci_a)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (mci_a <= m_stable_mci)
+			return;
+		m_stable_mci = mci_a;
+	}
+	m_condition.notify_one();
+}
+
+void mcp::history_pruner::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopped = true;
+	}
+	m_condition.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void mcp::history_pruner::run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	uint64_t failures(0);
+	while (!m_stopped)
+	{
+		if (m_stable_mci >= m_pruned_mci + m_keep_mcis + c_step_mcis)
+		{
+			uint64_t to_mci(std::min(m_stable_mci - m_keep_mcis, m_pruned_mci + c_step_mcis));
+			lock.unlock();
+			bool error(false);
+			try
+			{
+				prune(to_mci);
+				failures = 0;
+			}
+			catch (...)
+			{
+				LOG(m_log.error) << "history pruner error:" << boost::current_exception_diagnostic_information();
+				error = true;
+			}
+			lock.lock();
+			if (error)
+			{
+				/// pruning is not needed by node, history is kept if it keeps failing
+				m_failures++;
+				if (++failures >= c_max_failures)
+				{
+					LOG(m_log.error) << "history pruner stopped after " << failures << " failures, pruned mci:" << m_pruned_mci;
+					break;
+				}
+				m_condition.wait_for(lock, c_retry_interval, [this]() { return m_stopped; });
+			}
+			continue;
+		}
+
+		m_condition.wait(lock);
+	}
+}
+
+void mcp::history_pruner::prune(uint64_t const & to_mci_a)
+{
+	mcp::history_index_key from(m_pruned_mci, mcp::history_kind::account_state, h256(0));
+	bool skip_first(false);
+	while (true)
+	{
+		mcp::db::db_transaction transaction(m_store.create_transaction());
+		std::vector<std::pair<mcp::history_index_key, Address>> index;
+		m_store.history_index_get(transaction, from, to_mci_a, c_batch_size, index);
+		for (size_t i(skip_first ? 1 : 0); i < index.size(); i++)
+		{
+			mcp::history_index_key const & key(index[i].first);
+			switch (key.get_kind())
+			{
+			case mcp::history_kind::account_state:
+			{
+				h256 latest;
+				if (!m_store.latest_account_state_get(transaction, index[i].second, latest) && latest == key.hash)
+				{
+					m_kept_entries++;
+					continue;
+				}
+				m_store.account_state_del(transaction, key.hash);
+				break;
+			}
+			case mcp::history_kind::traces:
+				m_store.traces_del(transaction, key.hash);
+				break;
+			case mcp::history_kind::transaction_account_state:
+				m_store.transaction_previous_account_state_del(transaction, key.hash);
+				break;
+			default:
+				assert_x_msg(false, "invalid history kind");
+			}
+			m_pruned_entries++;
+		}
+
+		bool last(index.size() < c_batch_size);
+		if (last)
+			m_store.history_pruned_mci_put(transaction, to_mci_a);
+		transaction.commit();
+		if (last)
+			break;
+
+		from = index.back().first;
+		skip_first = true;
+	}
+
+	m_store.history_index_del_range(to_mci_a);
+	m_pruned_mci = to_mci_a;
+}
+
+std::string mcp::history_pruner::get_info()
+{
+	std::stringstream s;
+	s << "history pruner keep mcis:" << m_keep_mcis
+		<< " ,pruned mci:" << m_pruned_mci
+		<< " ,pruned entries:" << m_pruned_entries
+		<< " ,kept latest:" << m_kept_entries
+		<< " ,failures:" << m_failures;
+	return s.str();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <mcp/core/block_store.hpp>
+#include <mcp/common/log.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace mcp
+{
+	/// delete historical account states, traces and transaction account states older than last keep_mcis stable mcis.
+	/// history is found by history_index written in chain_state::commit, latest account states are always kept.
+	class history_pruner
+	{
+	public:
+		history_pruner(mcp::block_store & store_a, uint64_t const & keep_mcis_a);
+		~history_pruner();
+
+		/// called when mci becomes stable
+		void on_stable(uint64_t const & mci_a);
+		void stop();
+
+		std::string get_info();
+
+	private:
+		void run();
+		void prune(uint64_t const & to_mci_a);
+
+		/// index of stable mci may be not commited yet, never prune newer than this
+		static constexpr uint64_t c_min_keep_mcis = 100;
+		/// mcis pruned each round
+		static constexpr uint64_t c_step_mcis = 256;
+		/// index entries deleted each db transaction
+		static constexpr size_t c_batch_size = 1024;
+		/// failed rounds are retried after interval, pruning stops after failed rounds in a row
+		static constexpr std::chrono::seconds c_retry_interval = std::chrono::seconds(10);
+		static constexpr uint64_t c_max_failures = 5;
+
+		mcp::block_store & m_store;
+		uint64_t const m_keep_mcis;
+
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_stopped = false;
+		uint64_t m_stable_mci = 0;
+
+		std::atomic<uint64_t> m_pruned_mci = { 0 };
+		std::atomic<uint64_t> m_pruned_entries = { 0 };
+		std::atomic<uint64_t> m_kept_entries = { 0 };
+		std::atomic<uint64_t> m_failures = { 0 };
+
+		std::thread m_thread;
+		mcp::log m_log = { mcp::log("node") };
+	};
+}
@@ -331,6 +331,104 @@ void mcp::hash_tree_response_message::stream_RLP(dev::RLPStream & s) const
     s << next_start_index << request_id;
 }
 
+mcp::snapshot_request_message::snapshot_request_message(bool & error_a, dev::RLP const & r)
+{
+	error_a = r.itemCount() != 5;
+	if (error_a)
+		return;
+
+	request_id = (mcp::sync_request_hash)r[0];
+	type = (mcp::snapshot_request_type)r[1].toInt<uint8_t>();
+	stable_summary = (mcp::summary_hash)r[2];
+	table = (mcp::snapshot_table)r[3].toInt<uint8_t>();
+	from_key = r[4].toBytes();
+	error_a = type > mcp::snapshot_request_type::proof
+		|| (type != mcp::snapshot_request_type::manifest && stable_summary == mcp::summary_hash(0));
+}
+
+void mcp::snapshot_request_message::stream_RLP(dev::RLPStream & s) const
+{
+	s.appendList(5);
+	s << request_id << (uint8_t)type << stable_summary << (uint8_t)table << from_key;
+}
+
+mcp::snapshot_response_message::snapshot_response_message(bool & error_a, dev::RLP const & r)
+{
+	error_a = r.itemCount() != 4;
+	if (error_a)
+		return;
+
+	request_id = (mcp::sync_request_hash)r[0];
+	type = (mcp::snapshot_request_type)r[1].toInt<uint8_t>();
+	status = (mcp::snapshot_response_status)r[2].toInt<uint8_t>();
+	if (status != mcp::snapshot_response_status::ok)
+		return;
+
+	/// payload of type, empty list if status is not ok
+	dev::RLP const & payload(r[3]);
+	switch (type)
+	{
+	case mcp::snapshot_request_type::manifest:
+		manifest = mcp::snapshot_manifest(error_a, payload);
+		break;
+	case mcp::snapshot_request_type::chunk:
+		chunk = mcp::snapshot_chunk(error_a, payload);
+		break;
+	case mcp::snapshot_request_type::proof:
+	{
+		error_a = payload.itemCount() != 2;
+		if (error_a)
+			return;
+		for (auto joint : payload[0])
+		{
+			mcp::joint_message msg(error_a, joint);
+			if (error_a)
+				return;
+			witness_joints.push_back(msg);
+		}
+		for (auto item : payload[1])
+		{
+			mcp::hash_tree_response_message::summary_items summary(error_a, item);
+			if (error_a)
+				return;
+			summaries.push_back(summary);
+		}
+		break;
+	}
+	default:
+		error_a = true;
+	}
+}
+
+void mcp::snapshot_response_message::stream_RLP(dev::RLPStream & s) const
+{
+	s.appendList(4);
+	s << request_id << (uint8_t)type << (uint8_t)status;
+	if (status != mcp::snapshot_response_status::ok)
+	{
+		s.appendList(0);
+		return;
+	}
+
+	switch (type)
+	{
+	case mcp::snapshot_request_type::manifest:
+		manifest.stream_RLP(s);
+		break;
+	case mcp::snapshot_request_type::chunk:
+		chunk.stream_RLP(s);
+		break;
+	default:
+		s.appendList(2);
+		s.appendList(witness_joints.size());
+		for (auto joint : witness_joints)
+			joint.stream_RLP(s);
+		s.appendList(summaries.size());
+		for (auto summary : summaries)
+			summary.stream_RLP(s);
+	}
+}
+
 mcp::peer_info_message::peer_info_message()
 {
 }
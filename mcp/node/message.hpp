@@ -3,6 +3,7 @@
 #include <libdevcore/RLP.h>
 #include <mcp/common/common.hpp>
 #include <mcp/core/common.hpp>
+#include <mcp/core/state_snapshot.hpp>
 
 #include <boost/asio.hpp>
 
@@ -255,6 +256,57 @@ class hash_tree_response_message
 
 };
 
+enum class snapshot_request_type : uint8_t
+{
+	manifest = 0,
+	chunk,
+	/// witness proof of stable summary of manifest
+	proof
+};
+
+enum class snapshot_response_status : uint8_t
+{
+	ok = 0,
+	/// snapshot of requested stable summary is not served
+	unavailable,
+	/// stable summary of snapshot is not yet witnessed, request again later
+	pending
+};
+
+/// request of a fast syncing node for the state snapshot of a peer
+class snapshot_request_message
+{
+  public:
+	snapshot_request_message() = default;
+	snapshot_request_message(bool &error_a, dev::RLP const &r);
+	void stream_RLP(dev::RLPStream &s) const;
+
+	mcp::sync_request_hash request_id = mcp::sync_request_hash(0);
+	mcp::snapshot_request_type type = mcp::snapshot_request_type::manifest;
+	/// stable summary of manifest the chunk or proof belongs to, zero for manifest
+	mcp::summary_hash stable_summary = mcp::summary_hash(0);
+	mcp::snapshot_table table = mcp::snapshot_table::prop;
+	dev::bytes from_key;
+};
+
+class snapshot_response_message
+{
+  public:
+	snapshot_response_message() = default;
+	snapshot_response_message(bool &error_a, dev::RLP const &r);
+	void stream_RLP(dev::RLPStream &s) const;
+
+	mcp::sync_request_hash request_id = mcp::sync_request_hash(0);
+	mcp::snapshot_request_type type = mcp::snapshot_request_type::manifest;
+	mcp::snapshot_response_status status = mcp::snapshot_response_status::ok;
+	mcp::snapshot_manifest manifest;
+	mcp::snapshot_chunk chunk;
+	/// proof, unstable main chain joints from last mci down until enough distinct witnesses as in catchup chain,
+	/// and summary items of main chain blocks from last summary block of last joint down to last stable mci of manifest
+	std::list<joint_message> witness_joints;
+	std::list<hash_tree_response_message::summary_items> summaries;
+};
+
 class peer_info_message
 {
   public:
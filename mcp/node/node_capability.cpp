@@ -1,6 +1,7 @@
 #include "node_capability.hpp"
 #include "requesting.hpp"
 #include "arrival.hpp"
+#include <mcp/core/genesis.hpp>
 #include <fstream>
 
 mcp::node_capability::node_capability(
@@ -48,7 +49,12 @@ void mcp::node_capability::on_connect(std::shared_ptr<p2p::peer> peer_a, unsigne
     {
         mcp::db::db_transaction transaction(m_store.create_transaction());
         bool error = m_store.genesis_hash_get(transaction, m_genesis);
-        assert_x(!error);
+        if (error)
+        {
+            //fast syncing into empty store, genesis of network is set by fast sync
+            assert_x(m_sync->is_fast_syncing());
+            m_genesis = mcp::genesis::block_hash;
+        }
     }
     
     {
@@ -205,6 +211,9 @@ void mcp::node_capability::confirm_remote_connect(p2p::node_id node_id_a)
         }
 
     }
+
+    if (m_sync->is_fast_syncing())
+        m_sync->request_snapshot(node_id_a);
 }
 
 bool mcp::node_capability::is_local_remote_ack_ok_hello(p2p::node_id node_id_a)
@@ -247,10 +256,10 @@ void mcp::node_capability::set_remote_ack_hello(p2p::node_id node_id_a, bool rem
     }
 }
 
-bool mcp::node_capability::read_packet(std::shared_ptr<p2p::peer> peer_a, unsigned const & type, std::shared_ptr<dev::RLP> rlp)
+bool mcp::node_capability::read_packet(std::shared_ptr<p2p::peer> peer_a, unsigned const & type, mcp::p2p::packet_ref const & packet_a)
 {
 
-    //LOG(m_log.trace) << "node id: " << peer_a->remote_node_id().to_string() << ", packet type: " << type << ", rlp: " << *rlp;
+    //LOG(m_log.trace) << "node id: " << peer_a->remote_node_id().to_string() << ", packet type: " << type << ", rlp: " << packet_a.rlp();
     //check remote node genesis is ok
     mcp::sub_packet_type pack_type = (mcp::sub_packet_type)type;
     if (pack_type != mcp::sub_packet_type::hello_info && pack_type != mcp::sub_packet_type::hello_info_request &&  pack_type != mcp::sub_packet_type::hello_info_ack)
@@ -259,11 +268,16 @@ bool mcp::node_capability::read_packet(std::shared_ptr<p2p::peer> peer_a, unsign
         {
             return true;
         }
+        //store of fast syncing node has no chain to serve or process
+        if (m_sync->is_fast_syncing() && pack_type != mcp::sub_packet_type::snapshot_response)
+        {
+            return true;
+        }
     }
 
     try
     {
-        dev::RLP const & r(*rlp);
+        dev::RLP const r(packet_a.rlp());
         switch (pack_type)
         {
         case mcp::sub_packet_type::joint:
@@ -332,25 +346,24 @@ bool mcp::node_capability::read_packet(std::shared_ptr<p2p::peer> peer_a, unsign
 				peer_a->disconnect(p2p::disconnect_reason::bad_protocol);
 				return true;
 			}
-			try
+			if (!r[0].isList())///Malformed transaction
 			{
-				Transaction t(r[0], CheckTransaction::Cheap);///Signature will be checked later
-				auto _f = source::broadcast;
-				{
-					if (RequestingMageger.try_erase(t.sha3()))
-						_f = source::request;
-				}
-				if (mcp::node_sync::is_syncing() && _f == source::broadcast)
-					return true;
-				mark_as_known_transaction(peer_a->remote_node_id(), t.sha3());
-				mcp::CapMetricsRecieved.transaction++;
-				m_tq->enqueue(std::make_shared<Transaction>(t), peer_a->remote_node_id(), _f);
+				LOG(m_log.error) << "Bad transaction:" << r[0];
+				peer_a->disconnect(p2p::disconnect_reason::bad_protocol);
+				return true;
 			}
-			catch (...)///Malformed transaction
+			///rlp is decoded and signature is checked by transaction queue verifiers
+			h256 h(dev::sha3(r[0].data()));
+			auto _f = source::broadcast;
 			{
-				LOG(m_log.error) << "Bad transaction:" << boost::current_exception_diagnostic_information();
-				peer_a->disconnect(p2p::disconnect_reason::bad_protocol);
+				if (RequestingMageger.try_erase(h))
+					_f = source::request;
 			}
+			if (mcp::node_sync::is_syncing() && _f == source::broadcast)
+				return true;
+			mark_as_known_transaction(peer_a->remote_node_id(), h);
+			mcp::CapMetricsRecieved.transaction++;
+			m_tq->enqueue(r[0].data(), h, peer_a->remote_node_id(), _f);
 			break;
 		}
 		case mcp::sub_packet_type::transaction_request:
@@ -437,6 +450,7 @@ bool mcp::node_capability::read_packet(std::shared_ptr<p2p::peer> peer_a, unsign
             //    << ", first_catchup_chain_summary: " << request.first_catchup_chain_summary.to_string();
 
 			mcp::CapMetricsRecieved.catchup_request++;
+			receive_catchup_request_count++;
 			m_async_task->sync_async([this, peer_a, request]() {
 				m_sync->catchup_chain_request_handler(peer_a->remote_node_id(), request);
 			});
@@ -499,7 +513,7 @@ bool mcp::node_capability::read_packet(std::shared_ptr<p2p::peer> peer_a, unsign
         case mcp::sub_packet_type::hash_tree_response:
         {
             bool error(r.itemCount() != 1);
-            mcp::hash_tree_response_message response(error, r[0]);
+            auto response(std::make_shared<mcp::hash_tree_response_message>(error, r[0]));
 
             if (error)
             {
@@ -508,20 +522,51 @@ bool mcp::node_capability::read_packet(std::shared_ptr<p2p::peer> peer_a, unsign
                 return true;
             }
 
-            //LOG(m_log.trace) << "recv hash tree response, arr_summary size: " << response.arr_summaries.size();
-            if (m_sync->get_current_request_id() != response.request_id)
+            //LOG(m_log.trace) << "recv hash tree response, arr_summary size: " << response->arr_summaries.size();
+			/// several requests are outstanding, sync checks request id
+			mcp::CapMetricsRecieved.hash_tree_response++;
+			m_async_task->sync_async([this, peer_a, response]() {
+				m_sync->hash_tree_response_handler(peer_a->remote_node_id(), response);
+			});
+
+            break;
+        }
+        case mcp::sub_packet_type::snapshot_request:
+        {
+            bool error(r.itemCount() != 1);
+            mcp::snapshot_request_message request(error, r[0]);
+
+            if (error)
             {
-                LOG(m_log.error) << "hash_tree_request:return timeout. response.request_id:" << response.request_id.hex() << ",current_request_id:" << m_sync->get_current_request_id().hex();
+                LOG(m_log.error) << "Invalid snapshot request message rlp: " << r[0];
+                peer_a->disconnect(p2p::disconnect_reason::bad_protocol);
                 return true;
             }
 
-			mcp::CapMetricsRecieved.hash_tree_response++;
-			if (m_sync->response_for_sync_request(peer_a->remote_node_id(), mcp::sub_packet_type::hash_tree_request))
-			{
-				m_async_task->sync_async([this, peer_a, response]() {
-					m_sync->hash_tree_response_handler(peer_a->remote_node_id(), response);
-				});
-			}
+			mcp::CapMetricsRecieved.snapshot_request++;
+			m_async_task->sync_async([this, peer_a, request]() {
+				m_sync->snapshot_request_handler(peer_a->remote_node_id(), request);
+			});
+
+            break;
+        }
+        case mcp::sub_packet_type::snapshot_response:
+        {
+            bool error(r.itemCount() != 1);
+            mcp::snapshot_response_message response(error, r[0]);
+
+            if (error)
+            {
+                LOG(m_log.error) << "Invalid snapshot response message rlp: " << r[0];
+                peer_a->disconnect(p2p::disconnect_reason::bad_protocol);
+                return true;
+            }
+
+			/// sync checks request id and peer
+			mcp::CapMetricsRecieved.snapshot_response++;
+			m_async_task->sync_async([this, peer_a, response]() {
+				m_sync->snapshot_response_handler(peer_a->remote_node_id(), response);
+			});
 
             break;
         }
@@ -716,7 +761,7 @@ bool mcp::node_capability::read_packet(std::shared_ptr<p2p::peer> peer_a, unsign
     catch (std::exception const & e)
     {
         LOG(m_log.trace) << "Peer error, node id: " << peer_a->remote_node_id().hex()
-            << ", packet type: " << type << ", rlp: " << *rlp << ", message: " << e.what();
+            << ", packet type: " << type << ", rlp: " << packet_a.rlp() << ", message: " << e.what();
         throw;
     }
 
@@ -730,24 +775,9 @@ void mcp::node_capability::broadcast_block(mcp::joint_message const & message)
 	{
 		mcp::CapMetricsSend.broadcast_joint++;
 		mcp::block_hash block_hash(message.block->hash());
-		std::lock_guard<std::mutex> lock(m_peers_mutex);
-		for (auto it = m_peers.begin(); it != m_peers.end();)
-		{
-			mcp::peer_info &pi(it->second);
-			if (auto p = pi.try_lock_peer())
-			{
-				it++;
-				if (pi.is_known_block(block_hash))
-					continue;
-
-				dev::RLPStream s;
-				p->prep(s, pi.offset + (unsigned)mcp::sub_packet_type::joint, 1);
-				message.stream_RLP(s);
-				p->send(s);
-			}
-			else
-				it = m_peers.erase(it);
-		}
+		broadcast(mcp::sub_packet_type::joint,
+			[&block_hash](mcp::peer_info & pi_a) { return pi_a.is_known_block(block_hash); },
+			[&message](dev::RLPStream & s_a) { message.stream_RLP(s_a); });
 	}
 	catch (const std::exception& e)
 	{
@@ -762,24 +792,9 @@ void mcp::node_capability::broadcast_transaction(mcp::Transaction const & messag
 	{
 		mcp::CapMetricsSend.broadcast_transaction++;
 		auto hash(message.sha3());
-		std::lock_guard<std::mutex> lock(m_peers_mutex);
-		for (auto it = m_peers.begin(); it != m_peers.end();)
-		{
-			mcp::peer_info &pi(it->second);
-			if (auto p = pi.try_lock_peer())
-			{
-				it++;
-				if (pi.is_known_transaction(hash))
-					continue;
-
-				dev::RLPStream s;
-				p->prep(s, pi.offset + (unsigned)mcp::sub_packet_type::transaction, 1);
-				message.streamRLP(s);
-				p->send(s);
-			}
-			else
-				it = m_peers.erase(it);
-		}
+		broadcast(mcp::sub_packet_type::transaction,
+			[&hash](mcp::peer_info & pi_a) { return pi_a.is_known_transaction(hash); },
+			[&message](dev::RLPStream & s_a) { message.streamRLP(s_a); });
 	}
 	catch (const std::exception& e)
 	{
@@ -794,6 +809,21 @@ void mcp::node_capability::broadcast_approve(mcp::approve const & message)
 	{
 		mcp::CapMetricsSend.broadcast_approve++;
 		auto hash(message.sha3());
+		broadcast(mcp::sub_packet_type::approve,
+			[&hash](mcp::peer_info & pi_a) { return pi_a.is_known_approve(hash); },
+			[&message](dev::RLPStream & s_a) { message.streamRLP(s_a); });
+	}
+	catch (const std::exception& e)
+	{
+		LOG(m_log.error) << "broadcast_approve error, error: " << e.what();
+		throw;
+	}
+}
+
+void mcp::node_capability::broadcast(mcp::sub_packet_type const & type_a, std::function<bool(mcp::peer_info &)> const & is_known_a, std::function<void(dev::RLPStream &)> const & stream_a)
+{
+	std::vector<std::pair<std::shared_ptr<p2p::peer>, unsigned>> peers;
+	{
 		std::lock_guard<std::mutex> lock(m_peers_mutex);
 		for (auto it = m_peers.begin(); it != m_peers.end();)
 		{
@@ -801,23 +831,26 @@ void mcp::node_capability::broadcast_approve(mcp::approve const & message)
 			if (auto p = pi.try_lock_peer())
 			{
 				it++;
-				if (pi.is_known_approve(hash))
+				if (is_known_a(pi))
 					continue;
 
-				dev::RLPStream s;
-				p->prep(s, pi.offset + (unsigned)mcp::sub_packet_type::approve, 1);
-				message.streamRLP(s);
-				p->send(s);
+				peers.push_back(std::make_pair(p, pi.offset));
 			}
 			else
 				it = m_peers.erase(it);
 		}
 	}
-	catch (const std::exception& e)
-	{
-		LOG(m_log.error) << "broadcast_approve error, error: " << e.what();
-		throw;
-	}
+	if (peers.empty())
+		return;
+
+	///serialize once, write queues of all peers reference the same body
+	dev::RLPStream s(1);
+	stream_a(s);
+	dev::bytes b;
+	s.swapOut(b);
+	std::shared_ptr<dev::bytes const> body(std::make_shared<dev::bytes const>(std::move(b)));
+	for (auto const & p : peers)
+		p.first->send(p.second + (unsigned)type_a, body);
 }
 
 void mcp::node_capability::mark_as_known_block(p2p::node_id node_id_a, mcp::block_hash block_hash_a)
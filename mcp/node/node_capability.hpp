@@ -102,7 +102,7 @@ namespace mcp
 		~node_capability() { stop(); }
 		void on_connect(std::shared_ptr<p2p::peer> peer_a, unsigned const & offset);
 		void on_disconnect(std::shared_ptr<p2p::peer> peer_a);
-		bool read_packet(std::shared_ptr<p2p::peer> peer_a, unsigned const & type, std::shared_ptr<dev::RLP> r);
+		bool read_packet(std::shared_ptr<p2p::peer> peer_a, unsigned const & type, mcp::p2p::packet_ref const & packet_a);
 		void broadcast_block(mcp::joint_message const & message);
 		void broadcast_transaction(mcp::Transaction const & message);
 		void broadcast_approve(mcp::approve const & message);
@@ -145,6 +145,8 @@ namespace mcp
     private:
 		/// transaction or approve processed callback
 		void onTransactionImported(ImportResult _ir, p2p::node_id const& _nodeId);
+		/// serialize message once by stream_a and send it to peers not knowing it, peer list is not locked while serializing or sending
+		void broadcast(mcp::sub_packet_type const & type_a, std::function<bool(mcp::peer_info &)> const & is_known_a, std::function<void(dev::RLPStream &)> const & stream_a);
 
 		std::unordered_map<p2p::node_id, mcp::peer_info> m_peers;
 		std::mutex m_peers_mutex;
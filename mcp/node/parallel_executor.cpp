@@ -0,0 +1,80 @@
+#include "parallel_executor.hpp"
+
+#include <libdevcore/Log.h>
+
+mcp::parallel_executor::parallel_executor(unsigned const & threads_a)
+{
+	for (unsigned i = 1; i < threads_a; i++)
+		m_threads.emplace_back([this, i]() {
+			dev::setThreadName("exec" + std::to_string(i));
+			worker();
+		});
+}
+
+mcp::parallel_executor::~parallel_executor()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopped = true;
+	}
+	m_condition.notify_all();
+	for (auto & t : m_threads)
+		t.join();
+}
+
+void mcp::parallel_executor::run(size_t const & count_a, std::function<void(size_t const &)> const & task_a)
+{
+	if (count_a == 0)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = &task_a;
+		m_count = count_a;
+		m_next = 0;
+		m_running = m_threads.size();
+		m_generation++;
+	}
+	m_condition.notify_all();
+
+	drain(task_a, count_a);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done_condition.wait(lock, [this]() { return m_running == 0; });
+	m_task = nullptr;
+}
+
+void mcp::parallel_executor::worker()
+{
+	uint64_t generation(0);
+	while (true)
+	{
+		std::function<void(size_t const &)> const * task;
+		size_t count;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this, &generation]() { return m_stopped || m_generation != generation; });
+			if (m_stopped)
+				return;
+			generation = m_generation;
+			task = m_task;
+			count = m_count;
+		}
+
+		drain(*task, count);
+
+		bool done(false);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			done = --m_running == 0;
+		}
+		if (done)
+			m_done_condition.notify_one();
+	}
+}
+
+void mcp::parallel_executor::drain(std::function<void(size_t const &)> const & task_a, size_t const & count_a)
+{
+	for (size_t i = m_next++; i < count_a; i = m_next++)
+		task_a(i);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <libdevcore/Address.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mcp
+{
+	/// fixed worker pool for data parallel loops, the calling thread also takes part
+	class parallel_executor
+	{
+	public:
+		explicit parallel_executor(unsigned const & threads_a);
+		~parallel_executor();
+
+		/// call task_a(i) for i in [0, count_a) concurrently, return when all finished. task_a must not throw
+		void run(size_t const & count_a, std::function<void(size_t const &)> const & task_a);
+
+		unsigned threads() const { return m_threads.size() + 1; }
+
+	private:
+		void worker();
+		void drain(std::function<void(size_t const &)> const & task_a, size_t const & count_a);
+
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::condition_variable m_done_condition;
+		std::function<void(size_t const &)> const * m_task = nullptr;
+		size_t m_count = 0;
+		std::atomic<size_t> m_next = { 0 };
+		size_t m_running = 0;
+		uint64_t m_generation = 0;
+		bool m_stopped = false;
+		std::vector<std::thread> m_threads;
+	};
+
+	/// optimistic execution: transactions are executed speculatively in parallel and committed in canonical order.
+	/// a speculative result is valid only if none of the accounts it accessed were accessed by a transaction committed before it.
+	class optimistic_batch
+	{
+	public:
+		bool valid(dev::AddressHash const & accessed_a) const
+		{
+			for (dev::Address const & a : accessed_a)
+			{
+				if (m_committed.count(a))
+					return false;
+			}
+			return true;
+		}
+
+		/// accessed is a superset of written, so tracking accessed accounts is conservative
+		void commit(dev::AddressHash const & accessed_a)
+		{
+			m_committed.insert(accessed_a.begin(), accessed_a.end());
+		}
+
+	private:
+		dev::AddressHash m_committed;
+	};
+}
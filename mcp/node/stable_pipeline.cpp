@@ -0,0 +1,89 @@
+#include "stable_pipeline.hpp"
+
+#include <libdevcore/Log.h>
+#include <libdevcore/TrieHash.h>
+
+#include <sstream>
+
+mcp::stable_pipeline::stable_pipeline(size_t const & depth_a) :
+	m_depth(std::max<size_t>(1, depth_a)),
+	m_start(std::chrono::steady_clock::now())
+{
+	for (auto & b : m_busy)
+		b = 0;
+	m_thread = std::thread([this]() {
+		dev::setThreadName("stable_pipeline");
+		run();
+	});
+}
+
+mcp::stable_pipeline::~stable_pipeline()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopped = true;
+	}
+	m_condition.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+std::future<dev::h256> mcp::stable_pipeline::receipts_root(std::vector<dev::bytes> && receipts_a)
+{
+	auto receipts(std::make_shared<std::vector<dev::bytes>>(std::move(receipts_a)));
+	std::packaged_task<dev::h256()> task([this, receipts]() {
+		stable_pipeline_timer timer(*this, stage::receipts_root);
+		return dev::orderedTrieRoot(*receipts);
+	});
+	std::future<dev::h256> result(task.get_future());
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+	}
+	m_condition.notify_one();
+	return result;
+}
+
+void mcp::stable_pipeline::run()
+{
+	while (true)
+	{
+		std::packaged_task<dev::h256()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_stopped || !m_tasks.empty(); });
+			if (m_tasks.empty())
+				return;
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		///exceptions are stored in the future
+		task();
+	}
+}
+
+void mcp::stable_pipeline::add_busy(stage const & stage_a, std::chrono::steady_clock::duration const & duration_a)
+{
+	m_busy[(size_t)stage_a] += std::chrono::duration_cast<std::chrono::microseconds>(duration_a).count();
+}
+
+void mcp::stable_pipeline::set_pending(size_t const & pending_a)
+{
+	m_pending = pending_a;
+	if (pending_a > m_max_pending)
+		m_max_pending = pending_a;
+}
+
+std::string mcp::stable_pipeline::get_info()
+{
+	uint64_t elapsed(std::max<uint64_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count()));
+	auto percent = [elapsed](uint64_t busy_a) { return busy_a * 100 / elapsed; };
+
+	std::stringstream s;
+	s << "stable pipeline execute:" << percent(m_busy[(size_t)stage::execute]) << "%"
+		<< " ,receipts_root:" << percent(m_busy[(size_t)stage::receipts_root]) << "%"
+		<< " ,persist:" << percent(m_busy[(size_t)stage::persist]) << "%"
+		<< " ,pending:" << m_pending << "/" << m_depth
+		<< " ,max pending:" << m_max_pending;
+	return s.str();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace mcp
+{
+	/// stages of making blocks stable: execute -> receipts root -> persist summary.
+	/// receipts root of block N is built on the pipeline thread while block N+1 is executed,
+	/// summaries are persisted in stable order by the caller.
+	class stable_pipeline
+	{
+	public:
+		enum class stage
+		{
+			execute = 0,
+			receipts_root,
+			persist,
+			count
+		};
+
+		/// depth_a: max blocks waiting for summary persist
+		explicit stable_pipeline(size_t const & depth_a);
+		~stable_pipeline();
+
+		std::future<dev::h256> receipts_root(std::vector<dev::bytes> && receipts_a);
+
+		size_t depth() const { return m_depth; }
+
+		/// busy time of stage, measured by the caller for execute and persist
+		void add_busy(stage const & stage_a, std::chrono::steady_clock::duration const & duration_a);
+		void set_pending(size_t const & pending_a);
+
+		std::string get_info();
+
+	private:
+		void run();
+
+		size_t const m_depth;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::deque<std::packaged_task<dev::h256()>> m_tasks;
+		bool m_stopped = false;
+
+		std::chrono::steady_clock::time_point const m_start;
+		std::atomic<uint64_t> m_busy[(size_t)stage::count];
+		std::atomic<size_t> m_pending = { 0 };
+		std::atomic<size_t> m_max_pending = { 0 };
+
+		std::thread m_thread;
+	};
+
+	/// add elapsed time to a pipeline stage on destruction
+	class stable_pipeline_timer
+	{
+	public:
+		stable_pipeline_timer(mcp::stable_pipeline & pipeline_a, mcp::stable_pipeline::stage const & stage_a) :
+			m_pipeline(pipeline_a),
+			m_stage(stage_a),
+			m_start(std::chrono::steady_clock::now())
+		{
+		}
+
+		~stable_pipeline_timer()
+		{
+			m_pipeline.add_busy(m_stage, std::chrono::steady_clock::now() - m_start);
+		}
+
+	private:
+		mcp::stable_pipeline & m_pipeline;
+		mcp::stable_pipeline::stage m_stage;
+		std::chrono::steady_clock::time_point m_start;
+	};
+}
@@ -2,6 +2,17 @@
 #include "requesting.hpp"
 #include <libdevcore/TrieHash.h>
 #include <mcp/core/param.hpp>
+#include <mcp/core/genesis.hpp>
+
+namespace
+{
+	/// reader is replaced on manifest request if no request was served for this long
+	std::chrono::minutes const snapshot_idle_timeout(10);
+	size_t const snapshot_chunk_bytes(4 * 1024 * 1024);
+	boost::posix_time::seconds const snapshot_request_timeout(30);
+	/// wait before requesting a proof again that peer has not yet witnessed
+	boost::posix_time::seconds const snapshot_proof_retry(10);
+}
 
 mcp::sync_request_status::sync_request_status(mcp::p2p::node_id const & request_node_id_a,
 	mcp::sub_packet_type const & request_type_a) :
@@ -73,6 +84,8 @@ mcp::node_sync::node_sync(
 	m_request_joints_thread = std::thread([this]() { this->process_request_joints(); });
 	m_sync_timer = std::make_unique<ba::deadline_timer>(io_service_a);
 	m_sync_request_timer = std::make_unique<ba::deadline_timer>(io_service_a);
+	m_hash_tree_timer = std::make_unique<ba::deadline_timer>(io_service_a);
+	m_fast_sync_timer = std::make_unique<ba::deadline_timer>(io_service_a);
 }
 
 void mcp::node_sync::stop()
@@ -89,6 +102,10 @@ void mcp::node_sync::stop()
 		m_sync_timer->cancel(ec);
 	if (m_sync_request_timer)
 		m_sync_request_timer->cancel(ec);
+	if (m_hash_tree_timer)
+		m_hash_tree_timer->cancel(ec);
+	if (m_fast_sync_timer)
+		m_fast_sync_timer->cancel(ec);
 
 	if (m_request_joints_thread.joinable())
 	{
@@ -706,21 +723,16 @@ void mcp::node_sync::request_catchup_second(p2p::node_id const & id)
 	request_remote_mc(transaction, id, from_summary, unstable_tail_block);
 }
 
-mcp::sync_result mcp::node_sync::request_next_hash_tree(p2p::node_id const& id, uint64_t const & next_start_index)
+mcp::sync_result mcp::node_sync::request_next_hash_tree(p2p::node_id const& id)
 {
 	mcp::sync_result result(mcp::sync_result::ok);
 
 	m_request_info.id = id;
-	mcp::summary_hash from_summary(0);
-	mcp::summary_hash to_summary(0);
-	uint64_t index_to = 0;
 	{
 		//get last request index
 		mcp::db::db_transaction transaction(m_store.create_transaction());
 		while (true)
 		{
-			if (next_start_index != 0)
-				break;
 			mcp::summary_hash summary_hash;
 			if (m_store.catchup_chain_summaries_get(transaction, m_request_info.index - 1, summary_hash))
 				break;
@@ -750,14 +762,10 @@ mcp::sync_result mcp::node_sync::request_next_hash_tree(p2p::node_id const& id,
 			if (m_store.catchup_max_index_get(transaction, m_request_info.max_index))//must be exist
 				assert_x(false);
 		}
-		
-		//get from_summary
+
+		mcp::summary_hash from_summary(0);
 		if (m_store.catchup_chain_summaries_get(transaction, m_request_info.index, from_summary))
 		{
-			if (next_start_index != 0)
-			{
-				assert_x_msg(false, "request_next_hash_tree: catchup_chain_summaries is impossible empty.");
-			}
 			LOG(log_sync.info) << "send hash tree request:error: summary is null.";
 			mcp::sync_result result = mcp::sync_result::request_next_hash_tree_no_summary;
 			m_request_info.clear();
@@ -771,54 +779,127 @@ mcp::sync_result mcp::node_sync::request_next_hash_tree(p2p::node_id const& id,
 			LOG(log_sync.info) << "index small than 1.";
 			return mcp::sync_result::request_next_hash_tree_one_summary;
 		}
+	}
 
-		//to summary
-		index_to = m_request_info.index - 1;
-		if (m_store.catchup_chain_summaries_get(transaction, index_to, to_summary))
-		{
-			assert_x_msg(false, "request_next_hash_tree: catchup_chain_summaries is impossible empty.");
-		}
+	{
+		std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+		m_hash_tree.start(id, m_request_info.index);
 	}
+	fill_hash_tree_window();
+	start_hash_tree_timer();
+	return result;
+}
 
-	m_request_info.set_info(from_summary, to_summary, next_start_index);
+void mcp::node_sync::fill_hash_tree_window()
+{
+	std::vector<p2p::node_id> peers;
+	{
+		std::lock_guard<std::mutex> lock(m_capability->m_peers_mutex);
+		for (auto const & p : m_capability->m_peers)
+			peers.push_back(p.first);
+	}
 
-	mcp::hash_tree_request_message request(from_summary, to_summary);
-	request.next_start_index = next_start_index;
+	std::vector<mcp::hash_tree_request_item> requests;
+	bool stalled(false);
+	{
+		std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+		if (!m_hash_tree.is_active())
+			return;
 
-	uint64_t timestamp(mcp::seconds_since_epoch());
-	mcp::sub_packet_type ty(mcp::sub_packet_type::hash_tree_request);
-	request.request_id = mcp::gen_sync_request_hash(id, timestamp, ty);
+		uint64_t index;
+		if (m_hash_tree.next_range_index(index))
+		{
+			mcp::db::db_transaction transaction(m_store.create_transaction());
+			do
+			{
+				mcp::summary_hash from_summary(0);
+				mcp::summary_hash to_summary(0);
+				if (m_store.catchup_chain_summaries_get(transaction, index, from_summary)
+					|| m_store.catchup_chain_summaries_get(transaction, index - 1, to_summary))
+				{
+					assert_x_msg(false, "request_next_hash_tree: catchup_chain_summaries is impossible empty.");
+				}
+				m_hash_tree.add_range(mcp::hash_tree_range(index, from_summary, to_summary));
+			} while (m_hash_tree.next_range_index(index));
+		}
 
-	LOG(log_sync.debug) << "send hash tree request, from summary: " << from_summary.hex()
-		<< ", to summary: " << to_summary.hex() << ",next index:" << next_start_index << ",request_id:" << request.request_id.hex();
+		m_hash_tree.assign(peers, requests);
+		///no peer to request from and nothing to wait for
+		stalled = requests.empty() && m_hash_tree.is_stalled();
+	}
 
+	if (stalled)
+	{
+		LOG(log_sync.info) << "hash tree request: no peer available";
+		clear_catchup_info();
+		return;
+	}
 
-	send_hash_tree_request(id, request);
-	return result;
+	bool excluded(false);
+	for (auto const & r : requests)
+	{
+		LOG(log_sync.debug) << "send hash tree request, from summary: " << r.message.from_summary.hex()
+			<< ", to summary: " << r.message.to_summary.hex() << ",next index:" << r.message.next_start_index
+			<< ",request_id:" << r.message.request_id.hex() << ",peer:" << r.peer.hex();
+		if (!send_hash_tree_request(r.peer, r.message))
+		{
+			std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+			m_hash_tree.exclude(r.peer);
+			excluded = true;
+		}
+	}
+
+	///requests of disconnected peers go to other peers
+	if (excluded)
+		fill_hash_tree_window();
 }
 
-void mcp::node_sync::send_hash_tree_request(p2p::node_id const & id, mcp::hash_tree_request_message const & message)
+void mcp::node_sync::start_hash_tree_timer()
 {
-	std::lock_guard<std::mutex> lock(m_capability->m_peers_mutex);
-	if (m_capability->m_peers.count(id))
+	m_hash_tree_timer->expires_from_now(boost::posix_time::seconds(1));
+	m_hash_tree_timer->async_wait([this](boost::system::error_code const & error)
 	{
-		add_task_sync_request_timer(id, mcp::sub_packet_type::hash_tree_request);
-		mcp::peer_info &pi(m_capability->m_peers.at(id));
-		if (auto p = pi.try_lock_peer())
+		if (error || m_stoped)
+			return;
+
+		bool expired(false);
 		{
-			mcp::CapMetricsSend.hash_tree_request++;
+			std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+			if (!m_hash_tree.is_active())
+				return;
+			expired = !m_hash_tree.expire(std::chrono::steady_clock::now());
+		}
 
-			m_current_request_id = message.request_id;
-			dev::RLPStream s;
-			p->prep(s, pi.offset + (unsigned)mcp::sub_packet_type::hash_tree_request, 1);
-			message.stream_RLP(s);
-			p->send(s);
+		if (expired)
+		{
+			LOG(log_sync.info) << "hash tree request timeout, no retry left";
+			clear_catchup_info();
+			return;
 		}
-	}
-	else
-	{
-		clear_catchup_info();
-	}
+
+		fill_hash_tree_window();
+		start_hash_tree_timer();
+	});
+}
+
+bool mcp::node_sync::send_hash_tree_request(p2p::node_id const & id, mcp::hash_tree_request_message const & message)
+{
+	std::lock_guard<std::mutex> lock(m_capability->m_peers_mutex);
+	if (!m_capability->m_peers.count(id))
+		return false;
+
+	mcp::peer_info &pi(m_capability->m_peers.at(id));
+	auto p = pi.try_lock_peer();
+	if (!p)
+		return false;
+
+	mcp::CapMetricsSend.hash_tree_request++;
+
+	dev::RLPStream s;
+	p->prep(s, pi.offset + (unsigned)mcp::sub_packet_type::hash_tree_request, 1);
+	message.stream_RLP(s);
+	p->send(s);
+	return true;
 }
 
 mcp::sync_result mcp::node_sync::process_catchup_chain(mcp::catchup_response_message const& catchup_chain)
@@ -1317,7 +1398,7 @@ void mcp::node_sync::send_hash_tree_response(p2p::node_id const& id, mcp::hash_t
 	}
 }
 
-void mcp::node_sync::hash_tree_response_handler(p2p::node_id const &id, mcp::hash_tree_response_message const &message)
+void mcp::node_sync::hash_tree_response_handler(p2p::node_id const &id, std::shared_ptr<mcp::hash_tree_response_message> const &message)
 {
 	try
 	{
@@ -1326,7 +1407,18 @@ void mcp::node_sync::hash_tree_response_handler(p2p::node_id const &id, mcp::has
 		if (m_stoped)
 			return;
 
-		process_hash_tree(id, message);
+		{
+			std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+			if (!m_hash_tree.on_response(id, message))
+			{
+				LOG(log_sync.debug) << "hash tree response not requested or timeout, request_id:" << message->request_id.hex() << ",peer:" << id.hex();
+				return;
+			}
+		}
+
+		///next page of the range is requested before this page is processed
+		fill_hash_tree_window();
+		process_hash_tree_responses();
 	}
 	catch (const std::exception& e)
 	{
@@ -1335,29 +1427,87 @@ void mcp::node_sync::hash_tree_response_handler(p2p::node_id const &id, mcp::has
 	}
 }
 
-void mcp::node_sync::process_hash_tree(p2p::node_id const &id, mcp::hash_tree_response_message const &hash_tree_response)
+void mcp::node_sync::process_hash_tree_responses()
 {
-	if (m_block_processor->is_full())
+	uint64_t version;
+	{
+		std::lock_guard<std::mutex> lock(m_request_info.version_mutex);
+		version = m_request_info.version;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+		if (m_hash_tree_processing)
+			return;
+		m_hash_tree_processing = true;
+	}
+
+	while (true)
 	{
-		LOG(log_sync.debug) << "process_hash_tree: reach pending size limit";
-		m_sync_timer->expires_from_now(boost::posix_time::seconds(1));
-		m_sync_timer->async_wait([this, id, hash_tree_response](boost::system::error_code const & error)
+		if (m_block_processor->is_full())
 		{
-			if (!error)
+			LOG(log_sync.debug) << "process_hash_tree: reach pending size limit";
 			{
-				process_hash_tree(id, hash_tree_response);
+				std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+				m_hash_tree_processing = false;
 			}
-			else
+			m_sync_timer->expires_from_now(boost::posix_time::seconds(1));
+			m_sync_timer->async_wait([this](boost::system::error_code const & error)
+			{
+				if (!error)
+				{
+					process_hash_tree_responses();
+				}
+				else if (error != boost::asio::error::operation_aborted)
+				{
+					m_status = mcp::sync_status::ok;
+					LOG(log_sync.error) << "process_hash_tree:timer error: " << error.message();
+				}
+			});
+			return;
+		}
+
+		p2p::node_id id;
+		std::shared_ptr<mcp::hash_tree_response_message> response;
+		std::unique_ptr<mcp::hash_tree_range> range;
+		{
+			std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+			mcp::hash_tree_range const * head(nullptr);
+			response = m_hash_tree.front(id, head);
+			if (!response)
 			{
-				m_status = mcp::sync_status::ok;
-				LOG(log_sync.error) << "process_hash_tree:timer error: " << error.message();
+				m_hash_tree_processing = false;
+				break;
 			}
-		});
-		return;
+			range = std::make_unique<mcp::hash_tree_range>(head->index, head->from_summary, head->to_summary);
+		}
+
+		bool next(process_hash_tree(id, *response, *range));
+		{
+			std::lock_guard<std::mutex> lock(m_request_info.version_mutex);
+			///cleared while processing, scheduler may belong to a new sync
+			if (version != m_request_info.version)
+				next = false;
+		}
+		std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+		if (!next)
+		{
+			m_hash_tree_processing = false;
+			return;
+		}
+		m_hash_tree.pop_front();
 	}
 
+	///buffer limit may have stopped requests
+	fill_hash_tree_window();
+}
+
+bool mcp::node_sync::process_hash_tree(p2p::node_id const &id, mcp::hash_tree_response_message const &hash_tree_response, mcp::hash_tree_range const & range_a)
+{
 	LOG(log_sync.debug) << "process_hash_tree:" << hash_tree_response.request_id.hex();
 
+	m_request_info.index = range_a.index;
+	m_request_info.set_info(range_a.from_summary, range_a.to_summary, 0);
+
 	std::queue<std::shared_ptr<mcp::block_processor_item>> items;
 
 	std::shared_ptr<rocksdb::WriteOptions> w_option(mcp::db::database::default_write_options());
@@ -1473,15 +1623,15 @@ void mcp::node_sync::process_hash_tree(p2p::node_id const &id, mcp::hash_tree_re
 				}
 			}
 
-			if (s_item.summary == m_request_info.request_hash_tree_to_summary)
+			if (s_item.summary == range_a.to_summary)
 			{
-                if (m_request_info.index <= 1)//last
+                if (range_a.index <= 1)//last
                 {
                     clear_catchup_info(false);
-                    return;
+                    return false;
                 }
 
-                del_catchup_index(m_request_info.index);
+                del_catchup_index(range_a.index);
 			}
 
 			add_hash_tree_summary(tx, it->summary);
@@ -1522,7 +1672,7 @@ void mcp::node_sync::process_hash_tree(p2p::node_id const &id, mcp::hash_tree_re
 		if (error)
 		{
 			clear_catchup_info();
-			return;
+			return false;
 		}
 	}
 	catch (std::exception const & e)
@@ -1533,21 +1683,7 @@ void mcp::node_sync::process_hash_tree(p2p::node_id const &id, mcp::hash_tree_re
 	}
 
 	m_block_processor->add_many_to_mt_process(std::move(items));
-
-	if (hash_tree_response.next_start_index != 0)
-	{
-		LOG(log_sync.debug) << " process_hash_tree:next:index = " << hash_tree_response.next_start_index;
-		request_next_hash_tree(id, hash_tree_response.next_start_index);
-		return;
-	}
-
-	{
-		m_request_info.index--;
-		if (m_request_info.index > 0)
-		{
-			request_next_hash_tree(id);
-		}
-	}
+	return true;
 }
 
 void mcp::node_sync::del_catchup_index(uint64_t index)
@@ -1590,6 +1726,10 @@ void mcp::node_sync::clear_catchup_info(bool lock)
 			m_request_info.clear();
 			m_sync_requests.clear();
 		}
+		{
+			std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+			m_hash_tree.clear();
+		}
 		if (lock)
 			std::lock_guard<std::mutex> lock(m_del_catchup_mutex);
 
@@ -1621,6 +1761,8 @@ void mcp::node_sync::clear_catchup_info(bool lock)
 	boost::system::error_code ec;
 	if (m_sync_request_timer)
 		m_sync_request_timer->cancel(ec);
+	if (m_hash_tree_timer)
+		m_hash_tree_timer->cancel(ec);
 
     m_status = mcp::sync_status::ok;
 
@@ -1770,7 +1912,7 @@ void mcp::node_sync::add_hash_tree_summary(mcp::timeout_db_transaction & tx_a, m
 {
 	mcp::db::db_transaction & transaction(tx_a.get_transaction());
 	m_store.hash_tree_summary_put(transaction, summary_a);
-	tx_a.commit_if_timeout();
+	tx_a.commit_if_needed();
 }
 
 void mcp::node_sync::purge_handled_summaries_from_hash_tree()
@@ -2026,7 +2168,7 @@ void mcp::node_sync::send_approve_request(p2p::node_id const & id, mcp::approve_
 
 void mcp::node_sync::send_peer_info_request(p2p::node_id id)
 {
-	if (!is_syncing())
+	if (!is_syncing() && !is_fast_syncing())
 	{
 		std::lock_guard<std::mutex> lock(m_capability->m_peers_mutex);
 		if (m_capability->m_peers.count(id))
@@ -2106,7 +2248,551 @@ std::string mcp::node_sync::get_sync_info()
 	str = str + ", catchup_del_index:" + std::to_string(m_request_info.catchup_del_index.size());
 	str = str + ", catchup to summary size:" + std::to_string(m_request_info.to_summary_index.size());
 	str = str + ", m_joint_request_pending size:" + std::to_string(m_joint_request_pending.size());
+	{
+		std::lock_guard<std::mutex> lock(m_hash_tree_mutex);
+		str = str + ", " + m_hash_tree.get_info();
+	}
 	//str = str + ", del_hash_tree_summaries size:" + std::to_string(m_to_del_hash_tree_summaries.size());
 	return str;
 }
 
+void mcp::node_sync::snapshot_request_handler(p2p::node_id const & id, mcp::snapshot_request_message const & request)
+{
+	try
+	{
+		mcp::stopwatch_guard sw("sync:snapshot_request_handler");
+
+		if (m_stoped)
+			return;
+
+		mcp::snapshot_response_message response;
+		response.request_id = request.request_id;
+		response.type = request.type;
+
+		std::shared_ptr<mcp::state_snapshot_reader> reader;
+		{
+			std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+			std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+			if (request.type == mcp::snapshot_request_type::manifest
+				&& (!m_snapshot_reader || now - m_snapshot_served > snapshot_idle_timeout))
+				m_snapshot_reader = std::make_shared<mcp::state_snapshot_reader>(m_store);
+
+			///chunks and proofs are served from the snapshot of the manifest only
+			if (m_snapshot_reader && (request.type == mcp::snapshot_request_type::manifest
+				|| m_snapshot_reader->manifest().stable_summary == request.stable_summary))
+			{
+				reader = m_snapshot_reader;
+				m_snapshot_served = now;
+			}
+		}
+
+		if (!reader)
+			response.status = mcp::snapshot_response_status::unavailable;
+		else if (request.type == mcp::snapshot_request_type::manifest)
+			response.manifest = reader->manifest();
+		else if (request.type == mcp::snapshot_request_type::chunk)
+		{
+			if (reader->read(request.table, request.from_key, snapshot_chunk_bytes, response.chunk))
+				response.status = mcp::snapshot_response_status::unavailable;
+		}
+		else
+			read_snapshot_proof(reader->manifest(), response);
+
+		send_snapshot_response(id, response);
+	}
+	catch (const std::exception& e)
+	{
+		LOG(log_sync.error) << "snapshot_request_handler error:" << e.what();
+		throw;
+	}
+}
+
+void mcp::node_sync::read_snapshot_proof(mcp::snapshot_manifest const & manifest_a, mcp::snapshot_response_message & response_a)
+{
+	response_a.status = mcp::snapshot_response_status::pending;
+	mcp::db::db_transaction transaction(m_store.create_transaction());
+
+	mcp::witness_param const w_param(mcp::param::witness_param(transaction, m_chain->last_epoch()));
+	size_t distinct_witness_size = w_param.witness_count - w_param.majority_of_witnesses + 1; //there must be at least one honest witness
+
+	uint64_t last_mci;
+	std::shared_ptr<rocksdb::ManagedSnapshot> snapshot;
+	while (true)
+	{
+		snapshot = m_store.create_snapshot();
+		last_mci = m_chain->last_mci();
+
+		//make sure last mci exists in snapshot
+		mcp::block_hash last_mc_hash;
+		if (!m_store.main_chain_get(transaction, last_mci, last_mc_hash, snapshot))
+			break;
+	}
+
+	// main chain joints from last mci down until enough distinct witnesses, as in catchup chain
+	dev::h160Hash arr_found_witnesses;
+	mcp::block_hash last_summary_block(0);
+	for (uint64_t mci(last_mci); mci > manifest_a.last_stable_mci && response_a.witness_joints.size() < mcp::p2p::max_summary_items; mci--)
+	{
+		mcp::block_hash mc_hash;
+		bool mc_exists(!m_store.main_chain_get(transaction, mci, mc_hash, snapshot));
+		assert_x(mc_exists);
+
+		std::shared_ptr<mcp::block> mc_block(m_cache->block_get(transaction, mc_hash));
+		response_a.witness_joints.push_back(mcp::joint_message(mc_block));
+		arr_found_witnesses.insert(mc_block->from());
+		if (arr_found_witnesses.size() >= distinct_witness_size)
+		{
+			last_summary_block = mc_block->last_summary_block();
+			break;
+		}
+	}
+
+	std::shared_ptr<mcp::block_state> last_summary_state(last_summary_block == mcp::block_hash(0) ? nullptr : m_cache->block_state_get(transaction, last_summary_block));
+	if (!last_summary_state || !last_summary_state->is_on_main_chain || !last_summary_state->main_chain_index
+		|| *last_summary_state->main_chain_index < manifest_a.last_stable_mci
+		|| mcp::epoch(*last_summary_state->main_chain_index) != m_chain->last_epoch())
+	{
+		response_a.witness_joints.clear();
+		return;
+	}
+
+	// summaries of main chain blocks from last summary block down to last stable mci of manifest
+	for (uint64_t mci(*last_summary_state->main_chain_index); ; mci--)
+	{
+		mcp::block_hash bh;
+		bool exists(!m_store.main_chain_get(transaction, mci, bh, snapshot));
+		assert_x(exists);
+
+		std::shared_ptr<mcp::block> block_ptr(m_cache->block_get(transaction, bh));
+		std::shared_ptr<mcp::block_state> bs(m_cache->block_state_get(transaction, bh));
+		mcp::summary_hash sh;
+		bool summary_error(m_cache->block_summary_get(transaction, bh, sh));
+		assert_x(!summary_error);
+
+		mcp::summary_hash previous_summary(0);
+		if (block_ptr->previous() != mcp::block_hash(0))
+		{
+			bool previous_summary_hash_error(m_cache->block_summary_get(transaction, block_ptr->previous(), previous_summary));
+			assert_x(!previous_summary_hash_error);
+		}
+
+		std::list<mcp::summary_hash> p_summaries;
+		for (mcp::block_hash const & parent : block_ptr->parents())
+		{
+			mcp::summary_hash ps;
+			bool parent_summary_error(m_cache->block_summary_get(transaction, parent, ps));
+			assert_x(!parent_summary_error);
+			p_summaries.push_back(ps);
+		}
+
+		mcp::skiplist_info s_info;
+		m_store.skiplist_get(transaction, bh, s_info);
+		std::set<mcp::summary_hash> s_summaries;
+		for (mcp::block_hash const & skip : s_info.list)
+		{
+			mcp::summary_hash ss;
+			bool skiplist_summary_error(m_cache->block_summary_get(transaction, skip, ss));
+			assert_x(!skiplist_summary_error);
+			s_summaries.insert(ss);
+		}
+
+		h256 receiptsRoot;
+		bool receipts_root_exists(m_store.GetBlockReceiptsRoot(transaction, bh, receiptsRoot));
+		assert_x(receipts_root_exists);
+
+		response_a.summaries.push_back(mcp::hash_tree_response_message::summary_items(bh, sh, previous_summary, p_summaries, receiptsRoot, s_summaries,
+			bs->status, bs->stable_index, bs->mc_timestamp, bs->level, block_ptr, {}, {}, mci, s_info.list));
+		if (mci == manifest_a.last_stable_mci)
+			break;
+	}
+	response_a.status = mcp::snapshot_response_status::ok;
+}
+
+void mcp::node_sync::send_snapshot_response(p2p::node_id const & id, mcp::snapshot_response_message const & message)
+{
+	std::lock_guard<std::mutex> lock(m_capability->m_peers_mutex);
+	if (m_capability->m_peers.count(id))
+	{
+		mcp::peer_info &pi(m_capability->m_peers.at(id));
+		if (auto p = pi.try_lock_peer())
+		{
+			mcp::CapMetricsSend.send_snapshot++;
+
+			dev::RLPStream s;
+			p->prep(s, pi.offset + (unsigned)mcp::sub_packet_type::snapshot_response, 1);
+			message.stream_RLP(s);
+			p->send(s);
+		}
+	}
+}
+
+void mcp::node_sync::fast_sync(std::function<void(bool const &)> const & done_a)
+{
+	std::lock_guard<std::mutex> lock(m_fast_sync_mutex);
+	///genesis of network, hello and manifest are checked against it
+	mcp::Transaction genesis_transaction;
+	mcp::Transactions staking;
+	mcp::genesis::create(genesis_transaction, staking);
+
+	m_fast_sync_done = done_a;
+	m_fast_syncing = true;
+	LOG(log_sync.info) << "Fast sync started, genesis:" << mcp::genesis::block_hash.hex();
+	start_fast_sync_timer(snapshot_request_timeout);
+}
+
+void mcp::node_sync::request_snapshot(p2p::node_id const & id)
+{
+	std::lock_guard<std::mutex> lock(m_fast_sync_mutex);
+	if (!m_fast_syncing || !m_fast_sync_done || m_fast_sync_peer != p2p::node_id(0) || m_fast_sync_bad_peers.count(id))
+		return;
+
+	m_fast_sync_peer = id;
+	LOG(log_sync.info) << "Fast sync from peer:" << id.hex();
+	request_next_snapshot();
+}
+
+void mcp::node_sync::request_next_snapshot()
+{
+	mcp::snapshot_request_message request;
+	if (m_fast_sync_writer)
+	{
+		request.stable_summary = m_fast_sync_manifest->stable_summary;
+		if (m_fast_sync_writer->next(request.table, request.from_key))
+			request.type = mcp::snapshot_request_type::chunk;
+		else
+			request.type = mcp::snapshot_request_type::proof;
+	}
+
+	mcp::sub_packet_type ty(mcp::sub_packet_type::snapshot_request);
+	request.request_id = mcp::gen_sync_request_hash(m_fast_sync_peer, m_fast_sync_requests++, ty);
+	m_fast_sync_request = request;
+	m_fast_sync_waiting = true;
+	send_snapshot_request(m_fast_sync_peer, request);
+	start_fast_sync_timer(snapshot_request_timeout);
+}
+
+void mcp::node_sync::send_snapshot_request(p2p::node_id const & id, mcp::snapshot_request_message const & message)
+{
+	std::lock_guard<std::mutex> lock(m_capability->m_peers_mutex);
+	if (m_capability->m_peers.count(id))
+	{
+		mcp::peer_info &pi(m_capability->m_peers.at(id));
+		if (auto p = pi.try_lock_peer())
+		{
+			mcp::CapMetricsSend.snapshot_request++;
+
+			dev::RLPStream s;
+			p->prep(s, pi.offset + (unsigned)mcp::sub_packet_type::snapshot_request, 1);
+			message.stream_RLP(s);
+			p->send(s);
+		}
+	}
+}
+
+void mcp::node_sync::snapshot_response_handler(p2p::node_id const & id, mcp::snapshot_response_message const & response)
+{
+	try
+	{
+		mcp::stopwatch_guard sw("sync:snapshot_response_handler");
+
+		if (m_stoped)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_fast_sync_mutex);
+		if (!m_fast_sync_done || !m_fast_sync_waiting || id != m_fast_sync_peer
+			|| response.request_id != m_fast_sync_request.request_id || response.type != m_fast_sync_request.type)
+		{
+			LOG(log_sync.debug) << "snapshot response not requested or timeout, request_id:" << response.request_id.hex() << ",peer:" << id.hex();
+			return;
+		}
+		m_fast_sync_waiting = false;
+		boost::system::error_code ec;
+		m_fast_sync_timer->cancel(ec);
+
+		if (response.status == mcp::snapshot_response_status::pending)
+		{
+			LOG(log_sync.info) << "Fast sync stable summary is not yet witnessed by peer, request proof again later";
+			start_fast_sync_timer(snapshot_proof_retry);
+			return;
+		}
+		if (response.status != mcp::snapshot_response_status::ok)
+		{
+			if (m_fast_sync_writer)
+			{
+				LOG(log_sync.error) << "Fast sync peer does not serve snapshot any more, import can not be resumed";
+				finish_fast_sync(true);
+			}
+			else
+				switch_snapshot_peer(false);
+			return;
+		}
+
+		switch (response.type)
+		{
+		case mcp::snapshot_request_type::manifest:
+		{
+			if (response.manifest.genesis_hash != mcp::genesis::block_hash || response.manifest.version != m_store.version_get())
+			{
+				LOG(log_sync.info) << "Fast sync manifest of other genesis or version, peer:" << id.hex();
+				switch_snapshot_peer(true);
+				return;
+			}
+
+			bool error(false);
+			std::unique_ptr<mcp::state_snapshot_writer> writer(std::make_unique<mcp::state_snapshot_writer>(error, m_store, response.manifest));
+			if (error)
+			{
+				finish_fast_sync(true);
+				return;
+			}
+			m_fast_sync_manifest = std::make_unique<mcp::snapshot_manifest>(response.manifest);
+			m_fast_sync_writer = std::move(writer);
+			LOG(log_sync.info) << "Fast sync manifest, last stable mci:" << m_fast_sync_manifest->last_stable_mci
+				<< " ,stable summary:" << m_fast_sync_manifest->stable_summary.hex();
+			break;
+		}
+		case mcp::snapshot_request_type::chunk:
+		{
+			if (response.chunk.table != m_fast_sync_request.table || m_fast_sync_writer->write(response.chunk))
+			{
+				LOG(log_sync.error) << "Fast sync chunk rejected, table:" << (unsigned)response.chunk.table << " ,peer:" << id.hex();
+				finish_fast_sync(true);
+				return;
+			}
+			break;
+		}
+		default:
+		{
+			mcp::summary_hash summary;
+			if (verify_snapshot_proof(response, summary) || m_fast_sync_writer->finish(summary))
+			{
+				LOG(log_sync.error) << "Fast sync stable summary is not proven, peer:" << id.hex();
+				finish_fast_sync(true);
+				return;
+			}
+			LOG(log_sync.info) << "Fast sync imported, " << m_fast_sync_writer->get_info();
+			finish_fast_sync(false);
+			return;
+		}
+		}
+
+		request_next_snapshot();
+	}
+	catch (const std::exception& e)
+	{
+		LOG(log_sync.error) << "snapshot_response_handler error:" << e.what();
+		throw;
+	}
+}
+
+bool mcp::node_sync::verify_snapshot_proof(mcp::snapshot_response_message const & response_a, mcp::summary_hash & summary_a)
+{
+	std::list<mcp::hash_tree_response_message::summary_items> const & items(response_a.summaries);
+	if (items.empty() || response_a.witness_joints.empty())
+		return true;
+
+	///witness list of epoch of last summary block, main chain blocks of summaries are one mci apart.
+	///list of epochs after genesis epoch is read from imported epoch_param table
+	mcp::db::db_transaction transaction(m_store.create_transaction());
+	uint64_t const last_summary_mci(m_fast_sync_manifest->last_stable_mci + items.size() - 1);
+	mcp::Epoch const epoch(mcp::epoch(last_summary_mci));
+	mcp::witness_param const w_param(mcp::param::witness_param(transaction, epoch));
+	size_t distinct_witness_size = w_param.witness_count - w_param.majority_of_witnesses + 1; //there must be at least one honest witness
+	if (w_param.witness_list.empty())
+	{
+		LOG(log_sync.info) << "verify_snapshot_proof:no witness list of epoch " << epoch;
+		return true;
+	}
+
+	dev::h160Hash arr_found_witnesses;
+	std::vector<mcp::block_hash> arr_parent_blocks;
+	mcp::block_hash last_summary_block(0);
+	mcp::summary_hash last_summary(0);
+	for (auto const & joint : response_a.witness_joints)
+	{
+		std::shared_ptr<mcp::block> block(joint.block);
+		mcp::block_hash const & bh(block->hash());
+		if (!arr_parent_blocks.empty() && std::find(arr_parent_blocks.begin(), arr_parent_blocks.end(), bh) == arr_parent_blocks.end())
+		{
+			LOG(log_sync.info) << "verify_snapshot_proof:not in parents";
+			return true;
+		}
+		if (dev::toAddress(dev::recover(block->signature(), bh)) != block->from())
+		{
+			LOG(log_sync.info) << "verify_snapshot_proof:invalid signature";
+			return true;
+		}
+		if (!mcp::param::is_witness(transaction, epoch, block->from()))
+		{
+			LOG(log_sync.info) << "verify_snapshot_proof:not witness:" << block->from().hex();
+			return true;
+		}
+		arr_parent_blocks = block->parents();
+		arr_found_witnesses.insert(block->from());
+		if (arr_found_witnesses.size() >= distinct_witness_size)
+		{
+			last_summary_block = block->last_summary_block();
+			last_summary = block->last_summary();
+			break;
+		}
+	}
+	if (arr_found_witnesses.size() < distinct_witness_size)
+	{
+		LOG(log_sync.info) << "verify_snapshot_proof:not enough witnesses";
+		return true;
+	}
+
+	///summaries from last summary block down to stable block of manifest, each is a parent of the previous one
+	mcp::hash_tree_response_message::summary_items const * previous(nullptr);
+	mcp::summary_hash summary(0);
+	for (auto const & item : items)
+	{
+		if (!item.block || item.block->hash() != item.block_hash)
+			return true;
+		summary = mcp::summary::gen_summary_hash(item.block_hash, item.previous_summary, item.parent_summaries,
+			item.receiptsRoot, item.skiplist_summaries, item.status, item.stable_index, item.mc_timestamp);
+
+		if (!previous)
+		{
+			if (item.block_hash != last_summary_block || summary != last_summary)
+			{
+				LOG(log_sync.info) << "verify_snapshot_proof:summary is not last summary of witnesses";
+				return true;
+			}
+		}
+		else
+		{
+			std::vector<mcp::block_hash> const & parents(previous->block->parents());
+			if (std::find(parents.begin(), parents.end(), item.block_hash) == parents.end()
+				|| std::find(previous->parent_summaries.begin(), previous->parent_summaries.end(), summary) == previous->parent_summaries.end())
+			{
+				LOG(log_sync.info) << "verify_snapshot_proof:summary is not parent summary, block:" << item.block_hash.hex();
+				return true;
+			}
+		}
+		previous = &item;
+	}
+
+	if (previous->block_hash != m_fast_sync_manifest->stable_block || summary != m_fast_sync_manifest->stable_summary)
+	{
+		LOG(log_sync.info) << "verify_snapshot_proof:last summary is not stable summary of manifest";
+		return true;
+	}
+	summary_a = summary;
+	return false;
+}
+
+void mcp::node_sync::switch_snapshot_peer(bool const & bad_peer_a)
+{
+	p2p::node_id previous(m_fast_sync_peer);
+	if (bad_peer_a)
+		m_fast_sync_bad_peers.insert(previous);
+	m_fast_sync_peer = p2p::node_id(0);
+	{
+		std::lock_guard<std::mutex> lock(m_capability->m_peers_mutex);
+		for (auto const & it : m_capability->m_peers)
+		{
+			if (it.first != previous && !m_fast_sync_bad_peers.count(it.first)
+				&& !m_capability->m_wait_confirm_remote_node.count(it.first))
+			{
+				m_fast_sync_peer = it.first;
+				break;
+			}
+		}
+	}
+
+	if (m_fast_sync_peer == p2p::node_id(0))
+	{
+		///previous peer is tried again after timeout if no other peer is confirmed
+		start_fast_sync_timer(snapshot_request_timeout);
+		return;
+	}
+	LOG(log_sync.info) << "Fast sync from peer:" << m_fast_sync_peer.hex();
+	request_next_snapshot();
+}
+
+void mcp::node_sync::start_fast_sync_timer(boost::posix_time::seconds const & wait_a)
+{
+	m_fast_sync_timer->expires_from_now(wait_a);
+	m_fast_sync_timer->async_wait([this](boost::system::error_code const & error)
+	{
+		if (!error)
+			fast_sync_timeout();
+	});
+}
+
+void mcp::node_sync::fast_sync_timeout()
+{
+	std::lock_guard<std::mutex> lock(m_fast_sync_mutex);
+	if (m_stoped || !m_fast_sync_done)
+		return;
+
+	if (m_fast_sync_peer == p2p::node_id(0))
+		switch_snapshot_peer(false);
+	else if (!m_fast_sync_waiting)
+		request_next_snapshot(); /// pending proof
+	else if (!m_fast_sync_writer)
+	{
+		LOG(log_sync.info) << "Fast sync request timeout, peer:" << m_fast_sync_peer.hex();
+		switch_snapshot_peer(false);
+	}
+	else
+	{
+		bool connected(false);
+		{
+			std::lock_guard<std::mutex> lock(m_capability->m_peers_mutex);
+			connected = m_capability->m_peers.count(m_fast_sync_peer) > 0;
+		}
+		if (connected)
+			request_next_snapshot();
+		else
+		{
+			LOG(log_sync.error) << "Fast sync peer disconnected, import can not be resumed";
+			finish_fast_sync(true);
+		}
+	}
+}
+
+void mcp::node_sync::finish_fast_sync(bool const & error_a)
+{
+	boost::system::error_code ec;
+	m_fast_sync_timer->cancel(ec);
+	m_fast_sync_waiting = false;
+
+	std::function<void(bool const &)> done(std::move(m_fast_sync_done));
+	m_fast_sync_done = nullptr;
+	done(error_a);
+}
+
+void mcp::node_sync::fast_sync_handoff()
+{
+	p2p::node_id id;
+	{
+		std::lock_guard<std::mutex> lock(m_fast_sync_mutex);
+		m_fast_syncing = false;
+		m_fast_sync_writer.reset();
+		id = m_fast_sync_peer;
+	}
+
+	LOG(log_sync.info) << "Fast sync catches up from last stable mci:" << m_chain->last_stable_mci();
+	m_async_task->sync_async([this, id]() {
+		request_catchup(id);
+	});
+}
+
+std::string mcp::node_sync::get_fast_sync_info()
+{
+	std::stringstream s;
+	{
+		std::lock_guard<std::mutex> lock(m_fast_sync_mutex);
+		s << "fast syncing:" << (m_fast_syncing ? "yes" : "no") << " ,requests:" << m_fast_sync_requests;
+		if (m_fast_sync_writer)
+			s << " ," << m_fast_sync_writer->get_info();
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+		if (m_snapshot_reader)
+			s << " ,serving snapshot mci:" << m_snapshot_reader->manifest().last_stable_mci;
+	}
+	return s.str();
+}
@@ -6,6 +6,8 @@
 #include <mcp/common/log.hpp>
 #include <mcp/core/block_store.hpp>
 #include <mcp/node/block_processor.hpp>
+#include <mcp/node/hash_tree_scheduler.hpp>
+#include <mcp/core/state_snapshot.hpp>
 
 namespace mcp
 {
@@ -101,7 +103,7 @@ namespace mcp
 		bool response_for_sync_request(p2p::node_id const & request_node_id_a, mcp::sub_packet_type const & request_type_a);
 		void catchup_chain_response_handler(p2p::node_id const& id, mcp::catchup_response_message const& response);
 		void hash_tree_request_handler(p2p::node_id const& id, mcp::hash_tree_request_message const& message);
-		void hash_tree_response_handler(p2p::node_id const &, mcp::hash_tree_response_message const &);
+		void hash_tree_response_handler(p2p::node_id const &, std::shared_ptr<mcp::hash_tree_response_message> const &);
 
 		void peer_info_request_handler(p2p::node_id const &);
 		void request_new_missing_joints(mcp::requesting_item& item_a, bool const& is_timeout = false);
@@ -113,6 +115,19 @@ namespace mcp
 		void approve_request_handler(p2p::node_id const &, mcp::approve_request_message const &);
 		void send_peer_info_request(p2p::node_id id);
 		void send_peer_info(p2p::node_id const &, mcp::peer_info_message const &);
+
+		/// fast sync of an empty store: state snapshot of a confirmed peer is imported once its last stable summary is
+		/// proven by witness joints, done_a is called with false when import is finished, with true if it failed.
+		/// an interrupted import is not resumed, store must be removed before fast syncing again
+		void fast_sync(std::function<void(bool const &)> const & done_a);
+		bool is_fast_syncing() const { return m_fast_syncing; }
+		/// request snapshot from confirmed peer if fast syncing and no peer is serving it
+		void request_snapshot(p2p::node_id const & id);
+		/// chain is initialized from imported store, catch up from last stable mci of snapshot
+		void fast_sync_handoff();
+		void snapshot_request_handler(p2p::node_id const & id, mcp::snapshot_request_message const & request);
+		void snapshot_response_handler(p2p::node_id const & id, mcp::snapshot_response_message const & response);
+		std::string get_fast_sync_info();
 		
 		void stop();
 
@@ -124,11 +139,18 @@ namespace mcp
 		void send_catchup_response(p2p::node_id const& id, mcp::catchup_response_message const& message);
 		mcp::sync_result process_catchup_chain(mcp::catchup_response_message const& catchup_chain);
 		void request_catchup_second(p2p::node_id const &id);
-		mcp::sync_result request_next_hash_tree(p2p::node_id const& id, uint64_t const & next_start_index = 0);
-		void send_hash_tree_request(p2p::node_id const& id, mcp::hash_tree_request_message const& message);
+		mcp::sync_result request_next_hash_tree(p2p::node_id const& id);
+		/// open ranges and send requests until window is full
+		void fill_hash_tree_window();
+		void start_hash_tree_timer();
+		/// return false if peer is not connected
+		bool send_hash_tree_request(p2p::node_id const& id, mcp::hash_tree_request_message const& message);
 		void read_hash_tree(mcp::hash_tree_request_message const& hash_tree_request, mcp::hash_tree_response_message & hash_tree_response);
 		void send_hash_tree_response(p2p::node_id const& id, mcp::hash_tree_response_message const& message);
-		void process_hash_tree(p2p::node_id const &, mcp::hash_tree_response_message const &);
+		/// process received responses in catchup chain order, one thread at a time
+		void process_hash_tree_responses();
+		/// return false if sync is finished or failed
+		bool process_hash_tree(p2p::node_id const &, mcp::hash_tree_response_message const &, mcp::hash_tree_range const &);
 
 		void send_block(p2p::node_id const & id, mcp::joint_message const & message);
 		void send_transaction(p2p::node_id const & id, mcp::Transaction const & message);
@@ -153,6 +175,21 @@ namespace mcp
 		void clear_catchup_info(bool lock = true);
         void del_catchup_index(uint64_t index);
 
+		/// witness joints and summaries of main chain blocks down to last stable mci of manifest, status is pending if not yet witnessed
+		void read_snapshot_proof(mcp::snapshot_manifest const & manifest_a, mcp::snapshot_response_message & response_a);
+		void send_snapshot_response(p2p::node_id const & id, mcp::snapshot_response_message const & message);
+		/// next request of fast sync to fast sync peer, m_fast_sync_mutex must be held
+		void request_next_snapshot();
+		void send_snapshot_request(p2p::node_id const & id, mcp::snapshot_request_message const & message);
+		/// return true if proof does not bind stable summary of manifest to enough distinct witnesses
+		bool verify_snapshot_proof(mcp::snapshot_response_message const & response_a, mcp::summary_hash & summary_a);
+		/// drop peer and request manifest from another confirmed peer, m_fast_sync_mutex must be held
+		void switch_snapshot_peer(bool const & bad_peer_a);
+		void start_fast_sync_timer(boost::posix_time::seconds const & wait_a);
+		void fast_sync_timeout();
+		/// m_fast_sync_mutex must be held
+		void finish_fast_sync(bool const & error_a);
+
 		std::shared_ptr<mcp::node_capability> m_capability;
 		mcp::block_store & m_store;
 		std::shared_ptr<mcp::chain> m_chain;
@@ -171,6 +208,11 @@ namespace mcp
 		std::unique_ptr<boost::asio::deadline_timer> m_sync_timer;
 		std::unique_ptr<boost::asio::deadline_timer> m_sync_request_timer;
 
+		mcp::hash_tree_scheduler m_hash_tree;
+		std::mutex m_hash_tree_mutex;
+		bool m_hash_tree_processing = false;
+		std::unique_ptr<boost::asio::deadline_timer> m_hash_tree_timer;
+
 		//thread 
 		std::deque<mcp::requesting_item> m_joint_request_pending;
 		std::mutex m_mutex_joint_request;
@@ -182,6 +224,25 @@ namespace mcp
 		std::mutex m_del_catchup_mutex;
 
 		std::atomic<bool> m_task_clear_flag;
+
+		/// serving, one reader at a time, replaced if idle
+		std::shared_ptr<mcp::state_snapshot_reader> m_snapshot_reader;
+		std::chrono::steady_clock::time_point m_snapshot_served;
+		std::mutex m_snapshot_mutex;
+
+		/// fast syncing
+		std::atomic<bool> m_fast_syncing = { false };
+		std::mutex m_fast_sync_mutex;
+		p2p::node_id m_fast_sync_peer = p2p::node_id(0);
+		std::unordered_set<p2p::node_id> m_fast_sync_bad_peers;
+		mcp::snapshot_request_message m_fast_sync_request;
+		/// request is sent and not answered
+		bool m_fast_sync_waiting = false;
+		uint64_t m_fast_sync_requests = 0;
+		std::unique_ptr<mcp::snapshot_manifest> m_fast_sync_manifest;
+		std::unique_ptr<mcp::state_snapshot_writer> m_fast_sync_writer;
+		std::function<void(bool const &)> m_fast_sync_done;
+		std::unique_ptr<boost::asio::deadline_timer> m_fast_sync_timer;
 		static std::atomic<sync_status> m_status;
 		bool m_stoped;
 	};
@@ -1,4 +1,5 @@
 #include "transaction_queue.hpp"
+#include <algorithm>
 #include <thread>
 
 namespace mcp
@@ -10,9 +11,22 @@ namespace mcp
 
 	constexpr size_t c_maxAccountPendingSize = 64;
 	constexpr size_t c_maxVerificationQueueSize = 40960;
+	constexpr size_t c_maxPeerVerificationQueueSize = c_maxVerificationQueueSize / 8;	///a peer can not fill the queue
+	constexpr size_t c_verificationBatchSize = 128;
 	constexpr size_t c_maxDroppedTransactionCount = 100000;
 	constexpr size_t c_maxPendingTransactionCount = 100000;
 	constexpr size_t c_maxReadyTransactionCount = 100000;
+	constexpr size_t c_maxAccountTopTransactions = 64;	///an account can not fill top transactions while other accounts wait
+	constexpr size_t c_maxPoolTransactionCount = c_maxReadyTransactionCount + c_maxPendingTransactionCount;
+	constexpr size_t c_maxPoolBytes = 256 * 1024 * 1024;
+	constexpr size_t c_maxAccountSlots = 1024;	///queue and pending transactions of an account
+	constexpr size_t c_pooledTransactionOverhead = 256;	///bytes of a pooled transaction besides its data, entries of all, known, queue and pool
+	constexpr unsigned c_replacePriceBump = 10;	///percent
+
+	size_t transactionBytes(Transaction const& _t)
+	{
+		return sizeof(Transaction) + c_pooledTransactionOverhead + _t.data().size();
+	}
 
 	TransactionQueue::TransactionQueue(
 		boost::asio::io_service& io_service_a, mcp::block_store& store_a, std::shared_ptr<mcp::block_cache> cache_a, std::shared_ptr<mcp::chain> chain_a,
@@ -23,7 +37,9 @@ namespace mcp
 		m_chain(chain_a),
 		m_async_task(async_task_a),
 		m_dropped(c_maxDroppedTransactionCount),
-		m_pendingLimit(c_maxPendingTransactionCount)
+		m_pendingLimit(c_maxPendingTransactionCount),
+		m_countLimit(c_maxPoolTransactionCount),
+		m_bytesLimit(c_maxPoolBytes)
 	{
 		unsigned verifierThreads = std::max(thread::hardware_concurrency(), 3U) - 2U;
 		for (unsigned i = 0; i < verifierThreads; ++i)
@@ -46,6 +62,15 @@ namespace mcp
 
 		if (m_clearTimer)
 			m_clearTimer->cancel();
+		if (m_processSuperfluousThread.joinable())
+			m_processSuperfluousThread.join();
+	}
+
+	void TransactionQueue::set_limits(size_t const& _count, size_t const& _bytes)
+	{
+		WriteGuard l(m_lock);
+		m_countLimit = _count;
+		m_bytesLimit = _bytes;
 	}
 
 	ImportResult TransactionQueue::check_WITH_LOCK(h256 const& _h)
@@ -65,6 +90,12 @@ namespace mcp
 	ImportResult TransactionQueue::import(std::shared_ptr<Transaction> _transaction, source _in)
 	{
 		validateTx(_transaction);
+		return importVerified(_transaction, _in);
+	}
+
+	/// _transaction checked by validateTx
+	ImportResult TransactionQueue::importVerified(std::shared_ptr<Transaction> _transaction, source _in, p2p::node_id const& _nodeId)
+	{
 		// Check if we already know this transaction.
 		h256 h = _transaction->sha3();
 		//LOG(m_log.debug) << "import transaction:" << h.hex();
@@ -80,7 +111,7 @@ namespace mcp
 			if (_in != source::request && _in != source::sync)///block lined,do not checkout balance and nonce
 				checkTx(*_transaction); ///check balance and nonce
 			UpgradeGuard ul(l);
-			ret = manageImport_WITH_LOCK(_transaction, _in);
+			ret = manageImport_WITH_LOCK(_transaction, _in, _nodeId);
 
 			//LOG(m_log.debug) << "import.......";
 			//prinf();
@@ -102,15 +133,60 @@ namespace mcp
 
 	h256s TransactionQueue::topTransactions(unsigned _limit) const
 	{
-		/// todo: link accounts randomly and limit the maximum number of transactions in a single block links 
+		/// next transaction of each taken account, heap by its gas price
+		struct cursor
+		{
+			u256 gasPrice;
+			std::map<u256, std::shared_ptr<Transaction>>::const_iterator it;
+			std::map<u256, std::shared_ptr<Transaction>>::const_iterator end;
+			size_t taken;
+		};
+		auto lower = [](cursor const& _a, cursor const& _b) { return _a.gasPrice < _b.gasPrice; };
+
 		ReadGuard l(m_lock);
 		h256s ret;
-		for (auto cs = queue.begin(); cs != queue.end(); ++cs)
+		ret.reserve(std::min<size_t>(_limit, all.size()));
+		std::vector<cursor> heap;
+		std::vector<cursor> deferred;
+		auto head = m_queueHeads.begin();
+		while (ret.size() < _limit)
 		{
-			auto r = cs->second.transactionHashs(_limit - ret.size());
-			ret.insert(ret.end(), r.begin(), r.end());
-			if (ret.size() == _limit)
-				break;
+			/// accounts are taken from heads only when their next transaction pays more than taken accounts
+			if (head != m_queueHeads.end() && (heap.empty() || head->first > heap.front().gasPrice))
+			{
+				auto const& txs = queue.at(head->second).txs;
+				heap.push_back(cursor{ head->first, txs.begin(), txs.end(), 0 });
+				std::push_heap(heap.begin(), heap.end(), lower);
+				++head;
+				continue;
+			}
+
+			/// all accounts served, accounts over the limit continue
+			if (heap.empty())
+			{
+				if (deferred.empty())
+					break;
+				heap.swap(deferred);
+				for (auto& c : heap)
+					c.taken = 0;
+				std::make_heap(heap.begin(), heap.end(), lower);
+				continue;
+			}
+
+			std::pop_heap(heap.begin(), heap.end(), lower);
+			cursor c = heap.back();
+			heap.pop_back();
+			ret.push_back(c.it->second->sha3());
+			if (++c.it == c.end)
+				continue;
+			c.gasPrice = c.it->second->gasPrice();
+			if (++c.taken >= c_maxAccountTopTransactions)
+				deferred.push_back(c);
+			else
+			{
+				heap.push_back(c);
+				std::push_heap(heap.begin(), heap.end(), lower);
+			}
 		}
 		return ret;
 	}
@@ -128,7 +204,7 @@ namespace mcp
 	}
 
 
-	ImportResult TransactionQueue::manageImport_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in)
+	ImportResult TransactionQueue::manageImport_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in, p2p::node_id const& _nodeId)
 	{
 		try
 		{
@@ -137,7 +213,7 @@ namespace mcp
 			if (NonceRange::TooSmall == r)///nonce too low, just request need insert.
 			{
 				if (_in == source::request)
-					return insertQueue_WITH_LOCK(_t, _in, false);
+					return insertQueue_WITH_LOCK(_t, _in, _nodeId, false);
 				else
 					return ImportResult::InvalidNonce;
 			}
@@ -148,15 +224,24 @@ namespace mcp
 				else
 					return ImportResult::FutureFull; ///account's transaction is full,the maximum cache size is c_maxAccountPendingSize.
 			}
+
+			/// transactions linked by blocks are always kept
+			if (_in == source::local || _in == source::broadcast)
+			{
+				auto ir = admit_WITH_LOCK(_t, _in, _nodeId);
+				if (ir != ImportResult::Success)
+					return ir;
+			}
+
 			if (NonceRange::Pending == r)/// insert to pending
 			{
 				//LOG(m_log.debug) << "Queued vaguely not legit-looking transaction " << _t->sha3().hex();
-				return insertPending_WITH_LOCK(_t);
+				return insertPending_WITH_LOCK(_t, _in, _nodeId);
 			}
 			else ///insert to queue
 			{
 				//LOG(m_log.debug) << "Queued vaguely legit-looking transaction " << _t->sha3().hex();
-				return insertQueue_WITH_LOCK(_t, _in);
+				return insertQueue_WITH_LOCK(_t, _in, _nodeId);
 			}
 		}
 		catch (Exception const& _e)
@@ -171,6 +256,91 @@ namespace mcp
 		}
 	}
 
+	ImportResult TransactionQueue::admit_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in, p2p::node_id const& _nodeId)
+	{
+		Address const& from = _t->sender();
+		auto cs = queue.find(from);
+		auto fs = pending.find(from);
+		bool replace = (cs != queue.end() && cs->second.txs.count(_t->nonce())) || (fs != pending.end() && fs->second.txs.count(_t->nonce()));
+		if (!replace)
+		{
+			size_t slots = (cs != queue.end() ? cs->second.txs.size() : 0) + (fs != pending.end() ? fs->second.txs.size() : 0);
+			if (slots >= c_maxAccountSlots)
+			{
+				m_rejectedAccount++;
+				return ImportResult::FutureFull;
+			}
+		}
+
+		///a peer can not fill the pool
+		if (_in == source::broadcast)
+		{
+			auto p = m_peerPooled.find(_nodeId);
+			if (p != m_peerPooled.end() && p->second >= m_countLimit / 8)
+			{
+				m_rejectedPeer++;
+				return ImportResult::FutureFull;
+			}
+		}
+
+		///replacing transaction takes the slot of replaced one
+		size_t bytes = transactionBytes(*_t);
+		while (!replace && (m_pooled.size() + 1 > m_countLimit || m_pooledBytes + bytes > m_bytesLimit))
+		{
+			if (evict_WITH_LOCK(_t->gasPrice()))
+			{
+				m_rejectedUnderpriced++;
+				return ImportResult::OverbidGasPrice;
+			}
+			m_evicted++;
+		}
+		return ImportResult::Success;
+	}
+
+	bool TransactionQueue::evict_WITH_LOCK(u256 const& _gasPrice)
+	{
+		/// only pending transactions are evicted, they are not in all and can not be linked by a block.
+		/// ready transactions may be linked by blocks being processed or composed.
+		auto low = m_pendingPrices.begin();
+		if (low == m_pendingPrices.end() || std::get<0>(*low) >= _gasPrice)
+			return true;
+
+		Address a = std::get<1>(*low);
+		auto t = pending[a].erase(std::get<2>(*low));
+		m_pendingPrices.erase(low);
+		if (pending[a].empty())
+			pending.erase(a);
+		--m_pendingSize;
+		m_known.erase(t->sha3());
+		poolErase_WITH_LOCK(t->sha3());
+		return false;
+	}
+
+	void TransactionQueue::poolInsert_WITH_LOCK(std::shared_ptr<Transaction> _t, p2p::node_id const& _nodeId)
+	{
+		auto r = m_pooled.emplace(_t->sha3(), PooledTransaction{ transactionBytes(*_t), _nodeId });
+		if (!r.second)
+			return;
+		m_pooledBytes += r.first->second.bytes;
+		if (_nodeId)
+			m_peerPooled[_nodeId]++;
+	}
+
+	void TransactionQueue::poolErase_WITH_LOCK(h256 const& _h)
+	{
+		auto it = m_pooled.find(_h);
+		if (it == m_pooled.end())
+			return;
+		m_pooledBytes -= it->second.bytes;
+		if (it->second.peer)
+		{
+			auto p = m_peerPooled.find(it->second.peer);
+			if (p != m_peerPooled.end() && --p->second == 0)
+				m_peerPooled.erase(p);
+		}
+		m_pooled.erase(it);
+	}
+
 	u256 TransactionQueue::maxNonce(Address const& _a, BlockNumber const blockTag) const
 	{
 		ReadGuard l(m_lock);
@@ -212,7 +382,7 @@ namespace mcp
 	}
 
 
-	ImportResult TransactionQueue::insertQueue_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in, bool includeQueue)
+	ImportResult TransactionQueue::insertQueue_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in, p2p::node_id const& _nodeId, bool includeQueue)
 	{
 		if (all.count(_t->sha3()))
 			assert_x(false);
@@ -223,17 +393,24 @@ namespace mcp
 			auto from = _t->sender();
 			if (!queue.count(from)) 
 				queue[_t->sender()] = newTxList();
-			auto r = queue[_t->sender()].add(_t);/// have transaction used nonce,replace it
+			eraseHead_WITH_LOCK(from);
+			auto r = queue[_t->sender()].add(_t, _in == source::request || _in == source::sync ? 0 : c_replacePriceBump);/// have transaction used nonce,replace it
+			insertHead_WITH_LOCK(from);
 			if (!r.first)///OverbidGasPrice
+			{
+				m_rejectedReplace++;
 				return ImportResult::OverbidGasPrice;
+			}
 			if (r.second && _in != source::sync)///replaced. remove replaced transaction from known and all.
 			{
 				all.erase(r.second->sha3());
 				m_known.erase(r.second->sha3());
+				poolErase_WITH_LOCK(r.second->sha3());
 			}
 		}
 		
 		all[_t->sha3()] = _t;
+		poolInsert_WITH_LOCK(_t, _nodeId);
 		m_known.insert(_t->sha3());
 		m_onReady(_t->sha3());
 		/// Move following transactions from pending to queue
@@ -242,7 +419,7 @@ namespace mcp
 		return ImportResult::Success;
 	}
 
-	ImportResult TransactionQueue::insertPending_WITH_LOCK(std::shared_ptr<Transaction> _t)
+	ImportResult TransactionQueue::insertPending_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in, p2p::node_id const& _nodeId)
 	{
 		if (all.count(_t->sha3()))
 			assert_x(false);
@@ -250,14 +427,23 @@ namespace mcp
 		/// find from pending. if nonce exist and it is not the same transaction,try to replaced it.
 		if (!pending.count(_t->sender())) 
 			pending[_t->sender()] = newTxList();
-		auto r = pending[_t->sender()].add(_t);/// have transaction used nonce,replace it
+		auto r = pending[_t->sender()].add(_t, _in == source::request ? 0 : c_replacePriceBump);/// have transaction used nonce,replace it
 		if (!r.first)///OverbidGasPrice
+		{
+			m_rejectedReplace++;
 			return ImportResult::OverbidGasPrice;
+		}
 		if (r.second)///replaced. remove replaced transaction from known.
+		{
 			m_known.erase(r.second->sha3());
+			m_pendingPrices.erase(std::make_tuple(r.second->gasPrice(), _t->sender(), r.second->nonce()));
+			poolErase_WITH_LOCK(r.second->sha3());
+		}
 		else///not replaced, jsut insert.
 			++m_pendingSize;
 		m_known.insert(_t->sha3());
+		m_pendingPrices.emplace(_t->gasPrice(), _t->sender(), _t->nonce());
+		poolInsert_WITH_LOCK(_t, _nodeId);
 
 		/// exceed the maximum limit, half of the pending will be deleted, delete from each account in turn, from back to front.
 		/// TODO: priority queue for future transactions
@@ -270,7 +456,11 @@ namespace mcp
 				LOG(m_log.debug) << "Dropping out of bounds account transaction "
 					<< pending.begin()->first.hex();
 				for (auto t : txl.txs)
+				{
 					m_known.erase(t.second->sha3());
+					m_pendingPrices.erase(std::make_tuple(t.second->gasPrice(), pending.begin()->first, t.first));
+					poolErase_WITH_LOCK(t.second->sha3());
+				}
 				pending.erase(pending.begin());
 			}
 		}
@@ -292,7 +482,9 @@ namespace mcp
 
 		if (queue.count(from))
 		{
+			eraseHead_WITH_LOCK(from);
 			auto delt = queue[from].erase(nonce);
+			insertHead_WITH_LOCK(from);
 			if (delt && delt->sha3() != _txHash)/// not the hash,but deleted from queue,put it to delete queue,delete it 2 minutes later
 			{
 				auto now = SteadyClock.now();
@@ -305,6 +497,7 @@ namespace mcp
 		}
 		all.erase(_txHash);
 		m_known.erase(_txHash);
+		poolErase_WITH_LOCK(_txHash);
 
 		//LOG(m_log.debug) << "remove.......";
 		//prinf();
@@ -323,16 +516,33 @@ namespace mcp
 				if (!pending[_t->from()].size()) ///if have no transactions in pending delete it.
 					pending.erase(_t->from());
 				m_pendingSize -= cur.size();
+				eraseHead_WITH_LOCK(_t->sender());
 				for (auto td : cur) ///move to queue
 				{
+					m_pendingPrices.erase(std::make_tuple(td->gasPrice(), _t->from(), td->nonce()));
 					queue[_t->sender()].add(td);
 					all[td->sha3()] = td;
 					m_onReady(td->sha3());
 				}
+				insertHead_WITH_LOCK(_t->sender());
 			}
 		}
 	}
 
+	void TransactionQueue::eraseHead_WITH_LOCK(Address const& _a)
+	{
+		auto cs = queue.find(_a);
+		if (cs != queue.end() && !cs->second.txs.empty())
+			m_queueHeads.erase(std::make_pair(cs->second.txs.begin()->second->gasPrice(), _a));
+	}
+
+	void TransactionQueue::insertHead_WITH_LOCK(Address const& _a)
+	{
+		auto cs = queue.find(_a);
+		if (cs != queue.end() && !cs->second.txs.empty())
+			m_queueHeads.emplace(cs->second.txs.begin()->second->gasPrice(), _a);
+	}
+
 	NonceRange TransactionQueue::isPending_WITH_LOCK(std::shared_ptr<Transaction> _t)
 	{
 		/// account's first transaction
@@ -392,62 +602,170 @@ namespace mcp
 		bool queued = false;
 		{
 			Guard l(x_queue);
-			if (m_unverified.size() >= c_maxVerificationQueueSize && source::broadcast == _in)
+			queued = enqueue_WITH_QUEUE_LOCK(UnverifiedTransaction(_tx, _nodeId, _in));
+		}
+		if (queued)
+			m_queueReady.notify_one();
+	}
+
+	void TransactionQueue::enqueue(bytesConstRef _rlp, h256 const& _hash, p2p::node_id const& _nodeId, source _in)
+	{
+		bool queued = false;
+		{
+			Guard l(x_queue);
+			queued = enqueue_WITH_QUEUE_LOCK(UnverifiedTransaction(_rlp, _hash, _nodeId, _in));
+		}
+		if (queued)
+			m_queueReady.notify_one();
+	}
+
+	bool TransactionQueue::enqueue_WITH_QUEUE_LOCK(UnverifiedTransaction&& _work)
+	{
+		if (source::broadcast == _work.in)
+		{
+			///same transaction broadcast by many peers, verify once
+			if (m_verifying.count(_work.hash))
 			{
+				m_verifyDeduped++;
+				return false;
+			}
+
+			///shed broadcast transactions of the flooding peer, not of all peers
+			size_t& peerQueued = m_unverifiedPeers[_work.nodeId];
+			if (m_unverified.size() >= c_maxVerificationQueueSize || peerQueued >= c_maxPeerVerificationQueueSize)
+			{
+				if (!peerQueued)
+					m_unverifiedPeers.erase(_work.nodeId);
+				m_verifyShed++;
 				LOG(m_log.debug) << "Transaction verification queue is full. Dropping transactions";
-				return;
+				return false;
 			}
-			m_unverified.emplace_back(UnverifiedTransaction(_tx, _nodeId, _in));
-			queued = true;
+			peerQueued++;
+			m_verifying.insert(_work.hash);
 		}
-		if (queued)
-			m_queueReady.notify_all();
+		m_unverified.emplace_back(std::move(_work));
+		m_maxUnverified = std::max(m_maxUnverified, m_unverified.size());
+		return true;
 	}
 
 	void TransactionQueue::verifierBody()
 	{
 		while (!m_aborting)
 		{
-			std::deque<UnverifiedTransaction> works;
+			std::vector<UnverifiedTransaction> works;
 
 			{
 				unique_lock<Mutex> l(x_queue);
 				m_queueReady.wait(l, [&]() { return !m_unverified.empty() || m_aborting; });
 				if (m_aborting)
 					return;
-				std::swap(works, m_unverified);
-			}
-
-			while (!works.empty())
-			{
-				UnverifiedTransaction work = std::move(works.front());
-				works.pop_front();
-				try
+				/// take a batch, other verifiers take the rest
+				size_t count = std::min(m_unverified.size(), c_verificationBatchSize);
+				works.reserve(count);
+				for (size_t i = 0; i < count; i++)
 				{
-					if (all.size() > c_maxReadyTransactionCount/2 && work.in == source::broadcast)///only process request or sync transactions.
+					UnverifiedTransaction& work = m_unverified.front();
+					if (source::broadcast == work.in)
 					{
-						continue;
+						auto p = m_unverifiedPeers.find(work.nodeId);
+						if (p != m_unverifiedPeers.end() && --p->second == 0)
+							m_unverifiedPeers.erase(p);
 					}
-					auto ir = import(work.transaction, work.in);
-					m_onImport(ir, work.nodeId);
+					works.push_back(std::move(work));
+					m_unverified.pop_front();
 				}
-				catch (InvalidNonce)
-				{
-					///remote network is not very good,Disconnect the peer.todo
-				}
-				catch (NotEnoughCash)
-				{
-					///remote network is not very good,Disconnect the peer.todo
-				}
-				catch (...)
+				if (!m_unverified.empty())
+					m_queueReady.notify_one();
+			}
+
+			verifyBatch(works);
+
+			{
+				Guard l(x_queue);
+				for (auto const& work : works)
 				{
-					LOG(m_log.error) << "verifierBody Bad transaction:" << boost::current_exception_diagnostic_information();
-					m_onImport(ImportResult::Malformed, work.nodeId);///  Notify capability and P2P to process peer. diconnect peer if bad transaction  
+					if (source::broadcast == work.in)
+						m_verifying.erase(work.hash);
 				}
 			}
 		}
 	}
 
+	void TransactionQueue::verifyBatch(std::vector<UnverifiedTransaction>& _works)
+	{
+		/// dedupe against known transactions before decoding and sender recovery
+		std::vector<ImportResult> results(_works.size(), ImportResult::Success);
+		{
+			ReadGuard l(m_lock);
+			for (size_t i = 0; i < _works.size(); i++)
+			{
+				if (m_known.count(_works[i].hash))
+					results[i] = ImportResult::AlreadyKnown;
+				else if (m_dropped.contains(_works[i].hash))
+					results[i] = ImportResult::AlreadyInChain;
+			}
+		}
+
+		/// decode, check and recover sender of the batch without lock
+		for (size_t i = 0; i < _works.size(); i++)
+		{
+			UnverifiedTransaction& work = _works[i];
+			if (results[i] != ImportResult::Success)
+			{
+				m_verifyDeduped++;
+				continue;
+			}
+			try
+			{
+				if (!work.transaction)
+					work.transaction = std::make_shared<Transaction>(RLP(work.rlp), CheckTransaction::Cheap);
+				/// hash of wire rlp is known and marked before decoding, it must be hash of the transaction
+				if (work.transaction->sha3() != work.hash)
+					BOOST_THROW_EXCEPTION(InvalidTransactionFormat() << errinfo_comment("transaction hash differs from rlp hash"));
+				validateTx(work.transaction);
+				work.transaction->sender();
+				m_verified++;
+			}
+			catch (...)
+			{
+				LOG(m_log.error) << "verifierBody Bad transaction:" << boost::current_exception_diagnostic_information();
+				results[i] = ImportResult::Malformed;
+				m_verifyMalformed++;
+			}
+		}
+
+		/// import in received order
+		for (size_t i = 0; i < _works.size(); i++)
+		{
+			UnverifiedTransaction& work = _works[i];
+			if (results[i] != ImportResult::Success)
+			{
+				m_onImport(results[i], work.nodeId);///  Notify capability and P2P to process peer. diconnect peer if bad transaction  
+				continue;
+			}
+			if (!work.transaction)
+				continue;
+			try
+			{
+				auto ir = importVerified(work.transaction, work.in, work.nodeId);
+				m_onImport(ir, work.nodeId);
+			}
+			catch (InvalidNonce)
+			{
+				///remote network is not very good,Disconnect the peer.todo
+			}
+			catch (NotEnoughCash)
+			{
+				///remote network is not very good,Disconnect the peer.todo
+			}
+			catch (...)
+			{
+				LOG(m_log.error) << "verifierBody Bad transaction:" << boost::current_exception_diagnostic_information();
+				m_onImport(ImportResult::Malformed, work.nodeId);///  Notify capability and P2P to process peer. diconnect peer if bad transaction  
+			}
+		}
+	}
+
 	void TransactionQueue::validateTx(std::shared_ptr<Transaction> _t)
 	{
 		if (_t->hasZeroSignature())
@@ -517,6 +835,7 @@ namespace mcp
 					{
 						all.erase(h);
 						m_known.erase(h);
+						poolErase_WITH_LOCK(h);
 					}
 					ft++;
 				}
@@ -551,8 +870,14 @@ namespace mcp
 		int pendingAccountSize = 0;
 		int knownSize = 0;
 		int dropSize = 0;
+		size_t pooledSize = 0;
+		size_t pooledBytes = 0;
+		size_t pooledPeers = 0;
 		{
 			ReadGuard l(m_lock);
+			pooledSize = m_pooled.size();
+			pooledBytes = m_pooledBytes;
+			pooledPeers = m_peerPooled.size();
 			allSize = all.size();
 			queueAccountSize = queue.size();
 			pendingAccountSize = pending.size();
@@ -576,6 +901,44 @@ namespace mcp
 			+ " ,m_known:" + std::to_string(knownSize)
 			+ " ,m_dropped:" + std::to_string(dropSize)
 			+ " ,m_pendingSize:" + std::to_string(m_pendingSize)
+			+ " ,pooled:" + std::to_string(pooledSize)
+			+ " ,pooled bytes:" + std::to_string(pooledBytes)
+			+ " ,pooled peers:" + std::to_string(pooledPeers)
+			+ " ,evicted:" + std::to_string(m_evicted.load())
+			+ " ,rejected underpriced:" + std::to_string(m_rejectedUnderpriced.load())
+			+ " ,rejected replace:" + std::to_string(m_rejectedReplace.load())
+			+ " ,rejected peer:" + std::to_string(m_rejectedPeer.load())
+			+ " ,rejected account:" + std::to_string(m_rejectedAccount.load())
+			;
+
+		size_t unverifiedSize = 0;
+		size_t maxUnverifiedSize = 0;
+		size_t unverifiedPeers = 0;
+		uint64_t verified = 0;
+		uint64_t verifiedPerSecond = 0;
+		{
+			Guard l(x_queue);
+			unverifiedSize = m_unverified.size();
+			maxUnverifiedSize = m_maxUnverified;
+			unverifiedPeers = m_unverifiedPeers.size();
+
+			/// getInfo can be called from several threads
+			auto now = std::chrono::steady_clock::now();
+			verified = m_verified;
+			uint64_t ms = std::max<uint64_t>(1, std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastInfoTime).count());
+			verifiedPerSecond = (verified - m_lastInfoVerified) * 1000 / ms;
+			m_lastInfoTime = now;
+			m_lastInfoVerified = verified;
+		}
+
+		str += " ,unverified:" + std::to_string(unverifiedSize)
+			+ " ,max unverified:" + std::to_string(maxUnverifiedSize)
+			+ " ,unverified peers:" + std::to_string(unverifiedPeers)
+			+ " ,verified:" + std::to_string(verified)
+			+ " ,verified/s:" + std::to_string(verifiedPerSecond)
+			+ " ,deduped:" + std::to_string(m_verifyDeduped.load())
+			+ " ,shed:" + std::to_string(m_verifyShed.load())
+			+ " ,malformed:" + std::to_string(m_verifyMalformed.load())
 			;
 
 		return str;
@@ -633,12 +996,12 @@ namespace mcp
 		LOG(m_log.debug) << "-------------------------------------------------------";
 	}
 
-	std::pair<bool, std::shared_ptr<Transaction>> TransactionQueue::txList::add(std::shared_ptr<Transaction> _t)
+	std::pair<bool, std::shared_ptr<Transaction>> TransactionQueue::txList::add(std::shared_ptr<Transaction> _t, unsigned _priceBump)
 	{
 		if (txs.count(_t->nonce()))
 		{
 			auto old = txs[_t->nonce()];
-			if (_t->gasPrice() <= old->gasPrice())
+			if (_t->gasPrice() <= old->gasPrice() || _t->gasPrice() * 100 < old->gasPrice() * (100 + _priceBump))
 			{
 				return std::make_pair(false, nullptr);
 			}
@@ -682,16 +1045,4 @@ namespace mcp
 		return t;
 	}
 
-	h256s TransactionQueue::txList::transactionHashs(int _limit) const
-	{
-		h256s ret;
-		auto it = txs.begin();
-		while (it != txs.end() && ret.size() < _limit)
-		{
-			ret.push_back(it->second->sha3());
-			it++;
-		}
-		return ret;
-	}
-
 }
@@ -37,8 +37,18 @@ namespace mcp
 		/// @param _in Optional network identified of a node transaction comes from type.
 		void enqueue(std::shared_ptr<Transaction>, p2p::node_id const&, source);
 
+		/// Add transaction rlp to the queue, decoded and verified on verifier threads.
+		/// @param _rlp transaction rlp.
+		/// @param _hash sha3 of _rlp, dedupe queued and known transactions before decoding.
+		void enqueue(bytesConstRef _rlp, h256 const& _hash, p2p::node_id const&, source);
+
 		void set_capability(std::shared_ptr<mcp::node_capability> capability_a) { m_capability = capability_a; }
 
+		/// limit transactions kept in queue and pending, cheapest pending transactions are evicted for better ones when full
+		/// @param _count max number of transactions.
+		/// @param _bytes max bytes of transactions.
+		void set_limits(size_t const& _count, size_t const& _bytes);
+
 		size_t size() { return queue.size(); }
 
 		/// Verify and add transaction to the queue synchronously.
@@ -59,11 +69,11 @@ namespace mcp
 
 		/// Get top transactions from the queue. Returned transactions are not removed from the queue automatically.
 		/// @param _limit Max number of transactions to return.
-		/// @returns up to _limit transactions ordered by nonce and gas price.
-		/// @returns account A : b2, b3, b4, b5
-		///          account B : b1, b2, b3
-		///          account c : c2, c3
-		/// @returns accounts disorder,but transactions of account is order by nonce
+		/// @returns up to _limit transactions, the next transaction of the account with highest gas price first.
+		/// @returns account A : a2(9), a3(3)
+		///          account B : b1(5), b2(5)
+		///          returns a2, b1, b2, a3
+		/// @returns transactions of account is order by nonce, an account taken c_maxAccountTopTransactions waits for other accounts
 		h256s topTransactions(unsigned _limit) const;
 
 		/// Determined transaction exist.
@@ -99,12 +109,12 @@ namespace mcp
 			txList(){}
 			/// returning whether the transaction was accepted, and if yes, any previous transaction it replaced. 
 			/// return true if insert success. return true and replaced transaction if replaced a transaction. 
-			std::pair<bool, std::shared_ptr<Transaction>> add(std::shared_ptr<Transaction> _t);
+			/// a replacing transaction pays _priceBump percent more gas price at least.
+			std::pair<bool, std::shared_ptr<Transaction>> add(std::shared_ptr<Transaction> _t, unsigned _priceBump = 0);
 			///release all consecutive and compliant transactions
 			std::deque<std::shared_ptr<Transaction>> release(u256 const& nonce);
 			///Deletes the transaction for the specified nonce and returns the transaction 
 			std::shared_ptr<Transaction> erase(u256 const& _n); 
-			h256s transactionHashs(int _limit) const;
 			/// return txs max nonce
 			u256 maxNonce() const { assert_x(txs.size()); return txs.rbegin()->first; }
 			u256 minNonce() const { assert_x(txs.size()); return txs.begin()->first; }
@@ -118,13 +128,16 @@ namespace mcp
 		struct UnverifiedTransaction
 		{
 			UnverifiedTransaction() {}
-			UnverifiedTransaction(std::shared_ptr<Transaction> _t, p2p::node_id const& _nodeId, source _in) : transaction(_t), nodeId(_nodeId), in(_in) {}
-			UnverifiedTransaction(UnverifiedTransaction&& _t) : transaction(_t.transaction), nodeId(std::move(_t.nodeId)), in(std::move(_t.in)) {}
+			UnverifiedTransaction(std::shared_ptr<Transaction> _t, p2p::node_id const& _nodeId, source _in) : transaction(_t), hash(_t->sha3()), nodeId(_nodeId), in(_in) {}
+			UnverifiedTransaction(bytesConstRef _rlp, h256 const& _hash, p2p::node_id const& _nodeId, source _in) : rlp(_rlp.toBytes()), hash(_hash), nodeId(_nodeId), in(_in) {}
+			UnverifiedTransaction(UnverifiedTransaction&& _t) : transaction(std::move(_t.transaction)), rlp(std::move(_t.rlp)), hash(_t.hash), nodeId(std::move(_t.nodeId)), in(std::move(_t.in)) {}
 			UnverifiedTransaction& operator=(UnverifiedTransaction&& _other)
 			{
 				assert(&_other != this);
 
 				transaction = std::move(_other.transaction);
+				rlp = std::move(_other.rlp);
+				hash = _other.hash;
 				nodeId = std::move(_other.nodeId);
 				in = std::move(_other.in);
 				return *this;
@@ -133,21 +146,43 @@ namespace mcp
 			UnverifiedTransaction(UnverifiedTransaction const&) = delete;
 			UnverifiedTransaction& operator=(UnverifiedTransaction const&) = delete;
 
-			std::shared_ptr<Transaction> transaction;  ///< Transaction data
+			std::shared_ptr<Transaction> transaction;  ///< Transaction data, nullptr if not decoded yet
+			bytes rlp;			///< Transaction rlp, decoded by verifier
+			h256 hash;
 			source in;
 			p2p::node_id nodeId;	///< Network Id of the peer transaction comes from
 		};
 
-		ImportResult check_WITH_LOCK(h256 const& _h);
-		ImportResult manageImport_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in);
+		/// Transaction kept in queue or pending, charged to the peer it comes from
+		struct PooledTransaction
+		{
+			size_t bytes;
+			p2p::node_id peer;
+		};
 
-		ImportResult insertQueue_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in, bool includeQueue = true);
-		ImportResult insertPending_WITH_LOCK(std::shared_ptr<Transaction>);
+		ImportResult check_WITH_LOCK(h256 const& _h);
+		ImportResult importVerified(std::shared_ptr<Transaction>, source, p2p::node_id const& _nodeId = p2p::node_id());
+		bool enqueue_WITH_QUEUE_LOCK(UnverifiedTransaction&& _work);
+		ImportResult manageImport_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in, p2p::node_id const& _nodeId);
+		/// check quotas of local and broadcast transaction and evict cheaper transactions if full
+		ImportResult admit_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in, p2p::node_id const& _nodeId);
+		/// evict the cheapest pending transaction, ready transactions are kept.
+		/// return true if nothing cheaper than _gasPrice can be evicted
+		bool evict_WITH_LOCK(u256 const& _gasPrice);
+		void poolInsert_WITH_LOCK(std::shared_ptr<Transaction> _t, p2p::node_id const& _nodeId);
+		void poolErase_WITH_LOCK(h256 const& _h);
+
+		ImportResult insertQueue_WITH_LOCK(std::shared_ptr<Transaction> _t, source _in, p2p::node_id const& _nodeId, bool includeQueue = true);
+		ImportResult insertPending_WITH_LOCK(std::shared_ptr<Transaction>, source _in, p2p::node_id const& _nodeId);
 		void makeQueue_WITH_LOCK(std::shared_ptr<Transaction> _t);
+		/// remove account from m_queueHeads before its queue changes, insert it again after
+		void eraseHead_WITH_LOCK(Address const& _a);
+		void insertHead_WITH_LOCK(Address const& _a);
 		bool remove_WITH_LOCK(h256 const& _txHash);
 		u256 maxNonce_WITH_LOCK(Address const& _a, BlockNumber const blockTag = PendingBlock) const;
 		NonceRange isPending_WITH_LOCK(std::shared_ptr<Transaction>);
 		void verifierBody();
+		void verifyBatch(std::vector<UnverifiedTransaction>& _works);
 
 		void validateTx(std::shared_ptr<Transaction>);/// Base format check
 		void checkTx(Transaction const& _t);/// nonce and balance check
@@ -165,6 +200,14 @@ namespace mcp
 		std::unordered_map<h256, std::shared_ptr<Transaction>> all;///All transactions to allow lookups
 		std::unordered_map<Address, txList> queue;///< ready Transactions grouped by account and nonce
 		std::unordered_map<Address, txList> pending;///< pending Transactions grouped by account and nonce,there are nonce smaller transactions missing its nonce.
+		std::set<std::pair<u256, Address>, std::greater<std::pair<u256, Address>>> m_queueHeads;///< accounts of queue by gas price of their next transaction, highest first
+		std::set<std::tuple<u256, Address, u256>> m_pendingPrices;///< pending transactions by gas price, account and nonce, lowest first
+
+		std::unordered_map<h256, PooledTransaction> m_pooled;///< transactions in all and pending
+		std::unordered_map<p2p::node_id, size_t> m_peerPooled;///< pooled transactions by peer they come from
+		size_t m_pooledBytes = 0;
+		size_t m_countLimit;
+		size_t m_bytesLimit;
 
 		unsigned m_pendingLimit;													///< Max number of pending transactions
 		unsigned m_pendingSize = 0;													///< number of pending transactions
@@ -175,7 +218,25 @@ namespace mcp
 		Signal<h256 const&> m_onReady; ///<  Called when a subsequent call to import transactions and ready.
 		std::vector<std::thread> m_verifiers;
 		std::deque<UnverifiedTransaction> m_unverified;  ///< Pending verification queue
+		h256Hash m_verifying;                            ///< Hashes queued or being verified, verified once if received from many peers
+		std::unordered_map<p2p::node_id, size_t> m_unverifiedPeers;	///< Queued broadcast transactions by peer
+		size_t m_maxUnverified = 0;
 		mutable Mutex x_queue;                           ///< Verification queue mutex
+
+		/// verification metrics
+		std::atomic<uint64_t> m_verified = { 0 };
+		std::atomic<uint64_t> m_verifyDeduped = { 0 };
+		std::atomic<uint64_t> m_verifyShed = { 0 };
+		std::atomic<uint64_t> m_verifyMalformed = { 0 };
+
+		/// pool metrics
+		std::atomic<uint64_t> m_evicted = { 0 };
+		std::atomic<uint64_t> m_rejectedUnderpriced = { 0 };
+		std::atomic<uint64_t> m_rejectedReplace = { 0 };
+		std::atomic<uint64_t> m_rejectedPeer = { 0 };
+		std::atomic<uint64_t> m_rejectedAccount = { 0 };
+		std::chrono::steady_clock::time_point m_lastInfoTime = std::chrono::steady_clock::now();	///< Guarded by x_queue
+		uint64_t m_lastInfoVerified = 0;									///< Guarded by x_queue
 		std::atomic<bool> m_aborting = { false };          ///< Exit condition for verifier.
 
 		///clear superfluous transaction
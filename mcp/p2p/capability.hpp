@@ -28,7 +28,8 @@ namespace mcp
 			icapability(capability_desc const & desc_a, unsigned const & packet_count);
 			virtual void on_connect(std::shared_ptr<p2p::peer> peer_a, unsigned const & offset) = 0;
 			virtual void on_disconnect(std::shared_ptr<peer> peer_a) = 0;
-			virtual bool read_packet(std::shared_ptr<peer> peer_a, unsigned const & type, std::shared_ptr<dev::RLP> r) = 0;
+			/// packet_a refers to the received frame buffer, keep a copy of packet_a to use it after return
+			virtual bool read_packet(std::shared_ptr<peer> peer_a, unsigned const & type, mcp::p2p::packet_ref const & packet_a) = 0;
 			unsigned packet_count() const;
 
 			capability_desc desc;
@@ -1,7 +1,117 @@
 #include "common.hpp"
+#include "lz4.h"
+
+#include <mutex>
 
 using namespace mcp::p2p;
 
+namespace
+{
+	/// free receive buffers, large buffers are released to keep memory bounded
+	class receive_buffer_pool
+	{
+	public:
+		std::shared_ptr<dev::bytes> get(size_t const & size_a)
+		{
+			dev::bytes * buffer(nullptr);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_free.empty())
+				{
+					buffer = m_free.back();
+					m_free.pop_back();
+				}
+			}
+			if (!buffer)
+				buffer = new dev::bytes;
+			buffer->resize(size_a);
+			return std::shared_ptr<dev::bytes>(buffer, [this](dev::bytes * b) { put(b); });
+		}
+
+	private:
+		void put(dev::bytes * buffer_a)
+		{
+			if (buffer_a->capacity() <= c_max_capacity)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_free.size() < c_max_free)
+				{
+					m_free.push_back(buffer_a);
+					return;
+				}
+			}
+			delete buffer_a;
+		}
+
+		static size_t const c_max_free = 256;
+		static size_t const c_max_capacity = 1024 * 1024;
+
+		std::mutex m_mutex;
+		std::vector<dev::bytes *> m_free;
+	};
+
+	/// never destroyed, buffers may be released after static destruction
+	receive_buffer_pool & receive_pool()
+	{
+		static receive_buffer_pool * pool(new receive_buffer_pool);
+		return *pool;
+	}
+
+	uint32_t read_size(dev::byte const * data_a)
+	{
+		return ((uint32_t)data_a[0] << 24) + (data_a[1] << 16) + (data_a[2] << 8) + data_a[3];
+	}
+}
+
+std::shared_ptr<dev::bytes> mcp::p2p::get_receive_buffer(size_t const & size_a)
+{
+	return receive_pool().get(size_a);
+}
+
+std::shared_ptr<dev::bytes> mcp::p2p::decompress_frame(dev::bytesConstRef const & frame_a)
+{
+	if (frame_a.size() <= tcp_header_size)
+		return nullptr;
+
+	uint32_t original_size(read_size(frame_a.data()));
+	bool uncompressed(original_size & uncompressed_frame_flag);
+	original_size &= ~uncompressed_frame_flag;
+	if (original_size == 0 || original_size > max_tcp_packet_size + tcp_header_size)
+		return nullptr;
+
+	std::shared_ptr<dev::bytes> buffer(get_receive_buffer(original_size));
+	if (uncompressed)
+	{
+		if (frame_a.size() - tcp_header_size != original_size)
+			return nullptr;
+		frame_a.cropped(tcp_header_size).copyTo(dev::bytesRef(buffer.get()));
+		return buffer;
+	}
+
+	int decompressed_size = LZ4_decompress_safe((char const *)frame_a.data() + tcp_header_size, (char *)buffer->data(), frame_a.size() - tcp_header_size, original_size);
+	if (decompressed_size < 0 || (uint32_t)decompressed_size != original_size)
+		return nullptr;
+	return buffer;
+}
+
+bool mcp::p2p::split_frame(std::shared_ptr<dev::bytes> const & buffer_a, std::vector<mcp::p2p::packet_ref> & packets_a)
+{
+	dev::bytesConstRef data(buffer_a.get());
+	size_t offset(0);
+	while (offset < data.size())
+	{
+		if (data.size() - offset < tcp_header_size)
+			return false;
+		uint32_t size(read_size(data.data() + offset));
+		offset += tcp_header_size;
+		if (data.size() - offset < size)
+			return false;
+		packets_a.push_back(mcp::p2p::packet_ref(buffer_a, data.cropped(offset, size)));
+		offset += size;
+	}
+	return true;
+}
+
 bool mcp::p2p::isPublicAddress(bi::address const & _addressToCheck)
 {
 	return !(isPrivateAddress(_addressToCheck) || isLocalHostAddress(_addressToCheck));
@@ -19,13 +19,36 @@ namespace mcp
 {
 	namespace p2p
 	{
-		static uint16_t const version(0);
+		/// 1: frames flagged by uncompressed_frame_flag are sent without lz4
+		static uint16_t const version(1);
+		static uint16_t const uncompressed_frame_version(1);
 		static uint16_t const default_port(30606);
 		static uint16_t const default_max_peers(25);
 
 		static size_t const tcp_header_size(4);
 		static size_t const max_tcp_packet_size(128 * 1024 * 1024);
+		/// set in frame original size when frame body is not compressed
+		static uint32_t const uncompressed_frame_flag(0x80000000);
         static size_t const max_summary_items(500);
+
+		/// receive buffers are reused, a buffer goes back to the pool when its last reference is released
+		std::shared_ptr<dev::bytes> get_receive_buffer(size_t const & size_a);
+
+		/// slice of a received frame, keeps the pooled frame buffer alive
+		class packet_ref
+		{
+		public:
+			packet_ref(std::shared_ptr<dev::bytes> const & buffer_a, dev::bytesConstRef const & data_a) : buffer(buffer_a), data(data_a) { }
+			dev::RLP rlp() const { return dev::RLP(data); }
+			std::shared_ptr<dev::bytes> buffer;
+			dev::bytesConstRef data;
+		};
+
+		/// decompress frame (original size + lz4 or raw data) into a pooled buffer, return nullptr if malformed
+		std::shared_ptr<dev::bytes> decompress_frame(dev::bytesConstRef const & frame_a);
+		/// split decompressed frame into inner packets (size + packet), return false if malformed
+		bool split_frame(std::shared_ptr<dev::bytes> const & buffer_a, std::vector<mcp::p2p::packet_ref> & packets_a);
+
 		bool isPrivateAddress(bi::address const& _addressToCheck);
 		bool isLocalHostAddress(bi::address const& _addressToCheck);
 		bool isPublicAddress(bi::address const& _addressToCheck);
@@ -150,14 +150,20 @@ void RLPXFrameCoder::writeFrame(uint16_t _protocolType, uint16_t _seqId, uint32_
 	writeFrame(header, _payload, o_bytes);
 }
 
-void RLPXFrameCoder::writeFrame(RLPStream const& _header, bytesConstRef _payload, bytes& o_bytes)
+void RLPXFrameCoder::writeFrameHeader(RLPStream const& _header, bytes& o_bytes)
 {
 	// TODO: SECURITY check header values && header <= 16 bytes
-	bytes headerWithMac(h256::size);
-	bytesConstRef(&_header.out()).copyTo(bytesRef(&headerWithMac));
-	m_impl->frameEnc.ProcessData(headerWithMac.data(), headerWithMac.data(), 16);
-	updateEgressMACWithHeader(bytesConstRef(&headerWithMac).cropped(0, 16));
-	egressDigest().ref().copyTo(bytesRef(&headerWithMac).cropped(h128::size, h128::size));
+	o_bytes.assign(h256::size, 0);
+	bytesConstRef(&_header.out()).copyTo(bytesRef(&o_bytes));
+	m_impl->frameEnc.ProcessData(o_bytes.data(), o_bytes.data(), 16);
+	updateEgressMACWithHeader(bytesConstRef(&o_bytes).cropped(0, 16));
+	egressDigest().ref().copyTo(bytesRef(&o_bytes).cropped(h128::size, h128::size));
+}
+
+void RLPXFrameCoder::writeFrame(RLPStream const& _header, bytesConstRef _payload, bytes& o_bytes)
+{
+	bytes headerWithMac;
+	writeFrameHeader(_header, headerWithMac);
 
 	auto padding = (16 - (_payload.size() % 16)) % 16;
 	o_bytes.swap(headerWithMac);
@@ -182,6 +188,37 @@ void RLPXFrameCoder::writeSingleFramePacket(bytesConstRef _packet, bytes& o_byte
 	writeFrame(header, _packet, o_bytes);
 }
 
+void RLPXFrameCoder::writeSingleFramePacket(std::vector<bytesConstRef> const& _chunks, bytes& o_header, bytes& o_frame)
+{
+	size_t size(0);
+	for (auto const& chunk : _chunks)
+		size += chunk.size();
+
+	RLPStream header;
+	uint32_t len = (uint32_t)size;
+	header.appendRaw(bytes({ byte((len >> 16) & 0xff), byte((len >> 8) & 0xff), byte(len & 0xff) }));
+	header.appendRaw(bytes({ 0xc2,0x80,0x80 }));
+	writeFrameHeader(header, o_header);
+
+	/// ctr mode is a stream cipher, encrypting chunk by chunk gives the same cipher text as encrypting them joined
+	auto padding = (16 - (size % 16)) % 16;
+	o_frame.resize(size + padding + h128::size);
+	size_t offset(0);
+	for (auto const& chunk : _chunks)
+	{
+		m_impl->frameEnc.ProcessData(o_frame.data() + offset, chunk.data(), chunk.size());
+		offset += chunk.size();
+	}
+	if (padding)
+	{
+		bytesRef paddingRef(o_frame.data() + size, padding);
+		memset(paddingRef.data(), 0, padding);
+		m_impl->frameEnc.ProcessData(paddingRef.data(), paddingRef.data(), padding);
+	}
+	updateEgressMACWithFrame(bytesConstRef(o_frame.data(), size + padding));
+	egressDigest().ref().copyTo(bytesRef(o_frame.data() + size + padding, h128::size));
+}
+
 bool RLPXFrameCoder::authAndDecryptHeader(bytesRef io)
 {
 	asserts(io.size() == h256::size);
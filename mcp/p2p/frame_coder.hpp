@@ -78,6 +78,10 @@ namespace mcp
 			/// Legacy. Encrypt _packet as ill-defined legacy RLPx frame.
 			void writeSingleFramePacket(bytesConstRef _packet, bytes& o_bytes);
 
+			/// Encrypt concatenation of _chunks as legacy RLPx frame without joining them first.
+			/// o_header gets header with mac, o_frame gets encrypted payload, padding and mac, capacity of both is reused.
+			void writeSingleFramePacket(std::vector<bytesConstRef> const& _chunks, bytes& o_header, bytes& o_frame);
+
 			/// Authenticate and decrypt header in-place.
 			bool authAndDecryptHeader(bytesRef io_cipherWithMac);
 
@@ -100,6 +104,9 @@ namespace mcp
 		protected:
 			void writeFrame(RLPStream const& _header, bytesConstRef _payload, bytes& o_bytes);
 
+			/// Encrypt header and append egress mac, o_bytes is resized to h256::size.
+			void writeFrameHeader(RLPStream const& _header, bytes& o_bytes);
+
 			/// Update state of egress MAC with frame header.
 			void updateEgressMACWithHeader(bytesConstRef _headerCipher);
 
@@ -1,14 +1,57 @@
 #include "peer.hpp"
 using namespace mcp::p2p;
 
-peer::peer(std::shared_ptr<bi::tcp::socket> const & socket_a, node_id const & node_id_a, std::shared_ptr<peer_manager> peer_manager_a, std::unique_ptr<RLPXFrameCoder>&& _io, ba::io_service& io) :
+namespace
+{
+	bool is_loopback(std::shared_ptr<bi::tcp::socket> const & socket_a)
+	{
+		boost::system::error_code ec;
+		auto endpoint(socket_a->remote_endpoint(ec));
+		return !ec && endpoint.address().is_loopback();
+	}
+}
+
+compress_policy::compress_policy(bool const & enabled_a) :
+	m_enabled(enabled_a)
+{
+}
+
+bool compress_policy::should_compress(size_t const & size_a)
+{
+	if (!m_enabled || size_a < c_min_size)
+		return false;
+	if (m_skipped < m_skip)
+	{
+		m_skipped++;
+		return false;
+	}
+	return true;
+}
+
+void compress_policy::on_compressed(size_t const & size_a, size_t const & compressed_size_a)
+{
+	m_skipped = 0;
+	if (compressed_size_a * 100 > size_a * (100 - c_min_saved_percent))
+	{
+		uint32_t skip(m_skip == 0 ? 1 : m_skip * 2);
+		m_skip = skip > c_max_skip ? c_max_skip : skip;
+	}
+	else
+		m_skip = 0;
+}
+
+peer::peer(std::shared_ptr<bi::tcp::socket> const & socket_a, node_id const & node_id_a, std::shared_ptr<peer_manager> peer_manager_a, std::unique_ptr<RLPXFrameCoder>&& _io, ba::io_service& io, uint16_t const & remote_version_a) :
 	socket(socket_a),
 	m_node_id(node_id_a),
 	m_io_service(std::ref(io)),
 	m_peer_manager(peer_manager_a),
 	is_dropped(false),
 	m_pmetrics(std::make_shared<peer_metrics>()),
-	m_io(move(_io))
+	m_io(move(_io)),
+	m_lz4_state(LZ4_createStream(), LZ4_freeStream),
+	m_raw_frames(remote_version_a >= mcp::p2p::uncompressed_frame_version),
+	///cpu is the bottleneck on loopback, not bandwidth
+	m_compress_policy(!is_loopback(socket_a))
 {
 	_last_received = std::chrono::steady_clock::now();
 	_create = std::chrono::steady_clock::now();
@@ -160,10 +203,18 @@ void peer::read_loop()
 						return;
 					}
 					bytesConstRef frame(read_buffer.data(), hLength);
+					///decompress from decrypted frame into pooled buffer, packets are read from it without copy
+					std::shared_ptr<dev::bytes> buffer(mcp::p2p::decompress_frame(frame));
+					if (!buffer)
+					{
+						LOG(m_log.debug) << "Frame decompress failed, size:" << frame.size();
+						drop(disconnect_reason::bad_protocol);
+						return;
+					}
 					bool is_do_read(false);
 					{
 						std::lock_guard<std::mutex> lock(read_queue_mutex); 
-						read_queue.push_back(frame.toBytes());
+						read_queue.push_back(std::move(buffer));
 						is_do_read = read_queue.size() == 1;
 					}
 					if (is_do_read)
@@ -200,7 +251,7 @@ void peer::do_read()
 	if (!socket->is_open())
 		return;
 
-	dev::bytes buffer;
+	std::shared_ptr<dev::bytes> buffer;
 	try
 	{
 		{
@@ -208,51 +259,35 @@ void peer::do_read()
 			if (read_queue.empty())
 				return;
 
-			buffer.resize(read_queue[0].size());
-			buffer = std::move(read_queue[0]);
+			buffer = read_queue[0];
 		}
 
-		dev::bytes size(mcp::p2p::tcp_header_size);
-		dev::bytesConstRef(buffer.data(), mcp::p2p::tcp_header_size).copyTo(dev::bytesRef(size.data(), mcp::p2p::tcp_header_size));
-
-		uint32_t package_original_size(m_io->deserializePacketSize(size));
-		dev::bytes package_buffer(package_original_size);
-
-		uint32_t body_size = buffer.size() - mcp::p2p::tcp_header_size;
-		dev::bytesConstRef(buffer.data() + mcp::p2p::tcp_header_size, body_size).copyTo(dev::bytesRef(buffer.data(), body_size));
-		buffer.resize(body_size);
-
-		const int decompressed_size = LZ4_decompress_safe((const char*)buffer.data(), (char*)package_buffer.data(), buffer.size(), package_original_size);
-
-		uint32_t offset = 0;
-		while (offset < package_original_size)
+		read_packets.clear();
+		if (!mcp::p2p::split_frame(buffer, read_packets))
 		{
+			LOG(m_log.debug) << "invalid frame, size: " << buffer->size();
+			disconnect(disconnect_reason::bad_protocol);
+			return;
+		}
 
-			dev::bytes body_size(4);
-			dev::bytesConstRef(package_buffer.data() + offset, 4).copyTo(dev::bytesRef(body_size.data(), 4));
-			uint32_t isize(m_io->deserializePacketSize(body_size));
-
-			dev::bytes body(isize);
-			dev::bytesConstRef(package_buffer.data() + offset + 4, isize).copyTo(dev::bytesRef(body.data(), isize));
-
-			dev::bytesConstRef packet(body.data(), isize);
-			offset = offset + 4 + isize;
-
-			if (!check_packet(packet))
+		for (mcp::p2p::packet_ref const & packet : read_packets)
+		{
+			if (!check_packet(packet.data))
 			{
-                LOG(m_log.debug) << boost::str(boost::format("invalid packet, size: %1%, packet: %2%") % packet.size() % toHex(packet));
+                LOG(m_log.debug) << boost::str(boost::format("invalid packet, size: %1%, packet: %2%") % packet.data.size() % toHex(packet.data));
 				disconnect(disconnect_reason::bad_protocol);
 				return;
 			}
 			else
 			{
-				auto packet_type = dev::RLP(packet.cropped(0, 1)).toInt<unsigned>();
-				std::shared_ptr<dev::RLP> r(std::make_shared<dev::RLP>(packet.cropped(1)));
-				bool ok = read_packet(packet_type, r);
+				auto packet_type = dev::RLP(packet.data.cropped(0, 1)).toInt<unsigned>();
+				mcp::p2p::packet_ref body(packet.buffer, packet.data.cropped(1));
+				bool ok = read_packet(packet_type, body);
 				if (!ok)
-                    LOG(m_log.debug) << "invalid rlp packet:" << *r;
+                    LOG(m_log.debug) << "invalid rlp packet:" << body.rlp();
 			}
 		}
+		read_packets.clear();
 
 		{
 			std::lock_guard<std::mutex> lock(read_queue_mutex);
@@ -269,18 +304,13 @@ void peer::do_read()
 	}
 	catch (std::exception const & ex)
 	{
-		std::vector<int> x;
-		for (int a : x)
+		if (buffer && buffer->size() > 0)
 		{
-
-		}
-		if (buffer.size() > 0)
-		{
-            LOG(m_log.warning) << "Error while peer convert data to RLP, buffer size:" << buffer.size() << ", buffer:" << dev::toHex(bytesConstRef(&buffer)) << ", message:" << ex.what();
+            LOG(m_log.warning) << "Error while peer convert data to RLP, buffer size:" << buffer->size() << ", buffer:" << dev::toHex(bytesConstRef(buffer.get())) << ", message:" << ex.what();
 		}
 		else
 		{
-            LOG(m_log.warning) << "Error while peer convert data to RLP, buffer size:" << buffer.size() << ", message:" << ex.what();
+            LOG(m_log.warning) << "Error while peer convert data to RLP, message:" << ex.what();
 		}
 		throw;
 	}
@@ -321,7 +351,7 @@ bool peer::check_packet(dev::bytesConstRef msg)
     return true;
 }
 
-bool peer::read_packet(unsigned const & type, std::shared_ptr<dev::RLP> r)
+bool peer::read_packet(unsigned const & type, mcp::p2p::packet_ref const & packet_a)
 {
     _last_received = std::chrono::steady_clock::now();
 
@@ -343,8 +373,9 @@ bool peer::read_packet(unsigned const & type, std::shared_ptr<dev::RLP> r)
             }
             case packet_type::disconect:
             {
-                auto reason = (disconnect_reason)(*r)[0].toInt<unsigned>();
-                if (!(*r)[0].isInt())
+                dev::RLP const r(packet_a.rlp());
+                auto reason = (disconnect_reason)r[0].toInt<unsigned>();
+                if (!r[0].isInt())
                     drop(disconnect_reason::bad_protocol);
                 else
                 {
@@ -365,14 +396,14 @@ bool peer::read_packet(unsigned const & type, std::shared_ptr<dev::RLP> r)
         for (auto & p_cap : capabilities)
         {
             if (type >= p_cap->offset && type < p_cap->offset + p_cap->cap->packet_count())
-                return p_cap->cap->read_packet(this_l, type - p_cap->offset, r);
+                return p_cap->cap->read_packet(this_l, type - p_cap->offset, packet_a);
         }
 
         return false;
     }
     catch (std::exception const & e)
     {
-        LOG(m_log.warning) << boost::str(boost::format("Error while reading packet, packet type: %1% , rlp: %2%, message: %3%") % (unsigned)type % *r %e.what());
+        LOG(m_log.warning) << boost::str(boost::format("Error while reading packet, packet type: %1% , rlp: %2%, message: %3%") % (unsigned)type % packet_a.rlp() %e.what());
         disconnect(disconnect_reason::bad_protocol);
         return true;
     }
@@ -385,9 +416,60 @@ dev::RLPStream & peer::prep(dev::RLPStream & s, unsigned const & type, unsigned
 }
 
 void peer::send(dev::RLPStream & s)
+{
+	if (!can_send())
+		return;
+
+    dev::bytes b;
+    s.swapOut(b);
+    dev::bytesConstRef packet(&b);
+    if (!check_packet(packet))
+    {
+        LOG(m_log.warning) << "Invalid send packet:" << dev::toHex(packet);
+    }
+
+    size_t packet_size(b.size());
+    if (packet_size > mcp::p2p::max_tcp_packet_size)
+    {
+        LOG(m_log.error) << "Peer send: packet size too large, size:" << packet_size
+            << ", max packet size:" << mcp::p2p::max_tcp_packet_size;
+        throw std::runtime_error("Size too large");
+    }
+
+	///packet is moved to body instead of copied behind the size header
+	mcp::p2p::write_item item;
+	item.head = m_io->serializePacketSize(packet_size);
+	item.body = std::make_shared<dev::bytes const>(std::move(b));
+	enqueue(std::move(item));
+}
+
+void peer::send(unsigned const & type, std::shared_ptr<dev::bytes const> const & body_a)
+{
+	if (!can_send())
+		return;
+
+	dev::RLPStream s;
+	s.append(type);
+	size_t packet_size(s.out().size() + body_a->size());
+	if (packet_size > mcp::p2p::max_tcp_packet_size)
+	{
+		LOG(m_log.error) << "Peer send: packet size too large, size:" << packet_size
+			<< ", max packet size:" << mcp::p2p::max_tcp_packet_size;
+		throw std::runtime_error("Size too large");
+	}
+
+	///frame header and type are per peer, body is shared
+	mcp::p2p::write_item item;
+	item.head = m_io->serializePacketSize(packet_size);
+	item.head.insert(item.head.end(), s.out().begin(), s.out().end());
+	item.body = body_a;
+	enqueue(std::move(item));
+}
+
+bool peer::can_send()
 {
     if (is_dropped)
-        return;
+        return false;
 
 	if (!socket->is_open())
 	{
@@ -395,7 +477,7 @@ void peer::send(dev::RLPStream & s)
         LOG(m_log.debug) << "remote socket is closed: " << m_node_id.hex()
 			<< "@" << socket->remote_endpoint(ec);
 
-		return;
+		return false;
 	}
         
 	if (surplus_size > SEND_BUFFER_LIMIT)
@@ -415,31 +497,19 @@ void peer::send(dev::RLPStream & s)
 			drop(mcp::p2p::disconnect_reason::tcp_error);
 		});
 
-		return;
+		return false;
 	}
 
-    dev::bytes b;
-    s.swapOut(b);
-    dev::bytesConstRef packet(&b);
-    if (!check_packet(packet))
-    {
-        LOG(m_log.warning) << "Invalid send packet:" << dev::toHex(packet);
-    }
-
-    size_t packet_size(b.size());
-    if (packet_size > mcp::p2p::max_tcp_packet_size)
-    {
-        LOG(m_log.error) << "Peer send: packet size too large, size:" << packet_size
-            << ", max packet size:" << mcp::p2p::max_tcp_packet_size;
-        throw std::runtime_error("Size too large");
-    }
+	return true;
+}
 
-	m_io->writeFramePacketHeader(b);
+void peer::enqueue(mcp::p2p::write_item && item_a)
+{
 	bool is_do_write(false);
 	{
 		std::lock_guard<std::mutex> lock(write_queue_mutex);
-		surplus_size += b.size();
-		write_queue.push_back(std::move(b));
+		surplus_size += item_a.size();
+		write_queue.push_back(std::move(item_a));
 		is_do_write = write_queue.size() == 1;
 	}
 
@@ -478,29 +548,66 @@ void peer::do_write()
 			group_item_count++;
 		}
 
-		write_bufs.resize(group_buffer_size);
-		uint32_t offset = 0;
+		///items stay in write_queue until written, push_back of deque keeps references valid
+		write_chunks.clear();
 		for (uint32_t i = 0; i < group_item_count; i++)
 		{
-			dev::bytesConstRef(write_queue[i].data(), write_queue[i].size()).copyTo(dev::bytesRef(write_bufs.data() + offset, write_queue[i].size()));
-			offset += write_queue[i].size();
+			mcp::p2p::write_item const & item(write_queue[i]);
+			write_chunks.push_back(dev::bytesConstRef(&item.head));
+			if (item.body)
+				write_chunks.push_back(dev::bytesConstRef(item.body.get()));
 		}
 	}	
 
-	dev::bytes ori_size(m_io->serializePacketSize(write_bufs.size()));	//used for Decompression
-	lz4(write_bufs);
+	///peers of old version can only read compressed frames
+	bool compressed(!m_raw_frames || m_compress_policy.should_compress(group_buffer_size));
+	if (compressed)
+	{
+		///lz4 needs contiguous input
+		write_bufs.resize(group_buffer_size);
+		uint32_t offset = 0;
+		for (dev::bytesConstRef const & chunk : write_chunks)
+		{
+			chunk.copyTo(dev::bytesRef(write_bufs.data() + offset, chunk.size()));
+			offset += chunk.size();
+		}
+
+		auto compress_start(std::chrono::steady_clock::now());
+		bool smaller(lz4());
+		m_pmetrics->compress_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - compress_start).count();
+		m_pmetrics->compress_frames++;
+		if (m_raw_frames)
+		{
+			m_compress_policy.on_compressed(write_bufs.size(), compress_bufs.size());
+			compressed = smaller;
+		}
+	}
+
+	uint32_t ori_size(group_buffer_size);	//used for Decompression
+	if (compressed)
+	{
+		write_chunks.clear();
+		write_chunks.push_back(dev::bytesConstRef(&compress_bufs));
+	}
+	else
+	{
+		ori_size |= mcp::p2p::uncompressed_frame_flag;
+		m_pmetrics->uncompressed_frames++;
+	}
 
-	write_bufs.resize(mcp::p2p::tcp_header_size + write_bufs.size());
-	dev::bytesConstRef(write_bufs.data(), write_bufs.size()).copyTo(dev::bytesRef(write_bufs.data() + mcp::p2p::tcp_header_size, write_bufs.size()));
-	dev::bytesConstRef(ori_size.data(), mcp::p2p::tcp_header_size).copyTo(dev::bytesRef(write_bufs.data(), mcp::p2p::tcp_header_size));
+	dev::bytes size_header(m_io->serializePacketSize(ori_size));
+	write_chunks.insert(write_chunks.begin(), dev::bytesConstRef(&size_header));
+	m_pmetrics->send_wire_size += size_header.size() + (compressed ? compress_bufs.size() : group_buffer_size);
 
-	//encry
-	m_io->writeSingleFramePacket(dev::bytesConstRef(write_bufs.data(), write_bufs.size()), write_bufs);
+	//encry, chunks are encrypted straight into frame buffer
+	m_io->writeSingleFramePacket(write_chunks, frame_header_bufs, frame_bufs);
+	write_chunks.clear();
 	if (!socket->is_open())
 		return;
 
 	auto this_l(shared_from_this());
-	ba::async_write(*socket, ba::buffer(write_bufs),
+	std::array<ba::const_buffer, 2> buffers = { { ba::buffer(frame_header_bufs), ba::buffer(frame_bufs) } };
+	ba::async_write(*socket, buffers,
 		[this, this_l, group_buffer_size, group_item_count](boost::system::error_code ec, std::size_t size) {
 
 		if (is_dropped)
@@ -534,14 +641,14 @@ void peer::do_write()
 	});
 }
 
-void peer::lz4(bytes& o_bytes)
+bool peer::lz4()
 {
-	const int max_dst_size = LZ4_compressBound(o_bytes.size() + 1);
+	const int max_dst_size = LZ4_compressBound(write_bufs.size());
 
-	dev::bytes compressed_bufs(max_dst_size);
-	const int compressed_data_size = LZ4_compress_default((const char*)write_bufs.data(), (char *)compressed_bufs.data(), o_bytes.size(), max_dst_size);
-	compressed_bufs.resize(compressed_data_size);
-	o_bytes = std::move(compressed_bufs);
+	compress_bufs.resize(max_dst_size);
+	const int compressed_data_size = LZ4_compress_fast_extState(m_lz4_state.get(), (const char*)write_bufs.data(), (char *)compress_bufs.data(), write_bufs.size(), max_dst_size, 1);
+	compress_bufs.resize(compressed_data_size);
+	return compress_bufs.size() < write_bufs.size();
 }
 
 void peer::drop(disconnect_reason const & reason, bool record)
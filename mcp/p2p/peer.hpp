@@ -35,19 +35,56 @@ namespace mcp
             uint64_t  write_write_queue_size = 0;
 			uint64_t  read_read_queue_size = 0;
 			uint64_t  write_queue_buffer_size = 0;
+			/// bytes of frames after compression, before encryption
+			uint64_t  send_wire_size = 0;
+			/// frames sent without compression
+			uint64_t  uncompressed_frames = 0;
+			uint64_t  compress_frames = 0;
+			/// microseconds spent in lz4
+			uint64_t  compress_us = 0;
+        };
+
+        /// decide per frame whether compression is worth it. frames smaller than c_min_size are never compressed,
+        /// after a frame saves less than c_min_saved_percent, next frames are skipped, doubling up to c_max_skip before probing again.
+        class compress_policy
+        {
+        public:
+            compress_policy(bool const & enabled_a);
+            bool should_compress(size_t const & size_a);
+            void on_compressed(size_t const & size_a, size_t const & compressed_size_a);
+
+            static constexpr size_t c_min_size = 256;
+            static constexpr size_t c_min_saved_percent = 10;
+            static constexpr uint32_t c_max_skip = 256;
+
+        private:
+            bool const m_enabled;
+            uint32_t m_skip = 0;
+            uint32_t m_skipped = 0;
+        };
+
+        /// queued packet, body is shared by all peers a message is broadcast to
+        class write_item
+        {
+        public:
+            size_t size() const { return head.size() + (body ? body->size() : 0); }
+            dev::bytes head;
+            std::shared_ptr<dev::bytes const> body;
         };
 
         class peer : public std::enable_shared_from_this<peer>
         {
 			friend class host;
         public:
-			peer(std::shared_ptr<bi::tcp::socket> const & socket_a, node_id const & node_id_a, std::shared_ptr<peer_manager> peer_manager_a, std::unique_ptr<RLPXFrameCoder>&& _io, ba::io_service& io);
+			peer(std::shared_ptr<bi::tcp::socket> const & socket_a, node_id const & node_id_a, std::shared_ptr<peer_manager> peer_manager_a, std::unique_ptr<RLPXFrameCoder>&& _io, ba::io_service& io, uint16_t const & remote_version_a);
             ~peer();
             void register_capability(std::shared_ptr<peer_capability> const & cap);
             void start();
             void ping();
             dev::RLPStream & prep(dev::RLPStream & s, unsigned const & type, unsigned const & size = 0);
             void send(dev::RLPStream & s);
+            /// send packet of type with serialized body_a, body_a is referenced by write queue, not copied
+            void send(unsigned const & type, std::shared_ptr<dev::bytes const> const & body_a);
             bool is_connected();
             void disconnect(disconnect_reason const & reason);
             std::chrono::steady_clock::time_point last_received();
@@ -61,11 +98,14 @@ namespace mcp
         private:
             void read_loop();
             bool check_packet(dev::bytesConstRef msg);
-            bool read_packet(unsigned const & type, std::shared_ptr<dev::RLP> r);
+            bool read_packet(unsigned const & type, mcp::p2p::packet_ref const & packet_a);
+            bool can_send();
+            void enqueue(mcp::p2p::write_item && item_a);
             void do_write();
 			void do_read();
 			void drop(disconnect_reason const & reason, bool record = true);
-			void lz4(bytes& o_bytes);
+			/// compress write_bufs into compress_bufs, return false if compressed is not smaller
+			bool lz4();
 			/// Check error code after reading and drop peer if error code.
 			bool checkRead(std::size_t _expected, boost::system::error_code _ec, std::size_t _length);
             std::string reason_of(disconnect_reason reason)
@@ -96,15 +136,30 @@ namespace mcp
 			std::unique_ptr<RLPXFrameCoder> m_io;	///< Transport over which packets are sent.
             dev::bytes read_buffer;
 			dev::bytes read_header_buffer;
-            std::deque<dev::bytes> write_queue;
+            std::deque<mcp::p2p::write_item> write_queue;
             std::mutex write_queue_mutex;
-			std::deque<dev::bytes> read_queue;
+			/// decompressed frames in pooled buffers
+			std::deque<std::shared_ptr<dev::bytes>> read_queue;
 			std::mutex read_queue_mutex;
+			/// packets of frame being read, only used by do_read
+			std::vector<mcp::p2p::packet_ref> read_packets;
             std::chrono::steady_clock::time_point _last_received;
 			std::chrono::steady_clock::time_point _create;
 			std::atomic<bool> is_dropped;
             std::shared_ptr <mcp::p2p::peer_metrics> m_pmetrics;
+			/// buffers below are only used by do_write, capacity is reused
+			/// packets of group being written, referencing write_queue items
+			std::vector<dev::bytesConstRef> write_chunks;
+			/// joined group, lz4 input
 			dev::bytes write_bufs;
+			dev::bytes compress_bufs;
+			/// encrypted frame header and frame, written with one async_write
+			dev::bytes frame_header_bufs;
+			dev::bytes frame_bufs;
+			std::unique_ptr<LZ4_stream_t, int(*)(LZ4_stream_t *)> m_lz4_state;
+			/// remote can read uncompressed frames
+			bool const m_raw_frames;
+			mcp::p2p::compress_policy m_compress_policy;
 			bool bprintf = false;
 			uint32_t surplus_size = 0;
 
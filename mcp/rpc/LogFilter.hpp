@@ -22,6 +22,8 @@ namespace mcp
 		dev::h256 blockHash() const { return m_blockHash; }
 		mcp::BlockNumber fromBlock() const { return m_fromBlock; }
 		mcp::BlockNumber toBlock() const { return m_toBlock; }
+		dev::AddressHash const& addresses() const { return m_addresses; }
+		std::array<dev::h256Hash, 4> const& topics() const { return m_topics; }
 
 		LogFilter withAddress(Address _a) { m_addresses.insert(_a); return *this; }
 		LogFilter withTopic(unsigned _index, h256 const& _t) { if (_index < 4) m_topics[_index].insert(_t); return *this; }
@@ -6,6 +6,9 @@
 #include <mcp/common/pwd.hpp>
 #include <mcp/node/evm/Executive.hpp>
 
+#include <algorithm>
+#include <iterator>
+
 mcp::rpc_handler::rpc_handler(mcp::rpc &rpc_a, std::string const &body_a, std::function<void(mcp::json const &)> const &response_a, int m_cap) : body(body_a),
 																																				 rpc(rpc_a),
 																																				 response(response_a),
@@ -1128,20 +1131,46 @@ void mcp::rpc_handler::eth_getLogs(mcp::json &j_response, bool &)
 	LogFilter filter = toLogFilter(params[0]);
 	mcp::db::db_transaction transaction(m_store.create_transaction());
 
-	auto _handler = [this, &transaction, &filter](std::shared_ptr<mcp::block> _block, std::shared_ptr<mcp::block_state> _state, localised_log_entries& io_logs)
+	/// transaction addresses and receipts of all blocks are read by one batch each
+	auto _handler = [this, &transaction, &filter](std::vector<std::pair<std::shared_ptr<mcp::block>, std::shared_ptr<mcp::block_state>>> const& _blocks, localised_log_entries& io_logs)
 	{
-		for (size_t i = 0; i < _block->links().size(); i++)
+		std::vector<dev::h256> links;
+		for (auto const& b : _blocks)
+			links.insert(links.end(), b.first->links().begin(), b.first->links().end());
+		std::vector<std::shared_ptr<mcp::TransactionAddress>> tds;
+		m_cache->transaction_addresses_get(transaction, links, tds);
+
+		std::vector<dev::h256> first_links;///not first linked, ignore.
+		size_t k = 0;
+		for (auto const& b : _blocks)
 		{
-			dev::h256 th = _block->links().at(i);
-			auto td = m_cache->transaction_address_get(transaction, th);
-			if (td == nullptr || td->blockHash != _block->hash())///not first linked, ignore.
-				continue;
+			for (size_t i = 0; i < b.first->links().size(); i++, k++)
+			{
+				if (tds[k] != nullptr && tds[k]->blockHash == b.first->hash())
+					first_links.push_back(links[k]);
+			}
+		}
+		std::vector<std::shared_ptr<dev::eth::TransactionReceipt>> receipts;
+		m_cache->transaction_receipts_get(transaction, first_links, receipts);
 
-			auto receipt = m_cache->transaction_receipt_get(transaction, th);
-			assert_x(receipt);
-			log_entries le = filter.matches(*receipt, *_state->main_chain_index);
-			for (unsigned j = 0; j < le.size(); ++j)
-				io_logs.push_back(localised_log_entry(le[j], _block->hash(), _state->stable_index, th, i, j));
+		k = 0;
+		size_t r = 0;
+		for (auto const& b : _blocks)
+		{
+			std::shared_ptr<mcp::block> const& _block = b.first;
+			std::shared_ptr<mcp::block_state> const& _state = b.second;
+			for (size_t i = 0; i < _block->links().size(); i++, k++)
+			{
+				if (tds[k] == nullptr || tds[k]->blockHash != _block->hash())
+					continue;
+
+				dev::h256 const& th = links[k];
+				auto receipt = receipts[r++];
+				assert_x(receipt);
+				log_entries le = filter.matches(*receipt, *_state->main_chain_index);
+				for (unsigned j = 0; j < le.size(); ++j)
+					io_logs.push_back(localised_log_entry(le[j], _block->hash(), _state->stable_index, th, i, j));
+			}
 		}
 	};
 
@@ -1156,7 +1185,7 @@ void mcp::rpc_handler::eth_getLogs(mcp::json &j_response, bool &)
 		if (!_block)
 			BOOST_THROW_EXCEPTION(RPC_Error_RequestDenied("unknown block"));
 
-		_handler(_block, state, ret);
+		_handler({ std::make_pair(_block, state) }, ret);
 		j_response["result"] = toJson(ret);
 		return;
 	}
@@ -1167,25 +1196,120 @@ void mcp::rpc_handler::eth_getLogs(mcp::json &j_response, bool &)
 	if (filter.toBlock() == LatestBlock || filter.toBlock() == PendingBlock)
 		filter.withTo(_lastStable);
 
-	if (filter.toBlock() - filter.fromBlock() >= 2000)///max 2000
+	if (filter.toBlock() - filter.fromBlock() >= 1000000)///max 1000000 by log index
+		BOOST_THROW_EXCEPTION(RPC_Error_TooLargeSearchRange("Query Returned More Than 1000000 Results"));
+
+	/// range filters and blocks stabilized before log index was created are read block by block
+	uint64_t log_index_from(filter.toBlock() + 1);
+	m_store.log_index_from_get(transaction, log_index_from);
+	uint64_t scan_to(filter.isRangeFilter() ? filter.toBlock() : std::min<uint64_t>(filter.toBlock(), log_index_from - 1));
+	if (scan_to >= filter.fromBlock() && scan_to - filter.fromBlock() >= 2000)///max 2000
 		BOOST_THROW_EXCEPTION(RPC_Error_TooLargeSearchRange("Query Returned More Than 2000 Results"));//-32005 query returned more than 10000 results
-	for (uint64_t i(filter.fromBlock()); i <= filter.toBlock(); i++)
+
+	std::vector<uint64_t> stable_indexs;
+	for (uint64_t i(filter.fromBlock()); i <= scan_to; i++)
+		stable_indexs.push_back(i);
+	if (filter.toBlock() > scan_to)
+		log_index_get(transaction, filter, std::max<uint64_t>(filter.fromBlock(), scan_to + 1), filter.toBlock(), stable_indexs);
+
+	/// read blocks by batch, stop at the first block not exist or not stable
+	size_t const batch_size = 256;
+	bool stop = false;
+	for (size_t from(0); !stop && from < stable_indexs.size(); from += batch_size)
 	{
-		auto _block = m_cache->block_get(transaction, i);
-		if (!_block)
-			break;
-		if (!_block->links().size())///have no logs
-			continue;
-		auto state = m_cache->block_state_get(transaction, _block->hash());
-		if (!state || !state->is_stable)
-			break;
+		size_t to = std::min<size_t>(from + batch_size, stable_indexs.size());
+		std::vector<mcp::block_hash> hashs;
+		for (size_t i(from); i < to; i++)
+		{
+			mcp::block_hash hash;
+			if (m_cache->block_number_get(transaction, stable_indexs[i], hash))
+			{
+				stop = true;
+				break;
+			}
+			hashs.push_back(hash);
+		}
+
+		std::vector<std::shared_ptr<mcp::block>> blocks;
+		m_cache->blocks_get(transaction, hashs, blocks);
+		std::vector<std::shared_ptr<mcp::block>> link_blocks;
+		std::vector<mcp::block_hash> link_hashs;
+		for (auto const& _block : blocks)
+		{
+			if (!_block)
+			{
+				stop = true;
+				break;
+			}
+			if (!_block->links().size())///have no logs
+				continue;
+			link_blocks.push_back(_block);
+			link_hashs.push_back(_block->hash());
+		}
+
+		std::vector<std::shared_ptr<mcp::block_state>> states;
+		m_cache->block_states_get(transaction, link_hashs, states);
+		std::vector<std::pair<std::shared_ptr<mcp::block>, std::shared_ptr<mcp::block_state>>> stable_blocks;
+		for (size_t i = 0; i < link_blocks.size(); i++)
+		{
+			if (!states[i] || !states[i]->is_stable)
+			{
+				stop = true;
+				break;
+			}
+			stable_blocks.push_back(std::make_pair(link_blocks[i], states[i]));
+		}
 
-		_handler(_block, state, ret);
+		_handler(stable_blocks, ret);
 	}
 
 	j_response["result"] = toJson(ret);
 }
 
+void mcp::rpc_handler::log_index_get(mcp::db::db_transaction & transaction_a, mcp::LogFilter const & filter_a, uint64_t const & from_a, uint64_t const & to_a, std::vector<uint64_t> & stable_indexs_a)
+{
+	for (uint64_t section(from_a / mcp::LogBloomSectionSize); section <= to_a / mcp::LogBloomSectionSize; section++)
+	{
+		/// sections without bloom have no logs
+		log_bloom bloom;
+		if (m_store.log_bloom_get(transaction_a, section, bloom) || !filter_a.matches(bloom))
+			continue;
+
+		uint64_t from(std::max<uint64_t>(from_a, section * mcp::LogBloomSectionSize));
+		uint64_t to(std::min<uint64_t>(to_a, (section + 1) * mcp::LogBloomSectionSize - 1));
+
+		/// blocks having any of the addresses and any of the topics at each position
+		std::set<uint64_t> candidates;
+		bool first(true);
+		auto intersect = [&](uint8_t const & kind_a, std::vector<h256> const & values_a)
+		{
+			if (values_a.empty() || (!first && candidates.empty()))
+				return;
+			std::set<uint64_t> postings;
+			for (h256 const & v : values_a)
+				m_store.log_index_get(transaction_a, kind_a, v, from, to, postings);
+			if (first)
+				candidates.swap(postings);
+			else
+			{
+				std::set<uint64_t> both;
+				std::set_intersection(candidates.begin(), candidates.end(), postings.begin(), postings.end(), std::inserter(both, both.begin()));
+				candidates.swap(both);
+			}
+			first = false;
+		};
+
+		std::vector<h256> addresses;
+		for (Address const & a : filter_a.addresses())
+			addresses.push_back(mcp::log_index_key::address_value(a));
+		intersect((uint8_t)mcp::log_index_kind::address, addresses);
+		for (size_t i = 0; i < filter_a.topics().size(); i++)
+			intersect((uint8_t)((uint8_t)mcp::log_index_kind::topic + i), std::vector<h256>(filter_a.topics()[i].begin(), filter_a.topics()[i].end()));
+
+		stable_indexs_a.insert(stable_indexs_a.end(), candidates.begin(), candidates.end());
+	}
+}
+
 //void mcp::rpc_handler::debug_traceTransaction(mcp::json &j_response, bool &)
 //{
 //	
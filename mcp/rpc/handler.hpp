@@ -2,6 +2,7 @@
 
 #include "rpc.hpp"
 #include "json.hpp"
+#include "LogFilter.hpp"
 
 namespace mcp
 {
@@ -97,6 +98,8 @@ namespace mcp
 		void handleBatch(mcp::jsonrpcMessages const& req);
 		void handleMsg(mcp::jsonrpcMessage const& req);
 		mcp::json handleCallMsg(mcp::jsonrpcMessage const& req, bool& async);
+		/// stable indexes in [from_a, to_a] which may have logs matching filter, by log index
+		void log_index_get(mcp::db::db_transaction & transaction_a, mcp::LogFilter const & filter_a, uint64_t const & from_a, uint64_t const & to_a, std::vector<uint64_t> & stable_indexs_a);
 		std::shared_ptr<mcp::chain> m_chain;
 		std::shared_ptr<mcp::block_cache> m_cache;
 		std::shared_ptr<mcp::key_manager> m_key_manager;
@@ -0,0 +1,96 @@
+#include <mcp/node/chain.hpp>
+#include <mcp/core/genesis.hpp>
+#include <mcp/core/param.hpp>
+
+#include <iostream>
+
+void test_chain_dag_memory()
+{
+	std::cout << "-------------chain dag memory---------------" << std::endl;
+
+	/// single witness network, witnessed level is level. network and its parameters are global, this test runs last
+	mcp::mcp_network = mcp::mcp_networks::mcp_mini_test_network;
+	mcp::db::database::init_table_cache(64);
+	bool error(false);
+	mcp::block_store store(error, mcp::unique_path());
+	assert_x(!error);
+	std::shared_ptr<mcp::block_cache> cache(std::make_shared<mcp::block_cache>(store));
+	mcp::param::init(cache);
+	std::shared_ptr<mcp::process_block_cache> local(std::make_shared<mcp::process_block_cache>(cache, store, nullptr, nullptr));
+
+	/// genesis block written as on first start, so that chain init does not execute genesis transactions
+	{
+		mcp::db::db_transaction transaction(store.create_transaction());
+		mcp::genesis::try_initialize(transaction, store);
+		transaction.commit();
+	}
+	mcp::block_hash const genesis(mcp::genesis::block_hash);
+
+	std::shared_ptr<mcp::chain> chain(std::make_shared<mcp::chain>(store, cache));
+	mcp::timeout_db_transaction timeout_tx(store, 60000);
+	chain->init(error, timeout_tx, local, cache);
+	assert_x(!error);
+	mcp::db::db_transaction & transaction(timeout_tx.get_transaction());
+
+	std::string errors;
+	auto expect = [&](bool const & ok_a, std::string const & what_a) {
+		if (!ok_a)
+			errors += ", ERROR: " + what_a;
+	};
+
+	uint64_t exec_timestamp(1);
+	auto add = [&](uint64_t const & from_a, mcp::block_hash const & previous_a, std::vector<mcp::block_hash> const & parents_a) {
+		std::shared_ptr<mcp::block> block(std::make_shared<mcp::block>(dev::Address(from_a), previous_a, parents_a, dev::h256s{}, dev::h256s{}, mcp::summary_hash(0), genesis, genesis, exec_timestamp, dev::Secret()));
+		chain->save_dag_block(timeout_tx, local, block);
+		expect(chain->dag_memory_consistent(transaction), "memory differs from tables after block " + std::to_string(exec_timestamp));
+		exec_timestamp++;
+		return block->hash();
+	};
+	auto main_chain_block = [&](uint64_t const & mci_a) {
+		mcp::block_hash hash(0);
+		store.main_chain_get(transaction, mci_a, hash);
+		return hash;
+	};
+	auto on_main_chain = [&](mcp::block_hash const & hash_a) {
+		return local->block_state_get(transaction, hash_a)->is_on_main_chain;
+	};
+
+	/// branch a is main chain
+	std::vector<mcp::block_hash> a{ genesis };
+	for (size_t i(1); i <= 3; i++)
+		a.push_back(add(10, i > 1 ? a.back() : mcp::block_hash(0), { a.back() }));
+	expect(main_chain_block(3) == a[3], "main chain of branch a");
+
+	/// longer branch b retreats main chain to genesis
+	std::vector<mcp::block_hash> b{ genesis };
+	for (size_t i(1); i <= 4; i++)
+		b.push_back(add(11, i > 1 ? b.back() : mcp::block_hash(0), { b.back() }));
+	expect(main_chain_block(1) == b[1] && main_chain_block(4) == b[4], "main chain not retreated to branch b");
+	expect(!on_main_chain(a[1]) && !on_main_chain(a[3]) && on_main_chain(b[1]), "main chain flags after retreat");
+
+	/// branch a grows longer and retreats main chain back
+	for (size_t i(4); i <= 6; i++)
+		a.push_back(add(10, a.back(), { a.back() }));
+	expect(main_chain_block(1) == a[1] && main_chain_block(6) == a[6], "main chain not retreated to branch a");
+	expect(main_chain_block(7) == mcp::block_hash(0), "main chain after last mci");
+	expect(!on_main_chain(b[1]) && !on_main_chain(b[4]), "main chain flags after second retreat");
+
+	/// merge block is the only free block
+	mcp::block_hash merge(add(12, mcp::block_hash(0), { a.back(), b.back() }));
+	expect(main_chain_block(7) == merge, "merge block not on main chain");
+	size_t free_count(0);
+	bool merge_free(false);
+	for (mcp::db::forward_iterator it(store.dag_free_begin(transaction)); it.valid(); ++it)
+	{
+		free_count++;
+		merge_free = mcp::free_key(it.key()).hash_asc == merge;
+	}
+	expect(free_count == 1 && merge_free, "free blocks after merge");
+
+	std::list<mcp::block_hash> children;
+	store.block_children_get(transaction, b.back(), children);
+	expect(children.size() == 1 && children.front() == merge, "children of branch b");
+
+	std::cout << "chain dag memory blocks:" << exec_timestamp - 1 << " ,last mci:7"
+		<< (errors.empty() ? "" : errors) << std::endl;
+}
@@ -0,0 +1,420 @@
+#include <mcp/core/dag_index.hpp>
+#include <mcp/core/graph.hpp>
+#include <mcp/consensus/ledger.hpp>
+#include <mcp/node/process_block_cache.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <queue>
+#include <unordered_set>
+
+namespace
+{
+	size_t const witness_count(7);
+	uint64_t const majority_of_witnesses(5);
+
+	class recorded_block
+	{
+	public:
+		mcp::block_hash hash;
+		dev::Address from;
+		uint64_t level;
+		uint64_t witnessed_level;
+		mcp::block_hash best_parent;
+		std::vector<mcp::block_hash> parents;
+		bool is_on_main_chain;
+	};
+
+	/// witness dag, every block has parents own previous block and previous block of next witness, which is best parent.
+	/// best parents go through witnesses in turn, so that majority of witnesses is met along every best parent chain.
+	/// main chain is best parent chain of first witness block of last round, mci and included mcis are set as update_mci
+	/// and update_latest_included_mci do. blocks of first half of rounds are stable.
+	std::vector<recorded_block> record_dag(mcp::block_store & store_a, size_t const & rounds_a)
+	{
+		std::vector<std::shared_ptr<mcp::block>> blocks;
+		std::vector<mcp::block_state> states;
+		std::unordered_map<mcp::block_hash, size_t> positions;
+		auto add = [&](std::shared_ptr<mcp::block> block_a, mcp::block_state const & state_a) {
+			mcp::block_hash hash(block_a->hash());
+			positions[hash] = blocks.size();
+			blocks.push_back(block_a);
+			states.push_back(state_a);
+			return hash;
+		};
+
+		std::shared_ptr<mcp::block> root(std::make_shared<mcp::block>(dev::Address(1), mcp::block_hash(0), std::vector<mcp::block_hash>{}, dev::h256s{}, dev::h256s{}, mcp::summary_hash(0), mcp::block_hash(0), mcp::block_hash(0), 0, dev::Secret()));
+		mcp::block_state root_state;
+		root_state.is_stable = true;
+		root_state.is_on_main_chain = true;
+		root_state.main_chain_index = 0;
+		root_state.earliest_included_mc_index = 0;
+		root_state.latest_included_mc_index = 0;
+		root_state.bp_included_mc_index = 0;
+		root_state.earliest_bp_included_mc_index = 0;
+		root_state.latest_bp_included_mc_index = 0;
+		mcp::block_hash root_hash(add(root, root_state));
+
+		std::vector<mcp::block_hash> previous(witness_count, root_hash);
+		for (size_t r(1); r < rounds_a; r++)
+		{
+			std::vector<mcp::block_hash> next(witness_count);
+			for (size_t w(0); w < witness_count; w++)
+			{
+				mcp::block_hash const & best_parent(previous[(w + 1) % witness_count]);
+				std::vector<mcp::block_hash> parents{ previous[w] };
+				if (best_parent != previous[w])
+					parents.push_back(best_parent);
+
+				std::shared_ptr<mcp::block> block(std::make_shared<mcp::block>(dev::Address(w + 100), previous[w], parents, dev::h256s{}, dev::h256s{}, mcp::summary_hash(0), root_hash, root_hash, r, dev::Secret()));
+				mcp::block_state state;
+				state.best_parent = best_parent;
+				state.level = states[positions[best_parent]].level + 1;
+				state.witnessed_level = state.level > majority_of_witnesses - 1 ? state.level - majority_of_witnesses + 1 : 0;
+				state.is_stable = r < rounds_a / 2;
+				state.is_free = r == rounds_a - 1;
+				state.is_on_main_chain = false;
+				next[w] = add(block, state);
+			}
+			previous = next;
+		}
+
+		/// main chain, mci is level of main chain block
+		std::vector<size_t> main_chain;
+		for (size_t i(positions[previous[0]]); ; i = positions[states[i].best_parent])
+		{
+			main_chain.push_back(i);
+			if (i == 0)
+				break;
+		}
+		std::reverse(main_chain.begin(), main_chain.end());
+		for (size_t mci(0); mci < main_chain.size(); mci++)
+		{
+			states[main_chain[mci]].is_on_main_chain = true;
+			states[main_chain[mci]].main_chain_index = mci;
+		}
+
+		/// mci of other blocks is mci of first main chain block including it
+		for (size_t mci(1); mci < main_chain.size(); mci++)
+		{
+			std::vector<size_t> to_search{ main_chain[mci] };
+			while (!to_search.empty())
+			{
+				size_t i(to_search.back());
+				to_search.pop_back();
+				for (mcp::block_hash const & p : blocks[i]->parents())
+				{
+					mcp::block_state & p_state(states[positions[p]]);
+					if (p_state.main_chain_index)
+						continue;
+					p_state.main_chain_index = mci;
+					to_search.push_back(positions[p]);
+				}
+			}
+		}
+
+		/// included mcis, parents are before children
+		auto included = [&](mcp::block_state const & p_state_a, boost::optional<uint64_t> const & index_a) {
+			return p_state_a.is_on_main_chain ? *p_state_a.main_chain_index : *index_a;
+		};
+		for (size_t i(1); i < blocks.size(); i++)
+		{
+			mcp::block_state & state(states[i]);
+			mcp::block_state const & bp_state(states[positions[state.best_parent]]);
+			state.bp_included_mc_index = included(bp_state, bp_state.bp_included_mc_index);
+			state.earliest_bp_included_mc_index = state.bp_included_mc_index;
+			state.latest_bp_included_mc_index = state.bp_included_mc_index;
+			for (mcp::block_hash const & p : blocks[i]->parents())
+			{
+				mcp::block_state const & p_state(states[positions[p]]);
+				uint64_t eimci(included(p_state, p_state.earliest_included_mc_index));
+				uint64_t limci(included(p_state, p_state.latest_included_mc_index));
+				if (!state.earliest_included_mc_index || *state.earliest_included_mc_index > eimci)
+					state.earliest_included_mc_index = eimci;
+				if (!state.latest_included_mc_index || *state.latest_included_mc_index < limci)
+					state.latest_included_mc_index = limci;
+
+				if (!p_state.is_on_main_chain)
+				{
+					state.earliest_bp_included_mc_index = std::min(*state.earliest_bp_included_mc_index, *p_state.earliest_bp_included_mc_index);
+					state.latest_bp_included_mc_index = std::max(*state.latest_bp_included_mc_index, *p_state.latest_bp_included_mc_index);
+				}
+			}
+		}
+
+		mcp::db::db_transaction transaction(store_a.create_transaction());
+		std::vector<recorded_block> result;
+		for (size_t i(0); i < blocks.size(); i++)
+		{
+			mcp::block_hash hash(blocks[i]->hash());
+			store_a.block_put(transaction, hash, *blocks[i]);
+			store_a.block_state_put(transaction, hash, states[i]);
+			result.push_back(recorded_block{ hash, blocks[i]->from(), states[i].level, states[i].witnessed_level, states[i].best_parent, blocks[i]->parents(), states[i].is_on_main_chain });
+		}
+		transaction.commit();
+		return result;
+	}
+
+	/// find_mc_min_wl before dag index, reading block states from store
+	std::shared_ptr<mcp::min_wl_result> reference_min_wl(mcp::db::db_transaction & transaction_a, mcp::block_store & store_a, mcp::block_hash const & root_a,
+		uint64_t const & witnessed_level_a, mcp::block_hash const & best_parent_a, dev::Address const & from_a)
+	{
+		std::shared_ptr<mcp::min_wl_result> result(std::make_shared<mcp::min_wl_result>());
+		result->min_wl = witnessed_level_a;
+		result->witnesses.insert(from_a);
+		mcp::block_hash hash(best_parent_a);
+		while (hash != root_a)
+		{
+			std::shared_ptr<mcp::block_state> state(store_a.block_state_get(transaction_a, hash));
+			if (state->level < witnessed_level_a)
+				break;
+			std::shared_ptr<mcp::block> block(store_a.block_get(transaction_a, hash));
+			if (result->witnesses.insert(block->from()).second && state->witnessed_level < result->min_wl)
+				result->min_wl = state->witnessed_level;
+			hash = state->best_parent;
+		}
+		return result;
+	}
+
+	/// check_stable before dag index, reading blocks and block states from store
+	bool reference_check_stable(mcp::db::db_transaction & transaction_a, mcp::block_store & store_a, mcp::block_hash const & root_a,
+		mcp::block_hash const & earlier_hash, mcp::block_hash const & bp_block_hash, std::vector<mcp::block_hash> const & parents_a,
+		dev::Address const & block_from_a, mcp::block_hash const & checked_stable_block_hash, mcp::witness_param const & witness_param_a)
+	{
+		std::shared_ptr<mcp::block_state> earlier_block_state(store_a.block_state_get(transaction_a, earlier_hash));
+		if (!earlier_block_state->is_on_main_chain)
+			return false;
+		std::shared_ptr<mcp::block_state> checked_stable_block_state(store_a.block_state_get(transaction_a, checked_stable_block_hash));
+		uint64_t const earlier_mci(*earlier_block_state->main_chain_index);
+		uint64_t const checked_stable_mci(*checked_stable_block_state->main_chain_index);
+		if (earlier_mci <= checked_stable_mci)
+			return true;
+
+		uint64_t level(store_a.block_state_get(transaction_a, bp_block_hash)->level + 1);
+		std::shared_ptr<mcp::min_wl_result> min_wl_result(reference_min_wl(transaction_a, store_a, root_a, mcp::Ledger.calc_witnessed_level(witness_param_a, level), bp_block_hash, block_from_a));
+		if (min_wl_result->min_wl < earlier_block_state->level)
+			return false;
+
+		std::unordered_set<mcp::block_hash> searched_hashs(parents_a.begin(), parents_a.end());
+		std::queue<mcp::block_hash> to_search_hashs;
+		for (mcp::block_hash const & pblock_hash : parents_a)
+			to_search_hashs.push(pblock_hash);
+
+		std::unordered_set<mcp::block_hash> mc_hashs;
+		mcp::block_hash next_mc_hash(bp_block_hash);
+		while (true)
+		{
+			mc_hashs.insert(next_mc_hash);
+			if (next_mc_hash == earlier_hash)
+				break;
+			if (next_mc_hash == root_a)
+				return false;
+			std::shared_ptr<mcp::block_state> mc_block_state(store_a.block_state_get(transaction_a, next_mc_hash));
+			if (mc_block_state->level <= earlier_block_state->level)
+				return false;
+			next_mc_hash = mc_block_state->best_parent;
+		}
+
+		size_t const branch_witness_check_count(witness_param_a.majority_of_witnesses - (witness_param_a.witness_count - witness_param_a.majority_of_witnesses) * 2);
+		std::unordered_set<mcp::block_hash> handled_branch_hashs;
+		while (!to_search_hashs.empty())
+		{
+			mcp::block_hash block_hash(to_search_hashs.front());
+			to_search_hashs.pop();
+
+			std::shared_ptr<mcp::block_state> block_state(store_a.block_state_get(transaction_a, block_hash));
+			if (block_state->level < min_wl_result->min_wl)
+				continue;
+
+			std::shared_ptr<mcp::block> block(store_a.block_get(transaction_a, block_hash));
+			if (!mc_hashs.count(block_hash))
+			{
+				if (*block_state->latest_bp_included_mc_index < checked_stable_mci)
+					continue;
+				if (*block_state->earliest_bp_included_mc_index >= earlier_mci)
+					continue;
+
+				if (min_wl_result->witnesses.count(block->from())
+					&& *block_state->bp_included_mc_index < earlier_mci
+					&& *block_state->bp_included_mc_index >= checked_stable_mci
+					&& !handled_branch_hashs.count(block_hash))
+				{
+					if (branch_witness_check_count == 1)
+						return false;
+
+					std::unordered_set<dev::Address> branch_witnesses{ block->from() };
+					mcp::block_hash branch_bp_block_hash(block_state->best_parent);
+					while (true)
+					{
+						handled_branch_hashs.insert(branch_bp_block_hash);
+						std::shared_ptr<mcp::block_state> branch_bp_block_state(store_a.block_state_get(transaction_a, branch_bp_block_hash));
+						if (branch_witnesses.size() < branch_witness_check_count)
+						{
+							if (branch_bp_block_state->level < min_wl_result->min_wl)
+								break;
+							dev::Address branch_from(store_a.block_get(transaction_a, branch_bp_block_hash)->from());
+							if (min_wl_result->witnesses.count(branch_from) && branch_witnesses.insert(branch_from).second
+								&& branch_witnesses.size() == branch_witness_check_count)
+								return false;
+						}
+						if (branch_bp_block_state->is_on_main_chain)
+							break;
+						branch_bp_block_hash = branch_bp_block_state->best_parent;
+					}
+				}
+			}
+
+			for (mcp::block_hash const & pblock_hash : block->parents())
+			{
+				if (searched_hashs.insert(pblock_hash).second)
+					to_search_hashs.push(pblock_hash);
+			}
+		}
+		return true;
+	}
+
+	/// inclusion by search of all parents, reading blocks from store
+	bool reference_included(mcp::db::db_transaction & transaction_a, mcp::block_store & store_a, mcp::block_hash const & earlier_a, mcp::block_hash const & later_a)
+	{
+		uint64_t earlier_level(store_a.block_state_get(transaction_a, earlier_a)->level);
+		std::unordered_set<mcp::block_hash> searched{ later_a };
+		std::vector<mcp::block_hash> to_search{ later_a };
+		while (!to_search.empty())
+		{
+			mcp::block_hash hash(to_search.back());
+			to_search.pop_back();
+			if (hash == earlier_a)
+				return true;
+			if (store_a.block_state_get(transaction_a, hash)->level <= earlier_level)
+				continue;
+			for (mcp::block_hash const & p : store_a.block_get(transaction_a, hash)->parents())
+			{
+				if (searched.insert(p).second)
+					to_search.push_back(p);
+			}
+		}
+		return false;
+	}
+}
+
+void test_dag_index()
+{
+	std::cout << "-------------dag index---------------" << std::endl;
+
+	mcp::db::database::init_table_cache(64);
+	bool error(false);
+	mcp::block_store store(error, mcp::unique_path());
+	assert_x(!error);
+	size_t const rounds(400);
+	std::vector<recorded_block> dag(record_dag(store, rounds));
+
+	std::shared_ptr<mcp::block_cache> cache(std::make_shared<mcp::block_cache>(store));
+	std::shared_ptr<mcp::process_block_cache> local(std::make_shared<mcp::process_block_cache>(cache, store, nullptr, nullptr));
+	mcp::graph graph(store);
+	mcp::db::db_transaction transaction(store.create_transaction());
+
+	/// min witnessed level walk and inclusion search from every block, results are summed
+	auto replay = [&](std::shared_ptr<mcp::iblock_cache> cache_a, uint64_t & sum_a) {
+		auto start(std::chrono::steady_clock::now());
+		sum_a = 0;
+		for (size_t i(witness_count * majority_of_witnesses + 1); i < dag.size(); i++)
+		{
+			recorded_block const & b(dag[i]);
+			auto min_wl(mcp::Ledger.find_mc_min_wl(transaction, cache_a, b.witnessed_level, b.hash, b.from));
+			sum_a += min_wl->min_wl * 16 + min_wl->witnesses.size();
+
+			recorded_block const & earlier(dag[i - witness_count * 3 + 2]);
+			if (graph.determine_if_included(transaction, cache_a, earlier.hash, { b.hash }))
+				sum_a++;
+		}
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	uint64_t cold_sum(0), warm_sum(0), pruned_sum(0);
+	auto cold_ms(replay(cache, cold_sum));
+	replay(local, warm_sum);
+	auto warm_ms(replay(local, warm_sum));
+
+	std::shared_ptr<mcp::dag_index> index(local->get_dag_index());
+	size_t indexed(index->size());
+
+	/// block state written through process cache is seen by index at once
+	recorded_block const & updated(dag[dag.size() / 2]);
+	std::shared_ptr<mcp::block_state> state(std::make_shared<mcp::block_state>(*local->block_state_get(transaction, updated.hash)));
+	state->witnessed_level++;
+	local->block_state_put(transaction, updated.hash, state);
+	bool update_seen(index->witnessed_level(index->node(transaction, *local, updated.hash)) == updated.witnessed_level + 1);
+	state = std::make_shared<mcp::block_state>(*state);
+	state->witnessed_level--;
+	local->block_state_put(transaction, updated.hash, state);
+
+	/// stable blocks below are reloaded if walked again
+	index->prune(dag[dag.size() / 2].level);
+	size_t after_prune(index->size());
+	replay(local, pruned_sum);
+
+	/// index walks against walks of block states read from store
+	mcp::witness_param param;
+	param.witness_count = witness_count;
+	param.majority_of_witnesses = majority_of_witnesses;
+	std::vector<mcp::block_hash> main_chain;
+	for (recorded_block const & b : dag)
+	{
+		if (b.is_on_main_chain)
+			main_chain.push_back(b.hash);
+	}
+	size_t min_wl_differs(0), stable_differs(0), included_differs(0);
+	size_t stable_count(0), unstable_count(0), included_count(0), checks(0);
+	for (size_t i(witness_count * 20); i < dag.size(); i++)
+	{
+		recorded_block const & b(dag[i]);
+		auto min_wl(mcp::Ledger.find_mc_min_wl(transaction, local, b.witnessed_level, b.best_parent, b.from));
+		auto reference(reference_min_wl(transaction, store, dag[0].hash, b.witnessed_level, b.best_parent, b.from));
+		if (min_wl->min_wl != reference->min_wl || min_wl->witnesses != reference->witnesses)
+			min_wl_differs++;
+
+		/// earlier main chain blocks from checked stable one to just below block
+		uint64_t checked_stable_mci(b.level - 12);
+		for (uint64_t earlier_mci : { checked_stable_mci, checked_stable_mci + 2, b.level - 9, b.level - 6, b.level - 3 })
+		{
+			for (std::shared_ptr<mcp::iblock_cache> c : { std::static_pointer_cast<mcp::iblock_cache>(local), std::static_pointer_cast<mcp::iblock_cache>(cache) })
+			{
+				bool stable(mcp::Ledger.check_stable(transaction, c, main_chain[earlier_mci], b.best_parent, b.parents, b.from, main_chain[checked_stable_mci], param));
+				bool expected(reference_check_stable(transaction, store, dag[0].hash, main_chain[earlier_mci], b.best_parent, b.parents, b.from, main_chain[checked_stable_mci], param));
+				if (stable != expected)
+					stable_differs++;
+				stable ? stable_count++ : unstable_count++;
+			}
+		}
+
+		for (size_t distance : { size_t(1), witness_count + 1, witness_count * 3 - 2, witness_count * 6 })
+		{
+			recorded_block const & earlier(dag[i - distance]);
+			bool included(graph.determine_if_included(transaction, local, earlier.hash, { b.hash }));
+			if (included != reference_included(transaction, store, earlier.hash, b.hash))
+				included_differs++;
+			if (included)
+				included_count++;
+			checks++;
+		}
+	}
+
+	std::cout << "dag index blocks:" << dag.size()
+		<< " ,cold:" << cold_ms << "ms"
+		<< " ,warm:" << warm_ms << "ms"
+		<< " ,indexed:" << indexed
+		<< " ,after prune:" << after_prune << std::endl
+		<< index->report()
+		<< (cold_sum == warm_sum ? "" : ", ERROR: index walk differs")
+		<< (cold_sum == pruned_sum ? "" : ", ERROR: walk after prune differs")
+		<< (update_seen ? "" : ", ERROR: state update not seen")
+		<< (index->reach_answered() > index->reach_unknown() ? "" : ", ERROR: labels answer few inclusions")
+		<< (after_prune < indexed ? "" : ", ERROR: nothing pruned") << std::endl
+		<< "dag index against store stable:" << stable_count << " ,unstable:" << unstable_count
+		<< " ,included:" << included_count << "/" << checks
+		<< (min_wl_differs == 0 ? "" : ", ERROR: min wl differs " + std::to_string(min_wl_differs))
+		<< (stable_differs == 0 ? "" : ", ERROR: check stable differs " + std::to_string(stable_differs))
+		<< (included_differs == 0 ? "" : ", ERROR: inclusion differs " + std::to_string(included_differs))
+		<< (stable_count > 0 && unstable_count > 0 ? "" : ", ERROR: check stable has one result")
+		<< (included_count > 0 && included_count < checks ? "" : ", ERROR: inclusion has one result") << std::endl;
+}
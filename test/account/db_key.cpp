@@ -0,0 +1,136 @@
+#include <mcp/db/database.hpp>
+
+#include <libdevcore/FixedHash.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+
+namespace
+{
+	/// heap allocations of this thread are counted only inside measure
+	thread_local bool counting(false);
+	thread_local uint64_t allocations(0);
+}
+
+void * operator new(size_t size)
+{
+	if (counting)
+		allocations++;
+	if (void * p = std::malloc(size == 0 ? 1 : size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void * p, size_t) noexcept
+{
+	std::free(p);
+}
+
+namespace
+{
+	/// runs op ops times with allocation counting on, prints ops/s and heap allocations per op
+	void measure(std::string const & name, uint64_t const & ops, std::function<void(uint64_t const &)> const & op)
+	{
+		allocations = 0;
+		counting = true;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint64_t i = 0; i < ops; i++)
+			op(i);
+		auto dur = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start);
+		counting = false;
+
+		double ops_per_sec = dur.count() ? ops * 1e9 / dur.count() : 0;
+		std::cout << name << ": " << (uint64_t)ops_per_sec << " ops/s, allocations per op:" << (double)allocations / ops << std::endl;
+	}
+
+	dev::h256 make_key(uint64_t const & i)
+	{
+		dev::h256 key;
+		for (size_t b(0); b < 8; b++)
+			key[31 - b] = (dev::byte)(i >> (b * 8));
+		return key;
+	}
+}
+
+/// point reads and writes through database and db_transaction, with options allocated per call and values copied
+/// into std::string as before options were reused and values pinned, and with default options and PinnableSlice
+void test_db_key()
+{
+	std::cout << "-------------db key---------------" << std::endl;
+
+	uint64_t const keys = 100000;
+	std::string const value(256, 'v');
+	uint64_t checksum(0);
+
+	boost::filesystem::path path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path());
+	{
+		mcp::db::database::init_table_cache(64);
+		mcp::db::database db(path);
+		auto cfops = mcp::db::db_column::point_lookup_column_family_options(mcp::db::database::get_table_cache());
+		int column = db.create_column_family(rocksdb::kDefaultColumnFamilyName, cfops);
+		/// shared table, keys are composed with table prefix
+		int table = db.set_column_family(column, "005");
+		if (!db.open())
+		{
+			std::cout << "open database error" << std::endl;
+			return;
+		}
+
+		measure("put, options per call", keys, [&](uint64_t const & i) {
+			dev::h256 key(make_key(i));
+			db.put(table, dev::Slice((char const*)key.data(), key.size), dev::Slice(&value), mcp::db::database::default_write_options());
+		});
+		measure("put", keys, [&](uint64_t const & i) {
+			dev::h256 key(make_key(keys + i));
+			db.put(table, dev::Slice((char const*)key.data(), key.size), dev::Slice(&value));
+		});
+
+		measure("get std::string, options per call", keys, [&](uint64_t const & i) {
+			dev::h256 key(make_key(i));
+			std::string v;
+			db.get(table, dev::Slice((char const*)key.data(), key.size), v, mcp::db::database::default_read_options());
+			checksum += v.size();
+		});
+		rocksdb::PinnableSlice pinned;
+		measure("get PinnableSlice", keys, [&](uint64_t const & i) {
+			dev::h256 key(make_key(i));
+			db.get(table, dev::Slice((char const*)key.data(), key.size), pinned);
+			checksum += pinned.size();
+		});
+
+		{
+			mcp::db::db_transaction transaction(db.create_transaction());
+			measure("transaction get std::string", keys, [&](uint64_t const & i) {
+				dev::h256 key(make_key(i));
+				std::string v;
+				transaction.get(table, dev::Slice((char const*)key.data(), key.size), v);
+				checksum += v.size();
+			});
+			measure("transaction get PinnableSlice", keys, [&](uint64_t const & i) {
+				dev::h256 key(make_key(i));
+				transaction.get(table, dev::Slice((char const*)key.data(), key.size), pinned);
+				checksum += pinned.size();
+			});
+		}
+
+		measure("del, options per call", keys, [&](uint64_t const & i) {
+			dev::h256 key(make_key(i));
+			db.del(table, dev::Slice((char const*)key.data(), key.size), mcp::db::database::default_write_options());
+		});
+		measure("del", keys, [&](uint64_t const & i) {
+			dev::h256 key(make_key(keys + i));
+			db.del(table, dev::Slice((char const*)key.data(), key.size));
+		});
+	}
+	boost::filesystem::remove_all(path);
+
+	std::cout << "checksum:" << checksum << std::endl;
+}
@@ -0,0 +1,286 @@
+#include <mcp/node/sync.hpp>
+#include <mcp/core/genesis.hpp>
+#include <mcp/core/param.hpp>
+
+#include <libdevcore/TrieHash.h>
+#include <libdevcrypto/Common.h>
+
+#include <future>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+	uint64_t const last_stable_mci(2 * mcp::epoch_period);
+	uint64_t const last_stable_index(3 * mcp::epoch_period);
+
+	/// node set up as by daemon, each io service runs on one thread
+	class test_node
+	{
+	public:
+		test_node(uint16_t const & port_a) :
+			store(error, mcp::unique_path()),
+			cache(std::make_shared<mcp::block_cache>(store)),
+			alarm(std::make_shared<mcp::alarm>(bg_io_service)),
+			sync_async(std::make_shared<mcp::async_task>(sync_io_service)),
+			chain(std::make_shared<mcp::chain>(store, cache)),
+			key(dev::KeyPair::create()),
+			port(port_a)
+		{
+			assert_x(!error);
+			TQ = std::make_shared<mcp::TransactionQueue>(io_service, store, cache, chain, sync_async);
+			chain->set_TQ(TQ);
+			AQ = std::make_shared<mcp::ApproveQueue>(store, cache, chain, sync_async);
+			validation = std::make_shared<mcp::validation>(store, cache, TQ, AQ);
+			capability = std::make_shared<mcp::node_capability>(io_service, store, cache, sync_async, TQ, AQ);
+			TQ->set_capability(capability);
+			AQ->set_capability(capability);
+			sync = std::make_shared<mcp::node_sync>(capability, store, chain, cache, TQ, AQ, sync_async, bg_io_service);
+			capability->set_sync(sync);
+		}
+
+		/// chain is initialized from store by block processor
+		void start_processor()
+		{
+			processor = std::make_shared<mcp::block_processor>(error, store, cache, chain, sync, capability, validation, sync_async, TQ, AQ, bg_io_service, alarm);
+			assert_x(!error);
+			capability->set_processor(processor);
+			sync->set_processor(processor);
+		}
+
+		/// listen on loopback, exemption_a is connected directly if not empty
+		void start_host(std::string const & exemption_a)
+		{
+			mcp::p2p::p2p_config config;
+			config.listen_ip = "127.0.0.1";
+			config.port = port;
+			if (!exemption_a.empty())
+				config.exemption_nodes.push_back(exemption_a);
+
+			boost::filesystem::path path(mcp::unique_path());
+			boost::filesystem::create_directories(path);
+			host = std::make_shared<mcp::p2p::host>(error, config, io_service, key.secret(), path);
+			assert_x(!error);
+			host->register_capability(capability);
+			host->start();
+
+			for (boost::asio::io_service * service : { &io_service, &sync_io_service, &bg_io_service })
+			{
+				works.push_back(std::make_unique<boost::asio::io_service::work>(*service));
+				threads.emplace_back([service]() { service->run(); });
+			}
+		}
+
+		std::string node() const
+		{
+			return "mcpnode://" + host->id().hex() + "@127.0.0.1:" + std::to_string(port);
+		}
+
+		void stop()
+		{
+			if (processor)
+				processor->stop();
+			if (host)
+				host->stop();
+			sync->stop();
+			capability->stop();
+			works.clear();
+			io_service.stop();
+			sync_io_service.stop();
+			bg_io_service.stop();
+			for (auto & t : threads)
+				t.join();
+			threads.clear();
+		}
+
+		bool error = false;
+		mcp::block_store store;
+		std::shared_ptr<mcp::block_cache> cache;
+		boost::asio::io_service io_service;
+		boost::asio::io_service sync_io_service;
+		boost::asio::io_service bg_io_service;
+		std::shared_ptr<mcp::alarm> alarm;
+		std::shared_ptr<mcp::async_task> sync_async;
+		std::shared_ptr<mcp::chain> chain;
+		std::shared_ptr<mcp::TransactionQueue> TQ;
+		std::shared_ptr<mcp::ApproveQueue> AQ;
+		std::shared_ptr<mcp::validation> validation;
+		std::shared_ptr<mcp::node_capability> capability;
+		std::shared_ptr<mcp::node_sync> sync;
+		std::shared_ptr<mcp::block_processor> processor;
+		std::shared_ptr<mcp::p2p::host> host;
+		dev::KeyPair key;
+		uint16_t port;
+		std::vector<std::unique_ptr<boost::asio::io_service::work>> works;
+		std::vector<std::thread> threads;
+	};
+
+	mcp::witness_param single_witness(dev::Address const & witness_a)
+	{
+		mcp::witness_param w_param;
+		w_param.witness_count = 1;
+		w_param.majority_of_witnesses = 1;
+		w_param.witness_list.insert(witness_a);
+		return w_param;
+	}
+
+	/// genesis, stable main chain block of witness_a at last stable mci and unstable main chain block of sender_a above it.
+	/// block of sender_a has block of witness_a as last summary block, it proves stable summary if sender_a is a witness
+	void populate(mcp::block_store & store_a, dev::KeyPair const & witness_a, dev::KeyPair const & sender_a, size_t const & accounts_a)
+	{
+		mcp::db::db_transaction transaction(store_a.create_transaction());
+		mcp::genesis::try_initialize(transaction, store_a);
+		mcp::block_hash const genesis(mcp::genesis::block_hash);
+		mcp::summary_hash genesis_summary;
+		bool summary_error(store_a.block_summary_get(transaction, genesis, genesis_summary));
+		assert_x(!summary_error);
+		std::shared_ptr<mcp::block_state> genesis_state(store_a.block_state_get(transaction, genesis));
+		assert_x(genesis_state);
+
+		mcp::block stable(witness_a.address(), mcp::block_hash(0), { genesis }, dev::h256s{}, dev::h256s{}, genesis_summary, genesis, genesis, 1000, witness_a.secret());
+		mcp::block_hash const stable_hash(stable.hash());
+		store_a.block_put(transaction, stable_hash, stable);
+		mcp::block_state stable_state;
+		stable_state.status = mcp::block_status::ok;
+		stable_state.is_stable = true;
+		stable_state.is_on_main_chain = true;
+		stable_state.main_chain_index = last_stable_mci;
+		stable_state.stable_index = last_stable_index;
+		stable_state.level = 1;
+		stable_state.mc_timestamp = 1000;
+		store_a.block_state_put(transaction, stable_hash, stable_state);
+		store_a.main_chain_put(transaction, last_stable_mci, stable_hash);
+		store_a.stable_block_put(transaction, last_stable_index, stable_hash);
+
+		/// no links or approves
+		dev::h256 receipts_root(dev::orderedTrieRoot(std::vector<dev::bytes>()));
+		store_a.PutBlockReceiptsRoot(transaction, stable_hash, receipts_root);
+		mcp::summary_hash stable_summary(mcp::summary::gen_summary_hash(stable_hash, mcp::summary_hash(0), { genesis_summary }, receipts_root, {},
+			stable_state.status, stable_state.stable_index, stable_state.mc_timestamp));
+		store_a.block_summary_put(transaction, stable_hash, stable_summary);
+		store_a.summary_block_put(transaction, stable_summary, stable_hash);
+
+		mcp::dag_account_info info;
+		info.latest_stable_block = stable_hash;
+		store_a.dag_account_put(transaction, witness_a.address(), info);
+
+		mcp::block unstable(sender_a.address(), mcp::block_hash(0), { stable_hash }, dev::h256s{}, dev::h256s{}, stable_summary, stable_hash, stable_hash, 1001, sender_a.secret());
+		mcp::block_hash const unstable_hash(unstable.hash());
+		store_a.block_put(transaction, unstable_hash, unstable);
+		mcp::block_state unstable_state;
+		unstable_state.is_on_main_chain = true;
+		unstable_state.is_free = true;
+		unstable_state.main_chain_index = last_stable_mci + 1;
+		unstable_state.level = 2;
+		store_a.block_state_put(transaction, unstable_hash, unstable_state);
+		store_a.main_chain_put(transaction, last_stable_mci + 1, unstable_hash);
+		store_a.dag_free_del(transaction, mcp::free_key(genesis_state->witnessed_level, genesis_state->level, genesis));
+		store_a.dag_free_put(transaction, mcp::free_key(unstable_state.witnessed_level, unstable_state.level, unstable_hash));
+
+		mcp::witness_param w_param(single_witness(witness_a.address()));
+		store_a.epoch_param_put(transaction, mcp::epoch(last_stable_mci), w_param);
+		store_a.last_mci_put(transaction, last_stable_mci + 1);
+		store_a.last_stable_mci_put(transaction, last_stable_mci);
+		store_a.last_stable_index_put(transaction, last_stable_index);
+		transaction.count_add("block", 2);
+
+		for (size_t i(0); i < accounts_a; i++)
+		{
+			dev::Address account(i + 100);
+			mcp::account_state s(account, dev::h256(i), dev::h256(0), 0, i * 1000);
+			dev::h256 s_hash(s.hash());
+			store_a.account_state_put(transaction, s_hash, s);
+			store_a.latest_account_state_put(transaction, account, s_hash);
+		}
+		transaction.commit();
+	}
+
+	/// fast sync of target_a from the node it connects to, return true if import failed or timed out
+	bool fast_sync(test_node & target_a, std::string const & source_a)
+	{
+		std::promise<bool> imported;
+		std::future<bool> imported_future(imported.get_future());
+		target_a.sync->fast_sync([&imported](bool const & error_a) { imported.set_value(error_a); });
+		target_a.start_host(source_a);
+
+		if (imported_future.wait_for(std::chrono::minutes(3)) != std::future_status::ready)
+		{
+			std::cout << "fast sync timeout" << std::endl;
+			return true;
+		}
+		return imported_future.get();
+	}
+}
+
+/// two nodes in process over loopback, node with empty store imports snapshot of peer and hands off to catchup.
+/// a snapshot whose stable summary is attested by a non witness is rejected
+void test_fast_sync()
+{
+	std::cout << "-------------fast sync---------------" << std::endl;
+
+	mcp::db::database::init_table_cache(64);
+	size_t const accounts(1000);
+	dev::KeyPair witness(dev::KeyPair::create());
+	dev::KeyPair intruder(dev::KeyPair::create());
+
+	test_node source(30711);
+	mcp::param::init(source.cache);
+	populate(source.store, witness, witness, accounts);
+	{
+		/// witness list of epoch is found by every node in process through param
+		mcp::db::db_transaction transaction(source.store.create_transaction());
+		mcp::witness_param w_param(single_witness(witness.address()));
+		mcp::param::add_witness_param(transaction, mcp::epoch(last_stable_mci), w_param);
+		transaction.commit();
+	}
+	source.start_processor();
+	source.start_host("");
+
+	test_node target(30712);
+	bool failed(fast_sync(target, source.node()));
+	bool imported_accounts_ok(false);
+	bool stable_mci_ok(false);
+	bool catchup_requested(false);
+	if (!failed)
+	{
+		target.start_processor();
+		target.sync->fast_sync_handoff();
+		stable_mci_ok = target.chain->last_stable_mci() == last_stable_mci;
+
+		mcp::db::db_transaction transaction(target.store.create_transaction());
+		size_t imported_accounts(0);
+		for (mcp::db::forward_iterator it(transaction.begin(target.store.latest_account_state)); it.valid(); ++it)
+			imported_accounts++;
+		/// genesis accounts are imported too
+		imported_accounts_ok = imported_accounts >= accounts;
+
+		for (size_t i(0); i < 300 && !catchup_requested; i++)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			catchup_requested = source.capability->receive_catchup_request_count > 0;
+		}
+	}
+
+	std::cout << target.sync->get_fast_sync_info()
+		<< (failed ? ", ERROR: fast sync failed" : "")
+		<< (failed || stable_mci_ok ? "" : ", ERROR: last stable mci differs")
+		<< (failed || imported_accounts_ok ? "" : ", ERROR: accounts not imported")
+		<< (failed || !target.sync->is_fast_syncing() ? "" : ", ERROR: still fast syncing after handoff")
+		<< (failed || catchup_requested ? "" : ", ERROR: no catchup after handoff") << std::endl;
+	target.stop();
+	source.stop();
+
+	/// last summary block is attested by a block of a non witness
+	test_node forged(30713);
+	populate(forged.store, witness, intruder, accounts);
+	forged.start_processor();
+	forged.start_host("");
+
+	test_node victim(30714);
+	bool forged_rejected(fast_sync(victim, forged.node()));
+
+	std::cout << "fast sync from non witness proof"
+		<< (forged_rejected ? "" : ", ERROR: summary of non witness accepted") << std::endl;
+	victim.stop();
+	forged.stop();
+}
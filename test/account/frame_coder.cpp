@@ -0,0 +1,78 @@
+#include <mcp/p2p/frame_coder.hpp>
+
+#include <iostream>
+#include <random>
+
+namespace
+{
+	/// splits of a packet into chunks, empty chunks included
+	std::vector<std::vector<size_t>> chunk_splits(size_t const & size_a)
+	{
+		std::vector<std::vector<size_t>> result;
+		result.push_back({ size_a });
+		result.push_back({ 0, size_a, 0 });
+		if (size_a > 1)
+		{
+			result.push_back({ 1, size_a - 1 });
+			result.push_back({ size_a / 2, 0, size_a - size_a / 2 });
+			result.push_back(std::vector<size_t>(size_a, 1));
+			std::vector<size_t> sevens;
+			for (size_t offset(0); offset < size_a; offset += 7)
+				sevens.push_back(std::min<size_t>(7, size_a - offset));
+			result.push_back(sevens);
+		}
+		return result;
+	}
+}
+
+void test_frame_coder()
+{
+	std::cout << "-------------frame coder---------------" << std::endl;
+
+	/// coders set up identically have the same egress state, one writes contiguous packets, the other chunked ones
+	dev::KeyPair local(dev::KeyPair::create()), remote(dev::KeyPair::create()), ephemeral(dev::KeyPair::create());
+	dev::h256 nonce(dev::h256::random()), remote_nonce(dev::h256::random());
+	dev::bytes auth(dev::h256::random().asBytes()), ack(dev::h256::random().asBytes());
+	mcp::p2p::RLPXFrameCoder contiguous_coder(true, ephemeral.pub(), remote_nonce, local, nonce, &ack, &auth);
+	mcp::p2p::RLPXFrameCoder chunked_coder(true, ephemeral.pub(), remote_nonce, local, nonce, &ack, &auth);
+
+	std::mt19937 random(1);
+	size_t packets(0);
+	size_t mismatches(0);
+	/// sizes cover every padding length
+	for (size_t size(0); size <= 48; size++)
+	{
+		for (size_t const & big : { size_t(0), size_t(1000) })
+		{
+			dev::bytes packet(size + big);
+			for (auto & b : packet)
+				b = random() & 0xff;
+
+			for (std::vector<size_t> const & split : chunk_splits(packet.size()))
+			{
+				std::vector<dev::bytesConstRef> chunks;
+				size_t offset(0);
+				for (size_t const & length : split)
+				{
+					chunks.push_back(dev::bytesConstRef(&packet).cropped(offset, length));
+					offset += length;
+				}
+				assert_x(offset == packet.size());
+
+				dev::bytes contiguous;
+				contiguous_coder.writeSingleFramePacket(&packet, contiguous);
+				dev::bytes header, frame;
+				chunked_coder.writeSingleFramePacket(chunks, header, frame);
+				header.insert(header.end(), frame.begin(), frame.end());
+
+				packets++;
+				if (header != contiguous)
+					mismatches++;
+			}
+		}
+	}
+
+	std::cout << "frame coder packets:" << packets
+		<< " ,mismatches:" << mismatches
+		<< (mismatches == 0 ? "" : ", ERROR: chunked packet differs from contiguous") << std::endl;
+}
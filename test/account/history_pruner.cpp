@@ -0,0 +1,109 @@
+#include <mcp/node/history_pruner.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+void test_history_pruner()
+{
+	std::cout << "-------------history pruner---------------" << std::endl;
+
+	mcp::db::database::init_table_cache(64);
+	bool error(false);
+	mcp::block_store store(error, mcp::unique_path());
+	assert_x(!error);
+
+	/// state of account changes every mci, index entry at mci is the state replaced at mci as chain_state::commit writes
+	uint64_t const mcis(400);
+	dev::Address const account(1);
+	dev::Address const unchanged(2);
+	std::vector<dev::h256> states;
+	{
+		mcp::db::db_transaction transaction(store.create_transaction());
+		for (uint64_t mci(0); mci <= mcis; mci++)
+		{
+			mcp::account_state s(account, dev::h256(mci), states.empty() ? dev::h256(0) : states.back(), mci, mci);
+			store.account_state_put(transaction, s.hash(), s);
+			if (mci > 0)
+			{
+				store.history_index_put(transaction, mcp::history_index_key(mci, mcp::history_kind::account_state, states.back()), account);
+
+				std::vector<dev::h256> previous{ states.back() };
+				store.transaction_previous_account_state_put(transaction, dev::h256(mci), previous);
+				store.history_index_put(transaction, mcp::history_index_key(mci, mcp::history_kind::transaction_account_state, dev::h256(mci)));
+			}
+			states.push_back(s.hash());
+		}
+		store.latest_account_state_put(transaction, account, states.back());
+
+		/// indexed state which is still latest is kept
+		mcp::account_state u(unchanged, dev::h256(0), dev::h256(0), 0, 1);
+		store.account_state_put(transaction, u.hash(), u);
+		store.latest_account_state_put(transaction, unchanged, u.hash());
+		store.history_index_put(transaction, mcp::history_index_key(1, mcp::history_kind::account_state, u.hash()), unchanged);
+		transaction.commit();
+	}
+
+	/// keep 100 mcis, one round prunes 256 mcis
+	uint64_t const keep(100);
+	uint64_t const to_mci(256);
+	uint64_t pruned_mci(0);
+	{
+		mcp::history_pruner pruner(store, keep);
+		pruner.on_stable(mcis);
+		auto start(std::chrono::steady_clock::now());
+		while (std::chrono::steady_clock::now() - start < std::chrono::seconds(30))
+		{
+			mcp::db::db_transaction transaction(store.create_transaction());
+			if (!store.history_pruned_mci_get(transaction, pruned_mci) && pruned_mci >= to_mci)
+				break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		std::cout << pruner.get_info() << std::endl;
+	}
+
+	std::string errors;
+	auto expect = [&](bool const & ok_a, std::string const & what_a) {
+		if (!ok_a)
+			errors += ", ERROR: " + what_a;
+	};
+	expect(pruned_mci == to_mci, "pruned mci " + std::to_string(pruned_mci));
+
+	mcp::db::db_transaction transaction(store.create_transaction());
+	size_t pruned(0), retained(0);
+	for (uint64_t mci(0); mci <= mcis; mci++)
+	{
+		/// state replaced at mci lower than pruned mci is gone
+		bool gone(mci + 1 < to_mci);
+		std::shared_ptr<mcp::account_state> s(store.account_state_get(transaction, states[mci]));
+		if (gone)
+		{
+			expect(s == nullptr, "state not pruned at mci " + std::to_string(mci));
+			pruned++;
+		}
+		else
+		{
+			expect(s != nullptr && s->nonce() == mci && s->balance() == mci, "state not readable at mci " + std::to_string(mci));
+			retained++;
+		}
+
+		if (mci > 0)
+		{
+			std::vector<dev::h256> previous;
+			bool exists(store.transaction_previous_account_state_get(transaction, dev::h256(mci), previous));
+			expect(exists == (mci >= to_mci), "transaction account state at mci " + std::to_string(mci));
+			expect(!exists || (previous.size() == 1 && previous[0] == states[mci - 1]), "transaction account state differs at mci " + std::to_string(mci));
+		}
+	}
+
+	dev::h256 latest;
+	expect(!store.latest_account_state_get(transaction, unchanged, latest) && store.account_state_get(transaction, latest) != nullptr, "latest state pruned");
+
+	/// index of pruned mcis is deleted
+	std::vector<std::pair<mcp::history_index_key, dev::Address>> index;
+	store.history_index_get(transaction, mcp::history_index_key(0, mcp::history_kind::account_state, dev::h256(0)), to_mci, 1, index);
+	expect(index.empty(), "index left");
+
+	std::cout << "history pruner pruned states:" << pruned << " ,retained states:" << retained
+		<< (errors.empty() ? "" : errors) << std::endl;
+}
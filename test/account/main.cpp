@@ -22,6 +22,20 @@ int main(int argc, char * const * argv)
 	test_account_decrypt();
 	test_sha3();
 	test_eth_sign();
+	test_db_key();
+	test_parallel_exec();
+	test_parallel_exec_links();
+	test_p2p_receive();
+	test_state_snapshot();
+	test_dag_index();
+	test_transaction_queue();
+	test_transaction_pool();
+	test_sharded_cache();
+	test_history_pruner();
+	test_frame_coder();
+	test_fast_sync();
+	/// sets global network parameters, runs last
+	test_chain_dag_memory();
 
 	std::cout << std::endl;
 	std::cout << "Press \"Enter\" to exit...";
@@ -13,4 +13,18 @@ void test_secure_string();
 
 void test_abi();
 void test_decode();
-void test_vrf();
\ No newline at end of file
+void test_vrf();
+
+void test_db_key();
+void test_parallel_exec();
+void test_parallel_exec_links();
+void test_p2p_receive();
+void test_state_snapshot();
+void test_dag_index();
+void test_transaction_queue();
+void test_transaction_pool();
+void test_sharded_cache();
+void test_history_pruner();
+void test_frame_coder();
+void test_fast_sync();
+void test_chain_dag_memory();
\ No newline at end of file
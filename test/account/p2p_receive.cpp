@@ -0,0 +1,143 @@
+#include <mcp/p2p/common.hpp>
+#include "lz4.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace
+{
+	void append_size(dev::bytes & out_a, uint32_t const & size_a)
+	{
+		out_a.push_back((size_a >> 24) & 0xff);
+		out_a.push_back((size_a >> 16) & 0xff);
+		out_a.push_back((size_a >> 8) & 0xff);
+		out_a.push_back(size_a & 0xff);
+	}
+
+	/// cheap, so that timing is of the receive path
+	uint64_t checksum(dev::bytesConstRef const & data_a)
+	{
+		return data_a.size() * 1000003 + data_a[0] * 257 + data_a[data_a.size() - 1];
+	}
+
+	/// frame as written by peer::do_write: original size + lz4 of (size + packet)...
+	dev::bytes make_frame(std::vector<dev::bytes> const & packets_a)
+	{
+		dev::bytes group;
+		for (auto const & p : packets_a)
+		{
+			append_size(group, p.size());
+			group.insert(group.end(), p.begin(), p.end());
+		}
+		dev::bytes compressed(LZ4_compressBound(group.size()));
+		int size = LZ4_compress_default((char const *)group.data(), (char *)compressed.data(), group.size(), compressed.size());
+		compressed.resize(size);
+
+		dev::bytes frame;
+		append_size(frame, group.size());
+		frame.insert(frame.end(), compressed.begin(), compressed.end());
+		return frame;
+	}
+
+	/// receive path before packets referenced the frame buffer
+	size_t read_copying(dev::bytesConstRef const & frame_a, uint64_t & digest_a)
+	{
+		dev::bytes buffer(frame_a.toBytes());
+		uint32_t original_size((buffer[0] << 24) + (buffer[1] << 16) + (buffer[2] << 8) + buffer[3]);
+		dev::bytes package_buffer(original_size);
+		uint32_t body_size = buffer.size() - mcp::p2p::tcp_header_size;
+		dev::bytesConstRef(buffer.data() + mcp::p2p::tcp_header_size, body_size).copyTo(dev::bytesRef(buffer.data(), body_size));
+		buffer.resize(body_size);
+		LZ4_decompress_safe((char const *)buffer.data(), (char *)package_buffer.data(), buffer.size(), original_size);
+
+		size_t count(0);
+		uint32_t offset = 0;
+		while (offset < original_size)
+		{
+			dev::bytes size(4);
+			dev::bytesConstRef(package_buffer.data() + offset, 4).copyTo(dev::bytesRef(size.data(), 4));
+			uint32_t isize((size[0] << 24) + (size[1] << 16) + (size[2] << 8) + size[3]);
+			dev::bytes body(isize);
+			dev::bytesConstRef(package_buffer.data() + offset + 4, isize).copyTo(dev::bytesRef(body.data(), isize));
+			offset = offset + 4 + isize;
+
+			std::shared_ptr<dev::RLP> r(std::make_shared<dev::RLP>(dev::bytesConstRef(&body).cropped(1)));
+			digest_a += checksum(r->data());
+			count++;
+		}
+		return count;
+	}
+
+	size_t read_pooled(dev::bytesConstRef const & frame_a, uint64_t & digest_a, std::vector<mcp::p2p::packet_ref> & packets_a)
+	{
+		std::shared_ptr<dev::bytes> buffer(mcp::p2p::decompress_frame(frame_a));
+		packets_a.clear();
+		if (!buffer || !mcp::p2p::split_frame(buffer, packets_a))
+			return 0;
+		for (auto const & p : packets_a)
+			digest_a += checksum(mcp::p2p::packet_ref(p.buffer, p.data.cropped(1)).rlp().data());
+		return packets_a.size();
+	}
+}
+
+void test_p2p_receive()
+{
+	std::cout << "-------------p2p receive---------------" << std::endl;
+
+	/// catch up like traffic: groups of joint sized packets up to 32k per frame
+	std::mt19937_64 rng(20221017);
+	std::vector<dev::bytes> frames;
+	size_t traffic_size(0);
+	for (size_t f = 0; f < 2000; f++)
+	{
+		std::vector<dev::bytes> packets;
+		size_t group_size(0);
+		while (group_size < 32768)
+		{
+			dev::bytes payload(200 + rng() % 800);
+			for (size_t i = 0; i < payload.size(); i++)
+				payload[i] = (i % 7 == 0) ? (dev::byte)rng() : (dev::byte)(i & 0x1f);
+			dev::RLPStream s;
+			s.append((unsigned)0x10).appendList(1) << payload;
+			packets.push_back(s.out());
+			group_size += packets.back().size() + 4;
+		}
+		frames.push_back(make_frame(packets));
+		traffic_size += group_size;
+	}
+
+	uint64_t copy_digest(0);
+	size_t copy_count(0);
+	auto copy_start(std::chrono::steady_clock::now());
+	for (auto const & f : frames)
+		copy_count += read_copying(dev::bytesConstRef(&f), copy_digest);
+	auto copy_ms(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - copy_start).count());
+
+	uint64_t pooled_digest(0);
+	size_t pooled_count(0);
+	std::vector<mcp::p2p::packet_ref> packets;
+	auto pooled_start(std::chrono::steady_clock::now());
+	for (auto const & f : frames)
+		pooled_count += read_pooled(dev::bytesConstRef(&f), pooled_digest, packets);
+	auto pooled_ms(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - pooled_start).count());
+
+	/// truncated frame must be rejected, not read out of bounds
+	dev::bytes truncated(frames[0].begin(), frames[0].begin() + frames[0].size() / 2);
+	bool rejected(mcp::p2p::decompress_frame(dev::bytesConstRef(&truncated)) == nullptr);
+
+	/// uncompressed frame is copied as is
+	dev::bytes packet(200, 0x42);
+	dev::bytes raw_frame;
+	append_size(raw_frame, (packet.size() + 4) | mcp::p2p::uncompressed_frame_flag);
+	append_size(raw_frame, packet.size());
+	raw_frame.insert(raw_frame.end(), packet.begin(), packet.end());
+	std::shared_ptr<dev::bytes> raw(mcp::p2p::decompress_frame(dev::bytesConstRef(&raw_frame)));
+	bool raw_ok(raw && *raw == dev::bytesConstRef(&raw_frame).cropped(mcp::p2p::tcp_header_size).toBytes());
+
+	std::cout << "traffic:" << traffic_size / 1024 / 1024 << "MB, packets:" << pooled_count
+		<< ", copying:" << copy_ms << "ms, pooled:" << pooled_ms << "ms"
+		<< ((copy_count == pooled_count && copy_digest == pooled_digest) ? ", same packets" : ", ERROR: packets differ")
+		<< (rejected ? "" : ", ERROR: truncated frame accepted")
+		<< (raw_ok ? "" : ", ERROR: uncompressed frame differs") << std::endl;
+}
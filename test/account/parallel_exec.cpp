@@ -0,0 +1,312 @@
+#include <mcp/node/parallel_executor.hpp>
+#include <mcp/node/chain_state.hpp>
+
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libdevcore/TrieHash.h>
+#include <libdevcrypto/Common.h>
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+
+namespace
+{
+	/// transfer between accounts of a toy ledger, same commit protocol as chain::advance_stable_mci
+	class transfer
+	{
+	public:
+		dev::Address from;
+		dev::Address to;
+		uint64_t value;
+	};
+
+	using ledger = std::map<dev::Address, uint64_t>;
+
+	class toy_state
+	{
+	public:
+		toy_state(ledger const & committed_a) :
+			committed(committed_a)
+		{
+		}
+
+		uint64_t balance(dev::Address const & account_a)
+		{
+			accessed.insert(account_a);
+			auto it(changes.find(account_a));
+			if (it != changes.end())
+				return it->second;
+			auto c(committed.find(account_a));
+			return c != committed.end() ? c->second : 0;
+		}
+
+		/// return receipt, status and balances after the transfer
+		dev::h256 execute(transfer const & t_a)
+		{
+			uint64_t from_balance(balance(t_a.from));
+			bool status(from_balance >= t_a.value);
+			if (status)
+			{
+				changes[t_a.from] = from_balance - t_a.value;
+				changes[t_a.to] = balance(t_a.to) + t_a.value;
+			}
+			dev::RLPStream s(3);
+			s << (status ? 1 : 0) << balance(t_a.from) << balance(t_a.to);
+			return dev::sha3(s.out());
+		}
+
+		void commit(ledger & committed_a)
+		{
+			for (auto const & c : changes)
+				committed_a[c.first] = c.second;
+		}
+
+		ledger const & committed;
+		ledger changes;
+		dev::AddressHash accessed;
+	};
+
+	std::vector<dev::h256> execute_serial(ledger & ledger_a, std::vector<transfer> const & transfers_a)
+	{
+		std::vector<dev::h256> receipts;
+		for (transfer const & t : transfers_a)
+		{
+			toy_state state(ledger_a);
+			receipts.push_back(state.execute(t));
+			state.commit(ledger_a);
+		}
+		return receipts;
+	}
+
+	std::vector<dev::h256> execute_parallel(mcp::parallel_executor & executor_a, ledger & ledger_a, std::vector<transfer> const & transfers_a, size_t & reexecuted_a)
+	{
+		std::vector<std::unique_ptr<toy_state>> speculations(transfers_a.size());
+		std::vector<dev::h256> speculative_receipts(transfers_a.size());
+		executor_a.run(transfers_a.size(), [&](size_t const & i)
+		{
+			speculations[i] = std::make_unique<toy_state>(ledger_a);
+			speculative_receipts[i] = speculations[i]->execute(transfers_a[i]);
+		});
+
+		mcp::optimistic_batch batch;
+		std::vector<dev::h256> receipts;
+		for (size_t i = 0; i < transfers_a.size(); i++)
+		{
+			if (batch.valid(speculations[i]->accessed))
+			{
+				speculations[i]->commit(ledger_a);
+				batch.commit(speculations[i]->accessed);
+				receipts.push_back(speculative_receipts[i]);
+			}
+			else
+			{
+				toy_state state(ledger_a);
+				receipts.push_back(state.execute(transfers_a[i]));
+				state.commit(ledger_a);
+				batch.commit(state.accessed);
+				reexecuted_a++;
+			}
+		}
+		return receipts;
+	}
+
+	/// receipts, receipts root of each batch and final account states of links executed by chain
+	class links_result
+	{
+	public:
+		std::vector<dev::bytes> receipts;
+		std::vector<dev::h256> receipts_roots;
+		std::vector<dev::h256> states;
+		dev::u256 counter;
+		std::string exec_info;
+	};
+
+	links_result execute_links(unsigned const & threads_a, std::vector<dev::KeyPair> const & funded_a, std::vector<dev::Address> const & accounts_a,
+		dev::Address const & contract_a, std::vector<std::vector<std::shared_ptr<mcp::Transaction>>> const & batches_a)
+	{
+		bool error(false);
+		mcp::block_store store(error, mcp::unique_path());
+		assert_x(!error);
+		std::shared_ptr<mcp::block_cache> cache(std::make_shared<mcp::block_cache>(store));
+		std::shared_ptr<mcp::process_block_cache> local(std::make_shared<mcp::process_block_cache>(cache, store, nullptr, nullptr));
+		std::shared_ptr<mcp::chain> chain(std::make_shared<mcp::chain>(store, cache));
+		chain->set_exec_threads(threads_a);
+		mcp::db::db_transaction transaction(store.create_transaction());
+
+		for (dev::KeyPair const & k : funded_a)
+			local->latest_account_state_put(transaction, k.address(), std::make_shared<mcp::account_state>(k.address(), dev::h256(0), dev::h256(0), 0, dev::u256(1) << 100));
+
+		links_result result;
+		for (size_t b = 0; b < batches_a.size(); b++)
+		{
+			dev::eth::McInfo mc_info(b + 1, b + 1, 1000 + b, b);
+			std::vector<dev::bytes> batch_receipts;
+			for (auto const & receipt : chain->execute_links(transaction, local, mc_info, batches_a[b]))
+			{
+				/// rejected transaction gets empty receipt as in advance_stable_mci
+				dev::RLPStream s;
+				(receipt ? *receipt : dev::eth::TransactionReceipt(0, 0, mcp::log_entries())).streamRLP(s);
+				batch_receipts.push_back(s.out());
+			}
+			result.receipts.insert(result.receipts.end(), batch_receipts.begin(), batch_receipts.end());
+			result.receipts_roots.push_back(dev::orderedTrieRoot(batch_receipts));
+		}
+
+		for (dev::Address const & a : accounts_a)
+		{
+			std::shared_ptr<mcp::account_state> state(local->latest_account_state_get(transaction, a));
+			result.states.push_back(state ? state->hash() : dev::h256(0));
+		}
+		mcp::chain_state reader(transaction, 0, store, chain, local);
+		result.counter = reader.storage(contract_a, 0);
+		result.exec_info = chain->get_exec_info();
+		return result;
+	}
+}
+
+void test_parallel_exec()
+{
+	std::cout << "-------------parallel exec---------------" << std::endl;
+
+	std::mt19937_64 rng(20221017);
+	std::vector<dev::Address> accounts;
+	for (size_t i = 0; i < 64; i++)
+		accounts.push_back(dev::right160(dev::h256(i + 1)));
+
+	ledger genesis;
+	for (dev::Address const & a : accounts)
+		genesis[a] = 1000;
+
+	/// few hot accounts, so that batches have both conflicts and independent transfers
+	std::vector<std::vector<transfer>> batches;
+	for (size_t b = 0; b < 50; b++)
+	{
+		std::vector<transfer> batch;
+		for (size_t i = 0; i < 200; i++)
+		{
+			size_t from(rng() % 8 == 0 ? rng() % 4 : rng() % accounts.size());
+			size_t to(rng() % accounts.size());
+			batch.push_back(transfer{ accounts[from], accounts[to], rng() % 300 });
+		}
+		batches.push_back(batch);
+	}
+
+	ledger serial_ledger(genesis);
+	std::vector<dev::h256> serial_receipts;
+	for (auto const & batch : batches)
+	{
+		auto r(execute_serial(serial_ledger, batch));
+		serial_receipts.push_back(dev::sha3(dev::rlp(r)));
+	}
+
+	for (unsigned threads : { 1, 2, 4, 8 })
+	{
+		mcp::parallel_executor executor(threads);
+		ledger parallel_ledger(genesis);
+		size_t reexecuted(0);
+		bool same(true);
+		for (size_t b = 0; b < batches.size(); b++)
+		{
+			auto r(execute_parallel(executor, parallel_ledger, batches[b], reexecuted));
+			same &= dev::sha3(dev::rlp(r)) == serial_receipts[b];
+		}
+		same &= parallel_ledger == serial_ledger;
+
+		std::cout << "threads:" << threads << ", reexecuted:" << reexecuted
+			<< (same ? ", same as serial" : ", ERROR: differs from serial") << std::endl;
+	}
+}
+
+void test_parallel_exec_links()
+{
+	std::cout << "-------------parallel exec links---------------" << std::endl;
+
+	mcp::db::database::init_table_cache(64);
+	std::mt19937_64 rng(20221018);
+	std::vector<dev::KeyPair> funded;
+	for (size_t i = 0; i < 16; i++)
+		funded.push_back(dev::KeyPair::create());
+	dev::KeyPair unfunded(dev::KeyPair::create());
+	std::vector<dev::Address> accounts;
+	for (dev::KeyPair const & k : funded)
+		accounts.push_back(k.address());
+	accounts.push_back(unfunded.address());
+	for (size_t i = 0; i < 16; i++)
+		accounts.push_back(dev::right160(dev::sha3(dev::h256(i + 100))));
+
+	std::vector<uint64_t> nonces(funded.size(), 0);
+	auto sign = [&](size_t const & from_a, dev::Address const & to_a, dev::u256 const & value_a, dev::bytes const & data_a) {
+		mcp::TransactionSkeleton ts;
+		ts.from = funded[from_a].address();
+		ts.to = to_a;
+		ts.value = value_a;
+		ts.data = data_a;
+		ts.nonce = nonces[from_a]++;
+		ts.gas = 100000;
+		ts.gasPrice = 1000;
+		return std::make_shared<mcp::Transaction>(ts, funded[from_a].secret());
+	};
+
+	/// counter contract: storage 0 incremented by every call
+	dev::bytes const runtime{ 0x60, 0x00, 0x54, 0x60, 0x01, 0x01, 0x60, 0x00, 0x55, 0x00 };
+	dev::bytes init{ 0x60, 0x0a, 0x60, 0x0c, 0x60, 0x00, 0x39, 0x60, 0x0a, 0x60, 0x00, 0xf3 };
+	init.insert(init.end(), runtime.begin(), runtime.end());
+	dev::Address const contract(dev::right160(dev::sha3(dev::rlpList(funded[0].address(), dev::u256(0)))));
+	accounts.push_back(contract);
+
+	std::vector<std::vector<std::shared_ptr<mcp::Transaction>>> batches;
+	batches.push_back({ sign(0, dev::Address(), 0, init) });
+	size_t calls(0);
+	/// independent transfers, contract calls and transfers between funded accounts conflict
+	for (size_t b = 0; b < 4; b++)
+	{
+		std::vector<std::shared_ptr<mcp::Transaction>> batch;
+		for (size_t round = 0; round < 3; round++)
+		{
+			for (size_t s = 0; s < funded.size(); s++)
+			{
+				switch (rng() % 4)
+				{
+				case 0:
+					batch.push_back(sign(s, contract, 0, {}));
+					calls++;
+					break;
+				case 1:
+					batch.push_back(sign(s, funded[rng() % funded.size()].address(), rng() % 1000, {}));
+					break;
+				default:
+					batch.push_back(sign(s, accounts[funded.size() + 1 + rng() % 16], rng() % 1000, {}));
+					break;
+				}
+			}
+		}
+		/// rejected by nonce, and not enough balance
+		mcp::TransactionSkeleton ts;
+		ts.from = funded[b].address();
+		ts.to = contract;
+		ts.nonce = nonces[b] + 5;
+		ts.gas = 100000;
+		ts.gasPrice = 1000;
+		batch.insert(batch.begin() + batch.size() / 2, std::make_shared<mcp::Transaction>(ts, funded[b].secret()));
+		ts.from = unfunded.address();
+		ts.nonce = b;
+		batch.push_back(std::make_shared<mcp::Transaction>(ts, unfunded.secret()));
+		batches.push_back(batch);
+	}
+
+	links_result serial(execute_links(0, funded, accounts, contract, batches));
+	std::cout << "serial links counter:" << serial.counter << (serial.counter == calls ? "" : ", ERROR: counter differs from calls") << std::endl;
+	for (unsigned threads : { 2, 4, 8 })
+	{
+		links_result parallel(execute_links(threads, funded, accounts, contract, batches));
+		std::cout << "threads:" << threads << ", " << parallel.exec_info
+			<< (parallel.receipts == serial.receipts ? "" : ", ERROR: receipts differ from serial")
+			<< (parallel.receipts_roots == serial.receipts_roots ? "" : ", ERROR: receipts root differs from serial")
+			<< (parallel.states == serial.states ? "" : ", ERROR: account states differ from serial")
+			<< (parallel.counter == serial.counter ? "" : ", ERROR: contract storage differs from serial")
+			<< (parallel.exec_info.find("committed:0 ") == std::string::npos ? "" : ", ERROR: no speculative result committed")
+			<< (parallel.exec_info.find("reexecuted:0") == std::string::npos ? "" : ", ERROR: no conflict reexecuted") << std::endl;
+	}
+}
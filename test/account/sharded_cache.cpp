@@ -0,0 +1,119 @@
+#include <mcp/common/sharded_cache.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+	/// entry of uint64_t key and value, key and value besides overhead of an entry
+	size_t const entry_bytes(sizeof(uint64_t) + sizeof(uint64_t) + 48);
+	size_t const shard_count(16);
+}
+
+void test_sharded_cache()
+{
+	std::cout << "-------------sharded cache---------------" << std::endl;
+
+	std::string errors;
+	auto expect = [&](bool const & ok_a, std::string const & what_a) {
+		if (!ok_a)
+			errors += ", ERROR: " + what_a;
+	};
+
+	{
+		/// four entries a shard
+		size_t const capacity(shard_count * entry_bytes * 4);
+		mcp::sharded_cache<uint64_t, uint64_t> cache("eviction", capacity);
+		uint64_t const count(10000);
+		for (uint64_t i(0); i < count; i++)
+		{
+			cache.insert(i, i * 2);
+			expect(cache.bytes() <= capacity, "over capacity");
+		}
+		expect(cache.size() <= shard_count * 4, "over entries");
+		expect(cache.bytes() == cache.size() * entry_bytes, "bytes differ from entries");
+		expect(cache.evictions() == count - cache.size(), "evictions differ");
+
+		/// latest inserted is referenced, evicted ones are gone
+		uint64_t value(0);
+		expect(cache.tryGet(count - 1, value) && value == (count - 1) * 2, "latest evicted");
+		size_t found(0);
+		for (uint64_t i(0); i < count; i++)
+		{
+			if (cache.tryGet(i, value))
+			{
+				found++;
+				expect(value == i * 2, "wrong value");
+			}
+		}
+		expect(found == cache.size(), "entries not found");
+
+		/// overwrite keeps one entry
+		cache.insert(count - 1, 1);
+		expect(cache.tryGet(count - 1, value) && value == 1, "overwrite lost");
+		expect(cache.bytes() == cache.size() * entry_bytes, "overwrite bytes");
+
+		cache.remove(count - 1);
+		expect(!cache.tryGet(count - 1, value), "removed found");
+		expect(cache.bytes() == cache.size() * entry_bytes, "remove bytes");
+
+		cache.clear();
+		expect(cache.size() == 0 && cache.bytes() == 0, "clear");
+	}
+
+	{
+		/// value larger than shard removes cached value of key
+		size_t const capacity(shard_count * 1024);
+		mcp::sharded_cache<uint64_t, std::string> cache("oversize", capacity, [](std::string const & value_a) { return value_a.size(); });
+		cache.insert(1, "small");
+		std::string value;
+		expect(cache.tryGet(1, value) && value == "small", "small not cached");
+		cache.insert(1, std::string(2048, 'x'));
+		expect(!cache.tryGet(1, value), "stale value after oversize insert");
+		expect(cache.size() == 0 && cache.bytes() == 0, "oversize bytes");
+	}
+
+	{
+		/// readers and writers of overlapping keys, a key has one value
+		size_t const capacity(shard_count * entry_bytes * 64);
+		mcp::sharded_cache<uint64_t, uint64_t> cache("concurrency", capacity);
+		size_t const threads(8);
+		uint64_t const keys(4096);
+		uint64_t const ops(200000);
+		std::atomic<uint64_t> wrong(0);
+		std::atomic<uint64_t> hits(0);
+		std::vector<std::thread> workers;
+		for (size_t t(0); t < threads; t++)
+		{
+			workers.emplace_back([&, t]() {
+				uint64_t key(t);
+				for (uint64_t i(0); i < ops; i++)
+				{
+					key = (key * 6364136223846793005ull + 1442695040888963407ull) % keys;
+					uint64_t value(0);
+					if (cache.tryGet(key, value))
+					{
+						hits++;
+						if (value != key * 2)
+							wrong++;
+					}
+					else if (i % 16 == t)
+						cache.remove(key);
+					else
+						cache.insert(key, key * 2);
+				}
+			});
+		}
+		for (auto & w : workers)
+			w.join();
+
+		expect(wrong == 0, "wrong value read");
+		expect(cache.bytes() <= capacity, "over capacity");
+		expect(cache.bytes() == cache.size() * entry_bytes, "bytes differ from entries");
+		expect(cache.hits() == hits, "hits differ");
+		std::cout << cache.report() << std::endl;
+	}
+
+	std::cout << "sharded cache" << (errors.empty() ? " ok" : errors) << std::endl;
+}
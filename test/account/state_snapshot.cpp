@@ -0,0 +1,206 @@
+#include <mcp/core/snapshot_archive.hpp>
+
+#include <libdevcore/TrieHash.h>
+#include <libdevcrypto/Common.h>
+
+#include <functional>
+#include <iostream>
+
+namespace
+{
+	/// chunks go through rlp as between serving and importing node
+	mcp::snapshot_chunk transfer(mcp::snapshot_chunk const & chunk_a, bool & error_a)
+	{
+		dev::RLPStream s;
+		chunk_a.stream_RLP(s);
+		return mcp::snapshot_chunk(error_a, dev::RLP(s.out()));
+	}
+
+	/// stable genesis block linking a transaction, with its summary, receipt, account states, a contract trie node and unlink entries
+	void populate(mcp::block_store & store_a, size_t const & accounts_a)
+	{
+		mcp::db::db_transaction transaction(store_a.create_transaction());
+
+		dev::KeyPair key(dev::KeyPair::create());
+		mcp::TransactionSkeleton ts;
+		ts.from = key.address();
+		ts.to = dev::Address(2);
+		ts.nonce = 0;
+		ts.gas = 21000;
+		ts.gasPrice = 1;
+		mcp::Transaction t(ts, key.secret());
+		store_a.transaction_put(transaction, t.sha3(), t);
+		dev::eth::TransactionReceipt receipt(1, 21000, mcp::log_entries());
+		store_a.transaction_receipt_put(transaction, t.sha3(), receipt);
+
+		mcp::block genesis(dev::Address(1), mcp::block_hash(0), {}, { t.sha3() }, {}, mcp::summary_hash(0), mcp::block_hash(0), mcp::block_hash(0), 1000, dev::Secret());
+		mcp::block_hash hash(genesis.hash());
+		store_a.block_put(transaction, hash, genesis);
+
+		mcp::block_state state;
+		state.status = mcp::block_status::ok;
+		state.is_stable = true;
+		state.is_on_main_chain = true;
+		state.main_chain_index = 0;
+		state.mc_timestamp = 1000;
+		store_a.block_state_put(transaction, hash, state);
+		store_a.main_chain_put(transaction, 0, hash);
+		mcp::dag_account_info info;
+		info.latest_stable_block = hash;
+		store_a.dag_account_put(transaction, dev::Address(1), info);
+
+		dev::RLPStream receipt_rlp;
+		receipt.streamRLP(receipt_rlp);
+		dev::h256 receipts_root(dev::orderedTrieRoot(std::vector<dev::bytes>{ receipt_rlp.out() }));
+		store_a.PutBlockReceiptsRoot(transaction, hash, receipts_root);
+		mcp::summary_hash summary(mcp::summary::gen_summary_hash(hash, mcp::summary_hash(0), {}, receipts_root, {}, state.status, state.stable_index, state.mc_timestamp));
+		store_a.block_summary_put(transaction, hash, summary);
+		store_a.summary_block_put(transaction, summary, hash);
+
+		store_a.genesis_hash_put(transaction, hash);
+		store_a.last_stable_mci_put(transaction, 0);
+		store_a.last_stable_index_put(transaction, 0);
+		transaction.count_add("block", 1);
+
+		for (size_t i(0); i < accounts_a; i++)
+		{
+			dev::Address account(i + 100);
+			mcp::account_state s(account, dev::h256(i), dev::h256(0), 0, i * 1000);
+			dev::h256 s_hash(s.hash());
+			store_a.account_state_put(transaction, s_hash, s);
+			store_a.latest_account_state_put(transaction, account, s_hash);
+		}
+
+		std::string node("contract trie node");
+		store_a.contract_main_trie_node_put(transaction, mcp::code_hash(dev::sha3(node)), node);
+
+		transaction.put(store_a.unlink_block, mcp::h256_to_slice(dev::h256(1)), mcp::h256_to_slice(dev::h256(2)));
+		transaction.put(store_a.head_unlink, mcp::h256_to_slice(dev::h256(3)), mcp::h256_to_slice(dev::h256(4)));
+		transaction.commit();
+	}
+
+	/// import every chunk of reader into target, tamper_a may change received chunks. return true if finish failed
+	bool import(mcp::state_snapshot_reader & reader_a, mcp::snapshot_manifest const & manifest_a, mcp::block_store & target_a,
+		std::function<void(mcp::state_snapshot_writer &, mcp::snapshot_chunk &)> const & tamper_a, std::string & info_a)
+	{
+		bool error(false);
+		mcp::state_snapshot_writer writer(error, target_a, manifest_a);
+		assert_x(!error);
+
+		mcp::snapshot_table table;
+		dev::bytes from;
+		while (writer.next(table, from))
+		{
+			mcp::snapshot_chunk chunk;
+			assert_x(!reader_a.read(table, from, 4096, chunk));
+			mcp::snapshot_chunk received(transfer(chunk, error));
+			assert_x(!error);
+			tamper_a(writer, received);
+			assert_x(!writer.write(received));
+		}
+		bool failed(writer.finish(manifest_a.stable_summary));
+		info_a = writer.get_info();
+		return failed;
+	}
+}
+
+void test_state_snapshot()
+{
+	std::cout << "-------------state snapshot---------------" << std::endl;
+
+	mcp::db::database::init_table_cache(64);
+	size_t const accounts(5000);
+	bool error(false);
+	mcp::block_store source(error, mcp::unique_path());
+	assert_x(!error);
+	populate(source, accounts);
+
+	mcp::state_snapshot_reader reader(source);
+	{
+		/// written after snapshot, must not be exported
+		mcp::db::db_transaction transaction(source.create_transaction());
+		mcp::account_state late(dev::Address(1), dev::h256(1), dev::h256(0), 0, 1);
+		source.account_state_put(transaction, late.hash(), late);
+		source.latest_account_state_put(transaction, dev::Address(1), late.hash());
+		transaction.commit();
+	}
+
+	dev::RLPStream manifest_rlp;
+	reader.manifest().stream_RLP(manifest_rlp);
+	mcp::snapshot_manifest manifest(error, dev::RLP(manifest_rlp.out()));
+	assert_x(!error);
+
+	mcp::block_store target(error, mcp::unique_path());
+	assert_x(!error);
+	bool tampered_rejected(false);
+	std::string info;
+	bool finished(!import(reader, manifest, target, [&](mcp::state_snapshot_writer & writer_a, mcp::snapshot_chunk & chunk_a) {
+		if (chunk_a.table == mcp::snapshot_table::account_state && !tampered_rejected)
+		{
+			mcp::snapshot_chunk tampered(chunk_a);
+			tampered.entries.front().second.back() ^= 1;
+			tampered_rejected = writer_a.write(tampered);
+		}
+	}, info));
+
+	mcp::db::db_transaction transaction(target.create_transaction());
+	size_t imported_accounts(0);
+	for (mcp::db::forward_iterator it(transaction.begin(target.latest_account_state)); it.valid(); ++it)
+		imported_accounts++;
+	dev::h256 late_hash;
+	bool late_excluded(target.latest_account_state_get(transaction, dev::Address(1), late_hash));
+	std::string unlink;
+	bool unlink_imported(transaction.get(target.unlink_block, mcp::h256_to_slice(dev::h256(1)), unlink)
+		&& transaction.get(target.head_unlink, mcp::h256_to_slice(dev::h256(3)), unlink));
+
+	std::cout << info
+		<< (finished ? "" : ", ERROR: import not finished")
+		<< (imported_accounts == accounts ? "" : ", ERROR: accounts differ")
+		<< (late_excluded ? "" : ", ERROR: write after snapshot exported")
+		<< (tampered_rejected ? "" : ", ERROR: tampered chunk accepted")
+		<< (unlink_imported ? "" : ", ERROR: unlink tables not imported")
+		<< (transaction.count_get("block") == 1 ? "" : ", ERROR: counters differ") << std::endl;
+
+	/// well formed entries breaking receipts root or references are found by finish
+	mcp::block_store receipt_target(error, mcp::unique_path());
+	assert_x(!error);
+	bool receipt_failed(import(reader, manifest, receipt_target, [](mcp::state_snapshot_writer &, mcp::snapshot_chunk & chunk_a) {
+		if (chunk_a.table == mcp::snapshot_table::transaction_receipt)
+		{
+			dev::RLPStream s;
+			dev::eth::TransactionReceipt(0, 21000, mcp::log_entries()).streamRLP(s);
+			chunk_a.entries.front().second = s.out();
+		}
+	}, info));
+
+	mcp::block_store state_target(error, mcp::unique_path());
+	assert_x(!error);
+	bool state_failed(import(reader, manifest, state_target, [](mcp::state_snapshot_writer &, mcp::snapshot_chunk & chunk_a) {
+		if (chunk_a.table == mcp::snapshot_table::latest_account_state && chunk_a.entries.size() > 1)
+			std::swap(chunk_a.entries[0].second, chunk_a.entries[1].second);
+	}, info));
+
+	std::cout << "state snapshot finish"
+		<< (receipt_failed ? "" : ", ERROR: changed receipt accepted")
+		<< (state_failed ? "" : ", ERROR: latest account state of other account accepted") << std::endl;
+
+	/// offline archive of sst files, bulk loaded into another store
+	boost::filesystem::path archive_path(mcp::unique_path());
+	mcp::snapshot_archive exported(archive_path);
+	bool archive_written(!exported.write(source, 4));
+
+	mcp::block_store bulk(error, mcp::unique_path());
+	assert_x(!error);
+	mcp::snapshot_archive imported(archive_path);
+	bool archive_read(!imported.read(bulk, 4, manifest.stable_summary));
+
+	mcp::db::db_transaction bulk_transaction(bulk.create_transaction());
+	size_t bulk_accounts(0);
+	for (mcp::db::forward_iterator it(bulk_transaction.begin(bulk.account_state)); it.valid(); ++it)
+		bulk_accounts++;
+
+	std::cout << exported.get_info() << std::endl << imported.get_info()
+		<< (archive_written ? "" : ", ERROR: archive not written")
+		<< (archive_read ? "" : ", ERROR: archive not imported")
+		<< (bulk_accounts == accounts + 1 ? "" : ", ERROR: accounts differ") << std::endl;
+}
@@ -0,0 +1,227 @@
+#include <mcp/node/transaction_queue.hpp>
+
+#include <libdevcrypto/Common.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace
+{
+	class queued_transaction
+	{
+	public:
+		dev::Address sender;
+		uint64_t nonce;
+		dev::u256 fee;
+	};
+
+	std::shared_ptr<mcp::Transaction> signed_transaction(dev::KeyPair const & key_a, uint64_t const & nonce_a, dev::u256 const & gas_price_a)
+	{
+		mcp::TransactionSkeleton ts;
+		ts.from = key_a.address();
+		ts.to = dev::Address(1);
+		ts.nonce = nonce_a;
+		ts.gas = 21000;
+		ts.gasPrice = gas_price_a;
+		return std::make_shared<mcp::Transaction>(ts, key_a.secret());
+	}
+
+	/// account with balance for local and broadcast transactions, which are checked against stable state
+	dev::KeyPair funded_key(mcp::block_store & store_a)
+	{
+		dev::KeyPair key(dev::KeyPair::create());
+		mcp::db::db_transaction transaction(store_a.create_transaction());
+		mcp::account_state s(key.address(), dev::h256(0), dev::h256(0), 0, dev::u256(1) << 100);
+		store_a.account_state_put(transaction, s.hash(), s);
+		store_a.latest_account_state_put(transaction, key.address(), s.hash());
+		transaction.commit();
+		return key;
+	}
+
+	bool info_has(mcp::TransactionQueue & tq_a, std::string const & counter_a)
+	{
+		return tq_a.getInfo().find(" ," + counter_a + " ,") != std::string::npos;
+	}
+
+	dev::u256 fee_of(std::vector<queued_transaction> const & picked_a)
+	{
+		dev::u256 result(0);
+		for (queued_transaction const & t : picked_a)
+			result += t.fee;
+		return result;
+	}
+}
+
+void test_transaction_queue()
+{
+	std::cout << "-------------transaction queue---------------" << std::endl;
+
+	mcp::db::database::init_table_cache(64);
+	bool error(false);
+	mcp::block_store store(error, mcp::unique_path());
+	assert_x(!error);
+	std::shared_ptr<mcp::block_cache> cache(std::make_shared<mcp::block_cache>(store));
+	boost::asio::io_service io_service;
+	mcp::TransactionQueue tq(io_service, store, cache, nullptr, nullptr);
+
+	size_t const senders(1000);
+	size_t const nonces(100);
+	unsigned const limit(4096);
+	std::mt19937_64 random(1);
+	std::unordered_map<dev::h256, queued_transaction> queued;
+	std::vector<std::vector<queued_transaction>> by_sender(senders);
+	for (size_t s(0); s < senders; s++)
+	{
+		dev::KeyPair key(dev::KeyPair::create());
+		for (size_t n(0); n < nonces; n++)
+		{
+			mcp::TransactionSkeleton ts;
+			ts.from = key.address();
+			ts.to = dev::Address(1);
+			ts.nonce = n;
+			ts.gas = 21000;
+			ts.gasPrice = mcp::gas_price + random() % 1000;
+			std::shared_ptr<mcp::Transaction> t(std::make_shared<mcp::Transaction>(ts, key.secret()));
+			assert_x(tq.import(t, mcp::source::sync) == mcp::ImportResult::Success);
+
+			queued_transaction q{ key.address(), n, ts.gas * ts.gasPrice };
+			queued[t->sha3()] = q;
+			by_sender[s].push_back(q);
+		}
+	}
+
+	auto start(std::chrono::steady_clock::now());
+	dev::h256s top(tq.topTransactions(limit));
+	auto top_us(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+	/// transactions of a sender are taken in nonce order, no sender over the limit while others wait
+	std::vector<queued_transaction> picked;
+	std::unordered_map<dev::Address, uint64_t> next_nonces;
+	bool nonce_ordered(true);
+	size_t max_per_sender(0);
+	for (dev::h256 const & h : top)
+	{
+		queued_transaction const & q(queued.at(h));
+		uint64_t & next(next_nonces[q.sender]);
+		nonce_ordered = nonce_ordered && q.nonce == next;
+		next++;
+		max_per_sender = std::max<size_t>(max_per_sender, next);
+		picked.push_back(q);
+	}
+
+	/// accounts taken one after another as before
+	std::vector<queued_transaction> unordered;
+	for (size_t s(0); s < senders && unordered.size() < limit; s++)
+	{
+		for (size_t n(0); n < nonces && unordered.size() < limit; n++)
+			unordered.push_back(by_sender[s][n]);
+	}
+
+	std::cout << "transaction queue txs:" << queued.size()
+		<< " ,top:" << top.size()
+		<< " ,top time:" << top_us << "us"
+		<< " ,senders:" << next_nonces.size()
+		<< " ,max per sender:" << max_per_sender
+		<< " ,fee:" << fee_of(picked)
+		<< " ,fee of unordered:" << fee_of(unordered)
+		<< (top.size() == limit ? "" : ", ERROR: top size differs")
+		<< (nonce_ordered ? "" : ", ERROR: nonce not ordered")
+		<< (max_per_sender <= 64 ? "" : ", ERROR: sender over limit")
+		<< (fee_of(picked) >= fee_of(unordered) ? "" : ", ERROR: fee lower than unordered") << std::endl;
+}
+
+void test_transaction_pool()
+{
+	std::cout << "-------------transaction pool---------------" << std::endl;
+
+	mcp::db::database::init_table_cache(64);
+	bool error(false);
+	mcp::block_store store(error, mcp::unique_path());
+	assert_x(!error);
+	std::shared_ptr<mcp::block_cache> cache(std::make_shared<mcp::block_cache>(store));
+	boost::asio::io_service io_service;
+	std::shared_ptr<mcp::async_task> async(std::make_shared<mcp::async_task>(io_service));
+
+	dev::KeyPair a(funded_key(store)), b(funded_key(store)), c(funded_key(store)), d(funded_key(store)), e(funded_key(store));
+	std::string errors;
+	auto expect = [&](bool const & ok_a, std::string const & what_a) {
+		if (!ok_a)
+			errors += ", ERROR: " + what_a;
+	};
+
+	{
+		mcp::TransactionQueue tq(io_service, store, cache, nullptr, async);
+		tq.set_limits(8, SIZE_MAX);
+
+		/// ready transactions of a, pending transactions of b with a nonce gap
+		std::vector<std::shared_ptr<mcp::Transaction>> ready, waiting;
+		for (uint64_t n(0); n < 4; n++)
+		{
+			ready.push_back(signed_transaction(a, n, 100));
+			expect(tq.importLocal(ready.back()) == mcp::ImportResult::Success, "ready rejected");
+			waiting.push_back(signed_transaction(b, n + 2, 50 + n));
+			expect(tq.importLocal(waiting.back()) == mcp::ImportResult::Success, "pending rejected");
+		}
+
+		/// full pool rejects a transaction cheaper than all pending ones, a better one evicts the cheapest pending
+		expect(tq.importLocal(signed_transaction(c, 0, 10)) == mcp::ImportResult::OverbidGasPrice, "underpriced taken");
+		expect(tq.importLocal(signed_transaction(c, 0, 200)) == mcp::ImportResult::Success, "better rejected");
+		dev::h256Hash known(tq.knownTransactions());
+		expect(!known.count(waiting[0]->sha3()) && known.count(waiting[1]->sha3()), "eviction order");
+
+		/// replacement pays 10 percent more
+		expect(tq.importLocal(signed_transaction(a, 3, 105)) == mcp::ImportResult::OverbidGasPrice, "replaced without bump");
+		std::shared_ptr<mcp::Transaction> bumped(signed_transaction(a, 3, 110));
+		expect(tq.importLocal(bumped) == mcp::ImportResult::Success, "bumped replace rejected");
+
+		/// pending evicted one by one, ready transactions are never evicted
+		for (uint64_t n(1); n < 4; n++)
+			expect(tq.importLocal(signed_transaction(c, n, 200)) == mcp::ImportResult::Success, "better rejected");
+		expect(tq.importLocal(signed_transaction(e, 0, 10000)) == mcp::ImportResult::OverbidGasPrice, "ready transaction evicted");
+		for (size_t i(0); i < 3; i++)
+			expect(tq.exist(ready[i]->sha3()), "ready transaction missing");
+		expect(tq.exist(bumped->sha3()), "replacing transaction missing");
+
+		expect(info_has(tq, "pooled:8"), "pooled count");
+		expect(info_has(tq, "evicted:4"), "evicted counter");
+		expect(info_has(tq, "rejected underpriced:2"), "underpriced counter");
+		expect(info_has(tq, "rejected replace:1"), "replace counter");
+
+		/// slots of an account
+		tq.set_limits(4096, SIZE_MAX);
+		for (uint64_t n(0); n < 1024; n++)
+			expect(tq.importLocal(signed_transaction(d, n, 100)) == mcp::ImportResult::Success, "account slot rejected");
+		expect(tq.importLocal(signed_transaction(d, 1024, 100)) == mcp::ImportResult::FutureFull, "account over slots");
+		expect(info_has(tq, "rejected account:1"), "account counter");
+		std::cout << tq.getInfo() << std::endl;
+	}
+
+	{
+		/// a peer holds an eighth of pool at most
+		mcp::TransactionQueue tq(io_service, store, cache, nullptr, async);
+		tq.set_limits(16, SIZE_MAX);
+		std::atomic<size_t> imported(0), rejected(0);
+		tq.onImport([&](mcp::ImportResult ir_a, mcp::p2p::node_id const &) {
+			if (ir_a == mcp::ImportResult::FutureFull)
+				rejected++;
+			imported++;
+		});
+		mcp::p2p::node_id peer(1);
+		for (uint64_t n(0); n < 3; n++)
+		{
+			tq.enqueue(signed_transaction(e, n, 100), peer, mcp::source::broadcast);
+			/// imported in order of nonce
+			while (imported <= n)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		expect(rejected == 1, "peer over quota");
+		expect(info_has(tq, "rejected peer:1"), "peer counter");
+		expect(info_has(tq, "pooled peers:1"), "pooled peers");
+		std::cout << tq.getInfo() << std::endl;
+	}
+
+	std::cout << "transaction pool" << (errors.empty() ? " ok" : errors) << std::endl;
+}